@@ -1,28 +1,259 @@
 #include "logger.h"
+
 #include <glog/logging.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace logger {
 
+namespace detail {
+std::atomic<int> min_level{static_cast<int>(LogLevel::INFO)};
+} // namespace detail
+
+namespace {
+
+// 预留容量覆盖绝大多数单行日志，缓冲区与队列槽位交换后容量随之流转
+constexpr size_t kMessageReserve = 256;
+// 后台线程空闲时的最长等待，生产者不持锁通知，唤醒丢失时靠它兜底
+constexpr auto kIdleWait = std::chrono::milliseconds(2);
+
+struct ThreadBuffer {
+    std::string text;
+    bool in_use = false;
+
+    ThreadBuffer() { text.reserve(kMessageReserve); }
+};
+
+ThreadBuffer& thread_buffer() {
+    thread_local ThreadBuffer buffer;
+    return buffer;
+}
+
+std::atomic<LogWriter> g_writer{nullptr};
+
+void write_to_glog(LogLevel level, const char* file, int line, const char* message, size_t size) {
+    google::LogSeverity severity = google::GLOG_INFO;
+    switch (level) {
+        case LogLevel::INFO: severity = google::GLOG_INFO; break;
+        case LogLevel::WARNING: severity = google::GLOG_WARNING; break;
+        case LogLevel::ERROR: severity = google::GLOG_ERROR; break;
+        case LogLevel::FATAL: severity = google::GLOG_FATAL; break;
+    }
+    google::LogMessage(file, line, severity).stream().write(message, static_cast<std::streamsize>(size));
+}
+
+void write_message(LogLevel level, const char* file, int line, const std::string& message) {
+    LogWriter writer = g_writer.load(std::memory_order_acquire);
+    (writer ? writer : write_to_glog)(level, file, line, message.data(), message.size());
+}
+
+size_t round_up_power_of_two(size_t n) {
+    size_t capacity = 2;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+// 多生产者单消费者的有界环形队列（Vyukov 序号槽位算法），入队只有一次 CAS，不加锁。
+// 消息体与调用线程的缓冲区交换而非拷贝。
+class AsyncLogger {
+public:
+    explicit AsyncLogger(const AsyncLoggerOptions& options)
+        : overflow_(options.overflow),
+          capacity_(round_up_power_of_two(options.queue_capacity)),
+          mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+            slots_[i].message.reserve(kMessageReserve);
+        }
+        worker_ = std::thread([this] { run(); });
+    }
+
+    // 返回 false 表示按 DROP 策略丢弃
+    bool push(LogLevel level, const char* file, int line, std::string& message) {
+        while (!try_push(level, file, line, message)) {
+            // 已停止的实例不会再被消费，BLOCK 也只能丢弃
+            if (overflow_ == OverflowPolicy::DROP || stop_.load(std::memory_order_acquire)) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wake();
+            std::this_thread::yield();
+        }
+        if (sleeping_.load(std::memory_order_relaxed)) wake();
+        return true;
+    }
+
+    void flush() {
+        const size_t target = enqueue_pos_.load(std::memory_order_acquire);
+        while (written_.load(std::memory_order_acquire) < target && !stop_.load(std::memory_order_acquire)) {
+            wake();
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    // 停止后台线程并写出剩余消息
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        wake();
+        if (worker_.joinable()) worker_.join();
+        drain();
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogLevel level = LogLevel::INFO;
+        const char* file = nullptr;
+        int line = 0;
+        std::string message;
+    };
+
+    const OverflowPolicy overflow_;
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0;  // 只由消费者访问
+    std::atomic<size_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_dropped_ = 0;
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> sleeping_{false};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::thread worker_;
+
+    bool try_push(LogLevel level, const char* file, int line, std::string& message) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // 队列已满
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->level = level;
+        slot->file = file;
+        slot->line = line;
+        slot->message.swap(message);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop_and_write() {
+        Slot& slot = slots_[dequeue_pos_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) return false;
+        write_message(slot.level, slot.file, slot.line, slot.message);
+        slot.message.clear();
+        slot.sequence.store(dequeue_pos_ + capacity_, std::memory_order_release);
+        ++dequeue_pos_;
+        written_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    // 返回写出的条数
+    size_t drain() {
+        size_t count = 0;
+        while (try_pop_and_write()) ++count;
+        const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_dropped_) {
+            const std::string notice = "[Logger] Async queue full, dropped " +
+                                       std::to_string(dropped - reported_dropped_) + " log messages";
+            write_message(LogLevel::WARNING, __FILE__, __LINE__, notice);
+            reported_dropped_ = dropped;
+        }
+        return count;
+    }
+
+    void run() {
+        while (!stop_.load(std::memory_order_acquire)) {
+            if (drain() > 0) continue;
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            sleeping_.store(true, std::memory_order_relaxed);
+            wait_cv_.wait_for(lock, kIdleWait);
+            sleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void wake() { wait_cv_.notify_one(); }
+};
+
+// 停用后的实例不释放：可能仍有线程刚读到旧指针、正在入队
+std::atomic<AsyncLogger*> g_async{nullptr};
+std::mutex g_async_mutex;
+std::vector<std::unique_ptr<AsyncLogger>> g_retired;
+
+void stop_async_locked() {
+    AsyncLogger* current = g_async.exchange(nullptr, std::memory_order_acq_rel);
+    if (!current) return;
+    current->stop();
+    g_retired.emplace_back(current);
+}
+
+} // namespace
+
+namespace detail {
+
+void submit(LogLevel level, const char* file, int line, std::string& message) {
+    AsyncLogger* async = g_async.load(std::memory_order_acquire);
+    if (async && level != LogLevel::FATAL) {
+        async->push(level, file, line, message);
+        return;
+    }
+    // FATAL 会终止进程，先保证此前的日志落盘
+    if (async) async->flush();
+    write_message(level, file, line, message);
+}
+
+} // namespace detail
+
 LoggerStream::LoggerStream(LogLevel level, const char* file, int line)
-    : level_(level), file_(file), line_(line) {}
+    : level_(level), file_(file), line_(line) {
+    ThreadBuffer& buffer = thread_buffer();
+    if (buffer.in_use) {
+        text_ = &nested_;
+    } else {
+        buffer.in_use = true;
+        owns_thread_buffer_ = true;
+        buffer.text.clear();
+        text_ = &buffer.text;
+    }
+}
 
 LoggerStream::~LoggerStream() {
-    switch (level_) {
-        case LogLevel::INFO:
-            google::LogMessage(file_, line_, google::GLOG_INFO).stream() << stream_.str();
-            break;
-        case LogLevel::WARNING:
-            google::LogMessage(file_, line_, google::GLOG_WARNING).stream() << stream_.str();
-            break;
-        case LogLevel::ERROR:
-            google::LogMessage(file_, line_, google::GLOG_ERROR).stream() << stream_.str();
-            break;
-        case LogLevel::FATAL:
-            google::LogMessage(file_, line_, google::GLOG_FATAL).stream() << stream_.str();
-            break;
+    detail::submit(level_, file_, line_, *text_);
+    if (owns_thread_buffer_) {
+        ThreadBuffer& buffer = thread_buffer();
+        // 与队列槽位交换回来的缓冲区可能没有预留容量
+        if (buffer.text.capacity() < kMessageReserve) buffer.text.reserve(kMessageReserve);
+        buffer.in_use = false;
     }
 }
 
+void LoggerStream::append_floating(long double value) {
+    // 与 std::ostream 的默认格式（%g，6 位有效数字）一致
+    char buffer[64];
+    const int n = std::snprintf(buffer, sizeof(buffer), "%Lg", value);
+    if (n > 0) text_->append(buffer, static_cast<size_t>(n));
+}
+
 void InitLogger(const char* program_name, int stderr_level) {
     google::InitGoogleLogging(program_name);
     google::SetStderrLogging(static_cast<google::LogSeverity>(stderr_level));
@@ -30,7 +261,48 @@ void InitLogger(const char* program_name, int stderr_level) {
 }
 
 void ShutdownLogger() {
+    DisableAsyncLogging();
     google::ShutdownGoogleLogging();
 }
 
+void SetLogLevel(LogLevel level) {
+    detail::min_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel GetLogLevel() {
+    return static_cast<LogLevel>(detail::min_level.load(std::memory_order_relaxed));
+}
+
+void EnableAsyncLogging(const AsyncLoggerOptions& options) {
+    std::lock_guard<std::mutex> lock(g_async_mutex);
+    stop_async_locked();
+    g_async.store(new AsyncLogger(options), std::memory_order_release);
+}
+
+void DisableAsyncLogging() {
+    std::lock_guard<std::mutex> lock(g_async_mutex);
+    stop_async_locked();
+}
+
+bool IsAsyncLoggingEnabled() {
+    return g_async.load(std::memory_order_acquire) != nullptr;
+}
+
+void FlushLogger() {
+    if (AsyncLogger* async = g_async.load(std::memory_order_acquire)) async->flush();
+    google::FlushLogFiles(google::GLOG_INFO);
+}
+
+uint64_t DroppedLogCount() {
+    std::lock_guard<std::mutex> lock(g_async_mutex);
+    uint64_t total = 0;
+    for (const auto& retired : g_retired) total += retired->dropped();
+    if (AsyncLogger* async = g_async.load(std::memory_order_acquire)) total += async->dropped();
+    return total;
+}
+
+void SetLogWriter(LogWriter writer) {
+    g_writer.store(writer, std::memory_order_release);
+}
+
 }  // namespace logger
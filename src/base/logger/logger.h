@@ -1,7 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+// 编译期最低日志等级（0 INFO, 1 WARNING, 2 ERROR, 3 FATAL），低于它的日志语句连同参数求值一起被编译器消除
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 0
+#endif
 
 namespace logger {
 
@@ -12,14 +23,66 @@ enum class LogLevel {
     FATAL
 };
 
+// 异步队列写满时的处理方式
+enum class OverflowPolicy {
+    DROP,   // 丢弃并计数，调用线程从不阻塞
+    BLOCK   // 等待后台线程腾出空位
+};
+
+struct AsyncLoggerOptions {
+    // 环形队列槽位数，向上取整到 2 的幂
+    size_t queue_capacity = 8192;
+    OverflowPolicy overflow = OverflowPolicy::DROP;
+};
+
+// 最终写出函数，默认写入 glog
+using LogWriter = void (*)(LogLevel level, const char* file, int line, const char* message, size_t size);
+
+namespace detail {
+extern std::atomic<int> min_level;
+void submit(LogLevel level, const char* file, int line, std::string& message);
+} // namespace detail
+
+inline bool IsLevelEnabled(LogLevel level) {
+    return static_cast<int>(level) >= detail::min_level.load(std::memory_order_relaxed);
+}
+
+// 格式化到线程本地的复用缓冲区，常见类型不经过 std::ostream，稳态下不分配内存
 class LoggerStream {
 public:
     LoggerStream(LogLevel level, const char* file, int line);
     ~LoggerStream();
 
+    LoggerStream(const LoggerStream&) = delete;
+    LoggerStream& operator=(const LoggerStream&) = delete;
+
     template <typename T>
-    LoggerStream& operator<<(const T& msg) {
-        stream_ << msg;
+    LoggerStream& operator<<(const T& value) {
+        using Type = std::decay_t<T>;
+        if constexpr (std::is_same_v<Type, char> || std::is_same_v<Type, signed char> ||
+                      std::is_same_v<Type, unsigned char>) {
+            text_->push_back(static_cast<char>(value));
+        } else if constexpr (std::is_same_v<Type, bool>) {
+            text_->push_back(value ? '1' : '0');
+        } else if constexpr (std::is_integral_v<Type>) {
+            char buffer[24];
+            const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            text_->append(buffer, result.ptr);
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            append_floating(static_cast<long double>(value));
+        } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>) {
+            // 字符串字面量
+            text_->append(std::string_view(value));
+        } else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>) {
+            text_->append(value ? std::string_view(value) : std::string_view("(null)"));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            text_->append(std::string_view(value));
+        } else {
+            // 其他类型沿用其 operator<<
+            std::ostringstream stream;
+            stream << value;
+            text_->append(stream.str());
+        }
         return *this;
     }
 
@@ -27,23 +90,57 @@ private:
     LogLevel level_;
     const char* file_;
     int line_;
-    std::ostringstream stream_;
+    std::string* text_;
+    // 嵌套日志（格式化参数时又写日志）时使用，线程本地缓冲区已被外层占用
+    std::string nested_;
+    bool owns_thread_buffer_ = false;
+
+    void append_floating(long double value);
+};
+
+// 让条件表达式两侧类型一致
+struct LogVoidify {
+    void operator&(const LoggerStream&) {}
 };
 
 // 初始化和关闭接口
 void InitLogger(const char* program_name, int stderr_level = 0);
 void ShutdownLogger();
 
+// 运行期最低等级，低于它的日志不构造 LoggerStream、不格式化参数；FATAL 始终输出
+void SetLogLevel(LogLevel level);
+LogLevel GetLogLevel();
+
+// 异步模式：调用线程只把格式化好的消息放入无锁环形队列，由后台线程写入 glog。
+// 输出时间戳为后台写出时刻；FATAL 先排空队列再同步写出。可重复调用以更换配置。
+void EnableAsyncLogging(const AsyncLoggerOptions& options = {});
+// 排空队列并停止后台线程，之后回到同步写出
+void DisableAsyncLogging();
+bool IsAsyncLoggingEnabled();
+// 阻塞到此前提交的消息全部写出
+void FlushLogger();
+// DROP 策略下累计丢弃的消息数
+uint64_t DroppedLogCount();
+
+// 替换最终写出函数（nullptr 恢复为 glog），用于测试或由嵌入方接管日志
+void SetLogWriter(LogWriter writer);
+
 }  // namespace logger
 
 // === 宏封装 ===
-#define LOG_INFO    logger::LoggerStream(logger::LogLevel::INFO,    __FILE__, __LINE__)
-#define LOG_WARNING logger::LoggerStream(logger::LogLevel::WARNING, __FILE__, __LINE__)
-#define LOG_ERROR   logger::LoggerStream(logger::LogLevel::ERROR,   __FILE__, __LINE__)
-#define LOG_FATAL   logger::LoggerStream(logger::LogLevel::FATAL,   __FILE__, __LINE__)
+#define LOGGER_LOG(severity)                                                                \
+    !(static_cast<int>(logger::LogLevel::severity) >= LOGGER_MIN_LEVEL &&                   \
+      logger::IsLevelEnabled(logger::LogLevel::severity))                                   \
+        ? (void)0                                                                           \
+        : logger::LogVoidify() & logger::LoggerStream(logger::LogLevel::severity, __FILE__, __LINE__)
+
+#define LOG_INFO    LOGGER_LOG(INFO)
+#define LOG_WARNING LOGGER_LOG(WARNING)
+#define LOG_ERROR   LOGGER_LOG(ERROR)
+#define LOG_FATAL   LOGGER_LOG(FATAL)
 
 #ifdef ENABLE_DEBUG_LOG
-#define LOG_DEBUG logger::LoggerStream(logger::LogLevel::INFO, __FILE__, __LINE__)
+#define LOG_DEBUG LOGGER_LOG(INFO)
 #else
 #define LOG_DEBUG while(false) logger::LoggerStream(logger::LogLevel::INFO, __FILE__, __LINE__)
 #endif
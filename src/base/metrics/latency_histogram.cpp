@@ -0,0 +1,75 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace metrics {
+
+size_t latency_bucket_index(uint64_t value) {
+    if (value > kLatencyMaxValue) value = kLatencyMaxValue;
+    if (value < 2 * kLatencySubBuckets) return static_cast<size_t>(value);
+    const int msb = 63 - __builtin_clzll(value);
+    const int shift = msb - static_cast<int>(kLatencySubBucketBits);
+    // value >> shift 落在 [kLatencySubBuckets, 2 * kLatencySubBuckets)
+    return static_cast<size_t>(shift) * kLatencySubBuckets + static_cast<size_t>(value >> shift);
+}
+
+uint64_t latency_bucket_upper_bound(size_t index) {
+    if (index < 2 * kLatencySubBuckets) return index;
+    const size_t shift = index / kLatencySubBuckets - 1;
+    const uint64_t sub = index - shift * kLatencySubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+LatencyHistogram::LatencyHistogram() : counts_(kLatencyBucketCount, 0) {}
+
+LatencyHistogram::LatencyHistogram(std::vector<uint64_t> counts, uint64_t min, uint64_t max, double sum)
+    : counts_(std::move(counts)), min_(min), max_(max), sum_(sum) {
+    counts_.resize(kLatencyBucketCount, 0);
+    for (uint64_t c : counts_) count_ += c;
+    if (count_ == 0) reset();
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++counts_[latency_bucket_index(value)];
+    ++count_;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += static_cast<double>(value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kLatencyBucketCount; ++i) counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+double LatencyHistogram::mean() const {
+    return count_ ? sum_ / static_cast<double>(count_) : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (count_ == 0) return 0;
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    // 第 rank 个样本（从 1 计）所在的桶
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * count_)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kLatencyBucketCount; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) return std::clamp(latency_bucket_upper_bound(i), min(), max_);
+    }
+    return max_;
+}
+
+} // namespace metrics
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace metrics {
+
+// === HDR 风格的对数-线性分桶 ===
+// 小于 2 * kLatencySubBuckets 的值逐一成桶；之后每个 2 的幂区间再线性切成 kLatencySubBuckets 份，
+// 相对误差不超过 1 / kLatencySubBuckets（约 3%）。超过 kLatencyMaxValue 的值计入最后一个桶。
+constexpr size_t kLatencySubBucketBits = 5;
+constexpr size_t kLatencySubBuckets = size_t{1} << kLatencySubBucketBits;
+constexpr int kLatencyMaxValueBits = 40;  // 纳秒计约 18 分钟
+constexpr uint64_t kLatencyMaxValue = (uint64_t{1} << kLatencyMaxValueBits) - 1;
+constexpr size_t kLatencyBucketCount = (kLatencyMaxValueBits - kLatencySubBucketBits + 1) * kLatencySubBuckets;
+
+size_t latency_bucket_index(uint64_t value);
+// 桶内最大值，作为分位数的报告值（与 HdrHistogram 的 highest equivalent value 一致）
+uint64_t latency_bucket_upper_bound(size_t index);
+
+// 单线程延迟直方图，单位由调用方约定（本仓库统一用纳秒）。
+// 多线程场景每个线程各持一份，结束后 merge。
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    // 由已汇总的分桶计数构造，counts 长度须为 kLatencyBucketCount
+    LatencyHistogram(std::vector<uint64_t> counts, uint64_t min, uint64_t max, double sum);
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    // percentile 取 [0, 100]，无样本时返回 0；结果不超过实际观测到的最大值
+    uint64_t percentile(double percentile) const;
+
+    const std::vector<uint64_t>& buckets() const { return counts_; }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+    double sum_ = 0.0;
+};
+
+} // namespace metrics
@@ -0,0 +1,54 @@
+#include "process_stats.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace metrics {
+
+size_t current_rss_bytes() {
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    const int fields = std::fscanf(file, "%lu %lu", &size, &resident);
+    std::fclose(file);
+    if (fields != 2) return 0;
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+size_t peak_rss_bytes() {
+    // VmHWM 会随 clear_refs 重置，ru_maxrss 不会，优先读前者
+    if (FILE* file = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        size_t peak_kb = 0;
+        bool found = false;
+        while (std::fgets(line, sizeof(line), file)) {
+            if (std::strncmp(line, "VmHWM:", 6) == 0) {
+                found = std::sscanf(line + 6, "%zu", &peak_kb) == 1;
+                break;
+            }
+        }
+        std::fclose(file);
+        if (found) return peak_kb * 1024;
+    }
+
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+bool reset_peak_rss() {
+    FILE* file = std::fopen("/proc/self/clear_refs", "w");
+    if (!file) return false;
+    const bool ok = std::fputs("5", file) >= 0;
+    return std::fclose(file) == 0 && ok;
+}
+
+} // namespace metrics
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+namespace metrics {
+
+// 当前常驻内存（/proc/self/statm），不支持的平台返回 0
+size_t current_rss_bytes();
+
+// 进程启动（或上次 reset_peak_rss）以来的常驻内存峰值
+size_t peak_rss_bytes();
+
+// 重置峰值统计（写 /proc/self/clear_refs，需要 Linux 4.0+），失败返回 false，
+// 此时 peak_rss_bytes 仍是进程级的历史峰值
+bool reset_peak_rss();
+
+} // namespace metrics
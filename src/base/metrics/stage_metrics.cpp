@@ -0,0 +1,186 @@
+#include "stage_metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace metrics {
+
+namespace {
+
+// 线程首次写入时分配的序号，所有实例共用
+size_t thread_shard_index() {
+    static std::atomic<size_t> next_index{0};
+    thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return index;
+}
+
+void update_min(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void update_max(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void append_double(std::string& out, double value) {
+    char buffer[32];
+    const int n = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+} // namespace
+
+struct alignas(64) ConcurrentHistogram::Shard {
+    std::atomic<uint64_t> counts[kLatencyBucketCount];
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+
+    Shard() {
+        for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    }
+};
+
+ConcurrentHistogram::ConcurrentHistogram() {
+    for (auto& shard : shards_) shard.store(nullptr, std::memory_order_relaxed);
+}
+
+ConcurrentHistogram::~ConcurrentHistogram() {
+    for (auto& shard : shards_) delete shard.load(std::memory_order_relaxed);
+}
+
+ConcurrentHistogram::Shard& ConcurrentHistogram::local_shard() {
+    auto& slot = shards_[thread_shard_index()];
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard) return *shard;
+
+    // 分片惰性分配：只有真正写入过的线程才占用内存，竞争失败的一方释放自己的分片
+    auto* created = new Shard();
+    if (slot.compare_exchange_strong(shard, created, std::memory_order_acq_rel)) return *created;
+    delete created;
+    return *shard;
+}
+
+void ConcurrentHistogram::record(uint64_t value) {
+    Shard& shard = local_shard();
+    shard.counts[latency_bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    update_min(shard.min, value);
+    update_max(shard.max, value);
+}
+
+LatencyHistogram ConcurrentHistogram::snapshot() const {
+    std::vector<uint64_t> counts(kLatencyBucketCount, 0);
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+    double sum = 0.0;
+    for (const auto& slot : shards_) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) continue;
+        for (size_t i = 0; i < kLatencyBucketCount; ++i) counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+        sum += static_cast<double>(shard->sum.load(std::memory_order_relaxed));
+        min = std::min(min, shard->min.load(std::memory_order_relaxed));
+        max = std::max(max, shard->max.load(std::memory_order_relaxed));
+    }
+    return LatencyHistogram(std::move(counts), min, max, sum);
+}
+
+void ConcurrentHistogram::reset() {
+    for (auto& slot : shards_) {
+        Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) continue;
+        for (auto& count : shard->counts) count.store(0, std::memory_order_relaxed);
+        shard->sum.store(0, std::memory_order_relaxed);
+        shard->min.store(UINT64_MAX, std::memory_order_relaxed);
+        shard->max.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ConcurrentCounter::add(uint64_t n) {
+    slots_[thread_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t ConcurrentCounter::value() const {
+    uint64_t total = 0;
+    for (const auto& slot : slots_) total += slot.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void ConcurrentCounter::reset() {
+    for (auto& slot : slots_) slot.value.store(0, std::memory_order_relaxed);
+}
+
+const StageSnapshot* MetricsSnapshot::stage(const std::string& name) const {
+    for (const auto& item : stages) {
+        if (item.name == name) return &item;
+    }
+    return nullptr;
+}
+
+uint64_t MetricsSnapshot::counter(const std::string& name) const {
+    for (const auto& item : counters) {
+        if (item.name == name) return item.value;
+    }
+    return 0;
+}
+
+StageMetrics::StageMetrics(std::vector<std::string> stages, std::vector<std::string> counters)
+    : stage_names_(std::move(stages)),
+      counter_names_(std::move(counters)),
+      stages_(new ConcurrentHistogram[stage_names_.size()]),
+      counters_(new ConcurrentCounter[counter_names_.size()]) {}
+
+MetricsSnapshot StageMetrics::snapshot() const {
+    MetricsSnapshot snapshot;
+    snapshot.stages.reserve(stage_names_.size());
+    for (size_t i = 0; i < stage_names_.size(); ++i) {
+        snapshot.stages.push_back({stage_names_[i], stages_[i].snapshot()});
+    }
+    snapshot.counters.reserve(counter_names_.size());
+    for (size_t i = 0; i < counter_names_.size(); ++i) {
+        snapshot.counters.push_back({counter_names_[i], counters_[i].value()});
+    }
+    return snapshot;
+}
+
+void StageMetrics::reset() {
+    for (size_t i = 0; i < stage_names_.size(); ++i) stages_[i].reset();
+    for (size_t i = 0; i < counter_names_.size(); ++i) counters_[i].reset();
+}
+
+std::string to_prometheus(const MetricsSnapshot& snapshot, const std::string& prefix) {
+    constexpr double kNanosPerSecond = 1e9;
+    static const std::pair<const char*, double> kQuantiles[] = {
+        {"0.5", 50.0}, {"0.9", 90.0}, {"0.99", 99.0}, {"0.999", 99.9}};
+    std::string out;
+    if (!snapshot.stages.empty()) {
+        const std::string name = prefix + "_stage_seconds";
+        out += "# HELP " + name + " Time spent in each pipeline stage.\n";
+        out += "# TYPE " + name + " summary\n";
+        for (const auto& stage : snapshot.stages) {
+            const std::string label = "stage=\"" + stage.name + "\"";
+            for (const auto& [quantile, percentile] : kQuantiles) {
+                out += name + "{" + label + ",quantile=\"" + quantile + "\"} ";
+                append_double(out, stage.histogram.percentile(percentile) / kNanosPerSecond);
+                out += '\n';
+            }
+            out += name + "_sum{" + label + "} ";
+            append_double(out, stage.histogram.mean() * stage.histogram.count() / kNanosPerSecond);
+            out += '\n';
+            out += name + "_count{" + label + "} " + std::to_string(stage.histogram.count()) + '\n';
+        }
+    }
+    for (const auto& counter : snapshot.counters) {
+        const std::string name = prefix + "_" + counter.name + "_total";
+        out += "# TYPE " + name + " counter\n";
+        out += name + " " + std::to_string(counter.value) + '\n';
+    }
+    return out;
+}
+
+} // namespace metrics
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace metrics {
+
+// 写入分片数：线程按首次写入的顺序取模映射到分片，同一分片内只有少数线程竞争
+constexpr size_t kMetricShards = 32;
+
+// 多线程写入的直方图。写入只做 relaxed 原子加，不加锁；snapshot 时把各分片合并成 LatencyHistogram。
+// 读取与写入并发时结果是近似的一致快照（各桶计数可能相差在途的几次写入）。
+class ConcurrentHistogram {
+public:
+    ConcurrentHistogram();
+    ~ConcurrentHistogram();
+
+    ConcurrentHistogram(const ConcurrentHistogram&) = delete;
+    ConcurrentHistogram& operator=(const ConcurrentHistogram&) = delete;
+
+    void record(uint64_t value);
+    LatencyHistogram snapshot() const;
+    void reset();
+
+private:
+    struct Shard;
+    std::array<std::atomic<Shard*>, kMetricShards> shards_;
+
+    Shard& local_shard();
+};
+
+class ConcurrentCounter {
+public:
+    void add(uint64_t n = 1);
+    uint64_t value() const;
+    void reset();
+
+private:
+    // 每个分片独占缓存行，避免伪共享
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Slot, kMetricShards> slots_;
+};
+
+struct StageSnapshot {
+    std::string name;
+    LatencyHistogram histogram;  // 纳秒
+};
+
+struct CounterSnapshot {
+    std::string name;
+    uint64_t value = 0;
+};
+
+struct MetricsSnapshot {
+    std::vector<StageSnapshot> stages;
+    std::vector<CounterSnapshot> counters;
+
+    const StageSnapshot* stage(const std::string& name) const;
+    uint64_t counter(const std::string& name) const;
+};
+
+// 一组固定的阶段计时与计数器，阶段与计数器按下标访问，名字只在导出时使用
+class StageMetrics {
+public:
+    StageMetrics(std::vector<std::string> stages, std::vector<std::string> counters = {});
+
+    void record(size_t stage, uint64_t nanos) { stages_[stage].record(nanos); }
+    void add(size_t counter, uint64_t n = 1) { counters_[counter].add(n); }
+
+    MetricsSnapshot snapshot() const;
+    void reset();
+
+private:
+    std::vector<std::string> stage_names_;
+    std::vector<std::string> counter_names_;
+    std::unique_ptr<ConcurrentHistogram[]> stages_;
+    std::unique_ptr<ConcurrentCounter[]> counters_;
+};
+
+// 作用域计时，metrics 为空时不计时
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(StageMetrics* metrics, size_t stage)
+        : metrics_(metrics), stage_(stage),
+          start_(metrics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+    ~ScopedStageTimer() {
+        if (!metrics_) return;
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        metrics_->record(stage_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    StageMetrics* metrics_;
+    size_t stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Prometheus 文本格式：阶段耗时导出为 summary（秒，含 0.5/0.9/0.99/0.999 分位），计数器导出为 counter
+std::string to_prometheus(const MetricsSnapshot& snapshot, const std::string& prefix);
+
+} // namespace metrics
+
+// === 埋点宏：以 -DDISABLE_STAGE_METRICS 编译时展开为空，热路径上不留任何代码 ===
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+#ifdef DISABLE_STAGE_METRICS
+#define STAGE_TIMER(metrics_ptr, stage) do {} while (false)
+#define STAGE_COUNT(metrics_ptr, counter, n) do {} while (false)
+#else
+#define STAGE_TIMER(metrics_ptr, stage) \
+    metrics::ScopedStageTimer METRICS_CONCAT(stage_timer_, __LINE__)((metrics_ptr), (stage))
+#define STAGE_COUNT(metrics_ptr, counter, n)                                       \
+    do {                                                                           \
+        if (auto* metrics_sink = (metrics_ptr)) metrics_sink->add((counter), (n)); \
+    } while (false)
+#endif
@@ -0,0 +1,620 @@
+#include "vector_math.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECTOR_MATH_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define VECTOR_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace vector_math {
+
+// === 标量实现 ===
+namespace scalar {
+
+float dot(const float* a, const float* b, size_t dim) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < dim; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+float l2_norm(const float* v, size_t dim) {
+    return std::sqrt(dot(v, v, dim));
+}
+
+float cosine(const float* a, const float* b, size_t dim) {
+    return dot(a, b, dim) / (l2_norm(a, dim) * l2_norm(b, dim) + 1e-8f);
+}
+
+void l2_normalize(float* v, size_t dim) {
+    float norm = l2_norm(v, dim);
+    if (norm == 0.0f) return;
+    float inv = 1.0f / norm;
+    for (size_t i = 0; i < dim; ++i) v[i] *= inv;
+}
+
+void masked_mean_pooling(const float* hidden, const int64_t* mask,
+                         size_t seq_len, size_t dim, float* out) {
+    std::memset(out, 0, dim * sizeof(float));
+    size_t valid_count = 0;
+    for (size_t i = 0; i < seq_len; ++i) {
+        if (mask[i] == 0) continue;
+        ++valid_count;
+        const float* row = hidden + i * dim;
+        for (size_t j = 0; j < dim; ++j) out[j] += row[j];
+    }
+    if (valid_count == 0) valid_count = 1;
+    float inv = 1.0f / static_cast<float>(valid_count);
+    for (size_t j = 0; j < dim; ++j) out[j] *= inv;
+}
+
+void cls_pooling(const float* hidden, size_t dim, float* out) {
+    std::memcpy(out, hidden, dim * sizeof(float));
+}
+
+void dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores) {
+    for (size_t r = 0; r < rows; ++r) scores[r] = dot(query, matrix + r * dim, dim);
+}
+
+int32_t dot_int8(const int8_t* a, const int8_t* b, size_t dim) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < dim; ++i) sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    return sum;
+}
+
+size_t hamming(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t distance = 0;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t x = a[i] ^ b[i];
+        while (x) {
+            x &= x - 1;
+            ++distance;
+        }
+    }
+    return distance;
+}
+
+void fp32_to_fp16(const float* in, uint16_t* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t x;
+        std::memcpy(&x, &in[i], sizeof(x));
+        uint32_t sign = (x >> 16) & 0x8000u;
+        uint32_t exponent = (x >> 23) & 0xffu;
+        uint32_t mantissa = x & 0x7fffffu;
+
+        if (exponent == 0xff) {  // Inf / NaN
+            out[i] = static_cast<uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u | (mantissa >> 13) : 0u));
+            continue;
+        }
+
+        int32_t half_exponent = static_cast<int32_t>(exponent) - 127 + 15;
+        if (half_exponent >= 0x1f) {  // 上溢为 Inf
+            out[i] = static_cast<uint16_t>(sign | 0x7c00u);
+            continue;
+        }
+
+        if (half_exponent <= 0) {  // 半精度非规格化数或下溢为 0
+            if (half_exponent < -10) {
+                out[i] = static_cast<uint16_t>(sign);
+                continue;
+            }
+            mantissa |= 0x800000u;
+            uint32_t shift = static_cast<uint32_t>(14 - half_exponent);
+            uint32_t half_mantissa = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half_mantissa & 1u))) ++half_mantissa;
+            out[i] = static_cast<uint16_t>(sign | half_mantissa);
+            continue;
+        }
+
+        uint32_t half = sign | (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1fffu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) ++half;  // 进位可自然溢入指数
+        out[i] = static_cast<uint16_t>(half);
+    }
+}
+
+void fp16_to_fp32(const uint16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t h = in[i];
+        uint32_t sign = (h & 0x8000u) << 16;
+        uint32_t exponent = (h >> 10) & 0x1fu;
+        uint32_t mantissa = h & 0x3ffu;
+        uint32_t bits;
+
+        if (exponent == 0) {
+            if (mantissa == 0) {
+                bits = sign;
+            } else {  // 非规格化数，规格化到单精度
+                uint32_t e = 127 - 15 + 1;
+                while (!(mantissa & 0x400u)) {
+                    mantissa <<= 1;
+                    --e;
+                }
+                bits = sign | (e << 23) | ((mantissa & 0x3ffu) << 13);
+            }
+        } else if (exponent == 0x1f) {
+            bits = sign | 0x7f800000u | (mantissa << 13);
+        } else {
+            bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+        std::memcpy(&out[i], &bits, sizeof(bits));
+    }
+}
+
+} // namespace scalar
+
+namespace {
+
+struct Kernels {
+    Isa isa;
+    float (*dot)(const float*, const float*, size_t);
+    void (*dot_many)(const float* query, const float* matrix, size_t rows, size_t dim, float* scores);
+    void (*add_into)(float* acc, const float* row, size_t dim);
+    void (*scale)(float* v, float factor, size_t dim);
+    int32_t (*dot_int8)(const int8_t*, const int8_t*, size_t);
+    size_t (*hamming)(const uint64_t*, const uint64_t*, size_t);
+    void (*fp32_to_fp16)(const float*, uint16_t*, size_t);
+    void (*fp16_to_fp32)(const uint16_t*, float*, size_t);
+};
+
+void scalar_add_into(float* acc, const float* row, size_t dim) {
+    for (size_t j = 0; j < dim; ++j) acc[j] += row[j];
+}
+
+void scalar_scale(float* v, float factor, size_t dim) {
+    for (size_t j = 0; j < dim; ++j) v[j] *= factor;
+}
+
+#if defined(VECTOR_MATH_X86)
+
+__attribute__((target("avx2,fma")))
+float avx2_hsum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_hadd_ps(lo, lo);
+    lo = _mm_hadd_ps(lo, lo);
+    return _mm_cvtss_f32(lo);
+}
+
+__attribute__((target("avx2,fma")))
+float avx2_dot(const float* a, const float* b, size_t dim) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= dim; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float sum = avx2_hsum(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    for (; i < dim; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+// 每次处理 4 行：查询向量的每段只加载一次，4 个独立累加链同时推进
+__attribute__((target("avx2,fma")))
+void avx2_dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores) {
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const float* m0 = matrix + r * dim;
+        const float* m1 = m0 + dim;
+        const float* m2 = m1 + dim;
+        const float* m3 = m2 + dim;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= dim; i += 8) {
+            __m256 q = _mm256_loadu_ps(query + i);
+            acc0 = _mm256_fmadd_ps(q, _mm256_loadu_ps(m0 + i), acc0);
+            acc1 = _mm256_fmadd_ps(q, _mm256_loadu_ps(m1 + i), acc1);
+            acc2 = _mm256_fmadd_ps(q, _mm256_loadu_ps(m2 + i), acc2);
+            acc3 = _mm256_fmadd_ps(q, _mm256_loadu_ps(m3 + i), acc3);
+        }
+        // 两次 hadd 后每个 128 位通道依次是 4 行的部分和
+        __m256 sums = _mm256_hadd_ps(_mm256_hadd_ps(acc0, acc1), _mm256_hadd_ps(acc2, acc3));
+        __m128 total = _mm_add_ps(_mm256_castps256_ps128(sums), _mm256_extractf128_ps(sums, 1));
+        if (i < dim) {
+            float tail[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (; i < dim; ++i) {
+                tail[0] += query[i] * m0[i];
+                tail[1] += query[i] * m1[i];
+                tail[2] += query[i] * m2[i];
+                tail[3] += query[i] * m3[i];
+            }
+            total = _mm_add_ps(total, _mm_loadu_ps(tail));
+        }
+        _mm_storeu_ps(scores + r, total);
+    }
+    for (; r < rows; ++r) scores[r] = avx2_dot(query, matrix + r * dim, dim);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_add_into(float* acc, const float* row, size_t dim) {
+    size_t j = 0;
+    for (; j + 8 <= dim; j += 8) {
+        _mm256_storeu_ps(acc + j, _mm256_add_ps(_mm256_loadu_ps(acc + j), _mm256_loadu_ps(row + j)));
+    }
+    for (; j < dim; ++j) acc[j] += row[j];
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_scale(float* v, float factor, size_t dim) {
+    __m256 f = _mm256_set1_ps(factor);
+    size_t j = 0;
+    for (; j + 8 <= dim; j += 8) {
+        _mm256_storeu_ps(v + j, _mm256_mul_ps(_mm256_loadu_ps(v + j), f));
+    }
+    for (; j < dim; ++j) v[j] *= factor;
+}
+
+__attribute__((target("avx2,fma")))
+int32_t avx2_dot_int8(const int8_t* a, const int8_t* b, size_t dim) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i a_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+        __m256i a_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+        __m256i b_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+        __m256i b_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a_lo, b_lo));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a_hi, b_hi));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_hadd_epi32(sum, sum);
+    sum = _mm_hadd_epi32(sum, sum);
+    int32_t result = _mm_cvtsi128_si32(sum);
+    for (; i < dim; ++i) result += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    return result;
+}
+
+__attribute__((target("popcnt")))
+size_t popcnt_hamming(const uint64_t* a, const uint64_t* b, size_t words) {
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        c0 += _mm_popcnt_u64(a[i] ^ b[i]);
+        c1 += _mm_popcnt_u64(a[i + 1] ^ b[i + 1]);
+        c2 += _mm_popcnt_u64(a[i + 2] ^ b[i + 2]);
+        c3 += _mm_popcnt_u64(a[i + 3] ^ b[i + 3]);
+    }
+    for (; i < words; ++i) c0 += _mm_popcnt_u64(a[i] ^ b[i]);
+    return static_cast<size_t>(c0 + c1 + c2 + c3);
+}
+
+__attribute__((target("avx2,f16c")))
+void f16c_fp32_to_fp16(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), half);
+    }
+    if (i < n) scalar::fp32_to_fp16(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,f16c")))
+void f16c_fp16_to_fp32(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+    }
+    if (i < n) scalar::fp16_to_fp32(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+float avx512_dot(const float* a, const float* b, size_t dim) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    acc0 = _mm512_add_ps(acc0, acc1);
+    if (i + 16 <= dim) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        i += 16;
+    }
+    if (i < dim) {
+        __mmask16 tail = static_cast<__mmask16>((1u << (dim - i)) - 1);
+        acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail, a + i), _mm512_maskz_loadu_ps(tail, b + i), acc0);
+    }
+    return _mm512_reduce_add_ps(acc0);
+}
+
+__attribute__((target("avx512f")))
+void avx512_dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores) {
+    const size_t tail_len = dim % 16;
+    const __mmask16 tail = static_cast<__mmask16>((1u << tail_len) - 1);
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const float* m0 = matrix + r * dim;
+        const float* m1 = m0 + dim;
+        const float* m2 = m1 + dim;
+        const float* m3 = m2 + dim;
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        __m512 acc2 = _mm512_setzero_ps();
+        __m512 acc3 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= dim; i += 16) {
+            __m512 q = _mm512_loadu_ps(query + i);
+            acc0 = _mm512_fmadd_ps(q, _mm512_loadu_ps(m0 + i), acc0);
+            acc1 = _mm512_fmadd_ps(q, _mm512_loadu_ps(m1 + i), acc1);
+            acc2 = _mm512_fmadd_ps(q, _mm512_loadu_ps(m2 + i), acc2);
+            acc3 = _mm512_fmadd_ps(q, _mm512_loadu_ps(m3 + i), acc3);
+        }
+        if (tail_len) {
+            __m512 q = _mm512_maskz_loadu_ps(tail, query + i);
+            acc0 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail, m0 + i), acc0);
+            acc1 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail, m1 + i), acc1);
+            acc2 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail, m2 + i), acc2);
+            acc3 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail, m3 + i), acc3);
+        }
+        scores[r] = _mm512_reduce_add_ps(acc0);
+        scores[r + 1] = _mm512_reduce_add_ps(acc1);
+        scores[r + 2] = _mm512_reduce_add_ps(acc2);
+        scores[r + 3] = _mm512_reduce_add_ps(acc3);
+    }
+    for (; r < rows; ++r) scores[r] = avx512_dot(query, matrix + r * dim, dim);
+}
+
+__attribute__((target("avx512f")))
+void avx512_add_into(float* acc, const float* row, size_t dim) {
+    size_t j = 0;
+    for (; j + 16 <= dim; j += 16) {
+        _mm512_storeu_ps(acc + j, _mm512_add_ps(_mm512_loadu_ps(acc + j), _mm512_loadu_ps(row + j)));
+    }
+    if (j < dim) {
+        __mmask16 tail = static_cast<__mmask16>((1u << (dim - j)) - 1);
+        __m512 sum = _mm512_add_ps(_mm512_maskz_loadu_ps(tail, acc + j), _mm512_maskz_loadu_ps(tail, row + j));
+        _mm512_mask_storeu_ps(acc + j, tail, sum);
+    }
+}
+
+__attribute__((target("avx512f")))
+void avx512_scale(float* v, float factor, size_t dim) {
+    __m512 f = _mm512_set1_ps(factor);
+    size_t j = 0;
+    for (; j + 16 <= dim; j += 16) {
+        _mm512_storeu_ps(v + j, _mm512_mul_ps(_mm512_loadu_ps(v + j), f));
+    }
+    for (; j < dim; ++j) v[j] *= factor;
+}
+
+#endif // VECTOR_MATH_X86
+
+#if defined(VECTOR_MATH_NEON)
+
+float neon_dot(const float* a, const float* b, size_t dim) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= dim; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < dim; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+void neon_dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores) {
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const float* m0 = matrix + r * dim;
+        const float* m1 = m0 + dim;
+        const float* m2 = m1 + dim;
+        const float* m3 = m2 + dim;
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f);
+        float32x4_t acc3 = vdupq_n_f32(0.0f);
+        size_t i = 0;
+        for (; i + 4 <= dim; i += 4) {
+            float32x4_t q = vld1q_f32(query + i);
+            acc0 = vfmaq_f32(acc0, q, vld1q_f32(m0 + i));
+            acc1 = vfmaq_f32(acc1, q, vld1q_f32(m1 + i));
+            acc2 = vfmaq_f32(acc2, q, vld1q_f32(m2 + i));
+            acc3 = vfmaq_f32(acc3, q, vld1q_f32(m3 + i));
+        }
+        float s0 = vaddvq_f32(acc0), s1 = vaddvq_f32(acc1), s2 = vaddvq_f32(acc2), s3 = vaddvq_f32(acc3);
+        for (; i < dim; ++i) {
+            s0 += query[i] * m0[i];
+            s1 += query[i] * m1[i];
+            s2 += query[i] * m2[i];
+            s3 += query[i] * m3[i];
+        }
+        scores[r] = s0;
+        scores[r + 1] = s1;
+        scores[r + 2] = s2;
+        scores[r + 3] = s3;
+    }
+    for (; r < rows; ++r) scores[r] = neon_dot(query, matrix + r * dim, dim);
+}
+
+void neon_add_into(float* acc, const float* row, size_t dim) {
+    size_t j = 0;
+    for (; j + 4 <= dim; j += 4) {
+        vst1q_f32(acc + j, vaddq_f32(vld1q_f32(acc + j), vld1q_f32(row + j)));
+    }
+    for (; j < dim; ++j) acc[j] += row[j];
+}
+
+void neon_scale(float* v, float factor, size_t dim) {
+    size_t j = 0;
+    for (; j + 4 <= dim; j += 4) {
+        vst1q_f32(v + j, vmulq_n_f32(vld1q_f32(v + j), factor));
+    }
+    for (; j < dim; ++j) v[j] *= factor;
+}
+
+int32_t neon_dot_int8(const int8_t* a, const int8_t* b, size_t dim) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+    }
+    int32_t result = vaddvq_s32(acc);
+    for (; i < dim; ++i) result += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    return result;
+}
+
+size_t neon_hamming(const uint64_t* a, const uint64_t* b, size_t words) {
+    uint64_t distance = 0;
+    size_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        uint8x16_t x = veorq_u8(vreinterpretq_u8_u64(vld1q_u64(a + i)), vreinterpretq_u8_u64(vld1q_u64(b + i)));
+        distance += vaddvq_u8(vcntq_u8(x));
+    }
+    for (; i < words; ++i) distance += __builtin_popcountll(a[i] ^ b[i]);
+    return static_cast<size_t>(distance);
+}
+
+#endif // VECTOR_MATH_NEON
+
+// 环境变量 VECTOR_MATH_ISA=scalar|avx2 可强制降级，便于在同一台机器上对比和校验各实现
+Kernels select_kernels() {
+    const char* forced = std::getenv("VECTOR_MATH_ISA");
+    const bool force_scalar = forced && std::strcmp(forced, "scalar") == 0;
+    const bool force_avx2 = forced && std::strcmp(forced, "avx2") == 0;
+
+    Kernels selected = {Isa::SCALAR, scalar::dot, scalar::dot_many, scalar_add_into, scalar_scale,
+                        scalar::dot_int8, scalar::hamming, scalar::fp32_to_fp16, scalar::fp16_to_fp32};
+    if (force_scalar) {
+        return selected;
+    }
+#if defined(VECTOR_MATH_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt")) {
+        selected.hamming = popcnt_hamming;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        selected = {Isa::AVX2, avx2_dot, avx2_dot_many, avx2_add_into, avx2_scale,
+                    avx2_dot_int8, selected.hamming, selected.fp32_to_fp16, selected.fp16_to_fp32};
+        // F16C 与 AVX2 并非严格绑定，单独检测
+        if (__builtin_cpu_supports("f16c")) {
+            selected.fp32_to_fp16 = f16c_fp32_to_fp16;
+            selected.fp16_to_fp32 = f16c_fp16_to_fp32;
+        }
+    }
+    if (!force_avx2 && selected.isa == Isa::AVX2 && __builtin_cpu_supports("avx512f")) {
+        selected.isa = Isa::AVX512;
+        selected.dot = avx512_dot;
+        selected.dot_many = avx512_dot_many;
+        selected.add_into = avx512_add_into;
+        selected.scale = avx512_scale;
+    }
+#elif defined(VECTOR_MATH_NEON)
+    (void)force_avx2;
+    selected = {Isa::NEON, neon_dot, neon_dot_many, neon_add_into, neon_scale,
+                neon_dot_int8, neon_hamming, scalar::fp32_to_fp16, scalar::fp16_to_fp32};
+#else
+    (void)force_avx2;
+#endif
+    return selected;
+}
+
+const Kernels& kernels() {
+    static const Kernels selected = select_kernels();
+    return selected;
+}
+
+} // namespace
+
+Isa active_isa() {
+    return kernels().isa;
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR: return "scalar";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+        case Isa::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+float dot(const float* a, const float* b, size_t dim) {
+    return kernels().dot(a, b, dim);
+}
+
+float l2_norm(const float* v, size_t dim) {
+    return std::sqrt(kernels().dot(v, v, dim));
+}
+
+float cosine(const float* a, const float* b, size_t dim) {
+    const Kernels& k = kernels();
+    float norm_a = std::sqrt(k.dot(a, a, dim));
+    float norm_b = std::sqrt(k.dot(b, b, dim));
+    return k.dot(a, b, dim) / (norm_a * norm_b + 1e-8f);
+}
+
+void l2_normalize(float* v, size_t dim) {
+    const Kernels& k = kernels();
+    float norm = std::sqrt(k.dot(v, v, dim));
+    if (norm == 0.0f) return;
+    k.scale(v, 1.0f / norm, dim);
+}
+
+void masked_mean_pooling(const float* hidden, const int64_t* mask,
+                         size_t seq_len, size_t dim, float* out) {
+    const Kernels& k = kernels();
+    std::memset(out, 0, dim * sizeof(float));
+    size_t valid_count = 0;
+    for (size_t i = 0; i < seq_len; ++i) {
+        if (mask[i] == 0) continue;
+        ++valid_count;
+        k.add_into(out, hidden + i * dim, dim);
+    }
+    if (valid_count == 0) valid_count = 1;
+    k.scale(out, 1.0f / static_cast<float>(valid_count), dim);
+}
+
+void cls_pooling(const float* hidden, size_t dim, float* out) {
+    std::memcpy(out, hidden, dim * sizeof(float));
+}
+
+void dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores) {
+    kernels().dot_many(query, matrix, rows, dim, scores);
+}
+
+int32_t dot_int8(const int8_t* a, const int8_t* b, size_t dim) {
+    return kernels().dot_int8(a, b, dim);
+}
+
+size_t hamming(const uint64_t* a, const uint64_t* b, size_t words) {
+    return kernels().hamming(a, b, words);
+}
+
+void fp32_to_fp16(const float* in, uint16_t* out, size_t n) {
+    kernels().fp32_to_fp16(in, out, n);
+}
+
+void fp16_to_fp32(const uint16_t* in, float* out, size_t n) {
+    kernels().fp16_to_fp32(in, out, n);
+}
+
+} // namespace vector_math
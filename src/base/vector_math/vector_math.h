@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vector_math {
+
+enum class Isa {
+    SCALAR,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+// 运行时选中的指令集（首次调用时按 CPU 能力确定）
+Isa active_isa();
+const char* isa_name(Isa isa);
+
+// === 运行时分发的内核 ===
+
+float dot(const float* a, const float* b, size_t dim);
+float cosine(const float* a, const float* b, size_t dim);
+float l2_norm(const float* v, size_t dim);
+
+// 原地 L2 归一化，零向量保持不变
+void l2_normalize(float* v, size_t dim);
+
+// 对 [seq_len, dim] 的隐藏状态按 mask 求均值，结果写入 out[dim]
+void masked_mean_pooling(const float* hidden, const int64_t* mask,
+                         size_t seq_len, size_t dim, float* out);
+
+// 取首个 token（[CLS]）的隐藏状态
+void cls_pooling(const float* hidden, size_t dim, float* out);
+
+// 一条查询对行主序矩阵 [rows, dim] 逐行求内积，结果写入 scores[rows]（SIMD 实现按 4 行分块）
+void dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores);
+
+// int8 向量内积（32 位累加）
+int32_t dot_int8(const int8_t* a, const int8_t* b, size_t dim);
+
+// 按位打包的二值向量的 Hamming 距离，words 为 uint64_t 个数
+size_t hamming(const uint64_t* a, const uint64_t* b, size_t words);
+
+// IEEE 754 半精度与单精度互转（就近舍入到偶数）
+void fp32_to_fp16(const float* in, uint16_t* out, size_t n);
+void fp16_to_fp32(const uint16_t* in, float* out, size_t n);
+
+// === 标量参考实现，用于正确性校验与性能对比 ===
+namespace scalar {
+
+float dot(const float* a, const float* b, size_t dim);
+float cosine(const float* a, const float* b, size_t dim);
+float l2_norm(const float* v, size_t dim);
+void l2_normalize(float* v, size_t dim);
+void masked_mean_pooling(const float* hidden, const int64_t* mask,
+                         size_t seq_len, size_t dim, float* out);
+void cls_pooling(const float* hidden, size_t dim, float* out);
+void dot_many(const float* query, const float* matrix, size_t rows, size_t dim, float* scores);
+int32_t dot_int8(const int8_t* a, const int8_t* b, size_t dim);
+size_t hamming(const uint64_t* a, const uint64_t* b, size_t words);
+void fp32_to_fp16(const float* in, uint16_t* out, size_t n);
+void fp16_to_fp32(const uint16_t* in, float* out, size_t n);
+
+} // namespace scalar
+
+} // namespace vector_math
@@ -0,0 +1,164 @@
+#include "text_chunker.h"
+
+#include <stdexcept>
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool is_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+// 句末的全角标点（UTF-8 编码）
+const char* const kCjkTerminators[] = {
+    "\xE3\x80\x82",  // 。
+    "\xEF\xBC\x81",  // ！
+    "\xEF\xBC\x9F",  // ？
+    "\xEF\xBC\x9B",  // ；
+    "\xE2\x80\xA6",  // …
+};
+
+size_t cjk_terminator_length(const std::string& text, size_t pos) {
+    for (const char* terminator : kCjkTerminators) {
+        if (text.compare(pos, 3, terminator) == 0) return 3;
+    }
+    return 0;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = 0;
+    while (begin < s.size() && is_space(s[begin])) ++begin;
+    size_t end = s.size();
+    while (end > begin && is_space(s[end - 1])) --end;
+    return s.substr(begin, end - begin);
+}
+
+} // namespace
+
+namespace document_extractor {
+
+std::vector<std::string> split_sentences(const std::string& text) {
+    std::vector<std::string> sentences;
+    size_t start = 0;
+    size_t i = 0;
+    auto cut = [&](size_t end) {
+        // 吞掉句末之后的空白，使下一句从正文开始
+        while (end < text.size() && is_space(text[end])) ++end;
+        std::string sentence = text.substr(start, end - start);
+        if (trim(sentence).empty() && !sentences.empty()) {
+            sentences.back() += sentence;
+        } else {
+            sentences.push_back(std::move(sentence));
+        }
+        start = end;
+        i = end;
+    };
+
+    while (i < text.size()) {
+        const char c = text[i];
+        if (c == '\n') {
+            cut(i + 1);
+        } else if (size_t len = cjk_terminator_length(text, i)) {
+            size_t end = i + len;
+            // 连续的句末标点（如 ！？、……）归入同一句
+            while (size_t more = cjk_terminator_length(text, end)) end += more;
+            cut(end);
+        } else if ((c == '.' || c == '!' || c == '?') && (i + 1 == text.size() || is_space(text[i + 1]))) {
+            cut(i + 1);
+        } else {
+            ++i;
+        }
+    }
+    if (start < text.size()) cut(text.size());
+    return sentences;
+}
+
+std::vector<ChunkPlan> plan_chunks(const std::vector<size_t>& sentence_tokens,
+                                   size_t max_tokens, size_t overlap_tokens) {
+    std::vector<ChunkPlan> plans;
+    const size_t n = sentence_tokens.size();
+    size_t begin = 0;
+    while (begin < n) {
+        size_t end = begin;
+        size_t tokens = 0;
+        while (end < n && (end == begin || tokens + sentence_tokens[end] <= max_tokens)) {
+            tokens += sentence_tokens[end++];
+        }
+        plans.push_back({begin, end, tokens});
+        if (end == n) break;
+
+        size_t next = end;
+        size_t overlap = 0;
+        while (next - 1 > begin && overlap + sentence_tokens[next - 1] <= overlap_tokens) {
+            overlap += sentence_tokens[--next];
+        }
+        begin = next;
+    }
+    return plans;
+}
+
+TextChunker::TextChunker(text_embedding::TokenizerPool& tokenizer, ChunkerOptions options)
+    : tokenizer_(tokenizer), options_(options) {
+    if (options_.max_tokens == 0 || options_.overlap_tokens >= options_.max_tokens) {
+        throw std::invalid_argument("ChunkerOptions: overlap_tokens must be smaller than a non-zero max_tokens");
+    }
+}
+
+void TextChunker::split_oversized(const std::string& sentence, size_t tokens,
+                                  std::vector<std::string>& pieces, std::vector<size_t>& counts) const {
+    if (tokens <= options_.max_tokens) {
+        pieces.push_back(sentence);
+        counts.push_back(tokens);
+        return;
+    }
+
+    // 在中点附近找切分位置：优先四分之一范围内最近的空白，否则取最近的 UTF-8 字符边界
+    const size_t middle = sentence.size() / 2;
+    size_t cut = std::string::npos;
+    for (size_t d = 0; d <= sentence.size() / 4 && cut == std::string::npos; ++d) {
+        if (middle + d < sentence.size() && is_space(sentence[middle + d])) cut = middle + d + 1;
+        else if (middle >= d && middle - d > 0 && is_space(sentence[middle - d])) cut = middle - d + 1;
+    }
+    if (cut == std::string::npos) {
+        cut = middle;
+        while (cut > 0 && is_continuation(sentence[cut])) --cut;
+    }
+    if (cut == 0 || cut >= sentence.size()) {  // 单个字符，无法再分
+        pieces.push_back(sentence);
+        counts.push_back(tokens);
+        return;
+    }
+
+    const std::vector<std::string> halves = {sentence.substr(0, cut), sentence.substr(cut)};
+    const auto encoded = tokenizer_.encode_batch(halves);
+    split_oversized(halves[0], encoded[0].size(), pieces, counts);
+    split_oversized(halves[1], encoded[1].size(), pieces, counts);
+}
+
+std::vector<TextChunk> TextChunker::split(const std::string& text) const {
+    const auto sentences = split_sentences(text);
+    if (sentences.empty()) return {};
+    const auto encoded = tokenizer_.encode_batch(sentences);
+
+    std::vector<std::string> pieces;
+    std::vector<size_t> counts;
+    pieces.reserve(sentences.size());
+    counts.reserve(sentences.size());
+    for (size_t i = 0; i < sentences.size(); ++i) {
+        split_oversized(sentences[i], encoded[i].size(), pieces, counts);
+    }
+
+    std::vector<TextChunk> chunks;
+    for (const auto& plan : plan_chunks(counts, options_.max_tokens, options_.overlap_tokens)) {
+        std::string joined;
+        for (size_t s = plan.begin; s < plan.end; ++s) joined += pieces[s];
+        TextChunk chunk{trim(joined), plan.tokens};
+        if (!chunk.text.empty()) chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+}
+
+} // namespace document_extractor
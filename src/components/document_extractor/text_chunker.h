@@ -0,0 +1,57 @@
+#pragma once
+
+#include "tokenizer_pool.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace document_extractor {
+
+struct ChunkerOptions {
+    // 每块的 token 上限（不含特殊 token），通常不超过向量模型的最大长度减 2
+    size_t max_tokens = 256;
+    // 相邻块以整句回带的重叠 token 数上限，须小于 max_tokens
+    size_t overlap_tokens = 32;
+};
+
+struct TextChunk {
+    std::string text;
+    size_t token_count = 0;
+};
+
+// 按段落与句子边界切分：换行、中文句末标点（。！？；…）、后接空白的英文句末标点（.!?）。
+// 每段保留结尾的标点与空白，依次拼接即还原原文
+std::vector<std::string> split_sentences(const std::string& text);
+
+struct ChunkPlan {
+    size_t begin;   // 首句下标
+    size_t end;     // 末句下标 + 1
+    size_t tokens;
+};
+
+// 按句子 token 数贪心装箱：每块不超过 max_tokens（单句超长时独占一块），
+// 下一块从上一块末尾回带不超过 overlap_tokens 的整句，且总能向前推进
+std::vector<ChunkPlan> plan_chunks(const std::vector<size_t>& sentence_tokens,
+                                   size_t max_tokens, size_t overlap_tokens);
+
+// 使用向量模型的 tokenizer 计数的切块器，块长与模型实际看到的 token 数一致。
+// 超过 max_tokens 的单句在字符边界（优先空白处）二分，直到每段都不超长。
+// 线程安全：可被多个切块线程共享（TokenizerPool 自身可并发使用）
+class TextChunker {
+public:
+    explicit TextChunker(text_embedding::TokenizerPool& tokenizer, ChunkerOptions options = {});
+
+    std::vector<TextChunk> split(const std::string& text) const;
+
+    const ChunkerOptions& options() const { return options_; }
+
+private:
+    text_embedding::TokenizerPool& tokenizer_;
+    ChunkerOptions options_;
+
+    void split_oversized(const std::string& sentence, size_t tokens,
+                         std::vector<std::string>& pieces, std::vector<size_t>& counts) const;
+};
+
+} // namespace document_extractor
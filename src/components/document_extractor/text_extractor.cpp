@@ -0,0 +1,321 @@
+#include "text_extractor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::string to_lower(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+bool starts_with(const std::string& s, size_t pos, const char* prefix) {
+    return s.compare(pos, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xc0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xe0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x110000) {
+        out += static_cast<char>(0xf0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+// 统一换行符、去掉 BOM 与行尾空白，并把连续空行压缩为一个
+std::string normalize_lines(const std::string& text) {
+    size_t start = text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    std::string out;
+    out.reserve(text.size());
+    size_t blank_lines = 0;
+    std::string line;
+    auto flush_line = [&]() {
+        size_t end = line.find_last_not_of(" \t\f\v");
+        line.erase(end == std::string::npos ? 0 : end + 1);
+        if (line.empty()) {
+            if (!out.empty() && blank_lines++ == 0) out += '\n';
+        } else {
+            blank_lines = 0;
+            out += line;
+            out += '\n';
+        }
+        line.clear();
+    };
+    for (size_t i = start; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '\r') {
+            if (i + 1 < text.size() && text[i + 1] == '\n') ++i;
+            flush_line();
+        } else if (c == '\n') {
+            flush_line();
+        } else {
+            line += c;
+        }
+    }
+    flush_line();
+    while (!out.empty() && out.back() == '\n') out.pop_back();
+    return out;
+}
+
+// === Markdown ===
+
+// 行内标记：[text](url) -> text，![alt](url) -> alt，去掉 `、*、_、~ 强调符号与 <autolink>
+std::string strip_inline_markdown(const std::string& line) {
+    std::string out;
+    out.reserve(line.size());
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size() && std::ispunct(static_cast<unsigned char>(line[i + 1]))) {
+            out += line[++i];
+        } else if (c == '!' && i + 1 < line.size() && line[i + 1] == '[') {
+            continue;  // 图片按链接处理，保留 alt 文本
+        } else if (c == '[') {
+            size_t close = line.find(']', i + 1);
+            if (close != std::string::npos && close + 1 < line.size() && line[close + 1] == '(') {
+                size_t paren = line.find(')', close + 2);
+                if (paren != std::string::npos) {
+                    out += strip_inline_markdown(line.substr(i + 1, close - i - 1));
+                    i = paren;
+                    continue;
+                }
+            }
+            out += c;
+        } else if (c == '`' || c == '*' || c == '~') {
+            continue;
+        } else if (c == '_' && (i == 0 || i + 1 == line.size() || !std::isalnum(static_cast<unsigned char>(line[i - 1])) ||
+                                !std::isalnum(static_cast<unsigned char>(line[i + 1])))) {
+            continue;  // 词内的下划线（如 snake_case）保留
+        } else if (c == '<' && (starts_with(line, i + 1, "http://") || starts_with(line, i + 1, "https://"))) {
+            size_t close = line.find('>', i + 1);
+            if (close == std::string::npos) {
+                out += c;
+                continue;
+            }
+            out += line.substr(i + 1, close - i - 1);
+            i = close;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string extract_markdown(const std::string& content) {
+    std::string out;
+    bool in_code = false;
+    std::string fence;
+    size_t pos = 0;
+    while (pos <= content.size()) {
+        size_t end = content.find('\n', pos);
+        if (end == std::string::npos) end = content.size();
+        std::string line = content.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        size_t indent = line.find_first_not_of(" \t");
+        std::string body = indent == std::string::npos ? "" : line.substr(indent);
+        if (starts_with(body, 0, "```") || starts_with(body, 0, "~~~")) {
+            if (!in_code) {
+                in_code = true;
+                fence = body.substr(0, 3);
+            } else if (starts_with(body, 0, fence.c_str())) {
+                in_code = false;
+            }
+            out += '\n';
+            continue;
+        }
+        if (in_code) {
+            out += line + '\n';
+            continue;
+        }
+
+        // 分隔线与表格对齐行
+        if (!body.empty() && body.find_first_not_of("-*_= \t") == std::string::npos && body.size() >= 3) {
+            out += '\n';
+            continue;
+        }
+        if (!body.empty() && body.find_first_not_of("|-: \t") == std::string::npos && body.find('|') != std::string::npos) {
+            continue;
+        }
+
+        // 块级前缀：引用、标题、列表
+        if (!body.empty() && body[0] == '>') {
+            size_t text_begin = body.find_first_not_of("> \t");
+            body = text_begin == std::string::npos ? "" : body.substr(text_begin);
+        }
+        if (!body.empty() && body[0] == '#') {
+            size_t hashes = body.find_first_not_of('#');
+            if (hashes != std::string::npos && hashes <= 6 && body[hashes] == ' ') body = body.substr(hashes + 1);
+        }
+        if (body.size() > 1 && (body[0] == '-' || body[0] == '*' || body[0] == '+') && body[1] == ' ') {
+            body = body.substr(2);
+        } else {
+            size_t digits = 0;
+            while (digits < body.size() && std::isdigit(static_cast<unsigned char>(body[digits]))) ++digits;
+            if (digits > 0 && digits + 1 < body.size() && (body[digits] == '.' || body[digits] == ')') && body[digits + 1] == ' ') {
+                body = body.substr(digits + 2);
+            }
+        }
+        // 表格行：单元格之间用空格分隔
+        if (body.find('|') != std::string::npos && body.front() == '|') {
+            std::replace(body.begin(), body.end(), '|', ' ');
+        }
+        out += strip_inline_markdown(body) + '\n';
+    }
+    return out;
+}
+
+// === HTML ===
+
+const std::unordered_map<std::string, std::string>& named_entities() {
+    static const std::unordered_map<std::string, std::string> entities = {
+        {"amp", "&"}, {"lt", "<"}, {"gt", ">"}, {"quot", "\""}, {"apos", "'"}, {"nbsp", " "},
+        {"copy", "\xC2\xA9"}, {"reg", "\xC2\xAE"}, {"mdash", "\xE2\x80\x94"}, {"ndash", "\xE2\x80\x93"},
+        {"hellip", "\xE2\x80\xA6"}, {"middot", "\xC2\xB7"}, {"ldquo", "\xE2\x80\x9C"}, {"rdquo", "\xE2\x80\x9D"},
+        {"lsquo", "\xE2\x80\x98"}, {"rsquo", "\xE2\x80\x99"}};
+    return entities;
+}
+
+// 解码 pos 处的字符实体，成功时前移 pos
+bool decode_entity(const std::string& html, size_t& pos, std::string& out) {
+    size_t semicolon = html.find(';', pos + 1);
+    if (semicolon == std::string::npos || semicolon - pos > 10) return false;
+    std::string name = html.substr(pos + 1, semicolon - pos - 1);
+    if (name.size() > 1 && name[0] == '#') {
+        const bool hex = name[1] == 'x' || name[1] == 'X';
+        const std::string digits = name.substr(hex ? 2 : 1);
+        if (digits.empty()) return false;
+        char* end = nullptr;
+        unsigned long cp = std::strtoul(digits.c_str(), &end, hex ? 16 : 10);
+        if (*end != '\0') return false;
+        append_utf8(out, static_cast<uint32_t>(cp));
+    } else {
+        auto it = named_entities().find(name);
+        if (it == named_entities().end()) return false;
+        out += it->second;
+    }
+    pos = semicolon;
+    return true;
+}
+
+// 不区分大小写地查找 </name
+size_t find_closing_tag(const std::string& html, const std::string& name, size_t from) {
+    const std::string needle = "</" + name;
+    auto it = std::search(html.begin() + from, html.end(), needle.begin(), needle.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+    return it == html.end() ? std::string::npos : static_cast<size_t>(it - html.begin());
+}
+
+bool is_block_tag(const std::string& tag) {
+    static const char* kBlockTags[] = {"p", "div", "ul", "ol", "table", "section", "article",
+                                       "header", "footer", "h1", "h2", "h3", "h4", "h5", "h6", "pre",
+                                       "blockquote", "hr", "title", "main", "nav", "aside", "figure"};
+    return std::any_of(std::begin(kBlockTags), std::end(kBlockTags), [&](const char* t) { return tag == t; });
+}
+
+std::string extract_html(const std::string& html) {
+    std::string out;
+    out.reserve(html.size() / 2);
+    bool in_pre = false;
+    for (size_t i = 0; i < html.size(); ++i) {
+        char c = html[i];
+        if (c == '<') {
+            if (starts_with(html, i, "<!--")) {
+                size_t end = html.find("-->", i + 4);
+                i = end == std::string::npos ? html.size() : end + 2;
+                continue;
+            }
+            size_t close = html.find('>', i + 1);
+            if (close == std::string::npos) break;
+            std::string tag = html.substr(i + 1, close - i - 1);
+            const bool closing = !tag.empty() && tag[0] == '/';
+            size_t name_begin = closing ? 1 : 0;
+            size_t name_end = tag.find_first_of(" \t\r\n/>", name_begin);
+            std::string name = to_lower(tag.substr(name_begin, name_end == std::string::npos ? std::string::npos
+                                                                                            : name_end - name_begin));
+            i = close;
+            if (!closing && (name == "script" || name == "style" || name == "noscript" || name == "template")) {
+                size_t end = find_closing_tag(html, name, close + 1);
+                size_t gt = end == std::string::npos ? std::string::npos : html.find('>', end);
+                i = gt == std::string::npos ? html.size() : gt;
+                continue;
+            }
+            if (name == "pre") in_pre = !closing;
+            const bool line_tag = name == "br" || name == "li" || name == "tr" || name == "dd" || name == "dt";
+            if (line_tag) {
+                if (!closing) out += '\n';  // 行级元素只在开始处换行
+            } else if (is_block_tag(name)) {
+                out += "\n\n";
+            } else if ((name == "td" || name == "th") && !closing && !out.empty() && out.back() != ' ' &&
+                       out.back() != '\n') {
+                out += ' ';
+            }
+            continue;
+        }
+        if (c == '&' && decode_entity(html, i, out)) continue;
+        if (!in_pre && (c == '\n' || c == '\r' || c == '\t')) c = ' ';
+        // 非 pre 内容中的连续空白折叠为一个空格
+        if (!in_pre && c == ' ' && (out.empty() || out.back() == ' ' || out.back() == '\n')) continue;
+        out += c;
+    }
+    return out;
+}
+
+} // namespace
+
+namespace document_extractor {
+
+const char* format_name(DocumentFormat format) {
+    switch (format) {
+        case DocumentFormat::PLAIN:    return "plain";
+        case DocumentFormat::MARKDOWN: return "markdown";
+        case DocumentFormat::HTML:     return "html";
+    }
+    return "unknown";
+}
+
+DocumentFormat detect_format(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return DocumentFormat::PLAIN;
+    const std::string ext = to_lower(path.substr(dot + 1));
+    if (ext == "md" || ext == "markdown") return DocumentFormat::MARKDOWN;
+    if (ext == "html" || ext == "htm" || ext == "xhtml") return DocumentFormat::HTML;
+    return DocumentFormat::PLAIN;
+}
+
+std::string extract_text(const std::string& content, DocumentFormat format) {
+    switch (format) {
+        case DocumentFormat::MARKDOWN: return normalize_lines(extract_markdown(content));
+        case DocumentFormat::HTML:     return normalize_lines(extract_html(content));
+        case DocumentFormat::PLAIN:    break;
+    }
+    return normalize_lines(content);
+}
+
+std::string extract_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open document: " + path);
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return extract_text(content, detect_format(path));
+}
+
+} // namespace document_extractor
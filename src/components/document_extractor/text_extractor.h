@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+namespace document_extractor {
+
+enum class DocumentFormat {
+    PLAIN,
+    MARKDOWN,
+    HTML,
+};
+
+const char* format_name(DocumentFormat format);
+
+// 按扩展名判断格式（.md/.markdown、.html/.htm），其余按纯文本处理
+DocumentFormat detect_format(const std::string& path);
+
+// 提取正文：
+// - PLAIN：统一换行符为 \n，去掉 UTF-8 BOM
+// - MARKDOWN：去掉标题/列表/引用标记、强调符号、链接与图片地址，保留代码块内容
+// - HTML：丢弃 script/style/注释，块级标签转为换行，解码常见字符实体
+// 段落之间以空行分隔，供切块时按段落与句子边界切分
+std::string extract_text(const std::string& content, DocumentFormat format);
+
+// 读取文件并按扩展名提取正文，文件无法打开时抛出 std::runtime_error
+std::string extract_file(const std::string& path);
+
+} // namespace document_extractor
@@ -0,0 +1,487 @@
+#include "llama_inference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include <llama.h>
+
+#include "logger.h"
+#include "stop_sequence.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+void init_backend() {
+    static std::once_flag once;
+    std::call_once(once, [] { llama_backend_init(); });
+}
+
+std::vector<llama_token> tokenize(const llama_vocab* vocab, const std::string& text, bool add_special) {
+    const int32_t length = static_cast<int32_t>(text.size());
+    // 缓冲区不足时返回所需长度的相反数
+    std::vector<llama_token> tokens(text.size() + 2);
+    int32_t n = llama_tokenize(vocab, text.data(), length, tokens.data(),
+                               static_cast<int32_t>(tokens.size()), add_special, true);
+    if (n < 0) {
+        tokens.resize(static_cast<size_t>(-n));
+        n = llama_tokenize(vocab, text.data(), length, tokens.data(),
+                           static_cast<int32_t>(tokens.size()), add_special, true);
+    }
+    if (n < 0) throw std::runtime_error("llama_tokenize failed");
+    tokens.resize(static_cast<size_t>(n));
+    return tokens;
+}
+
+std::string token_to_piece(const llama_vocab* vocab, llama_token token) {
+    char buffer[128];
+    const int32_t n = llama_token_to_piece(vocab, token, buffer, sizeof(buffer), 0, false);
+    if (n >= 0) return std::string(buffer, static_cast<size_t>(n));
+
+    std::string piece(static_cast<size_t>(-n), '\0');
+    llama_token_to_piece(vocab, token, piece.data(), -n, 0, false);
+    return piece;
+}
+
+llama_sampler* make_sampler(const llm_inference::GenerationParams& params) {
+    llama_sampler* chain = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    if (params.temperature <= 0.0f) {
+        llama_sampler_chain_add(chain, llama_sampler_init_greedy());
+        return chain;
+    }
+    if (params.top_k > 0) llama_sampler_chain_add(chain, llama_sampler_init_top_k(params.top_k));
+    if (params.top_p < 1.0f) llama_sampler_chain_add(chain, llama_sampler_init_top_p(params.top_p, 1));
+    llama_sampler_chain_add(chain, llama_sampler_init_temp(params.temperature));
+    llama_sampler_chain_add(chain, llama_sampler_init_dist(params.seed));
+    return chain;
+}
+
+} // namespace
+
+namespace llm_inference {
+
+const char* finish_reason_name(FinishReason reason) {
+    switch (reason) {
+    case FinishReason::STOP: return "stop";
+    case FinishReason::LENGTH: return "length";
+    case FinishReason::CANCELLED: return "cancelled";
+    }
+    return "unknown";
+}
+
+struct LlamaInference::Request {
+    std::string prompt;
+    GenerationParams params;
+    TokenCallback on_token;
+    std::promise<GenerationResult> promise;
+    Clock::time_point submitted;
+};
+
+struct LlamaInference::Sequence {
+    llama_seq_id id = 0;
+    // 为空表示该序列空闲
+    std::unique_ptr<Request> request;
+
+    std::vector<llama_token> prompt;
+    size_t prefilled = 0;   // 已写入 KV 的 prompt token 数
+    size_t n_past = 0;      // KV 中的 token 数，即下一个 token 的位置
+    size_t max_tokens = 0;
+    llama_sampler* sampler = nullptr;
+
+    bool generating = false;
+    bool in_batch = false;
+    llama_token next = 0;       // 已采样、待下一步解码的 token
+    int32_t logits_index = -1;  // 本步 batch 中输出 logits 的下标
+
+    Clock::time_point started;
+    Clock::time_point first_token;
+    GenerationResult result;
+    StopSequenceFilter stop_filter;
+};
+
+LlamaInference::LlamaInference(LlamaOptions options)
+    : options_(std::move(options)), cache_(options_.cache) {
+    options_.max_sequences = std::max<size_t>(1, options_.max_sequences);
+    init_backend();
+}
+
+LlamaInference::~LlamaInference() {
+    unload_model();
+}
+
+bool LlamaInference::load_model(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    stop_scheduler();
+    release_model();
+    // 状态快照与模型绑定
+    cache_.clear();
+
+    llama_model_params model_params = llama_model_default_params();
+    model_params.n_gpu_layers = options_.n_gpu_layers;
+    model_ = llama_model_load_from_file(model_path.c_str(), model_params);
+    if (!model_) {
+        LOG_ERROR << "[LlamaInference] Failed to load model: " << model_path;
+        return false;
+    }
+
+    const size_t batch_capacity = std::max(options_.n_batch, options_.max_sequences);
+    const int32_t threads = options_.n_threads > 0
+        ? options_.n_threads
+        : static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+
+    llama_context_params context_params = llama_context_default_params();
+    context_params.n_ctx = static_cast<uint32_t>(options_.context_per_sequence * options_.max_sequences);
+    context_params.n_batch = static_cast<uint32_t>(batch_capacity);
+    context_params.n_ubatch = static_cast<uint32_t>(batch_capacity);
+    context_params.n_seq_max = static_cast<uint32_t>(options_.max_sequences);
+    context_params.n_threads = threads;
+    context_params.n_threads_batch = threads;
+    context_ = llama_init_from_model(model_, context_params);
+    if (!context_) {
+        LOG_ERROR << "[LlamaInference] Failed to create context for " << model_path;
+        release_model();
+        return false;
+    }
+
+    // 循环结构模型的状态无法按位置截断，只有完全相同的前缀才能复用，不值得缓存
+    cache_enabled_ = options_.prefix_cache && !llama_model_is_recurrent(model_);
+    if (options_.prefix_cache && !cache_enabled_) {
+        LOG_WARNING << "[LlamaInference] Recurrent model, prefix cache disabled";
+    }
+
+    start_scheduler();
+    LOG_INFO << "[LlamaInference] Loaded " << model_path << " | sequences: " << options_.max_sequences
+             << ", context/seq: " << options_.context_per_sequence << ", batch: " << batch_capacity
+             << ", threads: " << threads << ", prefix cache: " << (cache_enabled_ ? "on" : "off");
+    return true;
+}
+
+void LlamaInference::unload_model() {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    stop_scheduler();
+    release_model();
+    cache_.clear();
+}
+
+void LlamaInference::release_model() {
+    if (context_) llama_free(context_);
+    if (model_) llama_model_free(model_);
+    context_ = nullptr;
+    model_ = nullptr;
+}
+
+bool LlamaInference::is_loaded() const {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    return model_ != nullptr;
+}
+
+size_t LlamaInference::count_tokens(const std::string& text) const {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    if (!model_) return 0;
+    return tokenize(llama_model_get_vocab(model_), text, false).size();
+}
+
+GenerationResult LlamaInference::generate(const std::string& prompt, const GenerationParams& params,
+                                          TokenCallback on_token) {
+    return submit(prompt, params, std::move(on_token)).get();
+}
+
+std::future<GenerationResult> LlamaInference::submit(const std::string& prompt, const GenerationParams& params,
+                                                     TokenCallback on_token) {
+    auto request = std::make_unique<Request>();
+    request->prompt = prompt;
+    request->params = params;
+    request->on_token = std::move(on_token);
+    request->submitted = Clock::now();
+    auto future = request->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) throw std::runtime_error("LlamaInference: model not loaded");
+        pending_.push_back(std::move(request));
+    }
+    cv_.notify_one();
+    return future;
+}
+
+void LlamaInference::start_scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+    }
+    scheduler_ = std::thread(&LlamaInference::scheduler_loop, this);
+}
+
+void LlamaInference::stop_scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (scheduler_.joinable()) scheduler_.join();
+}
+
+void LlamaInference::scheduler_loop() {
+    const size_t capacity = std::max(options_.n_batch, options_.max_sequences);
+    llama_batch batch = llama_batch_init(static_cast<int32_t>(capacity), 0, 1);
+
+    std::vector<Sequence> slots(options_.max_sequences);
+    for (size_t i = 0; i < slots.size(); ++i) slots[i].id = static_cast<llama_seq_id>(i);
+
+    std::vector<Sequence*> admitted;
+    while (true) {
+        admitted.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const bool active = std::any_of(slots.begin(), slots.end(),
+                                            [](const Sequence& seq) { return seq.request != nullptr; });
+            cv_.wait(lock, [&] { return !running_ || active || !pending_.empty(); });
+            if (!running_) break;
+            // 有空闲序列就接入新请求，不必等当前批次结束
+            for (auto& seq : slots) {
+                if (pending_.empty()) break;
+                if (seq.request) continue;
+                seq.request = std::move(pending_.front());
+                pending_.pop_front();
+                admitted.push_back(&seq);
+            }
+        }
+        for (Sequence* seq : admitted) {
+            try {
+                start_sequence(*seq);
+            } catch (...) {
+                fail(*seq, std::current_exception());
+            }
+        }
+        step(slots, batch, capacity);
+    }
+
+    const auto unloaded = std::make_exception_ptr(std::runtime_error("LlamaInference: model unloaded"));
+    for (auto& seq : slots) {
+        if (seq.request) fail(seq, unloaded);
+    }
+    std::deque<std::unique_ptr<Request>> rejected;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rejected.swap(pending_);
+    }
+    for (auto& request : rejected) request->promise.set_exception(unloaded);
+    llama_batch_free(batch);
+}
+
+void LlamaInference::start_sequence(Sequence& seq) {
+    const Request& request = *seq.request;
+    seq.started = Clock::now();
+    seq.result = GenerationResult{};
+    seq.stop_filter = StopSequenceFilter(request.params.stop);
+    seq.result.queue_ms = elapsed_ms(request.submitted, seq.started);
+
+    seq.prompt = tokenize(llama_model_get_vocab(model_), request.prompt, true);
+    if (seq.prompt.empty()) throw std::invalid_argument("LlamaInference: empty prompt");
+    if (seq.prompt.size() >= options_.context_per_sequence) {
+        throw std::invalid_argument("LlamaInference: prompt has " + std::to_string(seq.prompt.size()) +
+                                    " tokens, context per sequence is " +
+                                    std::to_string(options_.context_per_sequence));
+    }
+    seq.result.prompt_tokens = seq.prompt.size();
+    seq.max_tokens = std::min(request.params.max_tokens, options_.context_per_sequence - seq.prompt.size());
+    seq.sampler = make_sampler(request.params);
+    seq.prefilled = 0;
+    seq.generating = false;
+    seq.logits_index = -1;
+
+    llama_memory_seq_rm(llama_get_memory(context_), seq.id, -1, -1);
+    if (cache_enabled_) restore_prefix(seq);
+    seq.n_past = seq.prefilled;
+    seq.result.cached_tokens = seq.prefilled;
+
+    if (seq.max_tokens == 0) finish(seq, FinishReason::LENGTH);
+}
+
+void LlamaInference::restore_prefix(Sequence& seq) {
+    const auto match = cache_.lookup(seq.prompt);
+    if (!match.entry) return;
+
+    // 至少留一个 prompt token 预填充，用它的 logits 采样第一个生成 token
+    const size_t keep = std::min(match.length, seq.prompt.size() - 1);
+    if (keep == 0) return;
+
+    const auto& state = match.entry->state;
+    llama_memory_t memory = llama_get_memory(context_);
+    if (llama_state_seq_set_data(context_, state.data(), state.size(), seq.id) == 0) {
+        LOG_WARNING << "[LlamaInference] Failed to restore cached prefix of " << match.entry->tokens.size() << " tokens";
+        llama_memory_seq_rm(memory, seq.id, -1, -1);
+        return;
+    }
+    // 快照可能比公共前缀长，截掉分叉之后的部分
+    if (keep < match.entry->tokens.size() &&
+        !llama_memory_seq_rm(memory, seq.id, static_cast<llama_pos>(keep), -1)) {
+        llama_memory_seq_rm(memory, seq.id, -1, -1);
+        return;
+    }
+    seq.prefilled = keep;
+}
+
+void LlamaInference::save_prefix(Sequence& seq) {
+    // 快照在调度线程上同步拷贝整条序列的 KV；只有超出已缓存前缀足够多的 prompt 才值得导出，
+    // 例如共享系统提示、只有问题不同的请求不再各自快照
+    if (!cache_enabled_ || !cache_.worth_saving(seq.prompt)) return;
+
+    // 此时该序列的 KV 恰好是整个 prompt，采样出的 token 还未写入
+    const auto start = Clock::now();
+    const size_t size = llama_state_seq_get_size(context_, seq.id);
+    std::vector<uint8_t> state(size);
+    const bool ok = llama_state_seq_get_data(context_, state.data(), size, seq.id) == size;
+    seq.result.snapshot_ms = elapsed_ms(start, Clock::now());
+    if (!ok) {
+        LOG_WARNING << "[LlamaInference] Failed to snapshot prefix of " << seq.prompt.size() << " tokens";
+        return;
+    }
+    cache_.insert(std::vector<int32_t>(seq.prompt.begin(), seq.prompt.end()), std::move(state));
+}
+
+bool LlamaInference::step(std::vector<Sequence>& slots, llama_batch& batch, size_t capacity) {
+    batch.n_tokens = 0;
+    auto add = [&batch](llama_token token, size_t pos, llama_seq_id id, bool logits) {
+        const int32_t i = batch.n_tokens++;
+        batch.token[i] = token;
+        batch.pos[i] = static_cast<llama_pos>(pos);
+        batch.n_seq_id[i] = 1;
+        batch.seq_id[i][0] = id;
+        batch.logits[i] = logits;
+        return i;
+    };
+
+    // 生成中的序列每步各解码一个 token，优先入批，保证它们的出字节奏不被长 prompt 拖慢
+    for (auto& seq : slots) {
+        seq.in_batch = false;
+        if (!seq.request || !seq.generating) continue;
+        seq.logits_index = add(seq.next, seq.n_past, seq.id, true);
+        seq.in_batch = true;
+    }
+    // 剩余容量分给预填充中的序列
+    for (auto& seq : slots) {
+        if (!seq.request || seq.generating) continue;
+        const size_t budget = capacity - static_cast<size_t>(batch.n_tokens);
+        if (budget == 0) break;
+        const size_t take = std::min(budget, seq.prompt.size() - seq.prefilled);
+        seq.logits_index = -1;
+        for (size_t pos = seq.prefilled; pos < seq.prefilled + take; ++pos) {
+            const bool last = pos + 1 == seq.prompt.size();
+            const int32_t i = add(seq.prompt[pos], pos, seq.id, last);
+            if (last) seq.logits_index = i;
+        }
+        seq.prefilled += take;
+        seq.in_batch = true;
+    }
+    if (batch.n_tokens == 0) return false;
+
+    const int32_t rc = llama_decode(context_, batch);
+    if (rc != 0) {
+        const auto error = std::make_exception_ptr(
+            std::runtime_error("LlamaInference: llama_decode failed with code " + std::to_string(rc)));
+        for (auto& seq : slots) {
+            if (seq.request && seq.in_batch) fail(seq, error);
+        }
+        return true;
+    }
+
+    for (auto& seq : slots) {
+        if (!seq.request || !seq.in_batch) continue;
+        if (seq.generating) {
+            ++seq.n_past;
+        } else {
+            seq.n_past = seq.prefilled;
+            if (seq.logits_index < 0) continue;  // prompt 尚未预填充完
+            seq.generating = true;
+            save_prefix(seq);
+        }
+        try {
+            emit(seq, llama_sampler_sample(seq.sampler, context_, seq.logits_index));
+        } catch (...) {
+            // 回调抛出的异常只结束该请求
+            if (seq.request) fail(seq, std::current_exception());
+        }
+    }
+    return true;
+}
+
+void LlamaInference::emit(Sequence& seq, int32_t token) {
+    auto& result = seq.result;
+    if (result.generated_tokens == 0) {
+        seq.first_token = Clock::now();
+        result.ttft_ms = elapsed_ms(seq.request->submitted, seq.first_token);
+    }
+
+    const llama_vocab* vocab = llama_model_get_vocab(model_);
+    const auto& on_token = seq.request->on_token;
+    if (llama_vocab_is_eog(vocab, token)) {
+        // 暂扣的尾部已确定不会组成停止串
+        const std::string rest = seq.stop_filter.flush();
+        if (on_token && !rest.empty() && !on_token(rest)) {
+            finish(seq, FinishReason::CANCELLED);
+            return;
+        }
+        finish(seq, FinishReason::STOP);
+        return;
+    }
+    ++result.generated_tokens;
+
+    // 可能是停止串开头的尾部字节先不交给回调，流式输出与最终文本保持一致
+    std::string ready = seq.stop_filter.append(token_to_piece(vocab, token));
+    const bool stopped = seq.stop_filter.stopped();
+    const bool at_limit = !stopped && result.generated_tokens >= seq.max_tokens;
+    if (at_limit) ready += seq.stop_filter.flush();
+
+    if (on_token && !ready.empty() && !on_token(ready)) {
+        finish(seq, FinishReason::CANCELLED);
+        return;
+    }
+    if (stopped) {
+        finish(seq, FinishReason::STOP);
+    } else if (at_limit) {
+        finish(seq, FinishReason::LENGTH);
+    } else {
+        seq.next = token;
+    }
+}
+
+void LlamaInference::finish(Sequence& seq, FinishReason reason) {
+    auto& result = seq.result;
+    const auto now = Clock::now();
+    result.text = seq.stop_filter.text();
+    result.finish_reason = reason;
+    result.total_ms = elapsed_ms(seq.request->submitted, now);
+    const double decode_ms = result.generated_tokens > 1 ? elapsed_ms(seq.first_token, now) : 0.0;
+    if (decode_ms > 0.0) {
+        result.tokens_per_second = static_cast<double>(result.generated_tokens - 1) * 1000.0 / decode_ms;
+    }
+
+    LOG_DEBUG << "[LlamaInference] seq " << seq.id << " " << finish_reason_name(reason) << " | prompt "
+              << result.prompt_tokens << " (cached " << result.cached_tokens << "), generated "
+              << result.generated_tokens << ", ttft " << result.ttft_ms << " ms, "
+              << result.tokens_per_second << " tok/s";
+    seq.request->promise.set_value(std::move(result));
+    release(seq);
+}
+
+void LlamaInference::fail(Sequence& seq, std::exception_ptr error) {
+    seq.request->promise.set_exception(error);
+    release(seq);
+}
+
+void LlamaInference::release(Sequence& seq) {
+    if (seq.sampler) llama_sampler_free(seq.sampler);
+    seq.sampler = nullptr;
+    seq.request.reset();
+    seq.generating = false;
+    seq.in_batch = false;
+    seq.prompt.clear();
+    llama_memory_seq_rm(llama_get_memory(context_), seq.id, -1, -1);
+}
+
+} // namespace llm_inference
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "llm_inference.h"
+#include "prefix_cache.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct llama_model;
+struct llama_context;
+struct llama_batch;
+
+namespace llm_inference {
+
+struct LlamaOptions {
+    // 同时解码的序列数，即一个 llama_context 内的 seq_id 个数
+    size_t max_sequences = 4;
+    // 每个序列可用的上下文长度（prompt + 生成），context 总长为 context_per_sequence * max_sequences
+    size_t context_per_sequence = 4096;
+    // 单次 llama_decode 的 token 上限；长 prompt 分多步预填充，与其他序列的解码交错进行
+    size_t n_batch = 512;
+    // 0 表示使用硬件线程数
+    int32_t n_threads = 0;
+    int32_t n_gpu_layers = 0;
+
+    bool prefix_cache = true;
+    PrefixCacheOptions cache;
+};
+
+// 基于 llama.cpp 的生成推理。
+// 一个调度线程独占 llama_context，所有请求在同一个 context 中以不同 seq_id 连续批处理：
+// 每一步把生成中序列的下一个 token 与预填充中序列的 prompt 片段拼成一个 batch 解码，
+// 新请求在有空闲序列时随时加入，结束的序列立即让出位置。
+// prompt 预填充完成后把该序列的 KV 状态存入 PrefixCache，后续请求恢复最长公共前缀，只预填充剩余部分。
+class LlamaInference : public LlmInference {
+public:
+    explicit LlamaInference(LlamaOptions options = {});
+    ~LlamaInference() override;
+
+    bool load_model(const std::string& model_path) override;
+    void unload_model() override;
+
+    GenerationResult generate(const std::string& prompt,
+                              const GenerationParams& params = {},
+                              TokenCallback on_token = nullptr) override;
+
+    // 异步提交；on_token 在调度线程上调用，应尽快返回
+    std::future<GenerationResult> submit(const std::string& prompt,
+                                         const GenerationParams& params = {},
+                                         TokenCallback on_token = nullptr);
+
+    bool is_loaded() const;
+    size_t count_tokens(const std::string& text) const;
+
+    PrefixCacheStats cache_stats() const { return cache_.stats(); }
+    void clear_cache() { cache_.clear(); }
+
+private:
+    struct Request;
+    struct Sequence;
+
+    LlamaOptions options_;
+    PrefixCache cache_;
+
+    // load / unload 串行化；model_ 与 context_ 只在调度线程停止时修改
+    mutable std::mutex load_mutex_;
+    llama_model* model_ = nullptr;
+    llama_context* context_ = nullptr;
+    bool cache_enabled_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Request>> pending_;
+    bool running_ = false;
+    std::thread scheduler_;
+
+    void release_model();
+    void start_scheduler();
+    void stop_scheduler();
+    void scheduler_loop();
+
+    void start_sequence(Sequence& seq);
+    void restore_prefix(Sequence& seq);
+    void save_prefix(Sequence& seq);
+    bool step(std::vector<Sequence>& slots, llama_batch& batch, size_t capacity);
+    void emit(Sequence& seq, int32_t token);
+    void release(Sequence& seq);
+    void finish(Sequence& seq, FinishReason reason);
+    void fail(Sequence& seq, std::exception_ptr error);
+};
+
+} // namespace llm_inference
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace llm_inference {
+
+struct GenerationParams {
+    size_t max_tokens = 256;
+    // <= 0 时使用贪心解码
+    float temperature = 0.8f;
+    int32_t top_k = 40;
+    float top_p = 0.95f;
+    uint32_t seed = 42;
+    // 生成文本出现任一停止串时结束，停止串本身不计入结果
+    std::vector<std::string> stop;
+};
+
+enum class FinishReason {
+    STOP,       // 遇到结束 token 或停止串
+    LENGTH,     // 达到 max_tokens 或序列上下文上限
+    CANCELLED,  // token 回调返回 false
+};
+
+const char* finish_reason_name(FinishReason reason);
+
+struct GenerationResult {
+    std::string text;
+    FinishReason finish_reason = FinishReason::STOP;
+
+    size_t prompt_tokens = 0;
+    // 从前缀缓存恢复、无需预填充的 prompt token 数
+    size_t cached_tokens = 0;
+    size_t generated_tokens = 0;
+
+    double queue_ms = 0.0;    // 提交到开始处理
+    double ttft_ms = 0.0;     // 提交到第一个 token
+    double total_ms = 0.0;    // 提交到结束
+    // 预填充后导出前缀快照的耗时，期间同一 context 内的其他序列停止解码
+    double snapshot_ms = 0.0;
+    // 解码阶段速度（不含首 token）
+    double tokens_per_second = 0.0;
+};
+
+// 每生成一段文本回调一次；返回 false 提前结束该请求。
+// 可能组成停止串开头的尾部会延后输出，所有片段拼起来等于 GenerationResult::text
+using TokenCallback = std::function<bool(const std::string& piece)>;
+
+class LlmInference {
+public:
+    virtual ~LlmInference() = default;
+
+    // 加载模型
+    virtual bool load_model(const std::string& model_path) = 0;
+
+    // 卸载模型
+    virtual void unload_model() = 0;
+
+    // 阻塞直到生成结束；可被多个线程并发调用
+    virtual GenerationResult generate(const std::string& prompt,
+                                      const GenerationParams& params = {},
+                                      TokenCallback on_token = nullptr) = 0;
+};
+
+} // namespace llm_inference
@@ -0,0 +1,99 @@
+#include "prefix_cache.h"
+
+#include <algorithm>
+
+namespace llm_inference {
+
+size_t common_prefix_length(const std::vector<int32_t>& a, const std::vector<int32_t>& b) {
+    const size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+PrefixCache::PrefixCache(PrefixCacheOptions options) : options_(options) {}
+
+PrefixCache::Match PrefixCache::lookup(const std::vector<int32_t>& tokens) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.lookups;
+
+    Match best;
+    auto best_it = entries_.end();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        const size_t length = common_prefix_length((*it)->tokens, tokens);
+        // 同长时取更短的条目，恢复后需要截掉的部分更少
+        if (length > best.length ||
+            (length == best.length && best.entry && (*it)->tokens.size() < best.entry->tokens.size())) {
+            best.entry = *it;
+            best.length = length;
+            best_it = it;
+        }
+    }
+    if (best.length < options_.min_tokens || best_it == entries_.end()) return {};
+
+    entries_.splice(entries_.begin(), entries_, best_it);
+    ++stats_.hits;
+    stats_.reused_tokens += best.length;
+    return best;
+}
+
+bool PrefixCache::worth_saving(const std::vector<int32_t>& tokens) const {
+    if (tokens.size() < options_.min_tokens) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t longest = 0;
+    for (const auto& entry : entries_) longest = std::max(longest, common_prefix_length(entry->tokens, tokens));
+    return tokens.size() - longest >= options_.min_tokens;
+}
+
+void PrefixCache::insert(std::vector<int32_t> tokens, std::vector<uint8_t> state) {
+    if (tokens.size() < options_.min_tokens || state.size() > options_.max_bytes) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        const auto& existing = (*it)->tokens;
+        const size_t length = common_prefix_length(existing, tokens);
+        if (length == tokens.size() && existing.size() >= tokens.size()) {
+            // 已被更长的条目覆盖，只刷新 LRU
+            entries_.splice(entries_.begin(), entries_, it);
+            return;
+        }
+        if (length == existing.size()) {
+            // 旧条目是新条目的前缀，新条目可以完全替代它
+            stats_.bytes -= (*it)->state.size();
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->tokens = std::move(tokens);
+    entry->state = std::move(state);
+    stats_.bytes += entry->state.size();
+    ++stats_.insertions;
+    entries_.push_front(std::move(entry));
+    evict_locked();
+}
+
+void PrefixCache::evict_locked() {
+    while (stats_.bytes > options_.max_bytes && !entries_.empty()) {
+        stats_.bytes -= entries_.back()->state.size();
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+void PrefixCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    stats_.bytes = 0;
+}
+
+PrefixCacheStats PrefixCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PrefixCacheStats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+} // namespace llm_inference
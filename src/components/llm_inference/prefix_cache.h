@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llm_inference {
+
+struct PrefixCacheOptions {
+    // 所有状态快照的总字节上限，超出后按 LRU 淘汰
+    size_t max_bytes = size_t(1) << 30;
+    // 公共前缀短于该值时不值得恢复，也不缓存更短的 prompt
+    size_t min_tokens = 32;
+};
+
+struct PrefixCacheStats {
+    size_t entries = 0;
+    size_t bytes = 0;
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t reused_tokens = 0;
+    uint64_t insertions = 0;
+    uint64_t evictions = 0;
+};
+
+// 以 token 序列为键的 KV 状态快照缓存。
+// 状态本身是不透明字节（llama_state_seq_get_data 的输出），lookup 返回与请求公共前缀最长的条目，
+// 调用方恢复整条快照后再截掉公共前缀之后的部分。线程安全。
+class PrefixCache {
+public:
+    struct Entry {
+        std::vector<int32_t> tokens;
+        std::vector<uint8_t> state;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    struct Match {
+        EntryPtr entry;
+        size_t length = 0;  // 与请求的公共前缀长度
+    };
+
+    explicit PrefixCache(PrefixCacheOptions options = {});
+
+    // 未命中时 entry 为空
+    Match lookup(const std::vector<int32_t>& tokens);
+
+    // 在与已有条目的最长公共前缀之后还有至少 min_tokens 个新 token 时返回 true。
+    // 快照要在调度线程上拷贝整条序列的 KV，期间所有序列停止出字，收益不足时跳过
+    bool worth_saving(const std::vector<int32_t>& tokens) const;
+
+    // 被新条目覆盖的旧条目一并移除；单条超过容量时不缓存
+    void insert(std::vector<int32_t> tokens, std::vector<uint8_t> state);
+
+    void clear();
+    PrefixCacheStats stats() const;
+    const PrefixCacheOptions& options() const { return options_; }
+
+private:
+    PrefixCacheOptions options_;
+    mutable std::mutex mutex_;
+    // 头部为最近使用
+    std::list<EntryPtr> entries_;
+    PrefixCacheStats stats_;
+
+    void evict_locked();
+};
+
+// 两个 token 序列的公共前缀长度
+size_t common_prefix_length(const std::vector<int32_t>& a, const std::vector<int32_t>& b);
+
+} // namespace llm_inference
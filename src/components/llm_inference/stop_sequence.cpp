@@ -0,0 +1,62 @@
+#include "stop_sequence.h"
+
+#include <algorithm>
+
+namespace llm_inference {
+
+StopSequenceFilter::StopSequenceFilter(std::vector<std::string> stops) {
+    for (auto& stop : stops) {
+        if (!stop.empty()) stops_.push_back(std::move(stop));
+    }
+}
+
+std::string StopSequenceFilter::append(const std::string& piece) {
+    if (stopped_) return {};
+    text_ += piece;
+
+    const size_t stop = find_stop(piece.size());
+    if (stop != std::string::npos) {
+        text_.resize(stop);
+        stopped_ = true;
+        return flush();
+    }
+
+    const size_t ready = text_.size() - held_back();
+    if (ready <= streamed_) return {};
+    std::string out = text_.substr(streamed_, ready - streamed_);
+    streamed_ = ready;
+    return out;
+}
+
+std::string StopSequenceFilter::flush() {
+    std::string out = text_.substr(std::min(streamed_, text_.size()));
+    streamed_ = text_.size();
+    return out;
+}
+
+// 新片段加入后最早出现的停止串位置；只在可能跨片段的尾部范围内查找
+size_t StopSequenceFilter::find_stop(size_t piece_length) const {
+    size_t found = std::string::npos;
+    for (const auto& stop : stops_) {
+        const size_t window = piece_length + stop.size();
+        const size_t from = text_.size() > window ? text_.size() - window : 0;
+        found = std::min(found, text_.find(stop, from));
+    }
+    return found;
+}
+
+// 末尾与某个停止串的真前缀相同的最长字节数，这部分之后仍可能组成停止串
+size_t StopSequenceFilter::held_back() const {
+    size_t longest = 0;
+    for (const auto& stop : stops_) {
+        for (size_t length = std::min(stop.size() - 1, text_.size()); length > longest; --length) {
+            if (text_.compare(text_.size() - length, length, stop, 0, length) == 0) {
+                longest = length;
+                break;
+            }
+        }
+    }
+    return longest;
+}
+
+} // namespace llm_inference
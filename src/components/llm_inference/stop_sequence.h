@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace llm_inference {
+
+// 流式生成时的停止串过滤。停止串可能跨多个 token 片段，末尾可能成为停止串开头的字节
+// 先暂扣，确定不会命中后再交给回调，因此流式输出拼起来总等于最终文本。
+class StopSequenceFilter {
+public:
+    StopSequenceFilter() = default;
+    explicit StopSequenceFilter(std::vector<std::string> stops);
+
+    // 追加一个 token 片段，返回此后可以安全流式输出的新文本。
+    // 命中停止串时返回停止串之前尚未输出的部分，之后的片段全部忽略
+    std::string append(const std::string& piece);
+
+    // 因其他原因结束生成时，取出暂扣的尾部
+    std::string flush();
+
+    bool stopped() const { return stopped_; }
+    // 截至目前的完整文本，不含停止串及其之后的内容
+    const std::string& text() const { return text_; }
+
+private:
+    std::vector<std::string> stops_;
+    std::string text_;
+    size_t streamed_ = 0;  // 已返回给调用方的字节数
+    bool stopped_ = false;
+
+    size_t find_stop(size_t piece_length) const;
+    size_t held_back() const;
+};
+
+} // namespace llm_inference
@@ -0,0 +1,135 @@
+#include "batching_embedding.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "logger.h"
+
+namespace text_embedding {
+
+BatchingEmbedding::BatchingEmbedding(std::unique_ptr<TextEmbedding> inner, BatchingOptions options)
+    : inner_(std::move(inner)), options_(options) {
+    if (!inner_) {
+        throw std::invalid_argument("BatchingEmbedding requires a non-null inner embedding.");
+    }
+    options_.max_batch_size = std::max<size_t>(options_.max_batch_size, 1);
+    options_.num_workers = std::max<size_t>(options_.num_workers, 1);
+
+    for (size_t i = 0; i < options_.num_workers; ++i) {
+        workers_.emplace_back(&BatchingEmbedding::worker_loop, this);
+    }
+}
+
+BatchingEmbedding::~BatchingEmbedding() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+bool BatchingEmbedding::load_model(const std::string& model_path) {
+    return inner_->load_model(model_path);
+}
+
+void BatchingEmbedding::unload_model() {
+    inner_->unload_model();
+}
+
+std::vector<float> BatchingEmbedding::embed(const std::string& text) {
+    Request request{&text, std::chrono::steady_clock::now(), {}};
+    auto future = request.promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_) {
+            throw std::runtime_error("BatchingEmbedding is shutting down.");
+        }
+        queue_.push_back(&request);
+    }
+    queue_cv_.notify_one();
+
+    return future.get();
+}
+
+std::vector<std::vector<float>> BatchingEmbedding::embed_batch(const std::vector<std::string>& texts) {
+    // 调用方已自行成批，直接透传
+    return inner_->embed_batch(texts);
+}
+
+void BatchingEmbedding::worker_loop() {
+    std::vector<Request*> batch;
+    batch.reserve(options_.max_batch_size);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+
+            // 攒批：直到达到最大批量、队首请求超时或调度器停止
+            if (!stopping_ && queue_.size() < options_.max_batch_size) {
+                auto deadline = queue_.front()->enqueue_time + options_.max_wait;
+                queue_cv_.wait_until(lock, deadline, [this] {
+                    return stopping_ || queue_.empty() || queue_.size() >= options_.max_batch_size;
+                });
+            }
+
+            if (queue_.empty()) {
+                if (stopping_) return;
+                continue;  // 已被其他工作线程取走
+            }
+
+            size_t count = std::min(queue_.size(), options_.max_batch_size);
+            batch.assign(queue_.begin(), queue_.begin() + count);
+            queue_.erase(queue_.begin(), queue_.begin() + count);
+        }
+
+        // 队列中仍有积压时唤醒其他工作线程
+        queue_cv_.notify_one();
+        run_batch(batch);
+        batch.clear();
+    }
+}
+
+void BatchingEmbedding::run_batch(std::vector<Request*>& batch) {
+    std::vector<std::string> texts;
+    texts.reserve(batch.size());
+    for (const auto* request : batch) {
+        texts.push_back(*request->text);
+    }
+
+    LOG_DEBUG << "[BatchingEmbedding] Running merged batch of " << batch.size() << " requests";
+
+    try {
+        auto results = inner_->embed_batch(texts);
+        if (results.size() != batch.size()) {
+            throw std::runtime_error("Inner embedding returned " + std::to_string(results.size()) +
+                                     " vectors for a batch of " + std::to_string(batch.size()));
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i]->promise.set_value(std::move(results[i]));
+        }
+    } catch (const std::exception& e) {
+        if (batch.size() == 1) {
+            batch[0]->promise.set_exception(std::current_exception());
+            return;
+        }
+
+        // 合并推理失败时逐条重试，避免单条异常输入拖垮同批的其他请求
+        LOG_WARNING << "[BatchingEmbedding] Merged batch failed (" << e.what() << "), retrying one by one";
+        for (auto* request : batch) {
+            try {
+                request->promise.set_value(inner_->embed(*request->text));
+            } catch (...) {
+                request->promise.set_exception(std::current_exception());
+            }
+        }
+    }
+}
+
+} // namespace text_embedding
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "text_embedding.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace text_embedding {
+
+struct BatchingOptions {
+    // 单次合并推理的最大条数
+    size_t max_batch_size = 32;
+    // 队首请求最长等待时间，超时即使未攒满也立即推理
+    std::chrono::microseconds max_wait{2000};
+    // 并发执行批量推理的工作线程数
+    size_t num_workers = 1;
+};
+
+// 动态微批调度器：将并发的 embed() 请求合并为一次 embed_batch() 推理
+class BatchingEmbedding : public TextEmbedding {
+public:
+    explicit BatchingEmbedding(std::unique_ptr<TextEmbedding> inner, BatchingOptions options = {});
+    ~BatchingEmbedding() override;
+
+    bool load_model(const std::string& model_path) override;
+    void unload_model() override;
+    std::vector<float> embed(const std::string& text) override;
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override;
+
+private:
+    struct Request {
+        const std::string* text;
+        std::chrono::steady_clock::time_point enqueue_time;
+        std::promise<std::vector<float>> promise;
+    };
+
+    std::unique_ptr<TextEmbedding> inner_;
+    BatchingOptions options_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Request*> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void worker_loop();
+    void run_batch(std::vector<Request*>& batch);
+};
+
+} // namespace text_embedding
@@ -0,0 +1,180 @@
+#include "compact_embedding.h"
+#include "vector_math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace text_embedding {
+
+Fp16Embedding to_fp16(const float* v, size_t dim) {
+    Fp16Embedding out(dim);
+    vector_math::fp32_to_fp16(v, out.data(), dim);
+    return out;
+}
+
+std::vector<float> from_fp16(const Fp16Embedding& v) {
+    std::vector<float> out(v.size());
+    vector_math::fp16_to_fp32(v.data(), out.data(), v.size());
+    return out;
+}
+
+void quantize_int8_into(const float* v, size_t dim, int8_t* out, float* scale) {
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < dim; ++i) max_abs = std::max(max_abs, std::fabs(v[i]));
+
+    if (max_abs == 0.0f) {
+        std::fill(out, out + dim, int8_t{0});
+        *scale = 0.0f;
+        return;
+    }
+
+    float inv = 127.0f / max_abs;
+    for (size_t i = 0; i < dim; ++i) {
+        float q = std::nearbyint(v[i] * inv);
+        out[i] = static_cast<int8_t>(std::clamp(q, -127.0f, 127.0f));
+    }
+    *scale = max_abs / 127.0f;
+}
+
+Int8Embedding quantize_int8(const float* v, size_t dim) {
+    Int8Embedding out;
+    out.values.resize(dim);
+    quantize_int8_into(v, dim, out.values.data(), &out.scale);
+    return out;
+}
+
+std::vector<float> dequantize_int8(const Int8Embedding& v) {
+    std::vector<float> out(v.values.size());
+    for (size_t i = 0; i < out.size(); ++i) out[i] = static_cast<float>(v.values[i]) * v.scale;
+    return out;
+}
+
+void binarize_into(const float* v, size_t dim, uint64_t* out) {
+    size_t words = binary_words(dim);
+    std::fill(out, out + words, uint64_t{0});
+    for (size_t i = 0; i < dim; ++i) {
+        if (v[i] > 0.0f) out[i >> 6] |= uint64_t{1} << (i & 63);
+    }
+}
+
+BinaryEmbedding binarize(const float* v, size_t dim) {
+    BinaryEmbedding out;
+    out.dim = dim;
+    out.bits.resize(binary_words(dim));
+    binarize_into(v, dim, out.bits.data());
+    return out;
+}
+
+float int8_dot(const Int8Embedding& a, const Int8Embedding& b) {
+    if (a.values.size() != b.values.size()) {
+        throw std::invalid_argument("int8 embeddings have different dimensions");
+    }
+    int32_t raw = vector_math::dot_int8(a.values.data(), b.values.data(), a.values.size());
+    return static_cast<float>(raw) * a.scale * b.scale;
+}
+
+float int8_dot(const float* query, const int8_t* values, float scale, size_t dim) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < dim; ++i) sum += query[i] * static_cast<float>(values[i]);
+    return sum * scale;
+}
+
+size_t hamming_distance(const BinaryEmbedding& a, const BinaryEmbedding& b) {
+    if (a.dim != b.dim) {
+        throw std::invalid_argument("binary embeddings have different dimensions");
+    }
+    return vector_math::hamming(a.bits.data(), b.bits.data(), a.bits.size());
+}
+
+Fp16Embedding embed_fp16(TextEmbedding& model, const std::string& text) {
+    auto v = model.embed(text);
+    return to_fp16(v.data(), v.size());
+}
+
+Int8Embedding embed_int8(TextEmbedding& model, const std::string& text) {
+    auto v = model.embed(text);
+    return quantize_int8(v.data(), v.size());
+}
+
+BinaryEmbedding embed_binary(TextEmbedding& model, const std::string& text) {
+    auto v = model.embed(text);
+    return binarize(v.data(), v.size());
+}
+
+std::vector<Fp16Embedding> embed_batch_fp16(TextEmbedding& model, const std::vector<std::string>& texts) {
+    std::vector<Fp16Embedding> out;
+    out.reserve(texts.size());
+    for (const auto& v : model.embed_batch(texts)) out.push_back(to_fp16(v.data(), v.size()));
+    return out;
+}
+
+std::vector<Int8Embedding> embed_batch_int8(TextEmbedding& model, const std::vector<std::string>& texts) {
+    std::vector<Int8Embedding> out;
+    out.reserve(texts.size());
+    for (const auto& v : model.embed_batch(texts)) out.push_back(quantize_int8(v.data(), v.size()));
+    return out;
+}
+
+std::vector<BinaryEmbedding> embed_batch_binary(TextEmbedding& model, const std::vector<std::string>& texts) {
+    std::vector<BinaryEmbedding> out;
+    out.reserve(texts.size());
+    for (const auto& v : model.embed_batch(texts)) out.push_back(binarize(v.data(), v.size()));
+    return out;
+}
+
+// === CompactVectorStore ===
+
+CompactVectorStore::CompactVectorStore(size_t dim) : dim_(dim), words_(binary_words(dim)) {
+    if (dim == 0) {
+        throw std::invalid_argument("CompactVectorStore dimension must be positive");
+    }
+}
+
+size_t CompactVectorStore::add(const float* v) {
+    size_t id = scales_.size();
+    codes_.resize(codes_.size() + words_);
+    values_.resize(values_.size() + dim_);
+    scales_.push_back(0.0f);
+
+    binarize_into(v, dim_, codes_.data() + id * words_);
+    quantize_int8_into(v, dim_, values_.data() + id * dim_, &scales_[id]);
+    return id;
+}
+
+std::vector<ScoredId> CompactVectorStore::search(const float* query, size_t top_k, size_t candidates) const {
+    size_t count = size();
+    if (count == 0 || top_k == 0) return {};
+    candidates = std::min(std::max(candidates, top_k), count);
+
+    // 第一阶段：Hamming 粗筛
+    std::vector<uint64_t> query_code(words_);
+    binarize_into(query, dim_, query_code.data());
+
+    std::vector<std::pair<size_t, size_t>> coarse(count);  // (distance, id)
+    for (size_t id = 0; id < count; ++id) {
+        coarse[id] = {vector_math::hamming(query_code.data(), codes_.data() + id * words_, words_), id};
+    }
+    if (candidates < count) {
+        std::nth_element(coarse.begin(), coarse.begin() + candidates, coarse.end());
+    }
+
+    // 第二阶段：fp32 查询对 int8 向量重排
+    std::vector<ScoredId> results(candidates);
+    for (size_t i = 0; i < candidates; ++i) {
+        size_t id = coarse[i].second;
+        results[i] = {id, int8_dot(query, values_.data() + id * dim_, scales_[id], dim_)};
+    }
+
+    top_k = std::min(top_k, candidates);
+    std::partial_sort(results.begin(), results.begin() + top_k, results.end(),
+                      [](const ScoredId& a, const ScoredId& b) { return a.score > b.score; });
+    results.resize(top_k);
+    return results;
+}
+
+size_t CompactVectorStore::memory_bytes() const {
+    return codes_.size() * sizeof(uint64_t) + values_.size() * sizeof(int8_t) + scales_.size() * sizeof(float);
+}
+
+} // namespace text_embedding
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "text_embedding.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace text_embedding {
+
+// 半精度向量，按 IEEE 754 binary16 存储，体积为 fp32 的 1/2
+using Fp16Embedding = std::vector<uint16_t>;
+
+// 对称标量量化：x[i] ≈ values[i] * scale，scale = max|x| / 127，体积约为 fp32 的 1/4
+struct Int8Embedding {
+    std::vector<int8_t> values;
+    float scale = 0.0f;
+};
+
+// 符号二值化：第 i 位为 1 表示 x[i] > 0，按 64 位打包，体积为 fp32 的 1/32
+struct BinaryEmbedding {
+    std::vector<uint64_t> bits;
+    size_t dim = 0;
+};
+
+inline size_t binary_words(size_t dim) { return (dim + 63) / 64; }
+
+// === 格式转换 ===
+Fp16Embedding to_fp16(const float* v, size_t dim);
+std::vector<float> from_fp16(const Fp16Embedding& v);
+
+Int8Embedding quantize_int8(const float* v, size_t dim);
+void quantize_int8_into(const float* v, size_t dim, int8_t* out, float* scale);
+std::vector<float> dequantize_int8(const Int8Embedding& v);
+
+BinaryEmbedding binarize(const float* v, size_t dim);
+void binarize_into(const float* v, size_t dim, uint64_t* out);
+
+// === 距离 ===
+// 两个 int8 向量的近似内积
+float int8_dot(const Int8Embedding& a, const Int8Embedding& b);
+// float 查询对 int8 向量的非对称内积，精度高于双边量化，用于重排
+float int8_dot(const float* query, const int8_t* values, float scale, size_t dim);
+size_t hamming_distance(const BinaryEmbedding& a, const BinaryEmbedding& b);
+
+// === embed 变体：调用模型得到 fp32 向量后就地转换 ===
+Fp16Embedding embed_fp16(TextEmbedding& model, const std::string& text);
+Int8Embedding embed_int8(TextEmbedding& model, const std::string& text);
+BinaryEmbedding embed_binary(TextEmbedding& model, const std::string& text);
+
+std::vector<Fp16Embedding> embed_batch_fp16(TextEmbedding& model, const std::vector<std::string>& texts);
+std::vector<Int8Embedding> embed_batch_int8(TextEmbedding& model, const std::vector<std::string>& texts);
+std::vector<BinaryEmbedding> embed_batch_binary(TextEmbedding& model, const std::vector<std::string>& texts);
+
+struct ScoredId {
+    size_t id = 0;
+    float score = 0.0f;
+};
+
+// 紧凑向量库：二值码与 int8 向量各自连续存放。
+// 检索分两阶段：先按 Hamming 距离粗筛 candidates 条，再用 fp32 查询对 int8 向量重排取 top_k。
+class CompactVectorStore {
+public:
+    explicit CompactVectorStore(size_t dim);
+
+    // 追加一条 fp32 向量，返回其 id（从 0 递增）
+    size_t add(const float* v);
+    std::vector<ScoredId> search(const float* query, size_t top_k, size_t candidates) const;
+
+    size_t dimension() const { return dim_; }
+    size_t size() const { return scales_.size(); }
+    // 向量数据占用字节数（不含 vector 预留容量）
+    size_t memory_bytes() const;
+
+private:
+    size_t dim_;
+    size_t words_;
+    std::vector<uint64_t> codes_;   // [size, words_]
+    std::vector<int8_t> values_;    // [size, dim_]
+    std::vector<float> scales_;     // [size]
+};
+
+} // namespace text_embedding
@@ -0,0 +1,483 @@
+#include "embedding_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "logger.h"
+#include "mapped_file.h"
+
+namespace {
+
+constexpr uint64_t kHashSeedHi = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t kHashSeedLo = 0xC2B2AE3D27D4EB4FULL;
+
+// 每条内存缓存的元数据开销估算（链表节点 + 哈希表节点 + vector 头）
+constexpr size_t kEntryOverheadBytes = 96;
+
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+size_t entry_bytes(const std::vector<float>& vec) {
+    return vec.size() * sizeof(float) + kEntryOverheadBytes;
+}
+
+// 指纹只读取每个文件首尾的这么多字节，大模型也能在毫秒级完成
+constexpr size_t kFingerprintSampleBytes = 64 << 10;
+
+} // namespace
+
+namespace text_embedding {
+
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (len * 0x9E3779B97F4A7C15ULL);
+
+    while (len >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ mix64(word)) * 0x9E3779B97F4A7C15ULL;
+        h = (h << 27) | (h >> 37);
+        p += 8;
+        len -= 8;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, len);
+    h ^= mix64(tail ^ len);
+    return mix64(h);
+}
+
+CacheKey make_cache_key(uint64_t model_hash, const std::string& text) {
+    CacheKey key;
+    key.hi = hash_bytes(text.data(), text.size(), kHashSeedHi ^ model_hash);
+    key.lo = hash_bytes(text.data(), text.size(), kHashSeedLo + model_hash) | 1;  // lo 非零，便于持久层判空
+    return key;
+}
+
+uint64_t model_fingerprint(const std::string& model_path) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<fs::path> files;
+    if (fs::is_directory(model_path, ec)) {
+        for (const auto& entry : fs::directory_iterator(model_path, ec)) {
+            if (!entry.is_regular_file(ec)) continue;
+            // 优化图缓存与临时文件不影响模型输出
+            const std::string ext = entry.path().extension().string();
+            if (ext == ".ort" || ext == ".tmp") continue;
+            files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+    } else if (fs::is_regular_file(model_path, ec)) {
+        files.push_back(model_path);
+    }
+    if (files.empty()) return hash_bytes(model_path.data(), model_path.size(), 0);
+
+    uint64_t h = 0;
+    std::string sample;
+    for (const auto& file : files) {
+        const std::string name = file.filename().string();
+        const uint64_t size = fs::file_size(file, ec);
+        const int64_t mtime = fs::last_write_time(file, ec).time_since_epoch().count();
+        h = hash_bytes(name.data(), name.size(), h);
+        h = hash_bytes(&size, sizeof(size), h);
+        h = hash_bytes(&mtime, sizeof(mtime), h);
+
+        std::ifstream in(file, std::ios::binary);
+        const size_t head = static_cast<size_t>(std::min<uint64_t>(size, kFingerprintSampleBytes));
+        sample.resize(head);
+        in.read(sample.data(), static_cast<std::streamsize>(head));
+        if (size > head) {
+            const size_t tail = static_cast<size_t>(std::min<uint64_t>(size - head, kFingerprintSampleBytes));
+            sample.resize(head + tail);
+            in.seekg(static_cast<std::streamoff>(size - tail));
+            in.read(sample.data() + head, static_cast<std::streamsize>(tail));
+        }
+        if (!in) sample.clear();  // 读取失败时只用名称、大小与修改时间
+        h = hash_bytes(sample.data(), sample.size(), h);
+    }
+    return h;
+}
+
+// === 持久层：mmap 文件上的开放寻址哈希表 ===
+// 文件布局：Header | Slot[capacity] | float[capacity][dim]
+class PersistentVectorStore {
+public:
+    PersistentVectorStore(const std::string& path, size_t capacity, uint64_t model_hash)
+        : path_(path), model_hash_(model_hash) {
+        capacity_ = 1;
+        while (capacity_ < capacity) capacity_ <<= 1;
+
+        // 仅当文件头与当前模型、容量一致时复用已有数据，否则在首次写入时重建
+        try {
+            MappedFile existing = MappedFile::open_read_only(path_);
+            if (existing.size() >= sizeof(Header)) {
+                Header header;
+                std::memcpy(&header, existing.data(), sizeof(Header));
+                if (header_matches(header) && existing.size() >= file_size(header.dim)) {
+                    existing.close();
+                    file_ = MappedFile::open_read_write(path_, file_size(header.dim));
+                    dim_ = header.dim;
+                    LOG_INFO << "[EmbeddingCache] Reopened persistent tier " << path_
+                             << " with " << header.count << " vectors";
+                }
+            }
+        } catch (const std::exception&) {
+            // 文件不存在，首次写入时创建
+        }
+    }
+
+    ~PersistentVectorStore() { file_.sync(); }
+
+    bool get(const CacheKey& key, std::vector<float>& out) {
+        std::shared_lock lock(mutex_);
+        if (!file_.valid()) return false;
+
+        size_t index = find_slot(key);
+        const Slot& slot = slots()[index];
+        if (slot.lo == 0) return false;
+
+        const float* vec = vectors() + index * dim_;
+        out.assign(vec, vec + dim_);
+        return true;
+    }
+
+    void put(const CacheKey& key, const std::vector<float>& vec) {
+        std::unique_lock lock(mutex_);
+        if (retired_) return;
+        if (!file_.valid() && !create(vec.size())) return;
+        if (vec.size() != dim_) return;
+
+        Header* header = this->header();
+        if (header->count * 4 >= capacity_ * 3) {
+            if (!full_logged_) {
+                LOG_WARNING << "[EmbeddingCache] Persistent tier " << path_ << " is full, new vectors are not persisted";
+                full_logged_ = true;
+            }
+            return;
+        }
+
+        size_t index = find_slot(key);
+        Slot& slot = slots()[index];
+        if (slot.lo != 0) return;
+
+        // 先写向量再写键，崩溃时不会留下指向半写向量的键
+        std::memcpy(vectors() + index * dim_, vec.data(), dim_ * sizeof(float));
+        slot.hi = key.hi;
+        slot.lo = key.lo;
+        ++header->count;
+    }
+
+    void flush() {
+        std::unique_lock lock(mutex_);
+        file_.sync();
+    }
+
+    // 被新实例替换后只读：新实例可能重新打开同一文件，写入只能来自一个实例
+    void retire() {
+        std::unique_lock lock(mutex_);
+        retired_ = true;
+    }
+
+private:
+    static constexpr char kMagic[8] = {'R', 'E', 'D', 'G', 'E', 'E', 'C', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t dim;
+        uint64_t capacity;
+        uint64_t model_hash;
+        uint64_t count;
+    };
+
+    struct Slot {
+        uint64_t hi;
+        uint64_t lo;
+    };
+
+    std::string path_;
+    uint64_t model_hash_;
+    size_t capacity_;
+    size_t dim_ = 0;
+    MappedFile file_;
+    std::shared_mutex mutex_;
+    bool full_logged_ = false;
+    bool retired_ = false;
+
+    bool header_matches(const Header& header) const {
+        return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+               header.capacity == capacity_ && header.model_hash == model_hash_ && header.dim > 0;
+    }
+
+    size_t file_size(size_t dim) const {
+        return sizeof(Header) + capacity_ * sizeof(Slot) + capacity_ * dim * sizeof(float);
+    }
+
+    // 在临时文件上建表后改名替换：替换前的实例可能仍映射着旧文件，新表不能在同一 inode 上原地清空
+    bool create(size_t dim) {
+        namespace fs = std::filesystem;
+        const std::string temp_path = path_ + ".tmp";
+        std::error_code ec;
+        fs::remove(temp_path, ec);
+        MappedFile file;
+        try {
+            file = MappedFile::open_read_write(temp_path, file_size(dim));
+        } catch (const std::exception& e) {
+            LOG_ERROR << "[EmbeddingCache] Failed to create persistent tier: " << e.what();
+            return false;
+        }
+        fs::rename(temp_path, path_, ec);
+        if (ec) {
+            LOG_ERROR << "[EmbeddingCache] Failed to create persistent tier " << path_ << ": " << ec.message();
+            file.close();
+            fs::remove(temp_path, ec);
+            return false;
+        }
+        file_ = std::move(file);
+        dim_ = dim;
+        std::memset(file_.data(), 0, sizeof(Header) + capacity_ * sizeof(Slot));
+
+        Header* header = this->header();
+        std::memcpy(header->magic, kMagic, sizeof(kMagic));
+        header->version = kVersion;
+        header->dim = static_cast<uint32_t>(dim);
+        header->capacity = capacity_;
+        header->model_hash = model_hash_;
+        header->count = 0;
+        LOG_INFO << "[EmbeddingCache] Created persistent tier " << path_ << ", capacity " << capacity_;
+        return true;
+    }
+
+    Header* header() const { return static_cast<Header*>(file_.data()); }
+    Slot* slots() const { return reinterpret_cast<Slot*>(static_cast<char*>(file_.data()) + sizeof(Header)); }
+    float* vectors() const { return reinterpret_cast<float*>(slots() + capacity_); }
+
+    // 线性探测，返回键所在槽位或第一个空槽位（装载率不超过 3/4，必然存在空槽）
+    size_t find_slot(const CacheKey& key) const {
+        const Slot* table = slots();
+        size_t index = key.hi & (capacity_ - 1);
+        while (table[index].lo != 0 && !(table[index].hi == key.hi && table[index].lo == key.lo)) {
+            index = (index + 1) & (capacity_ - 1);
+        }
+        return index;
+    }
+};
+
+// === CachedEmbedding ===
+
+CachedEmbedding::CachedEmbedding(std::unique_ptr<TextEmbedding> inner, EmbeddingCacheOptions options)
+    : inner_(std::move(inner)), options_(std::move(options)) {
+    if (!inner_) {
+        throw std::invalid_argument("CachedEmbedding requires a non-null inner embedding.");
+    }
+
+    size_t num_shards = std::max<size_t>(options_.num_shards, 1);
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    shard_budget_ = options_.max_bytes / num_shards;
+
+    if (!options_.model_id.empty()) {
+        set_model_identity(options_.model_id);
+    }
+}
+
+CachedEmbedding::~CachedEmbedding() = default;
+
+bool CachedEmbedding::load_model(const std::string& model_path) {
+    // 下层热加载期间旧模型仍在服务，此时算出的向量无法确定属于哪个模型，暂停写入缓存
+    load_generation_.fetch_add(1, std::memory_order_acq_rel);
+    bool loaded = false;
+    try {
+        loaded = inner_->load_model(model_path);
+        // 只在加载成功后切换标识：失败时旧模型继续服务，其向量仍对应旧标识
+        if (loaded && options_.model_id.empty()) {
+            set_model_identity(model_fingerprint(model_path));
+        }
+    } catch (...) {
+        load_generation_.fetch_add(1, std::memory_order_acq_rel);
+        throw;
+    }
+    load_generation_.fetch_add(1, std::memory_order_acq_rel);
+    return loaded;
+}
+
+void CachedEmbedding::unload_model() {
+    inner_->unload_model();
+}
+
+std::vector<float> CachedEmbedding::embed(const std::string& text) {
+    const uint64_t generation = load_generation_.load(std::memory_order_acquire);
+    CacheKey key = make_cache_key(model_hash_.load(std::memory_order_relaxed), text);
+
+    std::vector<float> vec;
+    if (lookup(key, vec)) {
+        return vec;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    vec = inner_->embed(text);
+    if (can_insert(generation)) insert(key, vec);
+    return vec;
+}
+
+std::vector<std::vector<float>> CachedEmbedding::embed_batch(const std::vector<std::string>& texts) {
+    const uint64_t generation = load_generation_.load(std::memory_order_acquire);
+    const uint64_t model_hash = model_hash_.load(std::memory_order_relaxed);
+    std::vector<std::vector<float>> results(texts.size());
+
+    // 未命中的文本去重后一次性交给下层批量计算
+    std::vector<std::string> miss_texts;
+    std::vector<CacheKey> miss_keys;
+    std::unordered_map<CacheKey, size_t, CacheKeyHash> miss_slot;
+    std::vector<size_t> result_to_miss(texts.size(), SIZE_MAX);
+
+    for (size_t i = 0; i < texts.size(); ++i) {
+        CacheKey key = make_cache_key(model_hash, texts[i]);
+        if (lookup(key, results[i])) continue;
+
+        auto [it, inserted] = miss_slot.emplace(key, miss_texts.size());
+        if (inserted) {
+            miss_texts.push_back(texts[i]);
+            miss_keys.push_back(key);
+        }
+        result_to_miss[i] = it->second;
+    }
+
+    if (miss_texts.empty()) {
+        return results;
+    }
+
+    misses_.fetch_add(miss_texts.size(), std::memory_order_relaxed);
+    auto computed = inner_->embed_batch(miss_texts);
+    if (computed.size() != miss_texts.size()) {
+        throw std::runtime_error("Inner embedding returned a mismatched number of vectors.");
+    }
+
+    if (can_insert(generation)) {
+        for (size_t m = 0; m < computed.size(); ++m) {
+            insert(miss_keys[m], computed[m]);
+        }
+    }
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (result_to_miss[i] != SIZE_MAX) results[i] = computed[result_to_miss[i]];
+    }
+    return results;
+}
+
+EmbeddingCacheStats CachedEmbedding::stats() const {
+    EmbeddingCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.persistent_hits = persistent_hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->index.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+void CachedEmbedding::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
+
+void CachedEmbedding::flush() {
+    if (auto store = persistent_store()) store->flush();
+}
+
+void CachedEmbedding::set_model_identity(const std::string& identity) {
+    set_model_identity(hash_bytes(identity.data(), identity.size(), 0));
+}
+
+void CachedEmbedding::set_model_identity(uint64_t model_hash) {
+    const uint64_t previous = model_hash_.exchange(model_hash, std::memory_order_relaxed);
+
+    if (options_.persistent_path.empty()) return;
+    // 模型未变时沿用现有实例，不让两个实例同时映射并写入同一文件
+    if (previous == model_hash && std::atomic_load(&persistent_)) return;
+
+    auto store = std::make_shared<PersistentVectorStore>(options_.persistent_path,
+                                                         options_.persistent_capacity, model_hash);
+    if (auto retired = std::atomic_exchange(&persistent_, std::move(store))) retired->retire();
+}
+
+std::shared_ptr<PersistentVectorStore> CachedEmbedding::persistent_store() const {
+    return std::atomic_load(&persistent_);
+}
+
+CachedEmbedding::Shard& CachedEmbedding::shard_for(const CacheKey& key) {
+    return *shards_[key.lo % shards_.size()];
+}
+
+bool CachedEmbedding::lookup(const CacheKey& key, std::vector<float>& out) {
+    Shard& shard = shard_for(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            out = it->second->second;
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    auto store = persistent_store();
+    if (store && store->get(key, out)) {
+        persistent_hits_.fetch_add(1, std::memory_order_relaxed);
+        insert_memory(key, out);
+        return true;
+    }
+    return false;
+}
+
+void CachedEmbedding::insert_memory(const CacheKey& key, const std::vector<float>& vec) {
+    const size_t bytes = entry_bytes(vec);
+    if (bytes > shard_budget_) return;
+
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.count(key)) return;
+
+    while (shard.bytes + bytes > shard_budget_ && !shard.lru.empty()) {
+        auto& victim = shard.lru.back();
+        shard.bytes -= entry_bytes(victim.second);
+        shard.index.erase(victim.first);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    shard.lru.emplace_front(key, vec);
+    shard.index.emplace(key, shard.lru.begin());
+    shard.bytes += bytes;
+}
+
+void CachedEmbedding::insert(const CacheKey& key, const std::vector<float>& vec) {
+    insert_memory(key, vec);
+    if (auto store = persistent_store()) store->put(key, vec);
+}
+
+bool CachedEmbedding::can_insert(uint64_t generation) const {
+    return generation % 2 == 0 && load_generation_.load(std::memory_order_acquire) == generation;
+}
+
+} // namespace text_embedding
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "text_embedding.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace text_embedding {
+
+// 128 位缓存键：模型标识 + 文本哈希
+struct CacheKey {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool operator==(const CacheKey& other) const { return hi == other.hi && lo == other.lo; }
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const { return static_cast<size_t>(key.hi ^ (key.lo >> 1)); }
+};
+
+// 按 8 字节分块的快速非加密哈希
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed);
+
+CacheKey make_cache_key(uint64_t model_hash, const std::string& text);
+
+// 模型内容指纹：目录下各文件（或单个文件）的名称、大小、修改时间及首尾各 64 KiB 内容，
+// 同一路径上替换模型后指纹随之改变。路径不存在时（非文件型后端）退回路径字符串本身
+uint64_t model_fingerprint(const std::string& model_path);
+
+struct EmbeddingCacheOptions {
+    // 模型标识，参与缓存键计算；为空时使用 load_model 成功后模型文件的 model_fingerprint
+    std::string model_id;
+    // 内存层分片数，每个分片独立加锁
+    size_t num_shards = 16;
+    // 内存层总字节预算（向量数据 + 估算的元数据开销）
+    size_t max_bytes = 256ull << 20;
+    // 持久层 mmap 文件路径，为空则不启用
+    std::string persistent_path;
+    // 持久层最多保存的向量条数（向上取整到 2 的幂）
+    size_t persistent_capacity = 1 << 20;
+};
+
+struct EmbeddingCacheStats {
+    uint64_t hits = 0;             // 内存层命中
+    uint64_t persistent_hits = 0;  // 内存层未命中、持久层命中
+    uint64_t misses = 0;           // 需要调用模型计算
+    uint64_t evictions = 0;        // 内存层淘汰条数
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+class PersistentVectorStore;
+
+// 向量缓存装饰器：分片 LRU 内存层 + 可选的 mmap 持久层（写穿），重启后持久层仍可命中
+class CachedEmbedding : public TextEmbedding {
+public:
+    explicit CachedEmbedding(std::unique_ptr<TextEmbedding> inner, EmbeddingCacheOptions options = {});
+    ~CachedEmbedding() override;
+
+    bool load_model(const std::string& model_path) override;
+    void unload_model() override;
+    std::vector<float> embed(const std::string& text) override;
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override;
+
+    EmbeddingCacheStats stats() const;
+
+    // 清空内存层（持久层保留）
+    void clear();
+
+    // 将持久层脏页刷回磁盘
+    void flush();
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::list<std::pair<CacheKey, std::vector<float>>> lru;
+        std::unordered_map<CacheKey, std::list<std::pair<CacheKey, std::vector<float>>>::iterator,
+                           CacheKeyHash> index;
+        size_t bytes = 0;
+    };
+
+    std::unique_ptr<TextEmbedding> inner_;
+    EmbeddingCacheOptions options_;
+    std::atomic<uint64_t> model_hash_{0};
+    // 加载期间为奇数；请求开始后若发生变化，其计算结果可能来自另一模型，不写入缓存
+    std::atomic<uint64_t> load_generation_{0};
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shard_budget_;
+    // 与模型版本相同的 RCU：更换模型时原子替换，读者持有的旧实例在请求结束后才析构
+    std::shared_ptr<PersistentVectorStore> persistent_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> persistent_hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    void set_model_identity(const std::string& identity);
+    void set_model_identity(uint64_t model_hash);
+    std::shared_ptr<PersistentVectorStore> persistent_store() const;
+    Shard& shard_for(const CacheKey& key);
+    bool lookup(const CacheKey& key, std::vector<float>& out);
+    void insert_memory(const CacheKey& key, const std::vector<float>& vec);
+    void insert(const CacheKey& key, const std::vector<float>& vec);
+    bool can_insert(uint64_t generation) const;
+};
+
+} // namespace text_embedding
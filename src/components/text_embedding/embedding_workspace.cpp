@@ -0,0 +1,31 @@
+#include "embedding_workspace.h"
+
+#include <algorithm>
+
+namespace text_embedding {
+
+EmbeddingWorkspace& thread_workspace() {
+    thread_local EmbeddingWorkspace workspace;
+    return workspace;
+}
+
+size_t fill_single_input(const std::vector<int32_t>& token_ids,
+                         std::optional<int32_t> bos_token_id,
+                         std::optional<int32_t> eos_token_id,
+                         EmbeddingWorkspace& workspace) {
+    size_t seq_len = token_ids.size() + (bos_token_id ? 1 : 0) + (eos_token_id ? 1 : 0);
+
+    // resize 在容量足够时不会重新分配
+    workspace.input_ids.resize(seq_len);
+    workspace.attention_mask.resize(seq_len);
+
+    size_t pos = 0;
+    if (bos_token_id) workspace.input_ids[pos++] = bos_token_id.value();
+    for (int32_t id : token_ids) workspace.input_ids[pos++] = id;
+    if (eos_token_id) workspace.input_ids[pos++] = eos_token_id.value();
+
+    std::fill(workspace.attention_mask.begin(), workspace.attention_mask.end(), 1);
+    return seq_len;
+}
+
+} // namespace text_embedding
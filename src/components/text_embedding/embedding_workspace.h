@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace text_embedding {
+
+// 单线程独占、跨请求复用的推理缓冲区。
+// 容量只增不减，处理过最长输入后稳态请求不再触发堆分配。
+struct EmbeddingWorkspace {
+    std::vector<int64_t> input_ids;
+    std::vector<int64_t> attention_mask;
+    std::vector<float> hidden_states;
+};
+
+// 当前线程的工作区
+EmbeddingWorkspace& thread_workspace();
+
+// 将 token 序列（补上 BOS/EOS）写入工作区的 input_ids/attention_mask，返回序列长度
+size_t fill_single_input(const std::vector<int32_t>& token_ids,
+                         std::optional<int32_t> bos_token_id,
+                         std::optional<int32_t> eos_token_id,
+                         EmbeddingWorkspace& workspace);
+
+} // namespace text_embedding
@@ -0,0 +1,56 @@
+#include "length_bucketing.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace text_embedding {
+
+namespace {
+
+// 返回长度所属桶的序号，超过所有上界时返回 bounds.size()
+size_t bucket_index(size_t length, const std::vector<size_t>& bounds) {
+    return std::lower_bound(bounds.begin(), bounds.end(), length) - bounds.begin();
+}
+
+} // namespace
+
+std::vector<std::vector<size_t>> plan_length_buckets(const std::vector<size_t>& lengths,
+                                                     const BucketingOptions& options) {
+    std::vector<size_t> order(lengths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&lengths](size_t a, size_t b) {
+        return lengths[a] < lengths[b];
+    });
+
+    std::vector<size_t> bounds = options.bucket_bounds;
+    std::sort(bounds.begin(), bounds.end());
+    const size_t max_batch_size = std::max<size_t>(options.max_batch_size, 1);
+
+    std::vector<std::vector<size_t>> batches;
+    size_t current_bucket = 0;
+    for (size_t index : order) {
+        size_t bucket = bucket_index(lengths[index], bounds);
+        if (batches.empty() || bucket != current_bucket || batches.back().size() >= max_batch_size) {
+            batches.emplace_back();
+            current_bucket = bucket;
+        }
+        batches.back().push_back(index);
+    }
+    return batches;
+}
+
+PaddingStats compute_padding_stats(const std::vector<size_t>& lengths,
+                                   const std::vector<std::vector<size_t>>& batches) {
+    PaddingStats stats;
+    for (const auto& batch : batches) {
+        size_t max_len = 0;
+        for (size_t index : batch) {
+            stats.useful_tokens += lengths[index];
+            max_len = std::max(max_len, lengths[index]);
+        }
+        stats.computed_tokens += static_cast<uint64_t>(max_len) * batch.size();
+    }
+    return stats;
+}
+
+} // namespace text_embedding
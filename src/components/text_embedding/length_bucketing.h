@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace text_embedding {
+
+struct BucketingOptions {
+    // 各长度桶的上界（token 数，升序）；超过最后一个上界的序列归入溢出桶
+    std::vector<size_t> bucket_bounds = {16, 32, 64, 128, 256, 512};
+    // 单次推理的最大条数
+    size_t max_batch_size = 32;
+};
+
+// 补齐效率统计：有效 token 数 / 实际参与计算的 token 数
+struct PaddingStats {
+    uint64_t useful_tokens = 0;
+    uint64_t computed_tokens = 0;
+
+    double efficiency() const {
+        return computed_tokens == 0 ? 1.0 : static_cast<double>(useful_tokens) / computed_tokens;
+    }
+};
+
+// 按 token 长度排序并在长度桶内切分子批次，返回每个子批次对应的原始下标
+std::vector<std::vector<size_t>> plan_length_buckets(const std::vector<size_t>& lengths,
+                                                     const BucketingOptions& options);
+
+// 统计按给定划分补齐后的计算量
+PaddingStats compute_padding_stats(const std::vector<size_t>& lengths,
+                                   const std::vector<std::vector<size_t>>& batches);
+
+} // namespace text_embedding
@@ -0,0 +1,125 @@
+#include "long_text.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+
+#include "logger.h"
+
+namespace text_embedding {
+
+namespace {
+
+std::optional<std::string> read_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return std::nullopt;
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// 在 JSON 文本中查找首个 "key": <number>，只用于读取配置中的顶层数值字段
+std::optional<double> find_json_number(const std::string& json, const std::string& key) {
+    const std::string quoted = "\"" + key + "\"";
+    size_t pos = json.find(quoted);
+    while (pos != std::string::npos) {
+        size_t cursor = pos + quoted.size();
+        while (cursor < json.size() && std::isspace(static_cast<unsigned char>(json[cursor]))) ++cursor;
+        if (cursor < json.size() && json[cursor] == ':') {
+            ++cursor;
+            while (cursor < json.size() && std::isspace(static_cast<unsigned char>(json[cursor]))) ++cursor;
+            const char* begin = json.c_str() + cursor;
+            char* end = nullptr;
+            double value = std::strtod(begin, &end);
+            if (end != begin) return value;
+            return std::nullopt;  // 值不是数字（如 null）
+        }
+        pos = json.find(quoted, pos + 1);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> find_json_string(const std::string& json, const std::string& key) {
+    const std::string quoted = "\"" + key + "\"";
+    size_t pos = json.find(quoted);
+    if (pos == std::string::npos) return std::nullopt;
+    size_t open = json.find('"', json.find(':', pos + quoted.size()) + 1);
+    if (open == std::string::npos) return std::nullopt;
+    size_t close = json.find('"', open + 1);
+    if (close == std::string::npos) return std::nullopt;
+    return json.substr(open + 1, close - open - 1);
+}
+
+} // namespace
+
+size_t read_model_max_length(const std::string& model_dir) {
+    // HuggingFace 未设置上限时 model_max_length 为 1e30 之类的哨兵值
+    if (auto config = read_file(model_dir + "tokenizer_config.json")) {
+        auto value = find_json_number(*config, "model_max_length");
+        if (value && *value > 0 && *value < 1e6) {
+            return static_cast<size_t>(*value);
+        }
+    }
+
+    if (auto config = read_file(model_dir + "config.json")) {
+        auto value = find_json_number(*config, "max_position_embeddings");
+        if (value && *value > 0 && *value < 1e6) {
+            size_t max_length = static_cast<size_t>(*value);
+            // RoBERTa 系（含 XLM-R / e5）的位置编码从 padding_idx + 1 开始，可用长度少 2
+            auto model_type = find_json_string(*config, "model_type");
+            if (model_type && model_type->find("roberta") != std::string::npos && max_length > 2) {
+                max_length -= 2;
+            }
+            return max_length;
+        }
+    }
+
+    LOG_DEBUG << "No max length found in " << model_dir << ", using default " << kDefaultMaxLength;
+    return kDefaultMaxLength;
+}
+
+std::vector<std::pair<size_t, size_t>> plan_token_windows(size_t num_tokens, size_t window, size_t overlap) {
+    if (window == 0) {
+        throw std::invalid_argument("Window length must be positive");
+    }
+    if (overlap >= window) {
+        throw std::invalid_argument("Window overlap must be smaller than window length");
+    }
+
+    std::vector<std::pair<size_t, size_t>> windows;
+    if (num_tokens == 0) return windows;
+
+    const size_t stride = window - overlap;
+    for (size_t begin = 0;; begin += stride) {
+        size_t end = std::min(begin + window, num_tokens);
+        windows.emplace_back(begin, end);
+        if (end == num_tokens) break;
+    }
+    return windows;
+}
+
+void combine_window_embeddings(const std::vector<std::vector<float>>& windows,
+                               const std::vector<size_t>& weights,
+                               float* out, size_t dim) {
+    if (windows.size() != weights.size()) {
+        throw std::invalid_argument("Window and weight counts differ");
+    }
+
+    std::fill(out, out + dim, 0.0f);
+    size_t total = 0;
+    for (size_t w = 0; w < windows.size(); ++w) {
+        if (windows[w].size() != dim) {
+            throw std::invalid_argument("Window embedding dimension mismatch");
+        }
+        const float weight = static_cast<float>(weights[w]);
+        for (size_t i = 0; i < dim; ++i) out[i] += weight * windows[w][i];
+        total += weights[w];
+    }
+
+    if (total == 0) return;
+    const float inv = 1.0f / static_cast<float>(total);
+    for (size_t i = 0; i < dim; ++i) out[i] *= inv;
+}
+
+} // namespace text_embedding
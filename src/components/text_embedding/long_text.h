@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace text_embedding {
+
+enum class LongTextPolicy {
+    TRUNCATE,        // 超出部分直接截断，只保留开头
+    SLIDING_WINDOW   // 切分为有重叠的窗口，作为一个批次推理后按长度加权合并
+};
+
+struct LongTextOptions {
+    LongTextPolicy policy = LongTextPolicy::TRUNCATE;
+    // 含特殊 token 的最大序列长度；0 表示从模型目录的配置文件读取
+    size_t max_length = 0;
+    // 相邻窗口重叠的 token 数（不含特殊 token），须小于窗口长度
+    size_t window_overlap = 64;
+};
+
+// 未能从配置中读到时使用的最大长度（BERT 系模型的位置编码上限）
+constexpr size_t kDefaultMaxLength = 512;
+
+// 依次从 tokenizer_config.json 的 model_max_length、config.json 的 max_position_embeddings
+// 读取模型可接受的最大序列长度，均缺失时返回 kDefaultMaxLength
+size_t read_model_max_length(const std::string& model_dir);
+
+// 把 num_tokens 个 token 切分为长度不超过 window、相邻重叠 overlap 的区间 [begin, end)
+std::vector<std::pair<size_t, size_t>> plan_token_windows(size_t num_tokens, size_t window, size_t overlap);
+
+// 按窗口 token 数加权平均各窗口向量，写入 out[dim]
+void combine_window_embeddings(const std::vector<std::vector<float>>& windows,
+                               const std::vector<size_t>& weights,
+                               float* out, size_t dim);
+
+} // namespace text_embedding
@@ -0,0 +1,107 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error mapping_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+namespace text_embedding {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile MappedFile::open_read_only(const std::string& path) {
+    return open_private(path, PROT_READ);
+}
+
+MappedFile MappedFile::open_copy_on_write(const std::string& path) {
+    return open_private(path, PROT_READ | PROT_WRITE);
+}
+
+MappedFile MappedFile::open_private(const std::string& path, int protection) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw mapping_error("Unable to open", path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw mapping_error("Unable to stat", path);
+    }
+
+    MappedFile file;
+    file.size_ = static_cast<size_t>(st.st_size);
+    if (file.size_ > 0) {
+        void* data = ::mmap(nullptr, file.size_, protection, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw mapping_error("Unable to mmap", path);
+        }
+        file.data_ = data;
+    }
+    ::close(fd);
+    return file;
+}
+
+MappedFile MappedFile::open_read_write(const std::string& path, size_t size) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) throw mapping_error("Unable to open", path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw mapping_error("Unable to stat", path);
+    }
+    if (static_cast<size_t>(st.st_size) < size && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        throw mapping_error("Unable to resize", path);
+    }
+
+    MappedFile file;
+    file.size_ = std::max(size, static_cast<size_t>(st.st_size));
+    void* data = ::mmap(nullptr, file.size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw mapping_error("Unable to mmap", path);
+    file.data_ = data;
+    return file;
+}
+
+void MappedFile::sync() {
+    if (data_) ::msync(data_, size_, MS_SYNC);
+}
+
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+} // namespace text_embedding
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace text_embedding {
+
+// 基于 mmap 的文件映射（RAII）
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 只读映射整个文件，失败时抛出 std::runtime_error
+    static MappedFile open_read_only(const std::string& path);
+
+    // 写时复制的私有映射：可原地修改，修改不会写回文件
+    static MappedFile open_copy_on_write(const std::string& path);
+
+    // 读写共享映射，文件不存在则创建，小于 size 时扩展到 size
+    static MappedFile open_read_write(const std::string& path, size_t size);
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool valid() const { return data_ != nullptr; }
+
+    // 将脏页刷回磁盘
+    void sync();
+    void close();
+
+private:
+    static MappedFile open_private(const std::string& path, int protection);
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace text_embedding
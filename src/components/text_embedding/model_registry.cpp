@@ -0,0 +1,267 @@
+#include "model_registry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <utility>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "logger.h"
+#include "process_stats.h"
+
+namespace text_embedding {
+
+namespace {
+
+constexpr double kMiB = 1024.0 * 1024.0;
+
+std::shared_ptr<TextEmbedding> load_onnx_model(const ModelSpec& spec, const ModelRegistryOptions& options) {
+    OnnxEmbeddingOptions model_options = spec.options;
+    if (options.share_thread_pool) {
+        model_options.session.use_global_thread_pool = true;
+        model_options.session.global_thread_pool = options.thread_pool;
+    }
+    if (options.share_allocator) {
+        model_options.session.use_env_allocator = true;
+    }
+    auto model = std::make_shared<OnnxRuntimeEmbedding>(std::move(model_options));
+    if (!model->load_model(spec.model_path)) return nullptr;
+    return model;
+}
+
+// 模型文件大小，作为常驻内存的下限估计
+size_t model_file_bytes(const ModelSpec& spec) {
+    ModelPrecision precision = spec.options.precision;
+    const std::string model_file = resolve_model_file(spec.model_path, precision);
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(model_file, ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+} // namespace
+
+ModelRegistry::ModelRegistry(ModelRegistryOptions options, ModelLoader loader)
+    : options_(std::move(options)), loader_(std::move(loader)) {
+    if (loader_) return;
+
+    // 共享 Env 在首次创建时决定是否带全局线程池，须先于任何模型加载
+    if (options_.share_thread_pool) shared_ort_env(&options_.thread_pool);
+    if (options_.share_allocator) register_shared_cpu_allocator();
+    loader_ = [this](const ModelSpec& spec) { return load_onnx_model(spec, options_); };
+}
+
+ModelRegistry::~ModelRegistry() {
+    unload_all();
+}
+
+bool ModelRegistry::register_model(const std::string& name, ModelSpec spec) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.count(name)) {
+        LOG_WARNING << "[ModelRegistry] Model " << name << " is already registered";
+        return false;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->name = name;
+    entry->spec = std::move(spec);
+    entry->lru_pos = lru_.end();
+    entries_.emplace(name, std::move(entry));
+    return true;
+}
+
+std::shared_ptr<TextEmbedding> ModelRegistry::acquire(const std::string& name) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        LOG_ERROR << "[ModelRegistry] Unknown model: " << name;
+        return nullptr;
+    }
+    Entry& entry = *it->second;
+
+    if (entry.model) {
+        lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+        return entry.model;
+    }
+    if (entry.loading.valid()) {
+        auto pending = entry.loading;
+        lock.unlock();
+        return pending.get();
+    }
+
+    std::promise<std::shared_ptr<TextEmbedding>> promise;
+    entry.loading = promise.get_future().share();
+    lock.unlock();
+
+    std::shared_ptr<TextEmbedding> model;
+    try {
+        model = load(entry);
+    } catch (...) {
+        // load 之外抛出的异常（如内存不足）也要结束本次加载：等待者收到同一异常，之后可以重试
+        {
+            std::lock_guard<std::mutex> relock(mutex_);
+            entry.loading = {};
+            ++stats_.load_failures;
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    promise.set_value(model);
+    return model;
+}
+
+std::shared_ptr<TextEmbedding> ModelRegistry::load(Entry& entry) {
+    std::lock_guard<std::mutex> load_lock(load_mutex_);
+    std::vector<std::shared_ptr<TextEmbedding>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        make_room_locked(estimate_bytes(entry), &entry, released);
+    }
+    release(released);
+
+    const size_t rss_before = metrics::current_rss_bytes();
+    const auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<TextEmbedding> model;
+    try {
+        model = loader_(entry.spec);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[ModelRegistry] Failed to load model " << entry.name << ": " << e.what();
+    } catch (...) {
+        LOG_ERROR << "[ModelRegistry] Failed to load model " << entry.name << ": unknown exception";
+    }
+    const double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t rss_after = metrics::current_rss_bytes();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry.loading = {};
+        if (!model) {
+            ++stats_.load_failures;
+            LOG_ERROR << "[ModelRegistry] Model " << entry.name << " failed to load from " << entry.spec.model_path;
+            return nullptr;
+        }
+
+        // 淘汰后重新加载时可能复用已释放的堆内存，RSS 增量偏小，因此以模型文件大小兜底
+        size_t bytes = entry.spec.memory_bytes;
+        if (bytes == 0) {
+            const size_t measured = rss_after > rss_before ? rss_after - rss_before : 0;
+            bytes = std::max(measured, model_file_bytes(entry.spec));
+        }
+        entry.model = model;
+        entry.memory_bytes = bytes;
+        entry.last_load_ms = load_ms;
+        ++entry.loads;
+        lru_.push_front(&entry);
+        entry.lru_pos = lru_.begin();
+        stats_.resident_bytes += bytes;
+        ++stats_.loaded_models;
+        ++stats_.loads;
+        LOG_INFO << "[ModelRegistry] Loaded " << entry.name << " in " << load_ms << " ms, resident "
+                 << bytes / kMiB << " MiB, total " << stats_.resident_bytes / kMiB << " MiB";
+
+        // 实测值可能大于预估，加载后再检查一次预算
+        make_room_locked(0, &entry, released);
+    }
+    release(released);
+    return model;
+}
+
+size_t ModelRegistry::estimate_bytes(const Entry& entry) const {
+    if (entry.spec.memory_bytes > 0) return entry.spec.memory_bytes;
+    if (entry.memory_bytes > 0) return entry.memory_bytes;
+    return model_file_bytes(entry.spec);
+}
+
+void ModelRegistry::make_room_locked(size_t incoming_bytes, const Entry* keep,
+                                     std::vector<std::shared_ptr<TextEmbedding>>& released) {
+    const size_t budget = options_.memory_budget_bytes;
+    if (budget == 0) return;
+
+    auto it = lru_.end();
+    while (stats_.resident_bytes + incoming_bytes > budget && it != lru_.begin()) {
+        --it;
+        Entry* candidate = *it;
+        // 仍被调用方持有的模型淘汰后内存也不会释放，跳过
+        if (candidate == keep || candidate->model.use_count() > 1) continue;
+        LOG_INFO << "[ModelRegistry] Evicting " << candidate->name << " ("
+                 << candidate->memory_bytes / kMiB << " MiB) to stay within "
+                 << budget / kMiB << " MiB budget";
+        ++stats_.evictions;
+        it = lru_.erase(it);
+        candidate->lru_pos = lru_.end();
+        stats_.resident_bytes -= candidate->memory_bytes;
+        --stats_.loaded_models;
+        released.push_back(std::move(candidate->model));
+    }
+    if (stats_.resident_bytes + incoming_bytes > budget) {
+        LOG_WARNING << "[ModelRegistry] Memory budget " << budget / kMiB << " MiB exceeded: resident "
+                    << stats_.resident_bytes / kMiB << " MiB, incoming " << incoming_bytes / kMiB
+                    << " MiB, no idle model left to evict";
+    }
+}
+
+void ModelRegistry::remove_locked(Entry& entry, std::vector<std::shared_ptr<TextEmbedding>>& released) {
+    if (!entry.model) return;
+    lru_.erase(entry.lru_pos);
+    entry.lru_pos = lru_.end();
+    stats_.resident_bytes -= entry.memory_bytes;
+    --stats_.loaded_models;
+    released.push_back(std::move(entry.model));
+}
+
+void ModelRegistry::release(std::vector<std::shared_ptr<TextEmbedding>>& released) {
+    if (released.empty()) return;
+    released.clear();
+#if defined(__GLIBC__)
+    // glibc 不会主动把空闲的大块堆内存还给系统，淘汰后立即归还才能真正降低 RSS
+    malloc_trim(0);
+#endif
+}
+
+void ModelRegistry::unload(const std::string& name) {
+    std::vector<std::shared_ptr<TextEmbedding>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(name);
+        if (it == entries_.end()) return;
+        remove_locked(*it->second, released);
+    }
+    release(released);
+}
+
+void ModelRegistry::unload_all() {
+    std::vector<std::shared_ptr<TextEmbedding>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [name, entry] : entries_) remove_locked(*entry, released);
+    }
+    release(released);
+}
+
+std::vector<RegisteredModelInfo> ModelRegistry::models() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<RegisteredModelInfo> infos;
+    infos.reserve(entries_.size());
+    for (const auto& [name, entry] : entries_) {
+        RegisteredModelInfo info;
+        info.name = name;
+        info.model_path = entry->spec.model_path;
+        info.loaded = entry->model != nullptr;
+        info.memory_bytes = entry->memory_bytes;
+        info.loads = entry->loads;
+        info.last_load_ms = entry->last_load_ms;
+        infos.push_back(std::move(info));
+    }
+    std::sort(infos.begin(), infos.end(),
+              [](const RegisteredModelInfo& a, const RegisteredModelInfo& b) { return a.name < b.name; });
+    return infos;
+}
+
+ModelRegistryStats ModelRegistry::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace text_embedding
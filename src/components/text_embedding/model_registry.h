@@ -0,0 +1,118 @@
+#pragma once
+
+#include "onnx_embedding.h"
+#include "ort_runtime.h"
+#include "text_embedding.h"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace text_embedding {
+
+struct ModelSpec {
+    // 模型目录（以 / 结尾，与 load_model 一致）
+    std::string model_path;
+    OnnxEmbeddingOptions options;
+    // 常驻内存的预估值；0 表示加载时按 RSS 增量测量，且不低于模型文件大小
+    size_t memory_bytes = 0;
+};
+
+struct ModelRegistryOptions {
+    // 已加载模型常驻内存之和的上限，0 表示不限制
+    size_t memory_budget_bytes = 0;
+    // 所有模型的 Session 共用进程级全局线程池
+    bool share_thread_pool = true;
+    GlobalThreadPoolOptions thread_pool;
+    // 所有模型的 Session 共用共享 Env 上注册的 CPU arena 分配器
+    bool share_allocator = true;
+};
+
+struct RegisteredModelInfo {
+    std::string name;
+    std::string model_path;
+    bool loaded = false;
+    // 最近一次加载时记录的常驻内存（配置值或测量值）
+    size_t memory_bytes = 0;
+    uint64_t loads = 0;  // 含淘汰后重新加载
+    double last_load_ms = 0.0;
+};
+
+struct ModelRegistryStats {
+    size_t resident_bytes = 0;
+    size_t loaded_models = 0;
+    uint64_t loads = 0;
+    uint64_t load_failures = 0;
+    uint64_t evictions = 0;
+};
+
+// 按名称管理多个向量化模型：首次使用时加载，共享 ORT 线程池与分配器，
+// 超出内存预算时按最近最少使用淘汰。同一模型的并发首次请求只触发一次加载。
+// 淘汰只释放注册表持有的引用，调用方仍持有的模型在最后一个引用释放后回收。
+class ModelRegistry {
+public:
+    // 构造已加载的模型，失败返回 nullptr；默认创建 OnnxRuntimeEmbedding
+    using ModelLoader = std::function<std::shared_ptr<TextEmbedding>(const ModelSpec& spec)>;
+
+    explicit ModelRegistry(ModelRegistryOptions options = {}, ModelLoader loader = nullptr);
+    ~ModelRegistry();
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    // 名称已存在时返回 false
+    bool register_model(const std::string& name, ModelSpec spec);
+
+    // 返回已加载的模型，必要时先加载（可能先淘汰其他模型）；未注册或加载失败返回 nullptr。
+    // 加载器之外的异常（如内存不足）会抛给本次与同时等待的调用方，之后仍可重试
+    std::shared_ptr<TextEmbedding> acquire(const std::string& name);
+
+    // 释放注册表持有的引用，模型仍保持注册
+    void unload(const std::string& name);
+    void unload_all();
+
+    std::vector<RegisteredModelInfo> models() const;
+    ModelRegistryStats stats() const;
+
+private:
+    struct Entry {
+        std::string name;
+        ModelSpec spec;  // 注册后不再修改
+        std::shared_ptr<TextEmbedding> model;
+        // 加载进行中时有效，同名的后续请求等待它
+        std::shared_future<std::shared_ptr<TextEmbedding>> loading;
+        size_t memory_bytes = 0;
+        uint64_t loads = 0;
+        double last_load_ms = 0.0;
+        std::list<Entry*>::iterator lru_pos;
+    };
+
+    ModelRegistryOptions options_;
+    ModelLoader loader_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+    // 已加载模型，表头为最近使用
+    std::list<Entry*> lru_;
+    ModelRegistryStats stats_;
+
+    // 串行化实际加载，使 RSS 增量只归属于一个模型
+    std::mutex load_mutex_;
+
+    std::shared_ptr<TextEmbedding> load(Entry& entry);
+    size_t estimate_bytes(const Entry& entry) const;
+    // 淘汰最久未使用且没有外部引用的模型，直到能容纳 incoming_bytes；被淘汰的模型移入 released
+    void make_room_locked(size_t incoming_bytes, const Entry* keep,
+                          std::vector<std::shared_ptr<TextEmbedding>>& released);
+    void remove_locked(Entry& entry, std::vector<std::shared_ptr<TextEmbedding>>& released);
+    // 在锁外析构被淘汰的模型并把空闲堆内存归还系统
+    static void release(std::vector<std::shared_ptr<TextEmbedding>>& released);
+};
+
+} // namespace text_embedding
@@ -1,5 +1,6 @@
 #include "onnx_embedding.h"
 
+#include <chrono>
 #include <iostream>
 #include <numeric>
 #include <algorithm>
@@ -7,10 +8,13 @@
 #include <vector>
 #include <stdexcept>
 #include <filesystem>
+#include <iterator>
 #include <fstream>
 #include <sstream>
 
+#include "embedding_workspace.h"
 #include "logger.h"
+#include "vector_math.h"
 
 namespace {
 
@@ -37,42 +41,105 @@ void print_model_io_info(Ort::Session& session) {
     }
 }
 
+const char* model_file_name(text_embedding::ModelPrecision precision) {
+    switch (precision) {
+        case text_embedding::ModelPrecision::FP16: return "model_fp16.onnx";
+        case text_embedding::ModelPrecision::INT8: return "model_int8.onnx";
+        default: return "model.onnx";
+    }
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
 template <typename T>
 std::string to_optional_str(const std::optional<T>& opt) {
     return opt ? std::to_string(*opt) : "n/a";
 }
 
+// 热路径阶段与计数器，下标与 make_stage_metrics 中的名字一一对应
+enum Stage : size_t { kStageTokenize, kStagePrepareInputs, kStageRunModel, kStagePooling };
+enum Counter : size_t { kCounterTexts, kCounterModelRuns, kCounterTokens };
+
+metrics::StageMetrics make_stage_metrics() {
+    return metrics::StageMetrics({"tokenize", "prepare_inputs", "run_model", "pooling"},
+                                 {"texts", "model_runs", "tokens"});
+}
+
+// 预热发生在发布前的加载线程上，期间的埋点与补齐统计都不计入；
+// 旧版本此时仍在其他线程上服务，只跳过本线程的计数
+thread_local bool t_warming_up = false;
+
+struct WarmupScope {
+    WarmupScope() { t_warming_up = true; }
+    ~WarmupScope() { t_warming_up = false; }
+};
+
 } // namespace
 
 namespace text_embedding {
 
-OnnxRuntimeEmbedding::OnnxRuntimeEmbedding()
-    : env_(ORT_LOGGING_LEVEL_WARNING, "TextEmbedding"),
-      session_(nullptr) {}
+const char* precision_name(ModelPrecision precision) {
+    switch (precision) {
+        case ModelPrecision::FP16: return "fp16";
+        case ModelPrecision::INT8: return "int8";
+        default: return "fp32";
+    }
+}
+
+std::string resolve_model_file(const std::string& model_path, ModelPrecision& precision) {
+    // 优先加载请求精度的模型变体，缺失时回退 fp32
+    std::string model_file = model_path + model_file_name(precision);
+    if (precision != ModelPrecision::FP32 && !std::filesystem::exists(model_file)) {
+        LOG_WARNING << "Model variant " << model_file << " not found, falling back to fp32 model.onnx";
+        precision = ModelPrecision::FP32;
+        model_file = model_path + model_file_name(precision);
+    }
+    return model_file;
+}
+
+// 一个已加载模型的全部状态，发布后只读（SessionPool/TokenizerPool 内部自带同步）
+struct OnnxRuntimeEmbedding::ModelVersion {
+    uint64_t version = 0;
+    std::string model_path;
+    ModelPrecision precision = ModelPrecision::FP32;
+    LoadTimings load_timings;
+
+    std::unique_ptr<TokenizerPool> tokenizer;
+    std::optional<int32_t> bos_token_id;
+    std::optional<int32_t> eos_token_id;
+    std::optional<int32_t> pad_token_id;
+    size_t max_length = 0;
+    size_t window_overlap = 0;
+
+    std::unique_ptr<SessionPool> sessions;
+    std::vector<std::string> input_names;
+    std::vector<const char*> input_name_ptrs;
+    std::string output_name;
+    PoolingMode pooling = PoolingMode::AUTO;  // 解析后为 MEAN/CLS/MODEL_OUTPUT 之一
+    size_t dimension = 0;
+};
+
+OnnxRuntimeEmbedding::OnnxRuntimeEmbedding(OnnxEmbeddingOptions options)
+    : options_(std::move(options)),
+      memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+      stage_metrics_(make_stage_metrics()) {}
 
 OnnxRuntimeEmbedding::~OnnxRuntimeEmbedding() {
     unload_model();
 }
 
 bool OnnxRuntimeEmbedding::load_model(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
     try {
-        std::string tokenizer_file = model_path + "tokenizer.json";
-        std::string model_file = model_path + "model.onnx";
-
-        LOG_DEBUG << "Tokenizer file: " << tokenizer_file << ", model file: " << model_file;
-
-        if (tokenizer_file.empty() || model_file.empty()) {
-            throw std::runtime_error("Tokenizer or model file path is empty");
-        }
-        
-        init_tokenizer(tokenizer_file);
-
-        Ort::SessionOptions session_options;
-        session_ = std::make_unique<Ort::Session>(env_, model_file.c_str(), session_options);
-        LOG_DEBUG << "Model loaded successfully: " << model_file;
-
-        // print_model_io_info(*session_);
+        auto model = build_version(model_path);
+        model->version = next_version_++;
 
+        VersionPtr published = std::move(model);
+        VersionPtr previous = std::atomic_exchange(&current_, published);
+        LOG_INFO << "Published model version " << published->version << " from " << model_path
+                 << (previous ? ", replacing version " + std::to_string(previous->version) : std::string());
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Failed to load model: " << e.what();
@@ -80,107 +147,529 @@ bool OnnxRuntimeEmbedding::load_model(const std::string& model_path) {
     }
 }
 
+std::future<bool> OnnxRuntimeEmbedding::reload_model_async(const std::string& model_path) {
+    return std::async(std::launch::async, [this, model_path] { return load_model(model_path); });
+}
+
 void OnnxRuntimeEmbedding::unload_model() {
-    std::shared_lock lock(tokenizer_mutex_);
-    session_.reset();
-    tokenizer_.reset();
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    // 在途请求持有的引用释放后旧版本才真正析构
+    std::atomic_store(&current_, VersionPtr());
 }
 
-std::vector<float> OnnxRuntimeEmbedding::embed(const std::string& text) {
-    std::shared_lock lock(tokenizer_mutex_);
+std::shared_ptr<OnnxRuntimeEmbedding::ModelVersion> OnnxRuntimeEmbedding::build_version(const std::string& model_path) {
+    const auto load_start = std::chrono::steady_clock::now();
+    auto model = std::make_shared<ModelVersion>();
+    model->model_path = model_path;
+
+    std::string tokenizer_file = model_path + "tokenizer.json";
+    ModelPrecision precision = options_.precision;
+    std::string model_file = resolve_model_file(model_path, precision);
+    model->precision = precision;
+
+    LOG_DEBUG << "Tokenizer file: " << tokenizer_file << ", model file: " << model_file;
+
+    auto stage_start = std::chrono::steady_clock::now();
+    init_tokenizer(*model, tokenizer_file);
+    resolve_max_length(*model, model_path);
+    model->load_timings.tokenizer_ms = elapsed_ms(stage_start);
+
+    stage_start = std::chrono::steady_clock::now();
+    const auto& pool_options = options_.session;
+    Ort::Env& env = shared_ort_env(pool_options.use_global_thread_pool ? &pool_options.global_thread_pool : nullptr);
+    model->sessions = std::make_unique<SessionPool>(env, model_file, pool_options);
+    resolve_model_io(*model);
+    model->load_timings.session_ms = elapsed_ms(stage_start);
+    model->load_timings.optimized_cache_hit = model->sessions->loaded_from_cache();
+
+    // 发布前预热，切换版本时不会把惰性分配的开销留给线上请求
+    stage_start = std::chrono::steady_clock::now();
+    warm_up(*model);
+    model->load_timings.warmup_ms = elapsed_ms(stage_start);
+    model->load_timings.total_ms = elapsed_ms(load_start);
+
+    LOG_DEBUG << "Model loaded successfully: " << model_file << " (" << precision_name(precision) << ")"
+              << ", max length: " << model->max_length << ", sessions: " << model->sessions->size()
+              << ", output: " << model->output_name << ", dimension: " << model->dimension
+              << ", load: " << model->load_timings.total_ms << " ms"
+              << (model->load_timings.optimized_cache_hit ? " (optimized cache hit)" : "");
+
+    // print_model_io_info(model->sessions->primary());
+    return model;
+}
 
-    if (!tokenizer_) {
-        throw std::runtime_error("Tokenizer not initialized. Call load_tokenizer_from_json first.");
+metrics::StageMetrics* OnnxRuntimeEmbedding::active_metrics() {
+    return t_warming_up ? nullptr : &stage_metrics_;
+}
+
+OnnxRuntimeEmbedding::VersionPtr OnnxRuntimeEmbedding::acquire_version() const {
+    VersionPtr model = std::atomic_load(&current_);
+    if (!model) {
+        throw std::runtime_error("Model not loaded. Call load_model first.");
     }
+    return model;
+}
+
+std::vector<float> OnnxRuntimeEmbedding::embed(const std::string& text) {
+    return embed_with_version(text).vector;
+}
 
-    auto input_ids = build_input_ids(text);
-    auto attention_mask = std::vector<int64_t>(input_ids.size(), 1);
-    auto input_tensors = prepare_input_tensors(input_ids, attention_mask);
+EmbeddingResult OnnxRuntimeEmbedding::embed_with_version(const std::string& text) {
+    VersionPtr model = acquire_version();
+    EmbeddingResult result;
+    result.model_version = model->version;
 
-    auto output_names_vec = session_->GetOutputNames();
-    if (output_names_vec.empty()) {
-        throw std::runtime_error("Model has no outputs.");
+    // 输出维度为动态时无法预先绑定输出内存，退回批量路径
+    if (model->dimension == 0) {
+        auto results = infer_batch(*model, {text});
+        result.vector = std::move(results.front());
+        return result;
     }
 
-    std::string selected_output = select_output_name(output_names_vec);
+    result.vector.resize(model->dimension);
+    infer_single_into(*model, text, result.vector.data(), result.vector.size());
+    return result;
+}
 
-    if (!selected_output.empty() && selected_output != "last_hidden_state") {
-        LOG_DEBUG << "[Debug] Using output name: " << selected_output;
-        return extract_tensor_data(run_model({selected_output.c_str()}, input_tensors), selected_output);
+uint64_t OnnxRuntimeEmbedding::embed_into(const std::string& text, float* out, size_t dim) {
+    VersionPtr model = acquire_version();
+
+    if (model->dimension == 0 || dim != model->dimension) {
+        throw std::invalid_argument("Output buffer dimension " + std::to_string(dim) +
+                                    " does not match model dimension " + std::to_string(model->dimension));
     }
 
-    LOG_DEBUG << "[Debug] Falling back to mean pooling over 'last_hidden_state'\n";
-    return mean_pooling(run_model({"last_hidden_state"}, input_tensors), attention_mask);
+    infer_single_into(*model, text, out, dim);
+    return model->version;
+}
+
+std::vector<std::vector<float>> OnnxRuntimeEmbedding::embed_batch(const std::vector<std::string>& texts) {
+    return embed_batch_with_version(texts).vectors;
 }
 
-void OnnxRuntimeEmbedding::init_tokenizer(const std::string& json_path) {
-    namespace fs = std::filesystem;
+BatchEmbeddingResult OnnxRuntimeEmbedding::embed_batch_with_version(const std::vector<std::string>& texts) {
+    VersionPtr model = acquire_version();
+    BatchEmbeddingResult result;
+    result.model_version = model->version;
+    result.vectors = infer_batch(*model, texts);
+    return result;
+}
+
+uint64_t OnnxRuntimeEmbedding::model_version() const {
+    VersionPtr model = std::atomic_load(&current_);
+    return model ? model->version : 0;
+}
+
+size_t OnnxRuntimeEmbedding::dimension() const {
+    VersionPtr model = std::atomic_load(&current_);
+    return model ? model->dimension : 0;
+}
 
-    if (!fs::exists(json_path)) {
-        throw std::runtime_error("Tokenizer file does not exist: " + json_path);
+size_t OnnxRuntimeEmbedding::max_length() const {
+    VersionPtr model = std::atomic_load(&current_);
+    return model ? model->max_length : 0;
+}
+
+LoadTimings OnnxRuntimeEmbedding::load_timings() const {
+    VersionPtr model = std::atomic_load(&current_);
+    return model ? model->load_timings : LoadTimings{};
+}
+
+ModelPrecision OnnxRuntimeEmbedding::loaded_precision() const {
+    VersionPtr model = std::atomic_load(&current_);
+    return model ? model->precision : ModelPrecision::FP32;
+}
+
+void OnnxRuntimeEmbedding::infer_single_into(const ModelVersion& model, const std::string& text, float* out, size_t dim) {
+    [[maybe_unused]] metrics::StageMetrics* stage_metrics = active_metrics();
+    STAGE_COUNT(stage_metrics, kCounterTexts, 1);
+
+    // tokenizers-cpp 的 Encode 总是返回新分配的 vector，这是稳态路径上唯一无法复用的分配
+    std::vector<int32_t> token_ids;
+    {
+        STAGE_TIMER(stage_metrics, kStageTokenize);
+        token_ids = encode_text(model, text);
     }
 
-    std::ifstream file(json_path);
-    if (!file) {
-        throw std::runtime_error("Unable to open tokenizer file: " + json_path);
+    // 超长文本：截断（缩小 size 不触发分配）或转入滑动窗口路径
+    const size_t budget = content_budget(model);
+    if (token_ids.size() > budget) {
+        if (options_.long_text.policy == LongTextPolicy::SLIDING_WINDOW) {
+            infer_windows_into(model, token_ids, out, dim);
+            return;
+        }
+        token_ids.resize(budget);
     }
 
-    std::string json_blob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EmbeddingWorkspace& workspace = thread_workspace();
+    // 句向量输出直接绑定到调用方内存；last_hidden_state 绑定到线程工作区后再池化
+    const bool needs_pooling = (model.pooling != PoolingMode::MODEL_OUTPUT);
+    size_t seq_len = 0;
+    Ort::Value input_tensor{nullptr};
+    Ort::Value mask_tensor{nullptr};
+    Ort::Value output_tensor{nullptr};
+    {
+        STAGE_TIMER(stage_metrics, kStagePrepareInputs);
+        seq_len = fill_single_input(token_ids, model.bos_token_id, model.eos_token_id, workspace);
+
+        const int64_t input_shape[2] = {1, static_cast<int64_t>(seq_len)};
+        input_tensor = Ort::Value::CreateTensor<int64_t>(
+            memory_info_, workspace.input_ids.data(), seq_len, input_shape, 2);
+        mask_tensor = Ort::Value::CreateTensor<int64_t>(
+            memory_info_, workspace.attention_mask.data(), seq_len, input_shape, 2);
+
+        if (needs_pooling) {
+            workspace.hidden_states.resize(seq_len * dim);
+            const int64_t output_shape[3] = {1, static_cast<int64_t>(seq_len), static_cast<int64_t>(dim)};
+            output_tensor = Ort::Value::CreateTensor<float>(
+                memory_info_, workspace.hidden_states.data(), workspace.hidden_states.size(), output_shape, 3);
+        } else {
+            const int64_t output_shape[2] = {1, static_cast<int64_t>(dim)};
+            output_tensor = Ort::Value::CreateTensor<float>(memory_info_, out, dim, output_shape, 2);
+        }
+    }
 
-    std::shared_lock lock(tokenizer_mutex_);
+    {
+        // 含等待空闲 Session 的时间
+        STAGE_TIMER(stage_metrics, kStageRunModel);
+        auto lease = model.sessions->acquire();
+        Ort::IoBinding binding(lease.session());
+        binding.BindInput(model.input_name_ptrs[0], input_tensor);
+        binding.BindInput(model.input_name_ptrs[1], mask_tensor);
+        binding.BindOutput(model.output_name.c_str(), output_tensor);
+        lease.session().Run(Ort::RunOptions{nullptr}, binding);
+    }
+    STAGE_COUNT(stage_metrics, kCounterModelRuns, 1);
+    STAGE_COUNT(stage_metrics, kCounterTokens, seq_len);
 
-    tokenizer_ = tokenizers::Tokenizer::FromBlobJSON(json_blob);
-    if (!tokenizer_) {
-        throw std::runtime_error("Failed to initialize tokenizer from: " + json_path);
+    STAGE_TIMER(stage_metrics, kStagePooling);
+    if (needs_pooling) {
+        pool_into(model, workspace.hidden_states.data(), workspace.attention_mask.data(), seq_len, dim, out);
+    }
+    if (options_.normalize) {
+        vector_math::l2_normalize(out, dim);
     }
+}
 
-    // 获取常见的特殊 token（尝试多种形式）
-    std::vector<std::string> bos_candidates = {"[CLS]", "<s>"};
-    std::vector<std::string> eos_candidates = {"[SEP]", "</s>"};
+void OnnxRuntimeEmbedding::infer_windows_into(const ModelVersion& model, const std::vector<int32_t>& token_ids,
+                                              float* out, size_t dim) {
+    std::vector<std::vector<int64_t>> rows;
+    std::vector<size_t> weights;
+    append_input_rows(model, token_ids, rows, weights);
+
+    // 所有窗口作为一个批次推理，耗时随文本长度线性增长
+    auto window_results = run_rows(model, rows);
+    STAGE_TIMER(active_metrics(), kStagePooling);
+    combine_window_embeddings(window_results, weights, out, dim);
+    if (options_.normalize) {
+        vector_math::l2_normalize(out, dim);
+    }
+}
 
-    for (const auto& token : bos_candidates) {
-        int id = tokenizer_->TokenToId(token);
-        if (id != -1) {
-            bos_token_id_ = id;
-            break;
+std::vector<std::vector<float>> OnnxRuntimeEmbedding::infer_batch(const ModelVersion& model,
+                                                                  const std::vector<std::string>& texts) {
+    if (texts.empty()) {
+        return {};
+    }
+    [[maybe_unused]] metrics::StageMetrics* stage_metrics = active_metrics();
+    STAGE_COUNT(stage_metrics, kCounterTexts, texts.size());
+
+    // 每条文本展开为一行或多行（滑动窗口），row_begin[i] 为第 i 条文本的首行
+    std::vector<std::vector<int64_t>> rows;
+    std::vector<size_t> weights;
+    std::vector<size_t> row_begin;
+    rows.reserve(texts.size());
+    row_begin.reserve(texts.size() + 1);
+    {
+        STAGE_TIMER(stage_metrics, kStageTokenize);
+        // 多条文本由 tokenizer 池并行编码
+        auto token_ids = model.tokenizer->encode_batch(texts);
+        for (size_t i = 0; i < texts.size(); ++i) {
+            if (token_ids[i].empty()) {
+                throw std::runtime_error("Tokenizer returned empty ids for text: " + texts[i]);
+            }
+            row_begin.push_back(rows.size());
+            append_input_rows(model, token_ids[i], rows, weights);
         }
+        row_begin.push_back(rows.size());
     }
 
-    for (const auto& token : eos_candidates) {
-        int id = tokenizer_->TokenToId(token);
-        if (id != -1) {
-            eos_token_id_ = id;
-            break;
+    auto row_results = run_rows(model, rows);
+
+    STAGE_TIMER(stage_metrics, kStagePooling);
+    std::vector<std::vector<float>> results(texts.size());
+    for (size_t i = 0; i < texts.size(); ++i) {
+        const size_t first = row_begin[i];
+        const size_t count = row_begin[i + 1] - first;
+        if (count == 1) {
+            results[i] = std::move(row_results[first]);
+            continue;
+        }
+
+        std::vector<std::vector<float>> windows(std::make_move_iterator(row_results.begin() + first),
+                                                std::make_move_iterator(row_results.begin() + first + count));
+        std::vector<size_t> window_weights(weights.begin() + first, weights.begin() + first + count);
+        results[i].resize(windows.front().size());
+        combine_window_embeddings(windows, window_weights, results[i].data(), results[i].size());
+        if (options_.normalize) {
+            vector_math::l2_normalize(results[i].data(), results[i].size());
         }
     }
+    return results;
+}
+
+std::vector<std::vector<float>> OnnxRuntimeEmbedding::run_rows(const ModelVersion& model,
+                                                               std::vector<std::vector<int64_t>>& rows) {
+    std::vector<size_t> lengths;
+    lengths.reserve(rows.size());
+    for (const auto& row : rows) lengths.push_back(row.size());
+
+    // 按长度分桶组批，避免短文本为长文本的补齐付出计算量
+    auto batches = plan_length_buckets(lengths, options_.bucketing);
+    auto stats = compute_padding_stats(lengths, batches);
+    if (!t_warming_up) {
+        useful_tokens_.fetch_add(stats.useful_tokens, std::memory_order_relaxed);
+        computed_tokens_.fetch_add(stats.computed_tokens, std::memory_order_relaxed);
+    }
+
+    std::vector<std::vector<float>> results(rows.size());
+    std::vector<std::vector<int64_t>> sub_batch;
+    for (const auto& batch : batches) {
+        sub_batch.clear();
+        for (size_t index : batch) {
+            sub_batch.push_back(std::move(rows[index]));
+        }
 
-    LOG_DEBUG << "[Tokenizer] BOS ID: " << to_optional_str(bos_token_id_)
-          << ", EOS ID: " << to_optional_str(eos_token_id_);
+        auto sub_results = run_padded_batch(model, sub_batch);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            results[batch[i]] = std::move(sub_results[i]);
+        }
+    }
+
+    LOG_DEBUG << "[Debug] " << rows.size() << " rows in " << batches.size()
+              << " length buckets, padding efficiency: " << stats.efficiency();
+    return results;
+}
+
+PaddingStats OnnxRuntimeEmbedding::padding_stats() const {
+    PaddingStats stats;
+    stats.useful_tokens = useful_tokens_.load(std::memory_order_relaxed);
+    stats.computed_tokens = computed_tokens_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void OnnxRuntimeEmbedding::reset_padding_stats() {
+    useful_tokens_.store(0, std::memory_order_relaxed);
+    computed_tokens_.store(0, std::memory_order_relaxed);
+}
+
+metrics::MetricsSnapshot OnnxRuntimeEmbedding::stage_metrics() const {
+    return stage_metrics_.snapshot();
+}
+
+void OnnxRuntimeEmbedding::reset_stage_metrics() {
+    stage_metrics_.reset();
+}
+
+std::vector<std::vector<float>> OnnxRuntimeEmbedding::run_padded_batch(
+    const ModelVersion& model, const std::vector<std::vector<int64_t>>& batch_ids) {
+    [[maybe_unused]] metrics::StageMetrics* stage_metrics = active_metrics();
+
+    // 按批内最长序列补齐，补齐位置的 attention mask 为 0
+    std::vector<int64_t> input_ids;
+    std::vector<int64_t> attention_mask;
+    std::vector<Ort::Value> input_tensors;
+    {
+        STAGE_TIMER(stage_metrics, kStagePrepareInputs);
+        pad_batch(model, batch_ids, input_ids, attention_mask);
+        input_tensors = prepare_input_tensors(input_ids, attention_mask, batch_ids.size());
+    }
+
+    std::vector<Ort::Value> output_tensors;
+    {
+        STAGE_TIMER(stage_metrics, kStageRunModel);
+        output_tensors = run_model(model, input_tensors);
+    }
+    STAGE_COUNT(stage_metrics, kCounterModelRuns, 1);
+    STAGE_COUNT(stage_metrics, kCounterTokens, input_ids.size());
+
+    STAGE_TIMER(stage_metrics, kStagePooling);
+    auto results = (model.pooling == PoolingMode::MODEL_OUTPUT)
+                       ? extract_tensor_data(output_tensors, batch_ids.size())
+                       : pool_hidden_states(model, output_tensors, attention_mask);
+    if (options_.normalize) {
+        for (auto& vec : results) vector_math::l2_normalize(vec.data(), vec.size());
+    }
+    return results;
+}
+
+void OnnxRuntimeEmbedding::init_tokenizer(ModelVersion& model, const std::string& json_path) {
+    model.tokenizer = load_tokenizer_pool(json_path, options_.tokenizer);
+
+    const SpecialTokens special = find_special_tokens(*model.tokenizer);
+    model.bos_token_id = special.bos;
+    model.eos_token_id = special.eos;
+    model.pad_token_id = special.pad;
+
+    LOG_DEBUG << "[Tokenizer] BOS ID: " << to_optional_str(model.bos_token_id)
+          << ", EOS ID: " << to_optional_str(model.eos_token_id)
+          << ", PAD ID: " << to_optional_str(model.pad_token_id);
+}
+
+void OnnxRuntimeEmbedding::resolve_model_io(ModelVersion& model) {
+    Ort::Session& session = model.sessions->primary();
+
+    auto model_inputs = session.GetInputNames();
+    model.input_names = {"input_ids", "attention_mask"};
+    for (const auto& required : model.input_names) {
+        if (std::find(model_inputs.begin(), model_inputs.end(), required) == model_inputs.end()) {
+            throw std::runtime_error("Model is missing required input: " + required);
+        }
+    }
+    model.input_name_ptrs.clear();
+    for (const auto& name : model.input_names) model.input_name_ptrs.push_back(name.c_str());
+
+    auto output_names = session.GetOutputNames();
+    if (output_names.empty()) {
+        throw std::runtime_error("Model has no outputs.");
+    }
+
+    // MEAN/CLS 固定使用 last_hidden_state；AUTO 优先使用模型自带的句向量输出
+    std::string selected_output = select_output_name(output_names);
+    model.pooling = options_.pooling;
+    if (model.pooling == PoolingMode::AUTO) {
+        model.pooling = selected_output.empty() ? PoolingMode::MEAN : PoolingMode::MODEL_OUTPUT;
+    }
+    if (model.pooling == PoolingMode::MODEL_OUTPUT && selected_output.empty()) {
+        throw std::runtime_error("Model has no sentence embedding output for PoolingMode::MODEL_OUTPUT.");
+    }
+    model.output_name = (model.pooling == PoolingMode::MODEL_OUTPUT) ? selected_output : "last_hidden_state";
+
+    auto it = std::find(output_names.begin(), output_names.end(), model.output_name);
+    if (it == output_names.end()) {
+        throw std::runtime_error("Model has no usable output: " + model.output_name);
+    }
+
+    // 输出按 float 读取；fp16 模型须在导出时保持 fp32 输入输出
+    auto output_info = session.GetOutputTypeInfo(it - output_names.begin()).GetTensorTypeAndShapeInfo();
+    if (output_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+        throw std::runtime_error("Model output " + model.output_name + " is not float32; "
+                                 "export fp16 models with keep_io_types enabled.");
+    }
+
+    // 隐藏维度一般是静态的；若为动态则为 0，embed_into 不可用
+    auto shape = output_info.GetShape();
+    model.dimension = (!shape.empty() && shape.back() > 0) ? static_cast<size_t>(shape.back()) : 0;
+
+    LOG_DEBUG << "[Debug] Using output name: " << model.output_name
+              << (model.pooling == PoolingMode::MEAN ? " (mean pooling)" : model.pooling == PoolingMode::CLS ? " (cls pooling)" : "");
 }
 
-std::vector<int64_t> OnnxRuntimeEmbedding::build_input_ids(const std::string& text) {
-    std::shared_lock lock(tokenizer_mutex_);
+void OnnxRuntimeEmbedding::resolve_max_length(ModelVersion& model, const std::string& model_path) {
+    const auto& long_text = options_.long_text;
+    model.max_length = long_text.max_length > 0 ? long_text.max_length : read_model_max_length(model_path);
+
+    const size_t specials = (model.bos_token_id ? 1 : 0) + (model.eos_token_id ? 1 : 0);
+    if (model.max_length <= specials) {
+        throw std::runtime_error("Max length " + std::to_string(model.max_length) + " leaves no room for text tokens");
+    }
+
+    model.window_overlap = long_text.window_overlap;
+    const size_t budget = model.max_length - specials;
+    if (model.window_overlap >= budget) {
+        model.window_overlap = budget / 2;
+        LOG_WARNING << "Window overlap " << long_text.window_overlap << " >= window length " << budget
+                    << ", clamped to " << model.window_overlap;
+    }
+}
+
+void OnnxRuntimeEmbedding::warm_up(const ModelVersion& model) {
+    const auto& warmup = options_.warmup;
+    if (warmup.runs == 0) return;
+    WarmupScope scope;
+
+    const std::vector<std::string> default_texts = {"warm up", "人工智能正在改变世界。The quick brown fox jumps over the lazy dog."};
+    const auto& texts = warmup.texts.empty() ? default_texts : warmup.texts;
+
+    // 新版本尚未发布，直接走内部推理路径；空闲时 acquire 轮转，每轮覆盖所有 Session
+    std::vector<float> out(model.dimension);
+    for (size_t run = 0; run < warmup.runs; ++run) {
+        for (size_t s = 0; s < model.sessions->size(); ++s) {
+            for (const auto& text : texts) {
+                if (model.dimension > 0) {
+                    infer_single_into(model, text, out.data(), out.size());
+                } else {
+                    infer_batch(model, {text});
+                }
+            }
+        }
+        infer_batch(model, texts);
+    }
+}
 
-    std::vector<int32_t> ids = tokenizer_->Encode(text);
+std::vector<int32_t> OnnxRuntimeEmbedding::encode_text(const ModelVersion& model, const std::string& text) const {
+    std::vector<int32_t> ids = model.tokenizer->encode(text);
     if (ids.empty()) {
         throw std::runtime_error("Tokenizer returned empty ids for text: " + text);
     }
+    return ids;
+}
+
+size_t OnnxRuntimeEmbedding::content_budget(const ModelVersion& model) const {
+    return model.max_length - (model.bos_token_id ? 1 : 0) - (model.eos_token_id ? 1 : 0);
+}
+
+void OnnxRuntimeEmbedding::append_input_rows(const ModelVersion& model,
+                                             const std::vector<int32_t>& token_ids,
+                                             std::vector<std::vector<int64_t>>& rows,
+                                             std::vector<size_t>& weights) const {
+    const size_t budget = content_budget(model);
+    std::vector<std::pair<size_t, size_t>> spans;
+    if (token_ids.size() <= budget || options_.long_text.policy == LongTextPolicy::TRUNCATE) {
+        spans.emplace_back(0, std::min(token_ids.size(), budget));
+    } else {
+        spans = plan_token_windows(token_ids.size(), budget, model.window_overlap);
+    }
+
+    for (const auto& [begin, end] : spans) {
+        std::vector<int64_t> row;
+        row.reserve(end - begin + 2);
+        if (model.bos_token_id) row.push_back(model.bos_token_id.value());
+        row.insert(row.end(), token_ids.begin() + begin, token_ids.begin() + end);
+        if (model.eos_token_id) row.push_back(model.eos_token_id.value());
+        rows.push_back(std::move(row));
+        weights.push_back(end - begin);
+    }
+}
 
-    if (bos_token_id_) ids.insert(ids.begin(), bos_token_id_.value());
-    if (eos_token_id_) ids.push_back(eos_token_id_.value());
-    
-    return std::vector<int64_t>(ids.begin(), ids.end());
+void OnnxRuntimeEmbedding::pad_batch(const ModelVersion& model,
+                                     const std::vector<std::vector<int64_t>>& batch_ids,
+                                     std::vector<int64_t>& input_ids,
+                                     std::vector<int64_t>& attention_mask) const {
+    size_t max_len = 0;
+    for (const auto& ids : batch_ids) max_len = std::max(max_len, ids.size());
+
+    const int64_t pad_id = model.pad_token_id.value_or(0);
+    input_ids.assign(batch_ids.size() * max_len, pad_id);
+    attention_mask.assign(batch_ids.size() * max_len, 0);
+
+    for (size_t row = 0; row < batch_ids.size(); ++row) {
+        const auto& ids = batch_ids[row];
+        std::copy(ids.begin(), ids.end(), input_ids.begin() + row * max_len);
+        std::fill_n(attention_mask.begin() + row * max_len, ids.size(), 1);
+    }
 }
 
 std::vector<Ort::Value> OnnxRuntimeEmbedding::prepare_input_tensors(const std::vector<int64_t>& input_ids,
-                                                                     const std::vector<int64_t>& attention_mask) {
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    std::vector<int64_t> input_shape = {1, static_cast<int64_t>(input_ids.size())};
+                                                                     const std::vector<int64_t>& attention_mask,
+                                                                     size_t batch_size) {
+    std::vector<int64_t> input_shape = {static_cast<int64_t>(batch_size),
+                                        static_cast<int64_t>(input_ids.size() / batch_size)};
 
     Ort::Value input_tensor = Ort::Value::CreateTensor<int64_t>(
-        memory_info, const_cast<int64_t*>(input_ids.data()), input_ids.size(), input_shape.data(), input_shape.size());
+        memory_info_, const_cast<int64_t*>(input_ids.data()), input_ids.size(), input_shape.data(), input_shape.size());
     Ort::Value mask_tensor = Ort::Value::CreateTensor<int64_t>(
-        memory_info, const_cast<int64_t*>(attention_mask.data()), attention_mask.size(), input_shape.data(), input_shape.size());
+        memory_info_, const_cast<int64_t*>(attention_mask.data()), attention_mask.size(), input_shape.data(), input_shape.size());
 
     std::vector<Ort::Value> input_tensors;
     input_tensors.push_back(std::move(input_tensor));
@@ -202,24 +691,35 @@ std::string OnnxRuntimeEmbedding::select_output_name(const std::vector<std::stri
     return "";
 }
 
-std::vector<Ort::Value> OnnxRuntimeEmbedding::run_model(const std::vector<const char*>& output_names,
-                                                         const std::vector<Ort::Value>& input_tensors) {
-    std::vector<const char*> input_names = {"input_ids", "attention_mask"};
-    return session_->Run(Ort::RunOptions{nullptr},
-                         input_names.data(), input_tensors.data(), input_tensors.size(),
-                         output_names.data(), output_names.size());
+std::vector<Ort::Value> OnnxRuntimeEmbedding::run_model(const ModelVersion& model,
+                                                        const std::vector<Ort::Value>& input_tensors) {
+    const char* output_names[] = {model.output_name.c_str()};
+    auto lease = model.sessions->acquire();
+    return lease.session().Run(Ort::RunOptions{nullptr},
+                         model.input_name_ptrs.data(), input_tensors.data(), input_tensors.size(),
+                         output_names, 1);
 }
 
-std::vector<float> OnnxRuntimeEmbedding::extract_tensor_data(const std::vector<Ort::Value>& output_tensors,
-                                                              const std::string& output_name) {
+std::vector<std::vector<float>> OnnxRuntimeEmbedding::extract_tensor_data(const std::vector<Ort::Value>& output_tensors,
+                                                                           size_t batch_size) {
     auto& tensor = output_tensors[0];
     const float* float_array = tensor.GetTensorData<float>();
     auto shape_info = tensor.GetTensorTypeAndShapeInfo();
-    auto shape = shape_info.GetShape();
+    auto shape = shape_info.GetShape();  // [batch, hidden]
 
     size_t output_size = 1;
     for (auto dim : shape) output_size *= dim;
-    std::vector<float> result(float_array, float_array + output_size);
+    if (batch_size == 0 || output_size % batch_size != 0) {
+        throw std::runtime_error("Output tensor size does not match batch size.");
+    }
+
+    size_t row_size = output_size / batch_size;
+    std::vector<std::vector<float>> result;
+    result.reserve(batch_size);
+    for (size_t row = 0; row < batch_size; ++row) {
+        const float* row_begin = float_array + row * row_size;
+        result.emplace_back(row_begin, row_begin + row_size);
+    }
 
     LOG_DEBUG << "[Debug] Embedding shape: [";
     for (size_t i = 0; i < shape.size(); ++i)
@@ -229,34 +729,38 @@ std::vector<float> OnnxRuntimeEmbedding::extract_tensor_data(const std::vector<O
     return result;
 }
 
-std::vector<float> OnnxRuntimeEmbedding::mean_pooling(const std::vector<Ort::Value>& output_tensors,
-                                                       const std::vector<int64_t>& attention_mask) {
+std::vector<std::vector<float>> OnnxRuntimeEmbedding::pool_hidden_states(const ModelVersion& model,
+                                                                          const std::vector<Ort::Value>& output_tensors,
+                                                                          const std::vector<int64_t>& attention_mask) {
     const float* float_array = output_tensors[0].GetTensorData<float>();
     auto shape_info = output_tensors[0].GetTensorTypeAndShapeInfo();
-    std::vector<int64_t> shape = shape_info.GetShape();  // [1, seq_len, hidden]
+    std::vector<int64_t> shape = shape_info.GetShape();  // [batch, seq_len, hidden]
 
     if (shape.size() != 3) {
         throw std::runtime_error("Unexpected output shape for last_hidden_state.");
     }
 
+    int64_t batch_size = shape[0];
     int64_t seq_len = shape[1];
     int64_t hidden_size = shape[2];
 
-    std::vector<float> pooled(hidden_size, 0.0f);
-    int valid_count = 0;
-    for (int64_t i = 0; i < seq_len; ++i) {
-        if (attention_mask[i] == 0) continue;
-        ++valid_count;
-        for (int64_t j = 0; j < hidden_size; ++j) {
-            pooled[j] += float_array[i * hidden_size + j];
-        }
+    std::vector<std::vector<float>> result(batch_size, std::vector<float>(hidden_size));
+    for (int64_t b = 0; b < batch_size; ++b) {
+        pool_into(model, float_array + b * seq_len * hidden_size, attention_mask.data() + b * seq_len,
+                  seq_len, hidden_size, result[b].data());
     }
 
-    if (valid_count == 0) valid_count = 1;
-    for (float& val : pooled) val /= valid_count;
+    LOG_DEBUG << "[Debug] Embedding shape: [" << batch_size << ", " << hidden_size << "]\n";
+    return result;
+}
 
-    LOG_DEBUG << "[Debug] Embedding shape: [" << hidden_size << "]\n";
-    return pooled;
+void OnnxRuntimeEmbedding::pool_into(const ModelVersion& model, const float* hidden_states, const int64_t* attention_mask,
+                                     size_t seq_len, size_t hidden_size, float* out) const {
+    if (model.pooling == PoolingMode::CLS) {
+        vector_math::cls_pooling(hidden_states, hidden_size, out);
+    } else {
+        vector_math::masked_mean_pooling(hidden_states, attention_mask, seq_len, hidden_size, out);
+    }
 }
 
 } // namespace text_embedding
@@ -1,45 +1,190 @@
 #pragma once
 
 #include "text_embedding.h"
+#include "length_bucketing.h"
+#include "long_text.h"
+#include "session_pool.h"
+#include "stage_metrics.h"
+#include "tokenizer_pool.h"
 
+#include <atomic>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <shared_mutex>
 
 #include <onnxruntime/onnxruntime_cxx_api.h>
-#include <tokenizers_cpp.h>
 
 namespace text_embedding {
 
+enum class PoolingMode {
+    AUTO,          // 模型自带句向量输出则直接使用，否则对 last_hidden_state 做均值池化
+    MEAN,          // 对 last_hidden_state 按 attention mask 求均值（e5 等）
+    CLS,           // 取 last_hidden_state 的首 token（bge 等）
+    MODEL_OUTPUT   // 必须使用模型自带的句向量输出
+};
+
+enum class ModelPrecision {
+    FP32,  // model.onnx
+    FP16,  // model_fp16.onnx（输入输出保持 fp32，见 tools/quantize_onnx.py）
+    INT8   // model_int8.onnx（动态量化，CPU 上吞吐提升最明显）
+};
+
+const char* precision_name(ModelPrecision precision);
+
+// 模型目录下对应精度的模型文件；该变体不存在时回退到 fp32 的 model.onnx 并更新 precision
+std::string resolve_model_file(const std::string& model_path, ModelPrecision& precision);
+
+struct WarmupOptions {
+    // load_model 返回前每个 Session 执行的预热轮数，0 表示不预热
+    size_t runs = 0;
+    // 预热文本，为空时使用内置短句；建议覆盖线上常见的输入长度
+    std::vector<std::string> texts;
+};
+
+// 最近一次 load_model 的分阶段耗时
+struct LoadTimings {
+    double tokenizer_ms = 0.0;
+    double session_ms = 0.0;
+    double warmup_ms = 0.0;
+    double total_ms = 0.0;
+    bool optimized_cache_hit = false;
+};
+
+struct OnnxEmbeddingOptions {
+    // 模型精度；对应文件不存在时回退到 fp32 的 model.onnx
+    ModelPrecision precision = ModelPrecision::FP32;
+    // 句向量池化方式
+    PoolingMode pooling = PoolingMode::AUTO;
+    // 输出前做 L2 归一化（bge/e5 的检索约定）
+    bool normalize = true;
+
+    // 超过模型最大长度的文本的处理方式
+    LongTextOptions long_text;
+    // tokenizer 实例数与并行批量编码配置
+    TokenizerPoolOptions tokenizer;
+    // 批量推理时的长度分桶策略
+    BucketingOptions bucketing;
+    // Session 数量、线程池、绑核、mmap 与优化图缓存配置
+    SessionPoolOptions session;
+    // 首个请求前的预热，摊掉 ORT 与工作区的惰性分配
+    WarmupOptions warmup;
+};
+
+// 带模型版本号的结果，版本号在每次 load_model 成功发布新模型时递增
+struct EmbeddingResult {
+    std::vector<float> vector;
+    uint64_t model_version = 0;
+};
+
+struct BatchEmbeddingResult {
+    std::vector<std::vector<float>> vectors;  // 同一批次总由同一版本模型计算
+    uint64_t model_version = 0;
+};
+
+// 模型状态（Session、tokenizer、输入输出配置）整体封装为不可变的版本快照，RCU 式发布：
+// 请求开始时取当前版本的 shared_ptr，load_model 在后台构建新版本后原子替换指针；
+// 在途请求继续使用旧版本，最后一个使用者离开时旧版本自动释放。
 class OnnxRuntimeEmbedding : public TextEmbedding {
 public:
-    OnnxRuntimeEmbedding();
+    explicit OnnxRuntimeEmbedding(OnnxEmbeddingOptions options = {});
     ~OnnxRuntimeEmbedding() override;
 
+    // 构建并预热新版本后再发布，期间旧版本照常服务；失败时保留旧版本
     bool load_model(const std::string& model_path) override;
     void unload_model() override;
     std::vector<float> embed(const std::string& text) override;
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override;
+
+    // 在后台线程加载并发布新模型；调用方须在对象析构前等待返回的 future。
+    // 丢弃返回值时 future 析构会阻塞到加载结束，调用退化为同步，因此标记为 nodiscard
+    [[nodiscard]] std::future<bool> reload_model_async(const std::string& model_path);
+
+    EmbeddingResult embed_with_version(const std::string& text);
+    BatchEmbeddingResult embed_batch_with_version(const std::vector<std::string>& texts);
+
+    // 将单条文本的向量直接写入调用方内存（如索引内存池的一行），dim 必须等于 dimension()。
+    // 稳态下除 tokenizer 与 ORT 内部外不产生堆分配。返回计算所用的模型版本。
+    uint64_t embed_into(const std::string& text, float* out, size_t dim);
+
+    // 当前发布的模型版本，未加载时为 0
+    uint64_t model_version() const;
+
+    // 输出向量维度，模型未加载或输出维度为动态时返回 0
+    size_t dimension() const;
+
+    // 含特殊 token 的最大序列长度，在 load_model 时确定
+    size_t max_length() const;
+
+    LoadTimings load_timings() const;
+
+    // 实际加载的模型精度（请求的变体缺失时为 FP32）
+    ModelPrecision loaded_precision() const;
+
+    // 累计的补齐效率统计，用于调优分桶上界
+    PaddingStats padding_stats() const;
+    void reset_padding_stats();
+
+    // 热路径分阶段耗时（tokenize / prepare_inputs / run_model / pooling）与计数（texts / model_runs / tokens），
+    // 不含预热请求；可用 metrics::to_prometheus 导出
+    metrics::MetricsSnapshot stage_metrics() const;
+    void reset_stage_metrics();
 
 private:
-    Ort::Env env_;
-    std::unique_ptr<Ort::Session> session_;
-    std::unique_ptr<tokenizers::Tokenizer> tokenizer_;
-    std::optional<int32_t> bos_token_id_;
-    std::optional<int32_t> eos_token_id_;
-    mutable std::shared_mutex tokenizer_mutex_;
+    struct ModelVersion;
+    using VersionPtr = std::shared_ptr<const ModelVersion>;
+
+    OnnxEmbeddingOptions options_;
+    Ort::MemoryInfo memory_info_;
+
+    // 只通过 std::atomic_load / std::atomic_store 访问
+    VersionPtr current_;
+    std::mutex load_mutex_;  // 串行化加载与发布，不在推理路径上
+    uint64_t next_version_ = 1;
+
+    std::atomic<uint64_t> useful_tokens_{0};
+    std::atomic<uint64_t> computed_tokens_{0};
+    metrics::StageMetrics stage_metrics_;
+
+    VersionPtr acquire_version() const;
+    // 当前线程在预热时返回 nullptr，埋点跳过
+    metrics::StageMetrics* active_metrics();
+    std::shared_ptr<ModelVersion> build_version(const std::string& model_path);
+
+    void init_tokenizer(ModelVersion& model, const std::string& json_path);
+    void resolve_model_io(ModelVersion& model);
+    void resolve_max_length(ModelVersion& model, const std::string& model_path);
+    void warm_up(const ModelVersion& model);
 
-    void init_tokenizer(const std::string& json_path);
+    std::vector<std::vector<float>> infer_batch(const ModelVersion& model, const std::vector<std::string>& texts);
+    void infer_single_into(const ModelVersion& model, const std::string& text, float* out, size_t dim);
+    void infer_windows_into(const ModelVersion& model, const std::vector<int32_t>& token_ids, float* out, size_t dim);
 
-    std::vector<int64_t> build_input_ids(const std::string& text);
+    std::vector<int32_t> encode_text(const ModelVersion& model, const std::string& text) const;
+    size_t content_budget(const ModelVersion& model) const;
+    void append_input_rows(const ModelVersion& model,
+                           const std::vector<int32_t>& token_ids,
+                           std::vector<std::vector<int64_t>>& rows,
+                           std::vector<size_t>& weights) const;
+    std::vector<std::vector<float>> run_rows(const ModelVersion& model, std::vector<std::vector<int64_t>>& rows);
+    std::vector<std::vector<float>> run_padded_batch(const ModelVersion& model,
+                                                     const std::vector<std::vector<int64_t>>& batch_ids);
+    void pad_batch(const ModelVersion& model,
+                   const std::vector<std::vector<int64_t>>& batch_ids,
+                   std::vector<int64_t>& input_ids,
+                   std::vector<int64_t>& attention_mask) const;
     std::vector<Ort::Value> prepare_input_tensors(const std::vector<int64_t>& input_ids,
-                                                  const std::vector<int64_t>& attention_mask);
+                                                  const std::vector<int64_t>& attention_mask,
+                                                  size_t batch_size);
     std::string select_output_name(const std::vector<std::string>& output_names);
-    std::vector<Ort::Value> run_model(const std::vector<const char*>& output_names,
-                                      const std::vector<Ort::Value>& input_tensors);
-    std::vector<float> extract_tensor_data(const std::vector<Ort::Value>& output_tensors,
-                                           const std::string& output_name);
-    std::vector<float> mean_pooling(const std::vector<Ort::Value>& output_tensors,
-                                    const std::vector<int64_t>& attention_mask);
+    std::vector<Ort::Value> run_model(const ModelVersion& model, const std::vector<Ort::Value>& input_tensors);
+    std::vector<std::vector<float>> extract_tensor_data(const std::vector<Ort::Value>& output_tensors,
+                                                        size_t batch_size);
+    std::vector<std::vector<float>> pool_hidden_states(const ModelVersion& model,
+                                                       const std::vector<Ort::Value>& output_tensors,
+                                                       const std::vector<int64_t>& attention_mask);
+    void pool_into(const ModelVersion& model, const float* hidden_states, const int64_t* attention_mask,
+                   size_t seq_len, size_t hidden_size, float* out) const;
 };
 
 } // namespace text_embedding
@@ -0,0 +1,85 @@
+#include "ort_runtime.h"
+
+#include <mutex>
+#include <stdexcept>
+
+#include "logger.h"
+
+namespace text_embedding {
+
+namespace {
+
+std::mutex g_env_mutex;
+Ort::Env* g_env = nullptr;
+bool g_has_global_thread_pool = false;
+bool g_has_shared_allocator = false;
+
+} // namespace
+
+Ort::Env& shared_ort_env(const GlobalThreadPoolOptions* global_pool) {
+    std::lock_guard<std::mutex> lock(g_env_mutex);
+
+    if (g_env) {
+        if (global_pool && !g_has_global_thread_pool) {
+            LOG_WARNING << "[OrtRuntime] Shared Env already created without a global thread pool, "
+                        << "global thread pool options are ignored";
+        }
+        return *g_env;
+    }
+
+    // Env 需要比所有 Session 活得久，这里有意不释放，交由进程退出回收
+    if (global_pool) {
+        Ort::ThreadingOptions threading_options;
+        if (global_pool->intra_op_threads > 0) {
+            threading_options.SetGlobalIntraOpNumThreads(global_pool->intra_op_threads);
+        }
+        if (global_pool->inter_op_threads > 0) {
+            threading_options.SetGlobalInterOpNumThreads(global_pool->inter_op_threads);
+        }
+        threading_options.SetGlobalSpinControl(global_pool->allow_spinning ? 1 : 0);
+
+        if (!global_pool->intra_op_affinity.empty()) {
+            Ort::ThrowOnError(Ort::GetApi().SetGlobalIntraOpThreadAffinity(
+                threading_options, global_pool->intra_op_affinity.c_str()));
+        }
+
+        g_env = new Ort::Env(threading_options, ORT_LOGGING_LEVEL_WARNING, "TextEmbedding");
+        g_has_global_thread_pool = true;
+        LOG_INFO << "[OrtRuntime] Created shared Env with global thread pool, intra_op_threads="
+                 << global_pool->intra_op_threads << ", inter_op_threads=" << global_pool->inter_op_threads;
+    } else {
+        g_env = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "TextEmbedding");
+    }
+
+    return *g_env;
+}
+
+bool shared_env_has_global_thread_pool() {
+    std::lock_guard<std::mutex> lock(g_env_mutex);
+    return g_has_global_thread_pool;
+}
+
+bool register_shared_cpu_allocator() {
+    Ort::Env& env = shared_ort_env();
+    std::lock_guard<std::mutex> lock(g_env_mutex);
+    if (g_has_shared_allocator) return true;
+
+    try {
+        // arena 按请求大小扩展（kSameAsRequested），避免翻倍扩展在多模型下放大占用
+        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        Ort::ArenaCfg arena_cfg(0, 1, -1, -1);
+        env.CreateAndRegisterAllocator(memory_info, arena_cfg);
+        g_has_shared_allocator = true;
+        LOG_INFO << "[OrtRuntime] Registered shared CPU arena allocator";
+    } catch (const Ort::Exception& e) {
+        LOG_WARNING << "[OrtRuntime] Failed to register shared CPU allocator: " << e.what();
+    }
+    return g_has_shared_allocator;
+}
+
+bool shared_env_has_shared_allocator() {
+    std::lock_guard<std::mutex> lock(g_env_mutex);
+    return g_has_shared_allocator;
+}
+
+} // namespace text_embedding
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include <onnxruntime/onnxruntime_cxx_api.h>
+
+namespace text_embedding {
+
+// 进程级全局线程池配置，所有关闭了会话私有线程池的 Session 共用
+struct GlobalThreadPoolOptions {
+    // 0 表示使用 ORT 默认值（物理核数）
+    int intra_op_threads = 0;
+    int inter_op_threads = 0;
+    bool allow_spinning = true;
+    // ORT 亲和性字符串，如 "1,2;3,4"（逻辑核编号从 1 开始），为空则不绑定
+    std::string intra_op_affinity;
+};
+
+// 获取进程内共享的 Ort::Env。
+// 首次调用决定是否创建全局线程池，之后传入的配置会被忽略。
+Ort::Env& shared_ort_env(const GlobalThreadPoolOptions* global_pool = nullptr);
+
+// 共享 Env 是否带有全局线程池
+bool shared_env_has_global_thread_pool();
+
+// 在共享 Env 上注册进程级 CPU arena 分配器（幂等）。开启 use_env_allocator 的 Session 共用它，
+// 多个模型不再各自持有一份 arena。返回是否已注册成功。
+bool register_shared_cpu_allocator();
+
+bool shared_env_has_shared_allocator();
+
+} // namespace text_embedding
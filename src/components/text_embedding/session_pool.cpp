@@ -0,0 +1,232 @@
+#include "session_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace {
+
+// 将 0 起编号的核集合转为 ORT 的亲和性字符串。
+// ORT 要求为除调用线程外的 intra_op_threads - 1 个线程各给出一组逻辑核（编号从 1 开始）。
+std::string build_affinity_string(const std::vector<int>& cores) {
+    std::string affinity;
+    for (size_t i = 1; i < cores.size(); ++i) {
+        if (!affinity.empty()) affinity += ";";
+        affinity += std::to_string(cores[i] + 1);
+    }
+    return affinity;
+}
+
+// 当前 CPU 的型号与指令集标志；ORT_ENABLE_ALL 会做与硬件相关的变换，优化图不能跨机器复用
+const std::string& cpu_signature() {
+    static const std::string signature = [] {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line, result;
+        while (std::getline(cpuinfo, line)) {
+            const std::string key = line.substr(0, line.find(':'));
+            if (key.rfind("model name", 0) == 0 || key.rfind("flags", 0) == 0 || key.rfind("Features", 0) == 0 ||
+                key.rfind("CPU part", 0) == 0) {
+                result += line;
+                result += '\n';
+            }
+            // 只取第一个逻辑核
+            if (line.empty() && !result.empty()) break;
+        }
+        return result;
+    }();
+    return signature;
+}
+
+// 缓存文件名包含模型文件绝对路径、大小与修改时间，以及影响优化结果的会话配置（优化级别、ORT 版本，
+// ORT_ENABLE_ALL 时还有 CPU 特征）的哈希，不同模型目录、不同配置可共用同一缓存目录。
+// 大小与修改时间使保留旧 mtime 的原地替换（cp -p、rsync -t）也不会命中上一个模型的优化图
+std::string optimized_model_cache_path(const std::string& cache_dir, const std::string& model_file,
+                                       const text_embedding::SessionPoolOptions& options) {
+    namespace fs = std::filesystem;
+    fs::path model_path = fs::absolute(model_file);
+    std::error_code ec;
+    std::string key = model_path.string();
+    key += "|size=" + std::to_string(fs::file_size(model_path, ec));
+    key += "|mtime=" + std::to_string(fs::last_write_time(model_path, ec).time_since_epoch().count());
+    key += "|level=" + std::to_string(static_cast<int>(options.graph_optimization_level));
+    key += "|ort=";
+    key += OrtGetApiBase()->GetVersionString();
+    if (options.graph_optimization_level == ORT_ENABLE_ALL) key += "|cpu=" + cpu_signature();
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016zx", std::hash<std::string>{}(key));
+    return (fs::path(cache_dir) / (model_path.stem().string() + "-" + hash + ".ort")).string();
+}
+
+bool is_cache_fresh(const std::string& cache_file, const std::string& model_file) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::exists(cache_file, ec) || fs::file_size(cache_file, ec) == 0) return false;
+    auto cache_time = fs::last_write_time(cache_file, ec);
+    if (ec) return false;
+    auto model_time = fs::last_write_time(model_file, ec);
+    return !ec && cache_time >= model_time;
+}
+
+} // namespace
+
+namespace text_embedding {
+
+SessionPool::Lease::Lease(Ort::Session& session, std::atomic<int>& in_flight)
+    : session_(&session), in_flight_(&in_flight) {}
+
+SessionPool::Lease::Lease(Lease&& other) noexcept
+    : session_(other.session_), in_flight_(other.in_flight_) {
+    other.in_flight_ = nullptr;
+}
+
+SessionPool::Lease::~Lease() {
+    if (in_flight_) in_flight_->fetch_sub(1, std::memory_order_relaxed);
+}
+
+SessionPool::SessionPool(Ort::Env& env, const std::string& model_file, const SessionPoolOptions& options) {
+    namespace fs = std::filesystem;
+
+    std::string cache_file;
+    if (!options.optimized_model_cache_dir.empty()) {
+        fs::create_directories(options.optimized_model_cache_dir);
+        cache_file = optimized_model_cache_path(options.optimized_model_cache_dir, model_file, options);
+    }
+    bool cache_ready = !cache_file.empty() && is_cache_fresh(cache_file, model_file);
+
+    MappedFile model_bytes;
+    size_t num_sessions = std::max<size_t>(options.num_sessions, 1);
+    for (size_t i = 0; i < num_sessions; ++i) {
+        auto slot = std::make_unique<Slot>();
+        Ort::SessionOptions session_options = make_session_options(options, i);
+
+        if (cache_ready) {
+            try {
+                slot->session = create_from_cache(env, cache_file, session_options, options.mmap_model);
+                if (i == 0) loaded_from_cache_ = true;
+            } catch (const Ort::Exception& e) {
+                // 缓存可能由其他版本的 ORT 写出，删除后按原始模型重建
+                if (i > 0) throw;
+                LOG_WARNING << "[SessionPool] Discarding unusable optimized model cache " << cache_file << ": " << e.what();
+                cached_model_bytes_.close();
+                fs::remove(cache_file);
+                cache_ready = false;
+                session_options = make_session_options(options, i);
+            }
+        }
+
+        if (!slot->session) {
+            // 首个 Session 负责写出优化图；先写临时文件再改名，避免并发进程读到半个文件
+            std::string temp_cache_file;
+            if (!cache_file.empty() && i == 0) {
+                temp_cache_file = cache_file + ".tmp." + std::to_string(::getpid());
+                session_options.SetOptimizedModelFilePath(temp_cache_file.c_str());
+                session_options.AddConfigEntry("session.save_model_format", "ORT");
+            }
+
+            if (options.mmap_model) {
+                if (!model_bytes.valid()) model_bytes = MappedFile::open_read_only(model_file);
+                slot->session = std::make_unique<Ort::Session>(env, model_bytes.data(), model_bytes.size(), session_options);
+            } else {
+                slot->session = std::make_unique<Ort::Session>(env, model_file.c_str(), session_options);
+            }
+
+            if (!temp_cache_file.empty()) {
+                std::error_code ec;
+                fs::rename(temp_cache_file, cache_file, ec);
+                if (ec) {
+                    LOG_WARNING << "[SessionPool] Failed to save optimized model cache " << cache_file << ": " << ec.message();
+                    fs::remove(temp_cache_file, ec);
+                } else {
+                    // 其余 Session 直接从刚写出的缓存加载
+                    cache_ready = true;
+                    LOG_DEBUG << "[SessionPool] Saved optimized model cache " << cache_file;
+                }
+            }
+        }
+        slots_.push_back(std::move(slot));
+    }
+    LOG_DEBUG << "[SessionPool] Created " << slots_.size() << " sessions for " << model_file
+              << (loaded_from_cache_ ? " from optimized cache" : "");
+}
+
+std::unique_ptr<Ort::Session> SessionPool::create_from_cache(Ort::Env& env, const std::string& cache_file,
+                                                             Ort::SessionOptions& session_options, bool mmap_model) {
+    // 图已在写缓存时完成优化
+    session_options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+    session_options.AddConfigEntry("session.load_model_format", "ORT");
+
+    if (!mmap_model) {
+        return std::make_unique<Ort::Session>(env, cache_file.c_str(), session_options);
+    }
+
+    // ORT 格式可直接引用映射内存，多个 Session 共享同一份只读页
+    if (!cached_model_bytes_.valid()) cached_model_bytes_ = MappedFile::open_read_only(cache_file);
+    session_options.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+    return std::make_unique<Ort::Session>(env, cached_model_bytes_.data(), cached_model_bytes_.size(), session_options);
+}
+
+SessionPool::Lease SessionPool::acquire() {
+    // 从轮转起点开始找在途请求最少的 Session，负载相同时自然轮转
+    size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    size_t best = start % slots_.size();
+    int best_load = slots_[best]->in_flight.load(std::memory_order_relaxed);
+    for (size_t i = 1; i < slots_.size() && best_load > 0; ++i) {
+        size_t index = (start + i) % slots_.size();
+        int load = slots_[index]->in_flight.load(std::memory_order_relaxed);
+        if (load < best_load) {
+            best = index;
+            best_load = load;
+        }
+    }
+
+    Slot& slot = *slots_[best];
+    slot.in_flight.fetch_add(1, std::memory_order_relaxed);
+    return Lease(*slot.session, slot.in_flight);
+}
+
+Ort::SessionOptions SessionPool::make_session_options(const SessionPoolOptions& options, size_t index) {
+    Ort::SessionOptions session_options;
+    session_options.SetGraphOptimizationLevel(options.graph_optimization_level);
+    session_options.SetExecutionMode(options.execution_mode);
+    if (options.use_env_allocator && shared_env_has_shared_allocator()) {
+        session_options.AddConfigEntry("session.use_env_allocators", "1");
+    }
+
+    if (options.use_global_thread_pool && shared_env_has_global_thread_pool()) {
+        session_options.DisablePerSessionThreads();
+        return session_options;
+    }
+    if (options.use_global_thread_pool) {
+        LOG_WARNING << "[SessionPool] Global thread pool unavailable, falling back to per-session threads";
+    }
+
+    int intra_op_threads = options.intra_op_threads;
+    if (!options.core_sets.empty()) {
+        const auto& cores = options.core_sets[index % options.core_sets.size()];
+        if (!cores.empty()) {
+            intra_op_threads = static_cast<int>(cores.size());
+            if (cores.size() > 1) {
+                session_options.AddConfigEntry("session.intra_op_thread_affinities",
+                                               build_affinity_string(cores).c_str());
+            }
+        }
+    }
+
+    if (intra_op_threads > 0) session_options.SetIntraOpNumThreads(intra_op_threads);
+    if (options.inter_op_threads > 0) session_options.SetInterOpNumThreads(options.inter_op_threads);
+
+    const char* spinning = options.allow_spinning ? "1" : "0";
+    session_options.AddConfigEntry("session.intra_op.allow_spinning", spinning);
+    session_options.AddConfigEntry("session.inter_op.allow_spinning", spinning);
+    return session_options;
+}
+
+} // namespace text_embedding
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <onnxruntime/onnxruntime_cxx_api.h>
+
+#include "mapped_file.h"
+#include "ort_runtime.h"
+
+namespace text_embedding {
+
+struct SessionPoolOptions {
+    // 每个模型创建的 Session 数
+    size_t num_sessions = 1;
+    // 会话私有线程池的线程数，0 表示使用 ORT 默认值
+    int intra_op_threads = 0;
+    int inter_op_threads = 0;
+    GraphOptimizationLevel graph_optimization_level = ORT_ENABLE_ALL;
+    ExecutionMode execution_mode = ORT_SEQUENTIAL;
+    bool allow_spinning = true;
+    // 第 i 个 Session 的 intra-op 线程绑定到 core_sets[i % size] 中的 CPU 核（从 0 开始编号）
+    std::vector<std::vector<int>> core_sets;
+    // 使用进程级全局线程池（此时 core_sets 不生效，改用 global_thread_pool 的亲和性）
+    bool use_global_thread_pool = false;
+    GlobalThreadPoolOptions global_thread_pool;
+    // 使用共享 Env 上注册的 CPU 分配器（见 register_shared_cpu_allocator），未注册时使用会话私有 arena
+    bool use_env_allocator = false;
+
+    // 通过 mmap 读取模型文件，从内存缓冲区创建 Session
+    bool mmap_model = true;
+    // 优化后计算图（ORT 格式）的缓存目录，为空则不缓存。
+    // 缓存不旧于模型文件时直接加载，跳过 ONNX 解析与图优化；否则由首个 Session 优化后写出。
+    // 缓存文件按优化级别、ORT 版本（ORT_ENABLE_ALL 时还有 CPU 特征）区分
+    std::string optimized_model_cache_dir;
+};
+
+// 同一模型的多个 Session，请求路由到当前在途请求最少的 Session
+class SessionPool {
+public:
+    class Lease {
+    public:
+        Lease(Ort::Session& session, std::atomic<int>& in_flight);
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        Ort::Session& session() { return *session_; }
+
+    private:
+        Ort::Session* session_;
+        std::atomic<int>* in_flight_;
+    };
+
+    SessionPool(Ort::Env& env, const std::string& model_file, const SessionPoolOptions& options);
+
+    // 借出负载最低的 Session，Lease 析构时归还
+    Lease acquire();
+
+    // 用于查询模型元信息（输入输出名、形状等）
+    Ort::Session& primary() { return *slots_.front()->session; }
+
+    size_t size() const { return slots_.size(); }
+
+    // 本次是否从优化图缓存加载
+    bool loaded_from_cache() const { return loaded_from_cache_; }
+
+private:
+    struct Slot {
+        std::unique_ptr<Ort::Session> session;
+        std::atomic<int> in_flight{0};
+    };
+
+    // ORT 格式缓存以 use_ort_model_bytes_directly 加载时，Session 直接引用映射内存，须先于 slots_ 构造、后于其析构
+    MappedFile cached_model_bytes_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::atomic<size_t> next_{0};
+    bool loaded_from_cache_ = false;
+
+    static Ort::SessionOptions make_session_options(const SessionPoolOptions& options, size_t index);
+    std::unique_ptr<Ort::Session> create_from_cache(Ort::Env& env, const std::string& cache_file,
+                                                    Ort::SessionOptions& session_options, bool mmap_model);
+};
+
+} // namespace text_embedding
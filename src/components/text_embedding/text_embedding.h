@@ -17,6 +17,9 @@ public:
 
     // 文本向量化
     virtual std::vector<float> embed(const std::string& text) = 0;
+
+    // 批量文本向量化，结果顺序与输入一致
+    virtual std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) = 0;
 };
 
 } // namespace text_embedding
@@ -0,0 +1,206 @@
+#include "tokenizer_pool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include <tokenizers_cpp.h>
+
+#include "logger.h"
+#include "mapped_file.h"
+
+namespace text_embedding {
+
+struct TokenizerPool::Slot {
+    std::mutex mutex;
+    std::unique_ptr<tokenizers::Tokenizer> tokenizer;
+};
+
+// 一次并行批量编码：参与者通过 next 领取下标，completed 达到总数时唤醒调用方。
+// 由 shared_ptr 持有，迟到的辅助线程领取不到下标后直接退出，调用方无需等待它们。
+struct TokenizerPool::Job {
+    // texts/results 属于调用方栈帧，只能在领取到有效下标后访问
+    const std::vector<std::string>* texts = nullptr;
+    std::vector<std::vector<int32_t>>* results = nullptr;
+    size_t total = 0;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> completed{0};
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::exception_ptr error;
+};
+
+TokenizerPool::TokenizerPool(const std::string& json_blob, TokenizerPoolOptions options)
+    : options_(options) {
+    size_t num_instances = options_.num_instances;
+    if (num_instances == 0) {
+        num_instances = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 4);
+    }
+
+    for (size_t i = 0; i < num_instances; ++i) {
+        auto slot = std::make_unique<Slot>();
+        slot->tokenizer = tokenizers::Tokenizer::FromBlobJSON(json_blob);
+        if (!slot->tokenizer) {
+            throw std::runtime_error("Failed to initialize tokenizer instance " + std::to_string(i));
+        }
+        slots_.push_back(std::move(slot));
+    }
+
+    // 调用线程本身也参与批量编码，辅助线程比实例数少一个
+    for (size_t i = 1; i < num_instances; ++i) {
+        workers_.emplace_back(&TokenizerPool::worker_loop, this);
+    }
+    LOG_DEBUG << "Tokenizer pool ready with " << num_instances << " instances";
+}
+
+TokenizerPool::~TokenizerPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stopping_ = true;
+    }
+    state_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+TokenizerPool::Slot& TokenizerPool::lock_slot(std::unique_lock<std::mutex>& lock) {
+    const size_t start = next_slot_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        Slot& slot = *slots_[(start + i) % slots_.size()];
+        std::unique_lock<std::mutex> candidate(slot.mutex, std::try_to_lock);
+        if (candidate.owns_lock()) {
+            lock = std::move(candidate);
+            return slot;
+        }
+    }
+
+    // 所有实例都在使用中，排队等待起始实例
+    Slot& slot = *slots_[start % slots_.size()];
+    lock = std::unique_lock<std::mutex>(slot.mutex);
+    return slot;
+}
+
+std::vector<int32_t> TokenizerPool::encode(const std::string& text) {
+    std::unique_lock<std::mutex> lock;
+    Slot& slot = lock_slot(lock);
+    return slot.tokenizer->Encode(text);
+}
+
+int32_t TokenizerPool::token_to_id(const std::string& token) {
+    std::unique_lock<std::mutex> lock;
+    Slot& slot = lock_slot(lock);
+    return slot.tokenizer->TokenToId(token);
+}
+
+void TokenizerPool::run_job(Job& job, Slot& slot) {
+    const size_t total = job.total;
+    size_t finished = 0;
+    for (size_t index = job.next.fetch_add(1); index < total; index = job.next.fetch_add(1)) {
+        try {
+            (*job.results)[index] = slot.tokenizer->Encode((*job.texts)[index]);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.done_mutex);
+            if (!job.error) job.error = std::current_exception();
+        }
+        ++finished;
+    }
+
+    if (finished > 0 && job.completed.fetch_add(finished) + finished == total) {
+        std::lock_guard<std::mutex> lock(job.done_mutex);
+        job.done_cv.notify_all();
+    }
+}
+
+void TokenizerPool::worker_loop() {
+    uint64_t seen_generation = 0;
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            state_cv_.wait(lock, [&] { return stopping_ || job_generation_ != seen_generation; });
+            if (stopping_) return;
+            seen_generation = job_generation_;
+            job = current_job_;
+        }
+        if (!job || job->next.load(std::memory_order_relaxed) >= job->total) continue;
+
+        std::unique_lock<std::mutex> slot_lock;
+        Slot& slot = lock_slot(slot_lock);
+        run_job(*job, slot);
+    }
+}
+
+std::vector<std::vector<int32_t>> TokenizerPool::encode_batch(const std::vector<std::string>& texts) {
+    std::vector<std::vector<int32_t>> results(texts.size());
+    if (texts.empty()) return results;
+
+    // 条数太少、没有辅助线程或已有并行任务在跑时，用一个实例串行编码
+    std::unique_lock<std::mutex> job_lock(job_mutex_, std::defer_lock);
+    if (texts.size() < options_.parallel_threshold || workers_.empty() || !job_lock.try_lock()) {
+        std::unique_lock<std::mutex> slot_lock;
+        Slot& slot = lock_slot(slot_lock);
+        for (size_t i = 0; i < texts.size(); ++i) results[i] = slot.tokenizer->Encode(texts[i]);
+        return results;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->texts = &texts;
+    job->results = &results;
+    job->total = texts.size();
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        current_job_ = job;
+        ++job_generation_;
+    }
+    state_cv_.notify_all();
+
+    {
+        std::unique_lock<std::mutex> slot_lock;
+        Slot& slot = lock_slot(slot_lock);
+        run_job(*job, slot);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(job->done_mutex);
+        job->done_cv.wait(lock, [&] { return job->completed.load() == texts.size(); });
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        current_job_.reset();
+    }
+
+    if (job->error) std::rethrow_exception(job->error);
+    return results;
+}
+
+SpecialTokens find_special_tokens(TokenizerPool& tokenizer) {
+    auto first_known = [&](std::initializer_list<const char*> candidates) -> std::optional<int32_t> {
+        for (const char* token : candidates) {
+            int32_t id = tokenizer.token_to_id(token);
+            if (id != -1) return id;
+        }
+        return std::nullopt;
+    };
+
+    SpecialTokens tokens;
+    tokens.bos = first_known({"[CLS]", "<s>"});
+    tokens.eos = first_known({"[SEP]", "</s>"});
+    tokens.pad = first_known({"[PAD]", "<pad>"});
+    tokens.roberta_style = tokens.bos && tokens.bos == first_known({"<s>"});
+    return tokens;
+}
+
+std::unique_ptr<TokenizerPool> load_tokenizer_pool(const std::string& json_path, TokenizerPoolOptions options) {
+    if (!std::filesystem::exists(json_path)) {
+        throw std::runtime_error("Tokenizer file does not exist: " + json_path);
+    }
+
+    // mmap 后一次性拷贝，代替逐字符的 istreambuf_iterator 读取
+    MappedFile file = MappedFile::open_read_only(json_path);
+    std::string json_blob(static_cast<const char*>(file.data()), file.size());
+    file.close();
+
+    return std::make_unique<TokenizerPool>(json_blob, options);
+}
+
+} // namespace text_embedding
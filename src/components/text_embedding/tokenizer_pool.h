@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace text_embedding {
+
+struct TokenizerPoolOptions {
+    // tokenizer 实例数，每个实例独立持有词表；0 表示 min(CPU 核数, 4)
+    size_t num_instances = 0;
+    // 批量编码条数达到该值才拆分到多个线程
+    size_t parallel_threshold = 8;
+};
+
+// tokenizers-cpp 的 Tokenizer 把编码结果暂存在实例内部，不能被多个线程同时使用。
+// TokenizerPool 持有多个由同一份 tokenizer.json 创建的实例：单条编码优先 try_lock 空闲实例，
+// 批量编码由常驻的辅助线程与调用线程各占一个实例并行处理。
+class TokenizerPool {
+public:
+    TokenizerPool(const std::string& json_blob, TokenizerPoolOptions options = {});
+    ~TokenizerPool();
+
+    TokenizerPool(const TokenizerPool&) = delete;
+    TokenizerPool& operator=(const TokenizerPool&) = delete;
+
+    std::vector<int32_t> encode(const std::string& text);
+    // 结果顺序与 texts 一致
+    std::vector<std::vector<int32_t>> encode_batch(const std::vector<std::string>& texts);
+    // 不存在时返回 -1
+    int32_t token_to_id(const std::string& token);
+
+    size_t size() const { return slots_.size(); }
+
+private:
+    struct Slot;
+    struct Job;
+
+    Slot& lock_slot(std::unique_lock<std::mutex>& lock);
+    static void run_job(Job& job, Slot& slot);
+    void worker_loop();
+
+    TokenizerPoolOptions options_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::atomic<size_t> next_slot_{0};
+
+    std::vector<std::thread> workers_;
+    std::mutex job_mutex_;  // 同一时刻只运行一个并行批量任务，其余调用方直接串行编码
+    std::mutex state_mutex_;
+    std::condition_variable state_cv_;
+    std::shared_ptr<Job> current_job_;
+    uint64_t job_generation_ = 0;
+    bool stopping_ = false;
+};
+
+// 特殊 token：依次尝试 BERT（[CLS]/[SEP]/[PAD]）与 RoBERTa/XLM-R（<s>/</s>/<pad>）两种写法
+struct SpecialTokens {
+    std::optional<int32_t> bos;
+    std::optional<int32_t> eos;
+    std::optional<int32_t> pad;
+    bool roberta_style = false;  // <s>/</s> 风格，句对之间用两个分隔符
+};
+
+SpecialTokens find_special_tokens(TokenizerPool& tokenizer);
+
+// 读取 tokenizer.json 创建 TokenizerPool，文件不存在或解析失败时抛出 std::runtime_error
+std::unique_ptr<TokenizerPool> load_tokenizer_pool(const std::string& json_path, TokenizerPoolOptions options = {});
+
+} // namespace text_embedding
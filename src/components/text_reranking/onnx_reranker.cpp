@@ -0,0 +1,278 @@
+#include "onnx_reranker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "logger.h"
+#include "long_text.h"
+#include "ort_runtime.h"
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// 预热在加载线程上执行；旧模型同时仍在服务，只跳过本线程的计数，不影响线上请求的统计
+thread_local bool t_warming_up = false;
+
+struct WarmupScope {
+    WarmupScope() { t_warming_up = true; }
+    ~WarmupScope() { t_warming_up = false; }
+};
+
+} // namespace
+
+namespace text_reranking {
+
+using text_embedding::ModelPrecision;
+
+// 一个已加载模型的全部状态，发布后只读
+struct OnnxRuntimeReranker::Model {
+    std::string model_path;
+    ModelPrecision precision = ModelPrecision::FP32;
+
+    std::unique_ptr<text_embedding::TokenizerPool> tokenizer;
+    PairTemplate pair_template;
+    int64_t pad_token_id = 0;
+    size_t max_length = 0;
+
+    std::unique_ptr<text_embedding::SessionPool> sessions;
+    std::vector<std::string> input_names;  // input_ids, attention_mask[, token_type_ids]
+    std::vector<const char*> input_name_ptrs;
+    std::string output_name;
+};
+
+OnnxRuntimeReranker::OnnxRuntimeReranker(OnnxRerankerOptions options)
+    : options_(std::move(options)),
+      memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {}
+
+OnnxRuntimeReranker::~OnnxRuntimeReranker() {
+    unload_model();
+}
+
+bool OnnxRuntimeReranker::load_model(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    try {
+        ModelPtr model = build_model(model_path);
+        std::atomic_store(&current_, model);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[Reranker] Failed to load model " << model_path << ": " << e.what();
+        return false;
+    }
+}
+
+void OnnxRuntimeReranker::unload_model() {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    std::atomic_store(&current_, ModelPtr());
+}
+
+std::shared_ptr<OnnxRuntimeReranker::Model> OnnxRuntimeReranker::build_model(const std::string& model_path) {
+    const auto start = std::chrono::steady_clock::now();
+    auto model = std::make_shared<Model>();
+    model->model_path = model_path;
+
+    model->precision = options_.precision;
+    const std::string model_file = text_embedding::resolve_model_file(model_path, model->precision);
+
+    model->tokenizer = text_embedding::load_tokenizer_pool(model_path + "tokenizer.json", options_.tokenizer);
+    const auto special = text_embedding::find_special_tokens(*model->tokenizer);
+    model->pair_template.bos = special.bos;
+    model->pair_template.eos = special.eos;
+    model->pair_template.double_separator = special.roberta_style;
+    model->pad_token_id = special.pad.value_or(0);
+
+    model->max_length = options_.max_length > 0 ? options_.max_length
+                                                : text_embedding::read_model_max_length(model_path);
+    pair_content_budget(model->pair_template, model->max_length);  // 长度不足时抛出
+
+    const auto& pool_options = options_.session;
+    Ort::Env& env = text_embedding::shared_ort_env(
+        pool_options.use_global_thread_pool ? &pool_options.global_thread_pool : nullptr);
+    model->sessions = std::make_unique<text_embedding::SessionPool>(env, model_file, pool_options);
+    resolve_model_io(*model);
+    warm_up(*model);
+
+    LOG_INFO << "[Reranker] Loaded " << model_file << " (" << text_embedding::precision_name(model->precision)
+             << "), max length: " << model->max_length << ", inputs: " << model->input_names.size()
+             << ", pair format: " << (special.roberta_style ? "roberta" : "bert")
+             << ", sessions: " << model->sessions->size() << ", load: " << elapsed_ms(start) << " ms";
+    return model;
+}
+
+void OnnxRuntimeReranker::resolve_model_io(Model& model) {
+    Ort::Session& session = model.sessions->primary();
+
+    auto model_inputs = session.GetInputNames();
+    model.input_names = {"input_ids", "attention_mask"};
+    for (const auto& required : model.input_names) {
+        if (std::find(model_inputs.begin(), model_inputs.end(), required) == model_inputs.end()) {
+            throw std::runtime_error("Model is missing required input: " + required);
+        }
+    }
+    // BERT 系 cross-encoder 依赖句子类型区分 query 与 passage
+    if (std::find(model_inputs.begin(), model_inputs.end(), "token_type_ids") != model_inputs.end()) {
+        model.input_names.push_back("token_type_ids");
+    }
+    model.input_name_ptrs.clear();
+    for (const auto& name : model.input_names) model.input_name_ptrs.push_back(name.c_str());
+
+    auto output_names = session.GetOutputNames();
+    if (output_names.empty()) {
+        throw std::runtime_error("Model has no outputs.");
+    }
+    auto it = std::find(output_names.begin(), output_names.end(), "logits");
+    if (it == output_names.end()) it = output_names.begin();
+    model.output_name = *it;
+
+    auto output_info = session.GetOutputTypeInfo(it - output_names.begin()).GetTensorTypeAndShapeInfo();
+    if (output_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+        throw std::runtime_error("Model output " + model.output_name + " is not float32; "
+                                 "export fp16 models with keep_io_types enabled.");
+    }
+}
+
+void OnnxRuntimeReranker::warm_up(const Model& model) {
+    if (options_.warmup_runs == 0) return;
+
+    const std::vector<int32_t> query = model.tokenizer->encode("warm up query");
+    const std::vector<std::string> passages = {"warm up", "人工智能正在改变世界。The quick brown fox jumps over the lazy dog."};
+    std::vector<float> scores(passages.size());
+    // 预热不计入统计
+    WarmupScope warmup_scope;
+    // 空闲时 acquire 轮转，每轮覆盖所有 Session
+    for (size_t run = 0; run < options_.warmup_runs * model.sessions->size(); ++run) {
+        score_range(model, query, passages, 0, passages.size(), scores);
+    }
+}
+
+OnnxRuntimeReranker::ModelPtr OnnxRuntimeReranker::acquire_model() const {
+    ModelPtr model = std::atomic_load(&current_);
+    if (!model) {
+        throw std::runtime_error("Model not loaded. Call load_model first.");
+    }
+    return model;
+}
+
+size_t OnnxRuntimeReranker::max_length() const {
+    ModelPtr model = std::atomic_load(&current_);
+    return model ? model->max_length : 0;
+}
+
+text_embedding::PaddingStats OnnxRuntimeReranker::padding_stats() const {
+    text_embedding::PaddingStats stats;
+    stats.useful_tokens = useful_tokens_.load(std::memory_order_relaxed);
+    stats.computed_tokens = computed_tokens_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::vector<float> OnnxRuntimeReranker::score(const std::string& query, const std::vector<std::string>& passages) {
+    ModelPtr model = acquire_model();
+    std::vector<float> scores(passages.size());
+    if (passages.empty()) return scores;
+
+    const auto query_ids = model->tokenizer->encode(query);
+    score_range(*model, query_ids, passages, 0, passages.size(), scores);
+    return scores;
+}
+
+std::vector<RerankResult> OnnxRuntimeReranker::rerank(const std::string& query,
+                                                      const std::vector<std::string>& passages,
+                                                      size_t top_k) {
+    return rerank(query, passages, top_k, nullptr);
+}
+
+std::vector<RerankResult> OnnxRuntimeReranker::rerank(const std::string& query,
+                                                      const std::vector<std::string>& passages,
+                                                      size_t top_k,
+                                                      RerankStats* stats) {
+    ModelPtr model = acquire_model();
+    const auto query_ids = model->tokenizer->encode(query);
+    return staged_rerank(passages.size(), top_k, options_.early_cut,
+                         [&](size_t begin, size_t end, std::vector<float>& scores) {
+                             score_range(*model, query_ids, passages, begin, end, scores);
+                         },
+                         stats);
+}
+
+void OnnxRuntimeReranker::score_range(const Model& model,
+                                      const std::vector<int32_t>& query_ids,
+                                      const std::vector<std::string>& passages,
+                                      size_t begin, size_t end,
+                                      std::vector<float>& scores) {
+    // 只编码本阶段的候选，query 在整个请求内只编码一次
+    const std::vector<std::string> stage(passages.begin() + begin, passages.begin() + end);
+    auto passage_ids = model.tokenizer->encode_batch(stage);
+
+    std::vector<PairRow> rows;
+    std::vector<size_t> lengths;
+    rows.reserve(stage.size());
+    lengths.reserve(stage.size());
+    for (const auto& ids : passage_ids) {
+        rows.push_back(build_pair_row(query_ids, ids, model.pair_template, model.max_length, options_.max_query_length));
+        lengths.push_back(rows.back().input_ids.size());
+    }
+
+    // 按长度分桶组批：top-N 候选只需 N / max_batch_size 次左右的 Session::Run
+    auto batches = text_embedding::plan_length_buckets(lengths, options_.bucketing);
+    if (!t_warming_up) {
+        auto stats = text_embedding::compute_padding_stats(lengths, batches);
+        useful_tokens_.fetch_add(stats.useful_tokens, std::memory_order_relaxed);
+        computed_tokens_.fetch_add(stats.computed_tokens, std::memory_order_relaxed);
+    }
+
+    for (const auto& batch : batches) {
+        run_batch(model, rows, batch, scores.data() + begin);
+    }
+}
+
+void OnnxRuntimeReranker::run_batch(const Model& model, const std::vector<PairRow>& rows,
+                                    const std::vector<size_t>& batch, float* scores) {
+    size_t max_len = 0;
+    for (size_t index : batch) max_len = std::max(max_len, rows[index].input_ids.size());
+
+    // 按批内最长句对补齐，补齐位置的 attention mask 为 0
+    const size_t batch_size = batch.size();
+    std::vector<int64_t> input_ids(batch_size * max_len, model.pad_token_id);
+    std::vector<int64_t> attention_mask(batch_size * max_len, 0);
+    std::vector<int64_t> token_type_ids(batch_size * max_len, 0);
+    for (size_t row = 0; row < batch_size; ++row) {
+        const PairRow& pair = rows[batch[row]];
+        std::copy(pair.input_ids.begin(), pair.input_ids.end(), input_ids.begin() + row * max_len);
+        std::copy(pair.token_type_ids.begin(), pair.token_type_ids.end(), token_type_ids.begin() + row * max_len);
+        std::fill_n(attention_mask.begin() + row * max_len, pair.input_ids.size(), 1);
+    }
+
+    const int64_t shape[2] = {static_cast<int64_t>(batch_size), static_cast<int64_t>(max_len)};
+    std::vector<Ort::Value> inputs;
+    inputs.push_back(Ort::Value::CreateTensor<int64_t>(memory_info_, input_ids.data(), input_ids.size(), shape, 2));
+    inputs.push_back(Ort::Value::CreateTensor<int64_t>(memory_info_, attention_mask.data(), attention_mask.size(), shape, 2));
+    if (model.input_names.size() > 2) {
+        inputs.push_back(Ort::Value::CreateTensor<int64_t>(memory_info_, token_type_ids.data(), token_type_ids.size(), shape, 2));
+    }
+
+    const char* output_names[] = {model.output_name.c_str()};
+    std::vector<Ort::Value> outputs;
+    {
+        auto lease = model.sessions->acquire();
+        outputs = lease.session().Run(Ort::RunOptions{nullptr}, model.input_name_ptrs.data(), inputs.data(),
+                                      inputs.size(), output_names, 1);
+    }
+    if (!t_warming_up) session_runs_.fetch_add(1, std::memory_order_relaxed);
+
+    // logits 形状为 [batch]、[batch, 1] 或二分类的 [batch, 2]
+    const size_t elements = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+    const size_t columns = elements / batch_size;
+    if (elements % batch_size != 0 || columns == 0 || columns > 2) {
+        throw std::runtime_error("Unexpected reranker output size " + std::to_string(elements) +
+                                 " for batch of " + std::to_string(batch_size));
+    }
+    const float* logits = outputs[0].GetTensorData<float>();
+    for (size_t row = 0; row < batch_size; ++row) {
+        scores[batch[row]] = pair_score(logits + row * columns, columns, options_.sigmoid);
+    }
+}
+
+} // namespace text_reranking
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "text_reranking.h"
+#include "length_bucketing.h"
+#include "onnx_embedding.h"
+#include "pair_encoding.h"
+#include "session_pool.h"
+#include "staged_rerank.h"
+#include "tokenizer_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <onnxruntime/onnxruntime_cxx_api.h>
+
+namespace text_reranking {
+
+struct OnnxRerankerOptions {
+    // 模型精度；对应文件不存在时回退到 fp32 的 model.onnx
+    text_embedding::ModelPrecision precision = text_embedding::ModelPrecision::FP32;
+    // 含特殊 token 的句对最大长度；0 表示从模型目录的配置文件读取
+    size_t max_length = 0;
+    // query 的最大 token 数（不含特殊 token），0 表示不单独限制
+    size_t max_query_length = 64;
+    // 对 logit 做 sigmoid，输出 (0, 1) 的相关概率；排序结果不变
+    bool sigmoid = false;
+
+    text_embedding::TokenizerPoolOptions tokenizer;
+    // 句对普遍较长，桶上界从 64 起；单次推理条数决定 top-N 需要几次 Session::Run
+    text_embedding::BucketingOptions bucketing{{64, 128, 256, 512}, 64};
+    text_embedding::SessionPoolOptions session;
+    // rerank 的分阶段打分，score 不受影响
+    EarlyCutOptions early_cut;
+    // load_model 返回前每个 Session 的预热轮数
+    size_t warmup_runs = 0;
+};
+
+// 基于 ONNX Runtime 的 cross-encoder 重排序（bge-reranker、ms-marco-MiniLM 等）。
+// 复用 text_embedding 的 TokenizerPool / SessionPool / 长度分桶；模型状态与 OnnxRuntimeEmbedding
+// 一样整体封装为不可变快照，load_model 构建完成后原子替换，在途请求不受影响。
+class OnnxRuntimeReranker : public TextReranking {
+public:
+    explicit OnnxRuntimeReranker(OnnxRerankerOptions options = {});
+    ~OnnxRuntimeReranker() override;
+
+    bool load_model(const std::string& model_path) override;
+    void unload_model() override;
+
+    std::vector<float> score(const std::string& query, const std::vector<std::string>& passages) override;
+    std::vector<RerankResult> rerank(const std::string& query,
+                                     const std::vector<std::string>& passages,
+                                     size_t top_k) override;
+    // stats 非空时返回实际打分的候选数与阶段数
+    std::vector<RerankResult> rerank(const std::string& query,
+                                     const std::vector<std::string>& passages,
+                                     size_t top_k,
+                                     RerankStats* stats);
+
+    // 句对最大长度，在 load_model 时确定
+    size_t max_length() const;
+    // 累计的 Session::Run 调用次数
+    uint64_t session_runs() const { return session_runs_.load(std::memory_order_relaxed); }
+    text_embedding::PaddingStats padding_stats() const;
+
+private:
+    struct Model;
+    using ModelPtr = std::shared_ptr<const Model>;
+
+    OnnxRerankerOptions options_;
+    Ort::MemoryInfo memory_info_;
+
+    // 只通过 std::atomic_load / std::atomic_store 访问
+    ModelPtr current_;
+    std::mutex load_mutex_;
+
+    std::atomic<uint64_t> session_runs_{0};
+    std::atomic<uint64_t> useful_tokens_{0};
+    std::atomic<uint64_t> computed_tokens_{0};
+
+    ModelPtr acquire_model() const;
+    std::shared_ptr<Model> build_model(const std::string& model_path);
+    void resolve_model_io(Model& model);
+    void warm_up(const Model& model);
+
+    void score_range(const Model& model,
+                     const std::vector<int32_t>& query_ids,
+                     const std::vector<std::string>& passages,
+                     size_t begin, size_t end,
+                     std::vector<float>& scores);
+    void run_batch(const Model& model, const std::vector<PairRow>& rows,
+                   const std::vector<size_t>& batch, float* scores);
+};
+
+} // namespace text_reranking
@@ -0,0 +1,54 @@
+#include "pair_encoding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace text_reranking {
+
+size_t pair_content_budget(const PairTemplate& tpl, size_t max_length) {
+    size_t specials = (tpl.bos ? 1 : 0) + (tpl.eos ? (tpl.double_separator ? 3 : 2) : 0);
+    if (max_length <= specials + 1) {
+        throw std::invalid_argument("Max length " + std::to_string(max_length) + " leaves no room for a text pair");
+    }
+    return max_length - specials;
+}
+
+PairRow build_pair_row(const std::vector<int32_t>& query,
+                       const std::vector<int32_t>& passage,
+                       const PairTemplate& tpl,
+                       size_t max_length,
+                       size_t max_query_tokens) {
+    const size_t budget = pair_content_budget(tpl, max_length);
+    size_t query_len = std::min(query.size(), budget - 1);
+    if (max_query_tokens > 0) query_len = std::min(query_len, max_query_tokens);
+    const size_t passage_len = std::min(passage.size(), budget - query_len);
+
+    PairRow row;
+    auto& ids = row.input_ids;
+    ids.reserve(query_len + passage_len + 4);
+    if (tpl.bos) ids.push_back(*tpl.bos);
+    ids.insert(ids.end(), query.begin(), query.begin() + query_len);
+    if (tpl.eos) {
+        ids.push_back(*tpl.eos);
+        if (tpl.double_separator) ids.push_back(*tpl.eos);
+    }
+    const size_t first_segment = ids.size();
+    ids.insert(ids.end(), passage.begin(), passage.begin() + passage_len);
+    if (tpl.eos) ids.push_back(*tpl.eos);
+
+    // RoBERTa 系模型没有句子类型嵌入，token_type_ids 全为 0
+    row.token_type_ids.assign(ids.size(), 0);
+    if (!tpl.double_separator) {
+        std::fill(row.token_type_ids.begin() + first_segment, row.token_type_ids.end(), 1);
+    }
+    return row;
+}
+
+float pair_score(const float* logits, size_t columns, bool sigmoid) {
+    const float logit = columns == 2 ? logits[1] - logits[0] : logits[0];
+    return sigmoid ? 1.0f / (1.0f + std::exp(-logit)) : logit;
+}
+
+} // namespace text_reranking
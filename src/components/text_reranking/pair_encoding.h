@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace text_reranking {
+
+// 句对拼接模板：
+//   BERT 风格        [CLS] query [SEP] passage [SEP]
+//   RoBERTa/XLM-R   <s> query </s></s> passage </s>
+struct PairTemplate {
+    std::optional<int32_t> bos;
+    std::optional<int32_t> eos;
+    bool double_separator = false;
+};
+
+struct PairRow {
+    std::vector<int64_t> input_ids;
+    std::vector<int64_t> token_type_ids;  // query 段为 0，passage 段为 1（RoBERTa 风格全为 0）
+};
+
+// 特殊 token 之外可容纳的 query + passage token 数
+size_t pair_content_budget(const PairTemplate& tpl, size_t max_length);
+
+// 按 HuggingFace 的 truncation="only_second" 拼接句对：
+// query 先截断到 max_query_tokens（0 表示不单独限制，但至少为 passage 留一个 token），
+// 剩余长度留给 passage，超出部分从尾部截断
+PairRow build_pair_row(const std::vector<int32_t>& query,
+                       const std::vector<int32_t>& passage,
+                       const PairTemplate& tpl,
+                       size_t max_length,
+                       size_t max_query_tokens);
+
+// 由模型一行输出计算相关性分数：单列 logits 直接取值；二分类 [batch, 2] 取 l1 - l0，
+// 其 sigmoid 即 softmax 的正类概率（只取 l1 与 softmax 排序不一致）。sigmoid 为 true 时输出 (0, 1)
+float pair_score(const float* logits, size_t columns, bool sigmoid);
+
+} // namespace text_reranking
@@ -0,0 +1,67 @@
+#include "staged_rerank.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace text_reranking {
+
+std::vector<RerankResult> select_top_k(const std::vector<float>& scores, size_t count, size_t top_k) {
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    top_k = std::min(top_k, count);
+    std::partial_sort(order.begin(), order.begin() + top_k, order.end(), [&](size_t a, size_t b) {
+        return scores[a] != scores[b] ? scores[a] > scores[b] : a < b;
+    });
+
+    std::vector<RerankResult> results;
+    results.reserve(top_k);
+    for (size_t i = 0; i < top_k; ++i) results.push_back({order[i], scores[order[i]]});
+    return results;
+}
+
+std::vector<RerankResult> staged_rerank(size_t count, size_t top_k, const EarlyCutOptions& options,
+                                        const ScoreRange& score_range, RerankStats* stats) {
+    std::vector<float> scores(count);
+    size_t scored = 0;
+    size_t stages = 0;
+    auto score_until = [&](size_t end) {
+        score_range(scored, end, scores);
+        scored = end;
+        ++stages;
+    };
+
+    if (count > 0 && top_k > 0) {
+        if (!options.enabled) {
+            score_until(count);
+        } else {
+            const size_t stage_size = std::max<size_t>(options.stage_size, 1);
+            const size_t first_stage = options.first_stage > 0 ? options.first_stage : std::max(2 * top_k, stage_size);
+            score_until(std::min(count, std::max(first_stage, top_k)));
+
+            // 比较的是 top-k 的下标集合，名次内部的顺序变化不影响停止判断
+            auto top_set = [&] {
+                std::vector<size_t> ids;
+                for (const auto& result : select_top_k(scores, scored, top_k)) ids.push_back(result.index);
+                std::sort(ids.begin(), ids.end());
+                return ids;
+            };
+            auto current = top_set();
+            size_t stable = 0;
+            while (scored < count && stable < options.patience) {
+                score_until(std::min(count, scored + stage_size));
+                auto next = top_set();
+                stable = (next == current) ? stable + 1 : 0;
+                current = std::move(next);
+            }
+        }
+    }
+
+    if (stats) {
+        stats->candidates = count;
+        stats->scored = scored;
+        stats->stages = stages;
+    }
+    return select_top_k(scores, scored, top_k);
+}
+
+} // namespace text_reranking
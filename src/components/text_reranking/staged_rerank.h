@@ -0,0 +1,37 @@
+#pragma once
+
+#include "text_reranking.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace text_reranking {
+
+// 分阶段打分（early cut）：候选按召回阶段的名次排列时，靠后的候选很少进入最终 top-k。
+// 先为前 first_stage 个候选打分，之后每次追加 stage_size 个，
+// top-k 集合连续 patience 个阶段不变即停止，剩余候选不再打分。
+struct EarlyCutOptions {
+    bool enabled = false;
+    size_t first_stage = 0;  // 0 表示 max(2 * top_k, stage_size)
+    size_t stage_size = 16;
+    size_t patience = 1;
+};
+
+struct RerankStats {
+    size_t candidates = 0;  // 输入候选数
+    size_t scored = 0;      // 实际打分的候选数
+    size_t stages = 0;      // 打分阶段数（每阶段一次批量推理）
+};
+
+// 按分数从高到低选出 top_k，同分时下标小的在前
+std::vector<RerankResult> select_top_k(const std::vector<float>& scores, size_t count, size_t top_k);
+
+// 为 [begin, end) 范围的候选打分，结果写入 scores[begin, end)
+using ScoreRange = std::function<void(size_t begin, size_t end, std::vector<float>& scores)>;
+
+// 未启用 early cut 时一次为全部候选打分
+std::vector<RerankResult> staged_rerank(size_t count, size_t top_k, const EarlyCutOptions& options,
+                                        const ScoreRange& score_range, RerankStats* stats = nullptr);
+
+} // namespace text_reranking
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace text_reranking {
+
+struct RerankResult {
+    size_t index = 0;    // 候选在输入 passages 中的下标
+    float score = 0.0f;  // 越大越相关
+};
+
+class TextReranking {
+public:
+    virtual ~TextReranking() = default;
+
+    // 加载模型
+    virtual bool load_model(const std::string& model_path) = 0;
+
+    // 卸载模型
+    virtual void unload_model() = 0;
+
+    // 对每个 (query, passage) 打分，顺序与 passages 一致
+    virtual std::vector<float> score(const std::string& query, const std::vector<std::string>& passages) = 0;
+
+    // 返回得分最高的至多 top_k 个候选，按分数从高到低
+    virtual std::vector<RerankResult> rerank(const std::string& query,
+                                             const std::vector<std::string>& passages,
+                                             size_t top_k) = 0;
+};
+
+} // namespace text_reranking
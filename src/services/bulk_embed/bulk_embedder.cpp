@@ -0,0 +1,372 @@
+#include "bulk_embedder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "json.h"
+#include "logger.h"
+
+namespace bulk_embed {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// 写临时文件并 fsync 后 rename，崩溃时旧检查点保持完整
+bool write_file_atomically(const std::string& path, const std::string& content) {
+    const std::string tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    const bool ok = ::write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()) &&
+                    ::fsync(fd) == 0;
+    ::close(fd);
+    return ok && std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+} // namespace
+
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint) {
+    std::string out = "{\"input_path\":";
+    http_service::append_json_string(out, checkpoint.input_path);
+    out += ",\"input_offset\":" + std::to_string(checkpoint.input_offset);
+    out += ",\"records\":" + std::to_string(checkpoint.records);
+    out += ",\"ids_bytes\":" + std::to_string(checkpoint.ids_bytes);
+    out += ",\"skipped_lines\":" + std::to_string(checkpoint.skipped_lines);
+    out += ",\"dim\":" + std::to_string(checkpoint.dim);
+    out += ",\"completed\":";
+    out += checkpoint.completed ? "true" : "false";
+    out += "}\n";
+    if (!write_file_atomically(path, out)) {
+        LOG_ERROR << "[BulkEmbed] Failed to write checkpoint " << path;
+        return false;
+    }
+    return true;
+}
+
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string content = buffer.str();
+
+    Checkpoint loaded;
+    try {
+        http_service::JsonReader reader(content);
+        std::string key;
+        reader.begin_object();
+        while (reader.next_key(key)) {
+            if (key == "input_path") {
+                reader.read_string(loaded.input_path);
+            } else if (key == "input_offset") {
+                loaded.input_offset = static_cast<uint64_t>(reader.read_number());
+            } else if (key == "records") {
+                loaded.records = static_cast<uint64_t>(reader.read_number());
+            } else if (key == "ids_bytes") {
+                loaded.ids_bytes = static_cast<uint64_t>(reader.read_number());
+            } else if (key == "skipped_lines") {
+                loaded.skipped_lines = static_cast<uint64_t>(reader.read_number());
+            } else if (key == "dim") {
+                loaded.dim = static_cast<size_t>(reader.read_number());
+            } else if (key == "completed") {
+                loaded.completed = reader.read_bool();
+            } else {
+                reader.skip_value();
+            }
+        }
+        reader.expect_end();
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[BulkEmbed] Invalid checkpoint " << path << ": " << e.what();
+        return false;
+    }
+    checkpoint = std::move(loaded);
+    return true;
+}
+
+BulkEmbedder::BulkEmbedder(text_embedding::TextEmbedding& model, BulkEmbedOptions options)
+    : model_(model), options_(std::move(options)) {
+    if (options_.ids_path.empty()) options_.ids_path = options_.output_path + ".ids";
+    if (options_.checkpoint_path.empty()) options_.checkpoint_path = options_.output_path + ".ckpt";
+    options_.batch_size = std::max<size_t>(options_.batch_size, 1);
+    options_.workers = std::max<size_t>(options_.workers, 1);
+    if (options_.max_in_flight_batches == 0) options_.max_in_flight_batches = options_.workers * 4;
+    options_.checkpoint_every = std::max<uint64_t>(options_.checkpoint_every, 1);
+}
+
+void BulkEmbedder::stop() {
+    stop_.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_all();
+}
+
+BulkEmbedStats BulkEmbedder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BulkEmbedder::fail(const std::string& message) {
+    LOG_ERROR << "[BulkEmbed] " << message;
+    stop_.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = true;
+    cv_.notify_all();
+}
+
+void BulkEmbedder::read_loop(CorpusReader& reader, BatchQueue& queue) {
+    CorpusRecord record;
+    uint64_t seq = 0;
+    bool reached_end = false;
+    while (!stop_.load()) {
+        Batch batch;
+        batch.seq = seq;
+        batch.ids.reserve(options_.batch_size);
+        batch.texts.reserve(options_.batch_size);
+        while (batch.ids.size() < options_.batch_size) {
+            if (!reader.next(record)) {
+                reached_end = true;
+                break;
+            }
+            batch.ids.push_back(std::move(record.id));
+            batch.texts.push_back(std::move(record.text));
+        }
+        batch.end_offset = reader.offset();
+        batch.skipped_lines = reader.skipped_lines();
+        if (batch.ids.empty()) break;
+
+        {
+            // 限制在途批次数，写出跟不上时读取暂停
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return in_flight_ < options_.max_in_flight_batches || stop_.load(); });
+            if (stop_.load()) break;
+            ++in_flight_;
+            ++batches_read_;
+        }
+        if (!queue.push(batch)) break;
+        ++seq;
+        if (reached_end) break;
+    }
+    queue.close();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    reading_done_ = true;
+    reached_end_ = reached_end;
+    cv_.notify_all();
+}
+
+void BulkEmbedder::embed_loop(BatchQueue& queue) {
+    while (auto batch = queue.pop()) {
+        {
+            // 出错后剩余批次不再推理；提前停止时已读入的批次仍要完成
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (failed_) continue;
+        }
+        EmbeddedBatch result;
+        try {
+            result.vectors = model_.embed_batch(batch->texts);
+        } catch (const std::exception& e) {
+            fail("Embedding failed for batch starting at id " + batch->ids.front() + ": " + e.what());
+            continue;
+        }
+        if (result.vectors.size() != batch->texts.size()) {
+            fail("Model returned " + std::to_string(result.vectors.size()) + " vectors for " +
+                 std::to_string(batch->texts.size()) + " texts");
+            continue;
+        }
+        batch->texts.clear();
+        batch->texts.shrink_to_fit();
+        result.batch = std::move(*batch);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.emplace(result.batch.seq, std::move(result));
+        cv_.notify_all();
+    }
+}
+
+bool BulkEmbedder::run() {
+    Checkpoint checkpoint;
+    checkpoint.input_path = options_.input_path;
+    bool resumed = false;
+    if (options_.resume && std::filesystem::exists(options_.checkpoint_path)) {
+        if (!load_checkpoint(options_.checkpoint_path, checkpoint)) return false;
+        if (checkpoint.input_path != options_.input_path) {
+            LOG_ERROR << "[BulkEmbed] Checkpoint " << options_.checkpoint_path << " belongs to input "
+                      << checkpoint.input_path << ", not " << options_.input_path;
+            return false;
+        }
+        if (checkpoint.completed) {
+            LOG_INFO << "[BulkEmbed] Checkpoint says " << options_.input_path << " is already complete ("
+                     << checkpoint.records << " records)";
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.total_records = checkpoint.records;
+            stats_.resumed_from = checkpoint.records;
+            stats_.skipped_lines = checkpoint.skipped_lines;
+            stats_.completed = true;
+            return true;
+        }
+        resumed = true;
+    }
+
+    std::unique_ptr<CorpusReader> reader;
+    std::unique_ptr<VectorWriter> writer;
+    try {
+        reader = std::make_unique<CorpusReader>(options_.input_path, options_.corpus);
+        reader->seek(checkpoint.input_offset);
+        if (resumed && checkpoint.dim > 0) {
+            writer = std::make_unique<VectorWriter>(options_.output_path, options_.ids_path, options_.output_format,
+                                                    checkpoint.dim, checkpoint.records, checkpoint.ids_bytes);
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[BulkEmbed] " << e.what();
+        return false;
+    }
+    if (resumed) {
+        LOG_INFO << "[BulkEmbed] Resuming from record " << checkpoint.records << " at byte "
+                 << checkpoint.input_offset << " of " << reader->size();
+    }
+
+    const size_t input_bytes = reader->size();
+    const uint64_t resumed_from = checkpoint.records;
+    const auto start = Clock::now();
+    auto last_report = start;
+    uint64_t last_report_records = 0;
+    uint64_t written = 0;
+    uint64_t since_checkpoint = 0;
+    uint64_t processed_offset = checkpoint.input_offset;
+    uint64_t skipped_lines = checkpoint.skipped_lines;
+    bool ok = true;
+
+    // 在已落盘的数据之后推进检查点
+    auto save_progress = [&](bool completed) {
+        Checkpoint progress;
+        progress.input_path = options_.input_path;
+        progress.input_offset = processed_offset;
+        progress.skipped_lines = skipped_lines;
+        progress.completed = completed;
+        if (writer) {
+            writer->sync();
+            progress.records = writer->count();
+            progress.ids_bytes = writer->ids_bytes();
+            progress.dim = writer->dim();
+        }
+        return save_checkpoint(options_.checkpoint_path, progress);
+    };
+
+    BatchQueue queue(options_.max_in_flight_batches);
+    std::thread read_thread([&] { read_loop(*reader, queue); });
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < options_.workers; ++i) workers.emplace_back([&] { embed_loop(queue); });
+
+    uint64_t next_seq = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [&] {
+            return results_.count(next_seq) || failed_ || (reading_done_ && next_seq == batches_read_);
+        });
+        // 出错时仍写出已按序完成的批次，之后停止
+        auto it = results_.find(next_seq);
+        if (it == results_.end()) break;
+        EmbeddedBatch result = std::move(it->second);
+        results_.erase(it);
+        lock.unlock();
+
+        try {
+            if (!writer) {
+                writer = std::make_unique<VectorWriter>(options_.output_path, options_.ids_path,
+                                                        options_.output_format, result.vectors.front().size());
+            }
+            writer->append(result.batch.ids, result.vectors);
+            written += result.vectors.size();
+            since_checkpoint += result.vectors.size();
+            processed_offset = result.batch.end_offset;
+            skipped_lines = result.batch.skipped_lines;
+            if (since_checkpoint >= options_.checkpoint_every) {
+                if (!save_progress(false)) throw std::runtime_error("checkpoint not saved");
+                since_checkpoint = 0;
+            }
+        } catch (const std::exception& e) {
+            fail(std::string("Writing output failed: ") + e.what());
+            ok = false;
+            lock.lock();
+            break;
+        }
+
+        if (options_.report_interval.count() > 0 && Clock::now() - last_report >= options_.report_interval) {
+            const double elapsed = seconds_since(start);
+            const double window = std::chrono::duration<double>(Clock::now() - last_report).count();
+            const double progress = input_bytes ? 100.0 * processed_offset / input_bytes : 100.0;
+            const double consumed = static_cast<double>(processed_offset - checkpoint.input_offset);
+            const double eta = consumed > 0 ? elapsed * (input_bytes - processed_offset) / consumed : 0.0;
+            LOG_INFO << "[BulkEmbed] " << resumed_from + written << " records (" << progress << "% of input), "
+                     << (written - last_report_records) / window << " rec/s now, " << written / elapsed
+                     << " rec/s avg, eta " << static_cast<uint64_t>(eta) << " s";
+            last_report = Clock::now();
+            last_report_records = written;
+        }
+
+        lock.lock();
+        ++next_seq;
+        --in_flight_;
+        cv_.notify_all();
+    }
+    const bool failed = failed_;
+    lock.unlock();
+
+    // 出错或提前停止时让读线程退出，剩余批次直接丢弃
+    stop();
+    queue.close();
+    read_thread.join();
+    for (auto& worker : workers) worker.join();
+
+    const bool completed = ok && !failed && reached_end_;
+    if (ok) {
+        try {
+            ok = save_progress(completed);
+        } catch (const std::exception& e) {
+            LOG_ERROR << "[BulkEmbed] Final sync failed: " << e.what();
+            ok = false;
+        }
+    }
+    if (writer) {
+        try {
+            writer->close();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "[BulkEmbed] Closing output failed: " << e.what();
+            ok = false;
+        }
+    }
+
+    const double elapsed = seconds_since(start);
+    {
+        std::lock_guard<std::mutex> stats_lock(mutex_);
+        stats_.records = written;
+        stats_.total_records = resumed_from + written;
+        stats_.resumed_from = resumed_from;
+        stats_.skipped_lines = skipped_lines;
+        stats_.elapsed_s = elapsed;
+        stats_.records_per_second = elapsed > 0 ? written / elapsed : 0.0;
+        stats_.completed = completed && ok;
+    }
+    LOG_INFO << "[BulkEmbed] " << (completed ? "Finished" : "Stopped") << ": " << written << " records in "
+             << elapsed << " s (" << (elapsed > 0 ? written / elapsed : 0.0) << " rec/s), total "
+             << resumed_from + written << ", skipped lines " << skipped_lines;
+    if (!completed && ok) {
+        LOG_INFO << "[BulkEmbed] Progress saved to " << options_.checkpoint_path << ", rerun to resume";
+    }
+    return ok && !failed;
+}
+
+} // namespace bulk_embed
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "bounded_queue.h"
+#include "corpus_reader.h"
+#include "text_embedding.h"
+#include "vector_writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bulk_embed {
+
+struct BulkEmbedOptions {
+    std::string input_path;
+    CorpusOptions corpus;
+
+    std::string output_path;
+    VectorFormat output_format = VectorFormat::FVECS;
+    // 为空时分别使用 <output>.ids 与 <output>.ckpt
+    std::string ids_path;
+    std::string checkpoint_path;
+
+    // 单次 embed_batch 的条数
+    size_t batch_size = 64;
+    // 并发调用 embed_batch 的线程数，应与模型的 Session 数一致
+    size_t workers = 2;
+    // 已读入但尚未写出的批次上限（排队 + 推理中 + 等待按序写出），0 表示 workers 的 4 倍
+    size_t max_in_flight_batches = 0;
+    // 每写出这么多条向量落盘并保存一次检查点
+    uint64_t checkpoint_every = 50000;
+    // 存在检查点时从断点继续；否则从头开始并覆盖输出
+    bool resume = true;
+    // 大于 0 时按该间隔输出吞吐与进度
+    std::chrono::milliseconds report_interval{5000};
+};
+
+// 检查点只在向量与 id 文件 fdatasync 之后写出（先写临时文件再 rename），
+// 因此记录的进度总不超过已落盘的数据
+struct Checkpoint {
+    std::string input_path;
+    uint64_t input_offset = 0;  // 下一条未处理记录的字节偏移
+    uint64_t records = 0;       // 已落盘的向量条数
+    uint64_t ids_bytes = 0;     // id 文件的已落盘长度
+    uint64_t skipped_lines = 0;
+    size_t dim = 0;
+    bool completed = false;
+};
+
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint);
+// 文件不存在或格式错误时返回 false
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint);
+
+struct BulkEmbedStats {
+    uint64_t records = 0;        // 本次运行写出的条数
+    uint64_t total_records = 0;  // 含断点之前的
+    uint64_t resumed_from = 0;   // 续跑起点的条数
+    uint64_t skipped_lines = 0;
+    double elapsed_s = 0.0;
+    double records_per_second = 0.0;
+    bool completed = false;      // 整个语料已处理完
+};
+
+// 离线批量向量化：单线程顺序读取语料并切批，workers 个线程并发推理，结果按读入顺序写出，
+// 输出文件中的第 i 条向量总对应语料中的第 i 条有效记录
+class BulkEmbedder {
+public:
+    BulkEmbedder(text_embedding::TextEmbedding& model, BulkEmbedOptions options);
+
+    // 阻塞直到语料处理完、stop() 或出错；出错返回 false（已写出的部分可续跑）
+    bool run();
+
+    // 请求提前结束：不再读入新批次，已读入的批次写完并保存检查点后 run 返回
+    void stop();
+
+    BulkEmbedStats stats() const;
+
+private:
+    struct Batch {
+        uint64_t seq = 0;
+        std::vector<std::string> ids;
+        std::vector<std::string> texts;
+        uint64_t end_offset = 0;  // 该批最后一条记录之后的偏移
+        uint64_t skipped_lines = 0;
+    };
+
+    struct EmbeddedBatch {
+        Batch batch;
+        std::vector<std::vector<float>> vectors;
+    };
+
+    using BatchQueue = infinite_rag::BoundedQueue<Batch>;
+
+    text_embedding::TextEmbedding& model_;
+    BulkEmbedOptions options_;
+
+    std::atomic<bool> stop_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<uint64_t, EmbeddedBatch> results_;  // 等待按序写出
+    size_t in_flight_ = 0;
+    uint64_t batches_read_ = 0;
+    bool reading_done_ = false;
+    bool reached_end_ = false;
+    bool failed_ = false;
+    BulkEmbedStats stats_;
+
+    void read_loop(CorpusReader& reader, BatchQueue& queue);
+    void embed_loop(BatchQueue& queue);
+    void fail(const std::string& message);
+};
+
+} // namespace bulk_embed
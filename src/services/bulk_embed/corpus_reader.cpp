@@ -0,0 +1,133 @@
+#include "corpus_reader.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/mman.h>
+
+#include "json.h"
+#include "logger.h"
+
+namespace bulk_embed {
+
+namespace {
+
+// 只对前若干条坏行逐条告警，其余只计数
+constexpr uint64_t kMaxSkipWarnings = 10;
+
+bool ends_with(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void format_number_id(double value, std::string& out) {
+    char buffer[32];
+    const bool integral = std::fabs(value) < 9e18 && value == static_cast<double>(static_cast<long long>(value));
+    const int n = integral ? std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value))
+                           : std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out.assign(buffer, static_cast<size_t>(n));
+}
+
+} // namespace
+
+CorpusFormat corpus_format_from_path(const std::string& path) {
+    return ends_with(path, ".tsv") ? CorpusFormat::TSV : CorpusFormat::JSONL;
+}
+
+CorpusReader::CorpusReader(const std::string& path, CorpusOptions options)
+    : options_(std::move(options)), file_(text_embedding::MappedFile::open_read_only(path)) {
+    data_ = static_cast<const char*>(file_.data());
+    size_ = file_.size();
+    // 顺序访问：加大预读，已读过的页可被尽早回收
+    if (data_) ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
+
+void CorpusReader::seek(size_t offset) {
+    if (offset > size_) {
+        throw std::out_of_range("Corpus offset " + std::to_string(offset) + " beyond file size " +
+                                std::to_string(size_));
+    }
+    offset_ = offset;
+    line_number_ = 0;
+}
+
+bool CorpusReader::next(CorpusRecord& record) {
+    while (offset_ < size_) {
+        const char* begin = data_ + offset_;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', size_ - offset_));
+        const size_t length = newline ? static_cast<size_t>(newline - begin) : size_ - offset_;
+        offset_ += newline ? length + 1 : length;
+        ++line_number_;
+
+        std::string_view line(begin, length);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
+
+        const bool ok = options_.format == CorpusFormat::JSONL ? parse_jsonl(line, record) : parse_tsv(line, record);
+        if (ok) return true;
+        ++skipped_lines_;
+    }
+    return false;
+}
+
+bool CorpusReader::parse_jsonl(std::string_view line, CorpusRecord& record) {
+    bool has_id = false;
+    bool has_text = false;
+    try {
+        http_service::JsonReader reader(line);
+        reader.begin_object();
+        while (reader.next_key(key_)) {
+            if (key_ == options_.id_field) {
+                if (reader.peek() == http_service::JsonType::NUMBER) {
+                    format_number_id(reader.read_number(), record.id);
+                } else {
+                    reader.read_string(record.id);
+                }
+                has_id = true;
+            } else if (key_ == options_.text_field) {
+                reader.read_string(record.text);
+                has_text = true;
+            } else {
+                reader.skip_value();
+            }
+        }
+        reader.expect_end();
+    } catch (const std::exception& e) {
+        if (skipped_lines_ < kMaxSkipWarnings) {
+            LOG_WARNING << "[CorpusReader] Skipping malformed line " << line_number_ << ": " << e.what();
+        }
+        return false;
+    }
+    // id 逐行写入 sidecar 文件，不能含换行
+    if (has_id && record.id.find_first_of("\r\n") != std::string::npos) {
+        if (skipped_lines_ < kMaxSkipWarnings) {
+            LOG_WARNING << "[CorpusReader] Skipping line " << line_number_ << ": id contains a line break";
+        }
+        return false;
+    }
+    if (!has_id || !has_text) {
+        if (skipped_lines_ < kMaxSkipWarnings) {
+            LOG_WARNING << "[CorpusReader] Skipping line " << line_number_ << ": missing \""
+                        << (has_id ? options_.text_field : options_.id_field) << "\"";
+        }
+        return false;
+    }
+    return true;
+}
+
+bool CorpusReader::parse_tsv(std::string_view line, CorpusRecord& record) const {
+    const size_t tab = line.find('\t');
+    if (tab == std::string_view::npos || tab == 0) {
+        if (skipped_lines_ < kMaxSkipWarnings) {
+            LOG_WARNING << "[CorpusReader] Skipping line " << line_number_ << ": expected id<TAB>text";
+        }
+        return false;
+    }
+    record.id.assign(line.data(), tab);
+    record.text.assign(line.data() + tab + 1, line.size() - tab - 1);
+    return true;
+}
+
+} // namespace bulk_embed
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+
+namespace bulk_embed {
+
+enum class CorpusFormat {
+    JSONL,  // 每行一个 JSON 对象，如 {"id": "doc-1", "text": "..."}
+    TSV     // 每行 id<TAB>text，text 为该行剩余部分
+};
+
+// .tsv 为 TSV，其余按 JSONL 处理
+CorpusFormat corpus_format_from_path(const std::string& path);
+
+struct CorpusOptions {
+    CorpusFormat format = CorpusFormat::JSONL;
+    // JSONL 的字段名；id 为数字时按十进制输出（超过 2^53 会丢失精度）
+    std::string id_field = "id";
+    std::string text_field = "text";
+};
+
+struct CorpusRecord {
+    std::string id;
+    std::string text;
+};
+
+// 通过 mmap 顺序读取语料，由内核按需换页，不把整个文件读入内存。
+// 偏移量以字节计且总在行首，可用于断点续跑
+class CorpusReader {
+public:
+    // 文件无法打开时抛出 std::runtime_error
+    CorpusReader(const std::string& path, CorpusOptions options);
+
+    // 定位到 offset（须为某行行首，通常来自检查点）
+    void seek(size_t offset);
+
+    // 读取下一条记录，到达文件末尾返回 false。空行直接跳过，格式错误的行跳过并计数
+    bool next(CorpusRecord& record);
+
+    // 下一条记录的起始偏移
+    size_t offset() const { return offset_; }
+    size_t size() const { return size_; }
+    uint64_t skipped_lines() const { return skipped_lines_; }
+
+private:
+    CorpusOptions options_;
+    text_embedding::MappedFile file_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;
+    size_t line_number_ = 0;  // 仅用于日志，seek 后从 0 重新计
+    uint64_t skipped_lines_ = 0;
+    std::string key_;  // JSON 解析时复用
+
+    bool parse_jsonl(std::string_view line, CorpusRecord& record);
+    bool parse_tsv(std::string_view line, CorpusRecord& record) const;
+};
+
+} // namespace bulk_embed
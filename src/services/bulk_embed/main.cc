@@ -0,0 +1,188 @@
+#include <pthread.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "bulk_embedder.h"
+#include "logger.h"
+#include "onnx_embedding.h"
+
+namespace {
+
+struct BulkEmbedConfig {
+    std::string model_path = "resource/model/multilingual-e5-small/";
+    text_embedding::ModelPrecision precision = text_embedding::ModelPrecision::FP32;
+    // Session 数即并发推理的批次数；每个 Session 的 intra-op 线程数，0 表示平分全部核
+    size_t sessions = 2;
+    int threads_per_session = 0;
+    bulk_embed::BulkEmbedOptions run;
+};
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " --input <corpus> --output <vectors> [options]\n"
+              << "  --input <path>            corpus file, JSONL ({\"id\":..,\"text\":..}) or .tsv (id<TAB>text)\n"
+              << "  --output <path>           vector file, .npy for numpy, otherwise .fvecs layout\n"
+              << "  --ids <path>              id sidecar, one id per line (default <output>.ids)\n"
+              << "  --checkpoint <path>       progress file (default <output>.ckpt)\n"
+              << "  --format <jsonl|tsv>      corpus format (default by extension)\n"
+              << "  --id-field <name>         JSONL id field (default id)\n"
+              << "  --text-field <name>       JSONL text field (default text)\n"
+              << "  --model <dir>             embedding model directory\n"
+              << "  --precision <fp32|fp16|int8>  model variant (default fp32)\n"
+              << "  --sessions <n>            concurrent inference sessions (default 2)\n"
+              << "  --threads <n>             intra-op threads per session (default cores / sessions)\n"
+              << "  --batch <n>               texts per inference batch (default 64)\n"
+              << "  --checkpoint-every <n>    records between checkpoints (default 50000)\n"
+              << "  --report-interval <sec>   progress log interval, 0 to disable (default 5)\n"
+              << "  --no-resume               ignore an existing checkpoint and start over\n";
+}
+
+bool parse_precision(const std::string& value, text_embedding::ModelPrecision& precision) {
+    if (value == "fp32") {
+        precision = text_embedding::ModelPrecision::FP32;
+    } else if (value == "fp16") {
+        precision = text_embedding::ModelPrecision::FP16;
+    } else if (value == "int8") {
+        precision = text_embedding::ModelPrecision::INT8;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse_args(int argc, char** argv, BulkEmbedConfig& config) {
+    bool has_format = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") return false;
+        if (arg == "--no-resume") {
+            config.run.resume = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--input") {
+            config.run.input_path = value;
+        } else if (arg == "--output") {
+            config.run.output_path = value;
+        } else if (arg == "--ids") {
+            config.run.ids_path = value;
+        } else if (arg == "--checkpoint") {
+            config.run.checkpoint_path = value;
+        } else if (arg == "--format") {
+            if (value != "jsonl" && value != "tsv") {
+                std::cerr << "Unknown corpus format " << value << "\n";
+                return false;
+            }
+            config.run.corpus.format = value == "tsv" ? bulk_embed::CorpusFormat::TSV : bulk_embed::CorpusFormat::JSONL;
+            has_format = true;
+        } else if (arg == "--id-field") {
+            config.run.corpus.id_field = value;
+        } else if (arg == "--text-field") {
+            config.run.corpus.text_field = value;
+        } else if (arg == "--model") {
+            config.model_path = value;
+        } else if (arg == "--precision") {
+            if (!parse_precision(value, config.precision)) {
+                std::cerr << "Unknown precision " << value << "\n";
+                return false;
+            }
+        } else if (arg == "--sessions") {
+            config.sessions = std::stoul(value);
+        } else if (arg == "--threads") {
+            config.threads_per_session = std::stoi(value);
+        } else if (arg == "--batch") {
+            config.run.batch_size = std::stoul(value);
+        } else if (arg == "--checkpoint-every") {
+            config.run.checkpoint_every = std::stoull(value);
+        } else if (arg == "--report-interval") {
+            config.run.report_interval = std::chrono::milliseconds(static_cast<int64_t>(std::stod(value) * 1000));
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.run.input_path.empty() || config.run.output_path.empty()) {
+        std::cerr << "--input and --output are required\n";
+        return false;
+    }
+    if (!has_format) config.run.corpus.format = bulk_embed::corpus_format_from_path(config.run.input_path);
+    config.run.output_format = bulk_embed::vector_format_from_path(config.run.output_path);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BulkEmbedConfig config;
+    try {
+        if (!parse_args(argc, argv, config)) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // 先屏蔽信号再创建线程，由单独线程 sigwait 后请求停止，保证检查点完整写出
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    // 运行结束后用于唤醒信号线程
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    logger::InitLogger(argv[0]);
+    logger::EnableAsyncLogging();
+
+    // 多个 Session 并发跑不同批次，各自的 intra-op 线程平分全部核
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t sessions = std::max<size_t>(config.sessions, 1);
+    text_embedding::OnnxEmbeddingOptions model_options;
+    model_options.precision = config.precision;
+    model_options.session.num_sessions = sessions;
+    model_options.session.intra_op_threads =
+        config.threads_per_session > 0 ? config.threads_per_session : static_cast<int>(std::max<size_t>(cores / sessions, 1));
+    model_options.session.inter_op_threads = 1;
+    model_options.tokenizer.num_instances = sessions;
+    config.run.workers = sessions;
+
+    text_embedding::OnnxRuntimeEmbedding model(model_options);
+    if (!model.load_model(config.model_path)) {
+        LOG_ERROR << "[BulkEmbed] Failed to load embedding model from " << config.model_path;
+        logger::ShutdownLogger();
+        return EXIT_FAILURE;
+    }
+    LOG_INFO << "[BulkEmbed] Model " << config.model_path << " (" << text_embedding::precision_name(model.loaded_precision())
+             << "), dim " << model.dimension() << ", " << sessions << " sessions x "
+             << model_options.session.intra_op_threads << " threads, batch " << config.run.batch_size;
+
+    bulk_embed::BulkEmbedder embedder(model, config.run);
+    std::thread signal_thread([&] {
+        int received = 0;
+        sigwait(&signals, &received);
+        if (received == SIGUSR1) return;
+        LOG_WARNING << "[BulkEmbed] Received signal " << received << ", finishing in-flight batches";
+        embedder.stop();
+    });
+
+    const bool ok = embedder.run();
+
+    pthread_kill(signal_thread.native_handle(), SIGUSR1);
+    signal_thread.join();
+
+    const auto stats = embedder.stats();
+    logger::ShutdownLogger();
+    if (!ok) return EXIT_FAILURE;
+    // 被信号中断时返回非零，便于脚本判断需要重跑续传
+    return stats.completed ? EXIT_SUCCESS : 3;
+}
@@ -0,0 +1,177 @@
+#include "vector_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bulk_embed {
+
+namespace {
+
+// 攒够后一次写出，减少系统调用
+constexpr size_t kFlushBytes = 8u << 20;
+
+std::runtime_error io_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+int open_output(const std::string& path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) throw io_error("Unable to open", path);
+    return fd;
+}
+
+// 截断到 size；文件比 size 短说明与检查点不一致
+void truncate_to(int fd, uint64_t size, const std::string& path) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) throw io_error("Unable to stat", path);
+    if (static_cast<uint64_t>(st.st_size) < size) {
+        throw std::runtime_error("Output file " + path + " is shorter (" + std::to_string(st.st_size) +
+                                 " bytes) than the checkpoint expects (" + std::to_string(size) + " bytes)");
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) throw io_error("Unable to truncate", path);
+    if (::lseek(fd, 0, SEEK_END) < 0) throw io_error("Unable to seek", path);
+}
+
+void write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+} // namespace
+
+VectorFormat vector_format_from_path(const std::string& path) {
+    const std::string suffix = ".npy";
+    const bool npy = path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    return npy ? VectorFormat::NPY : VectorFormat::FVECS;
+}
+
+VectorWriter::VectorWriter(const std::string& vectors_path, const std::string& ids_path, VectorFormat format,
+                           size_t dim, uint64_t resume_count, uint64_t resume_ids_bytes)
+    : format_(format), dim_(dim), count_(resume_count), ids_bytes_(resume_ids_bytes) {
+    if (dim_ == 0) throw std::invalid_argument("Vector dimension must be positive");
+    vectors_fd_ = open_output(vectors_path);
+    try {
+        ids_fd_ = open_output(ids_path);
+        if (count_ == 0 && ids_bytes_ == 0) {
+            truncate_to(vectors_fd_, 0, vectors_path);
+            truncate_to(ids_fd_, 0, ids_path);
+            if (format_ == VectorFormat::NPY) {
+                // 先占位推进文件偏移，再原地写入真正的头
+                const std::string placeholder(kNpyHeaderBytes, ' ');
+                write_all(vectors_fd_, placeholder.data(), placeholder.size());
+                write_npy_header();
+            }
+        } else {
+            truncate_to(vectors_fd_, header_bytes() + count_ * record_bytes(), vectors_path);
+            truncate_to(ids_fd_, ids_bytes_, ids_path);
+        }
+    } catch (...) {
+        // 未完成初始化，不做 sync，避免改动已有文件
+        if (ids_fd_ >= 0) ::close(ids_fd_);
+        ::close(vectors_fd_);
+        ids_fd_ = -1;
+        vectors_fd_ = -1;
+        throw;
+    }
+    vector_buffer_.reserve(kFlushBytes + record_bytes());
+}
+
+VectorWriter::~VectorWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+uint64_t VectorWriter::record_bytes() const {
+    const uint64_t data = dim_ * sizeof(float);
+    return format_ == VectorFormat::FVECS ? sizeof(int32_t) + data : data;
+}
+
+uint64_t VectorWriter::header_bytes() const {
+    return format_ == VectorFormat::NPY ? kNpyHeaderBytes : 0;
+}
+
+void VectorWriter::append(const std::vector<std::string>& ids, const std::vector<std::vector<float>>& vectors) {
+    if (ids.size() != vectors.size()) {
+        throw std::invalid_argument("ids and vectors size mismatch");
+    }
+    const int32_t dim = static_cast<int32_t>(dim_);
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        if (vectors[i].size() != dim_) {
+            throw std::invalid_argument("Vector " + ids[i] + " has dimension " + std::to_string(vectors[i].size()) +
+                                        ", expected " + std::to_string(dim_));
+        }
+        // 按主机字节序写出，目标平台（x86 / ARM）均为小端
+        if (format_ == VectorFormat::FVECS) {
+            vector_buffer_.append(reinterpret_cast<const char*>(&dim), sizeof(dim));
+        }
+        vector_buffer_.append(reinterpret_cast<const char*>(vectors[i].data()), dim_ * sizeof(float));
+        ids_buffer_ += ids[i];
+        ids_buffer_ += '\n';
+        ids_bytes_ += ids[i].size() + 1;
+    }
+    count_ += vectors.size();
+    if (vector_buffer_.size() >= kFlushBytes || ids_buffer_.size() >= kFlushBytes) flush_buffers();
+}
+
+void VectorWriter::flush_buffers() {
+    write_all(vectors_fd_, vector_buffer_.data(), vector_buffer_.size());
+    write_all(ids_fd_, ids_buffer_.data(), ids_buffer_.size());
+    vector_buffer_.clear();
+    ids_buffer_.clear();
+}
+
+void VectorWriter::write_npy_header() {
+    // numpy 格式 1.0：魔数、版本、uint16 头长度，之后是以换行结尾、按 64 字节对齐的 Python 字典
+    std::string header("\x93NUMPY\x01\x00", 8);
+    const uint16_t dict_len = static_cast<uint16_t>(kNpyHeaderBytes - 10);
+    header.push_back(static_cast<char>(dict_len & 0xff));
+    header.push_back(static_cast<char>(dict_len >> 8));
+    header += "{'descr': '<f4', 'fortran_order': False, 'shape': (" + std::to_string(count_) + ", " +
+              std::to_string(dim_) + "), }";
+    header.resize(kNpyHeaderBytes - 1, ' ');
+    header.push_back('\n');
+    if (::pwrite(vectors_fd_, header.data(), header.size(), 0) != static_cast<ssize_t>(header.size())) {
+        throw std::runtime_error(std::string("Unable to write npy header: ") + std::strerror(errno));
+    }
+}
+
+void VectorWriter::sync() {
+    flush_buffers();
+    if (format_ == VectorFormat::NPY) write_npy_header();
+    if (::fdatasync(vectors_fd_) != 0 || ::fdatasync(ids_fd_) != 0) {
+        throw std::runtime_error(std::string("fdatasync failed: ") + std::strerror(errno));
+    }
+}
+
+void VectorWriter::close() {
+    std::exception_ptr error;
+    if (vectors_fd_ >= 0 && ids_fd_ >= 0) {
+        try {
+            sync();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    if (vectors_fd_ >= 0) ::close(vectors_fd_);
+    if (ids_fd_ >= 0) ::close(ids_fd_);
+    vectors_fd_ = -1;
+    ids_fd_ = -1;
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace bulk_embed
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bulk_embed {
+
+enum class VectorFormat {
+    FVECS,  // 每条向量前置 int32 维度，随后 dim 个 float32（faiss / ann-benchmarks 的 .fvecs）
+    NPY     // 固定 128 字节头的 float32 二维数组，可直接 numpy.load / np.load(mmap_mode="r")
+};
+
+// .npy 为 NPY，其余按 fvecs 处理
+VectorFormat vector_format_from_path(const std::string& path);
+
+// npy 的固定头长度；shape 留有足够空位，续写时原地更新行数
+constexpr size_t kNpyHeaderBytes = 128;
+
+// 追加写入连续存储的向量文件和逐行一个 id 的 sidecar 文件（小端 float32）。
+// 写入经用户态缓冲，只有 sync 之后的内容才保证落盘，检查点据此记录进度
+class VectorWriter {
+public:
+    // resume_count / resume_ids_bytes 为检查点记录的已落盘进度：两个文件先截断到该位置再续写，
+    // 丢弃上次中断时写了一半的数据。均为 0 时新建（覆盖已有文件）。失败时抛出 std::runtime_error
+    VectorWriter(const std::string& vectors_path, const std::string& ids_path, VectorFormat format, size_t dim,
+                 uint64_t resume_count = 0, uint64_t resume_ids_bytes = 0);
+    ~VectorWriter();
+
+    VectorWriter(const VectorWriter&) = delete;
+    VectorWriter& operator=(const VectorWriter&) = delete;
+
+    // ids 与 vectors 一一对应，每条向量的维度必须等于 dim
+    void append(const std::vector<std::string>& ids, const std::vector<std::vector<float>>& vectors);
+
+    // 写出缓冲、更新 npy 头并 fdatasync 两个文件
+    void sync();
+    void close();
+
+    size_t dim() const { return dim_; }
+    uint64_t count() const { return count_; }
+    // ids 文件的逻辑长度（含未刷出的缓冲）
+    uint64_t ids_bytes() const { return ids_bytes_; }
+
+private:
+    VectorFormat format_;
+    size_t dim_;
+    int vectors_fd_ = -1;
+    int ids_fd_ = -1;
+    uint64_t count_ = 0;
+    uint64_t ids_bytes_ = 0;
+    std::string vector_buffer_;
+    std::string ids_buffer_;
+
+    uint64_t record_bytes() const;
+    uint64_t header_bytes() const;
+    void write_npy_header();
+    void flush_buffers();
+};
+
+} // namespace bulk_embed
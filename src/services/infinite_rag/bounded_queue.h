@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace infinite_rag {
+
+// 多生产者多消费者的有界阻塞队列，满时 push 阻塞形成背压。
+// close 之后 push 失败；pop 取完剩余元素后返回空，消费者据此退出
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 队列已关闭时返回 false，item 不被移走
+    bool push(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(item));
+        max_depth_ = std::max(max_depth_, items_.size());
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool push(T&& item) { return push(item); }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return std::nullopt;
+        std::optional<T> item(std::move(items_.front()));
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return item;
+    }
+
+    // 至少等到一个元素，再取走当前可用的至多 max_items 个；关闭且取空后返回 0
+    size_t pop_batch(std::vector<T>& out, size_t max_items) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        const size_t count = std::min(max_items, items_.size());
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(std::move(items_.front()));
+            items_.pop_front();
+        }
+        lock.unlock();
+        if (count) not_full_.notify_all();
+        return count;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t max_depth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_depth_;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    size_t max_depth_ = 0;
+    bool closed_ = false;
+};
+
+} // namespace infinite_rag
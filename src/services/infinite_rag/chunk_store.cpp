@@ -0,0 +1,409 @@
+#include "chunk_store.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <sqlite3.h>
+
+namespace {
+
+constexpr size_t kMaxQueryPhrases = 64;
+
+std::runtime_error sqlite_error(sqlite3* db, const std::string& what) {
+    return std::runtime_error(what + ": " + (db ? sqlite3_errmsg(db) : "out of memory"));
+}
+
+void exec(sqlite3* db, const std::string& sql) {
+    char* message = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &message) != SQLITE_OK) {
+        std::string error = message ? message : "unknown error";
+        sqlite3_free(message);
+        throw std::runtime_error("SQLite error in \"" + sql + "\": " + error);
+    }
+}
+
+// sqlite3_stmt 的 RAII 封装，bind 按调用顺序自动编号
+class Statement {
+public:
+    Statement(sqlite3* db, const std::string& sql) : db_(db) {
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt_, nullptr) != SQLITE_OK) {
+            throw sqlite_error(db, "Failed to prepare \"" + sql + "\"");
+        }
+    }
+    ~Statement() { sqlite3_finalize(stmt_); }
+
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    Statement& bind(const std::string& value) {
+        sqlite3_bind_text(stmt_, ++index_, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+        return *this;
+    }
+    Statement& bind(int64_t value) {
+        sqlite3_bind_int64(stmt_, ++index_, value);
+        return *this;
+    }
+
+    // 有结果行时返回 true
+    bool step() {
+        int rc = sqlite3_step(stmt_);
+        if (rc == SQLITE_ROW) return true;
+        if (rc == SQLITE_DONE) return false;
+        throw sqlite_error(db_, "SQLite step failed");
+    }
+
+    void reset() {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+        index_ = 0;
+    }
+
+    int64_t column_int64(int col) const { return sqlite3_column_int64(stmt_, col); }
+    double column_double(int col) const { return sqlite3_column_double(stmt_, col); }
+    std::string column_text(int col) const {
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt_, col));
+        return text ? std::string(text, sqlite3_column_bytes(stmt_, col)) : std::string();
+    }
+
+private:
+    sqlite3* db_;
+    sqlite3_stmt* stmt_ = nullptr;
+    int index_ = 0;
+};
+
+sqlite3* open_connection(const std::string& path, int flags) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &db, flags | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        std::runtime_error error = sqlite_error(db, "Unable to open " + path);
+        sqlite3_close(db);
+        throw error;
+    }
+    sqlite3_busy_timeout(db, 5000);
+    return db;
+}
+
+std::vector<std::string> utf8_chars(const std::string& text) {
+    std::vector<std::string> chars;
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        size_t len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 1;
+        chars.push_back(text.substr(i, len));
+        i += len;
+    }
+    return chars;
+}
+
+std::string quote_phrase(const std::string& phrase) {
+    std::string quoted = "\"";
+    for (char c : phrase) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// 把用户输入转成 FTS5 查询：按空白切词，每个词作为短语（屏蔽 FTS5 语法），短语之间 OR。
+// trigram 分词下少于 3 个字符的词无法匹配；不含空格的中文按三字滑窗拆成多个短语。
+std::string build_fts_query(const std::string& text, bool trigram) {
+    std::vector<std::string> phrases;
+    auto add_phrase = [&](const std::string& phrase) {
+        if (phrases.size() < kMaxQueryPhrases && std::find(phrases.begin(), phrases.end(), phrase) == phrases.end()) {
+            phrases.push_back(phrase);
+        }
+    };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t begin = text.find_first_not_of(" \t\r\n", pos);
+        if (begin == std::string::npos) break;
+        size_t end = text.find_first_of(" \t\r\n", begin);
+        if (end == std::string::npos) end = text.size();
+        std::string term = text.substr(begin, end - begin);
+        pos = end;
+
+        if (!trigram) {
+            add_phrase(term);
+            continue;
+        }
+        auto chars = utf8_chars(term);
+        if (chars.size() < 3) continue;
+        if (chars.size() == term.size()) {
+            add_phrase(term);  // ASCII 词（编号、型号）整体匹配
+            continue;
+        }
+        for (size_t i = 0; i + 3 <= chars.size(); ++i) add_phrase(chars[i] + chars[i + 1] + chars[i + 2]);
+    }
+
+    std::string query;
+    for (const auto& phrase : phrases) {
+        if (!query.empty()) query += " OR ";
+        query += quote_phrase(phrase);
+    }
+    return query;
+}
+
+// 每个键值对走 (key, value, chunk_id) 主键索引，多个条件取交集
+std::string filter_subquery(const infinite_rag::MetadataFilter& filter, const std::string& extra = "") {
+    std::string sql;
+    for (size_t i = 0; i < filter.size(); ++i) {
+        if (i > 0) sql += " INTERSECT ";
+        sql += "SELECT chunk_id FROM chunk_meta WHERE key = ? AND value = ?" + extra;
+    }
+    return sql;
+}
+
+void bind_filter(Statement& stmt, const infinite_rag::MetadataFilter& filter) {
+    for (const auto& [key, value] : filter) stmt.bind(key).bind(value);
+}
+
+std::string id_list(const std::vector<uint64_t>& ids) {
+    std::string list;
+    for (uint64_t id : ids) {
+        if (!list.empty()) list += ',';
+        list += std::to_string(static_cast<int64_t>(id));
+    }
+    return list;
+}
+
+} // namespace
+
+namespace infinite_rag {
+
+// 只读连接租约，析构时归还连接池
+class ChunkStore::Reader {
+public:
+    explicit Reader(const ChunkStore& store) : store_(store), db_(store.acquire_reader()) {}
+    ~Reader() { store_.release_reader(db_); }
+    sqlite3* get() const { return db_; }
+
+private:
+    const ChunkStore& store_;
+    sqlite3* db_;
+};
+
+ChunkStore::ChunkStore(const std::string& path, ChunkStoreOptions options)
+    : options_(std::move(options)), path_(path) {
+    writer_ = open_connection(path_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    try {
+        init_schema();
+        for (size_t i = 0; i < std::max<size_t>(options_.read_connections, 1); ++i) {
+            readers_.push_back(open_connection(path_, SQLITE_OPEN_READONLY));
+        }
+    } catch (...) {
+        for (sqlite3* db : readers_) sqlite3_close(db);
+        sqlite3_close(writer_);
+        throw;
+    }
+    idle_readers_ = readers_;
+    LOG_DEBUG << "[ChunkStore] Opened " << path_ << " with " << readers_.size() << " read connections";
+}
+
+ChunkStore::~ChunkStore() {
+    for (sqlite3* db : readers_) sqlite3_close(db);
+    sqlite3_close(writer_);
+}
+
+void ChunkStore::init_schema() {
+    // WAL：读连接不阻塞写入，写入不阻塞读
+    exec(writer_, "PRAGMA journal_mode=WAL");
+    exec(writer_, "PRAGMA synchronous=NORMAL");
+    exec(writer_,
+         "CREATE TABLE IF NOT EXISTS chunks("
+         "  id INTEGER PRIMARY KEY,"
+         "  doc_id TEXT NOT NULL DEFAULT '',"
+         "  text TEXT NOT NULL)");
+    exec(writer_,
+         "CREATE TABLE IF NOT EXISTS chunk_meta("
+         "  key TEXT NOT NULL,"
+         "  value TEXT NOT NULL,"
+         "  chunk_id INTEGER NOT NULL,"
+         "  PRIMARY KEY(key, value, chunk_id)) WITHOUT ROWID");
+    exec(writer_, "CREATE INDEX IF NOT EXISTS chunk_meta_by_chunk ON chunk_meta(chunk_id)");
+    exec(writer_,
+         "CREATE VIRTUAL TABLE IF NOT EXISTS chunks_fts USING fts5("
+         "  text, content='chunks', content_rowid='id', tokenize='" + options_.tokenizer + "')");
+
+    // 外部内容表由触发器与 chunks 保持同步
+    exec(writer_,
+         "CREATE TRIGGER IF NOT EXISTS chunks_ai AFTER INSERT ON chunks BEGIN"
+         "  INSERT INTO chunks_fts(rowid, text) VALUES (new.id, new.text);"
+         "END");
+    exec(writer_,
+         "CREATE TRIGGER IF NOT EXISTS chunks_ad AFTER DELETE ON chunks BEGIN"
+         "  INSERT INTO chunks_fts(chunks_fts, rowid, text) VALUES ('delete', old.id, old.text);"
+         "  DELETE FROM chunk_meta WHERE chunk_id = old.id;"
+         "END");
+    exec(writer_,
+         "CREATE TRIGGER IF NOT EXISTS chunks_au AFTER UPDATE OF text ON chunks BEGIN"
+         "  INSERT INTO chunks_fts(chunks_fts, rowid, text) VALUES ('delete', old.id, old.text);"
+         "  INSERT INTO chunks_fts(rowid, text) VALUES (new.id, new.text);"
+         "END");
+}
+
+sqlite3* ChunkStore::acquire_reader() const {
+    std::unique_lock<std::mutex> lock(reader_mutex_);
+    reader_cv_.wait(lock, [this] { return !idle_readers_.empty(); });
+    sqlite3* db = idle_readers_.back();
+    idle_readers_.pop_back();
+    return db;
+}
+
+void ChunkStore::release_reader(sqlite3* db) const {
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        idle_readers_.push_back(db);
+    }
+    reader_cv_.notify_one();
+}
+
+void ChunkStore::upsert(const std::vector<Chunk>& chunks) {
+    if (chunks.empty()) return;
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+
+    exec(writer_, "BEGIN IMMEDIATE");
+    try {
+        Statement upsert_chunk(writer_,
+                               "INSERT INTO chunks(id, doc_id, text) VALUES (?, ?, ?) "
+                               "ON CONFLICT(id) DO UPDATE SET doc_id = excluded.doc_id, text = excluded.text");
+        Statement clear_meta(writer_, "DELETE FROM chunk_meta WHERE chunk_id = ?");
+        Statement insert_meta(writer_, "INSERT INTO chunk_meta(key, value, chunk_id) VALUES (?, ?, ?)");
+
+        for (const auto& chunk : chunks) {
+            const auto id = static_cast<int64_t>(chunk.id);
+            upsert_chunk.reset();
+            upsert_chunk.bind(id).bind(chunk.doc_id).bind(chunk.text).step();
+
+            clear_meta.reset();
+            clear_meta.bind(id).step();
+            for (const auto& [key, value] : chunk.metadata) {
+                insert_meta.reset();
+                insert_meta.bind(key).bind(value).bind(id).step();
+            }
+        }
+        exec(writer_, "COMMIT");
+    } catch (...) {
+        exec(writer_, "ROLLBACK");
+        throw;
+    }
+}
+
+bool ChunkStore::remove(uint64_t id) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    Statement stmt(writer_, "DELETE FROM chunks WHERE id = ?");
+    stmt.bind(static_cast<int64_t>(id)).step();
+    return sqlite3_changes(writer_) > 0;
+}
+
+std::optional<Chunk> ChunkStore::get(uint64_t id) const {
+    auto chunks = get_many({id});
+    if (chunks.empty()) return std::nullopt;
+    return std::move(chunks.front());
+}
+
+std::vector<Chunk> ChunkStore::get_many(const std::vector<uint64_t>& ids) const {
+    if (ids.empty()) return {};
+    Reader reader(*this);
+    const std::string list = id_list(ids);
+
+    std::unordered_map<uint64_t, Chunk> found;
+    Statement chunks(reader.get(), "SELECT id, doc_id, text FROM chunks WHERE id IN (" + list + ")");
+    while (chunks.step()) {
+        Chunk chunk;
+        chunk.id = static_cast<uint64_t>(chunks.column_int64(0));
+        chunk.doc_id = chunks.column_text(1);
+        chunk.text = chunks.column_text(2);
+        found.emplace(chunk.id, std::move(chunk));
+    }
+
+    Statement meta(reader.get(), "SELECT chunk_id, key, value FROM chunk_meta WHERE chunk_id IN (" + list + ")");
+    while (meta.step()) {
+        auto it = found.find(static_cast<uint64_t>(meta.column_int64(0)));
+        if (it != found.end()) it->second.metadata[meta.column_text(1)] = meta.column_text(2);
+    }
+
+    std::vector<Chunk> result;
+    result.reserve(found.size());
+    for (uint64_t id : ids) {
+        auto it = found.find(id);
+        if (it != found.end()) result.push_back(std::move(it->second));
+    }
+    return result;
+}
+
+std::vector<LexicalHit> ChunkStore::search_bm25(const std::string& query, size_t k, const MetadataFilter& filter) const {
+    const std::string match = build_fts_query(query, options_.tokenizer == "trigram");
+    if (match.empty() || k == 0) return {};
+
+    std::string sql = "SELECT rowid, -bm25(chunks_fts) FROM chunks_fts WHERE chunks_fts MATCH ?";
+    // "+rowid" 阻止 FTS5 把 IN 列表当作 rowid 约束逐个重跑 MATCH：先全文匹配，再按集合过滤
+    if (!filter.empty()) sql += " AND +rowid IN (" + filter_subquery(filter) + ")";
+    sql += " ORDER BY bm25(chunks_fts) LIMIT ?";
+
+    Reader reader(*this);
+    Statement stmt(reader.get(), sql);
+    stmt.bind(match);
+    bind_filter(stmt, filter);
+    stmt.bind(static_cast<int64_t>(k));
+
+    std::vector<LexicalHit> hits;
+    while (stmt.step()) {
+        hits.push_back({static_cast<uint64_t>(stmt.column_int64(0)), stmt.column_double(1)});
+    }
+    return hits;
+}
+
+std::vector<uint64_t> ChunkStore::filter_ids(const MetadataFilter& filter, size_t limit) const {
+    if (filter.empty()) {
+        throw std::invalid_argument("filter_ids requires a non-empty filter");
+    }
+    Reader reader(*this);
+    Statement stmt(reader.get(), filter_subquery(filter) + " LIMIT ?");
+    bind_filter(stmt, filter);
+    stmt.bind(static_cast<int64_t>(limit));
+
+    std::vector<uint64_t> ids;
+    while (stmt.step()) ids.push_back(static_cast<uint64_t>(stmt.column_int64(0)));
+    return ids;
+}
+
+size_t ChunkStore::count_filtered(const MetadataFilter& filter, size_t limit) const {
+    if (filter.empty()) {
+        throw std::invalid_argument("count_filtered requires a non-empty filter");
+    }
+    Reader reader(*this);
+    Statement stmt(reader.get(), "SELECT COUNT(*) FROM (" + filter_subquery(filter) + " LIMIT ?)");
+    bind_filter(stmt, filter);
+    stmt.bind(static_cast<int64_t>(limit));
+    stmt.step();
+    return static_cast<size_t>(stmt.column_int64(0));
+}
+
+std::vector<uint64_t> ChunkStore::filter_candidates(const MetadataFilter& filter,
+                                                    const std::vector<uint64_t>& candidates) const {
+    if (filter.empty() || candidates.empty()) return candidates;
+
+    Reader reader(*this);
+    Statement stmt(reader.get(), filter_subquery(filter, " AND chunk_id IN (" + id_list(candidates) + ")"));
+    bind_filter(stmt, filter);
+
+    std::unordered_set<uint64_t> allowed;
+    while (stmt.step()) allowed.insert(static_cast<uint64_t>(stmt.column_int64(0)));
+
+    std::vector<uint64_t> kept;
+    for (uint64_t id : candidates) {
+        if (allowed.count(id)) kept.push_back(id);
+    }
+    return kept;
+}
+
+size_t ChunkStore::size() const {
+    Reader reader(*this);
+    Statement stmt(reader.get(), "SELECT COUNT(*) FROM chunks");
+    stmt.step();
+    return static_cast<size_t>(stmt.column_int64(0));
+}
+
+} // namespace infinite_rag
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+namespace infinite_rag {
+
+struct Chunk {
+    uint64_t id = 0;
+    std::string doc_id;
+    std::string text;
+    std::map<std::string, std::string> metadata;
+};
+
+// 元数据过滤：所有键值同时相等
+using MetadataFilter = std::map<std::string, std::string>;
+
+struct LexicalHit {
+    uint64_t id = 0;
+    double score = 0.0;  // -bm25()，越大越相关
+};
+
+struct ChunkStoreOptions {
+    // FTS5 分词器：trigram 支持中文与编号/型号的子串匹配；纯英文语料可用 unicode61
+    std::string tokenizer = "trigram";
+    // 只读连接数（WAL 模式下与写连接并发），即可并行执行的查询数
+    size_t read_connections = 4;
+};
+
+// 文档块文本与元数据的 SQLite 存储，附带 FTS5 全文索引。
+// 写入经单一写连接串行化；查询从只读连接池取连接，可多线程并发。
+class ChunkStore {
+public:
+    // 打开或创建数据库文件，失败时抛出 std::runtime_error
+    explicit ChunkStore(const std::string& path, ChunkStoreOptions options = {});
+    ~ChunkStore();
+
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    // 插入或覆盖（含元数据），整批在一个事务内完成
+    void upsert(const std::vector<Chunk>& chunks);
+    bool remove(uint64_t id);
+
+    std::optional<Chunk> get(uint64_t id) const;
+    // 按 ids 的顺序返回存在的块
+    std::vector<Chunk> get_many(const std::vector<uint64_t>& ids) const;
+
+    // BM25 检索，过滤条件下推到 SQL 中执行
+    std::vector<LexicalHit> search_bm25(const std::string& query, size_t k, const MetadataFilter& filter = {}) const;
+
+    // 满足过滤条件的 id，至多 limit 个（走元数据索引，不扫描全表）
+    std::vector<uint64_t> filter_ids(const MetadataFilter& filter, size_t limit) const;
+    // 满足过滤条件的块数，数到 limit 即停止；只用于判断选择性，不取回 id
+    size_t count_filtered(const MetadataFilter& filter, size_t limit) const;
+    // 从候选中保留满足过滤条件的 id，保持原有顺序
+    std::vector<uint64_t> filter_candidates(const MetadataFilter& filter, const std::vector<uint64_t>& candidates) const;
+
+    size_t size() const;
+
+private:
+    class Reader;
+
+    sqlite3* acquire_reader() const;
+    void release_reader(sqlite3* db) const;
+    void init_schema();
+
+    ChunkStoreOptions options_;
+    std::string path_;
+
+    sqlite3* writer_ = nullptr;
+    std::mutex writer_mutex_;
+
+    mutable std::mutex reader_mutex_;
+    mutable std::condition_variable reader_cv_;
+    std::vector<sqlite3*> readers_;
+    mutable std::vector<sqlite3*> idle_readers_;
+};
+
+} // namespace infinite_rag
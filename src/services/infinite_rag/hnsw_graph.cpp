@@ -0,0 +1,405 @@
+#include "hnsw_graph.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <unistd.h>
+
+namespace {
+
+using HnswIndex = hnswlib::HierarchicalNSW<float>;
+
+// open_snapshot 绕过 loadIndex 直接填充 HierarchicalNSW 的内部成员，按 hnswlib v0.8.0
+// （third_party/init_third_party.sh 固定的版本）的布局编写。升级前需对照新版 loadIndex 核对，
+// 下列成员改名或改类型时编译失败
+static_assert(std::is_same_v<decltype(HnswIndex::label_op_locks_), std::vector<std::mutex>> &&
+                  std::is_same_v<decltype(HnswIndex::link_list_locks_), std::vector<std::mutex>>,
+              "open_snapshot assumes hnswlib v0.8.0 lock layout");
+static_assert(std::is_same_v<decltype(HnswIndex::level_generator_), std::default_random_engine> &&
+                  std::is_same_v<decltype(HnswIndex::num_deleted_), std::atomic<size_t>>,
+              "open_snapshot assumes hnswlib v0.8.0 members");
+static_assert(std::is_same_v<decltype(HnswIndex::linkLists_), char**> &&
+                  std::is_same_v<decltype(HnswIndex::element_levels_), std::vector<int>> &&
+                  sizeof(hnswlib::tableint) == 4 && sizeof(hnswlib::linklistsizeint) == 4,
+              "open_snapshot assumes hnswlib v0.8.0 link list layout");
+
+constexpr char kSnapshotMagic[8] = {'R', 'E', 'D', 'G', 'H', 'N', 'S', 'W'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr size_t kPageSize = 4096;
+
+// 快照布局：header | level0（页对齐，可直接映射）| labels[count] | levels[count] | 上层邻接表
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metric;
+    uint64_t dim;
+    uint64_t element_count;
+    uint64_t deleted_count;
+    uint64_t size_data_per_element;
+    uint64_t offset_level0;
+    uint64_t offset_data;
+    uint64_t label_offset;
+    uint64_t M;
+    uint64_t max_m;
+    uint64_t max_m0;
+    uint64_t ef_construction;
+    double mult;
+    int32_t max_level;
+    uint32_t enterpoint;
+    uint64_t level0_pos;
+    uint64_t labels_pos;
+    uint64_t levels_pos;
+    uint64_t links_pos;
+    uint64_t file_size;
+};
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::unique_ptr<hnswlib::SpaceInterface<float>> make_space(const infinite_rag::GraphParams& params) {
+    if (params.dim == 0) {
+        throw std::invalid_argument("Vector index dimension must be positive");
+    }
+    if (params.metric == infinite_rag::IndexMetric::L2) {
+        return std::make_unique<hnswlib::L2Space>(params.dim);
+    }
+    return std::make_unique<hnswlib::InnerProductSpace>(params.dim);
+}
+
+// 把 std::function 适配为 hnswlib 的过滤接口
+class FunctionFilter : public hnswlib::BaseFilterFunctor {
+public:
+    explicit FunctionFilter(const std::function<bool(uint64_t)>& fn) : fn_(fn) {}
+    bool operator()(hnswlib::labeltype id) override { return fn_(static_cast<uint64_t>(id)); }
+
+private:
+    const std::function<bool(uint64_t)>& fn_;
+};
+
+void write_padding(std::ofstream& out, size_t pos) {
+    static const char zeros[kPageSize] = {};
+    size_t current = static_cast<size_t>(out.tellp());
+    if (pos > current) out.write(zeros, static_cast<std::streamsize>(pos - current));
+}
+
+} // namespace
+
+namespace infinite_rag {
+
+HnswGraph::HnswGraph(const GraphParams& params) : params_(params), space_(make_space(params)) {}
+
+HnswGraph::HnswGraph(const GraphParams& params, size_t capacity) : HnswGraph(params) {
+    hnsw_ = std::make_unique<HnswIndex>(space_.get(), std::max<size_t>(capacity, 1), params.M,
+                                        params.ef_construction, params.random_seed);
+}
+
+HnswGraph::~HnswGraph() {
+    // level0 属于映射而非 malloc，交给 MappedFile 释放
+    if (mapping_.valid() && hnsw_) hnsw_->data_level0_memory_ = nullptr;
+}
+
+std::unique_ptr<HnswGraph> HnswGraph::open_snapshot(const std::string& path, const GraphParams& params) {
+    auto mapping = text_embedding::MappedFile::open_copy_on_write(path);
+    if (mapping.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Vector index snapshot is truncated: " + path);
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, mapping.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 || header.version != kSnapshotVersion) {
+        throw std::runtime_error("Not a vector index snapshot: " + path);
+    }
+    if (header.dim != params.dim || header.metric != static_cast<uint32_t>(params.metric)) {
+        throw std::runtime_error("Vector index snapshot " + path + " has dimension " + std::to_string(header.dim) +
+                                 ", expected " + std::to_string(params.dim) + " with the same metric");
+    }
+
+    const size_t count = header.element_count;
+    if (header.file_size != mapping.size() ||
+        header.level0_pos + count * header.size_data_per_element > header.labels_pos ||
+        header.labels_pos + count * sizeof(uint64_t) > header.levels_pos ||
+        header.levels_pos + count * sizeof(int32_t) > header.links_pos || header.links_pos > header.file_size) {
+        throw std::runtime_error("Vector index snapshot is corrupted: " + path);
+    }
+
+    // 图参数以快照为准
+    GraphParams graph_params = params;
+    graph_params.M = header.M;
+    graph_params.ef_construction = header.ef_construction;
+    if (count == 0) {
+        return std::make_unique<HnswGraph>(graph_params, 1);
+    }
+
+    std::unique_ptr<HnswGraph> graph(new HnswGraph(graph_params));
+    auto hnsw = std::make_unique<HnswIndex>(graph->space_.get());
+
+    // 与 hnswlib::loadIndex 相同的字段初始化，但 level0 不读入内存
+    hnsw->max_elements_ = count;
+    hnsw->size_data_per_element_ = header.size_data_per_element;
+    hnsw->offsetLevel0_ = header.offset_level0;
+    hnsw->offsetData_ = header.offset_data;
+    hnsw->label_offset_ = header.label_offset;
+    hnsw->maxlevel_ = header.max_level;
+    hnsw->enterpoint_node_ = header.enterpoint;
+    hnsw->M_ = header.M;
+    hnsw->maxM_ = header.max_m;
+    hnsw->maxM0_ = header.max_m0;
+    hnsw->mult_ = header.mult;
+    hnsw->revSize_ = 1.0 / header.mult;
+    hnsw->ef_construction_ = header.ef_construction;
+    hnsw->ef_ = 10;
+    hnsw->data_size_ = graph->space_->get_data_size();
+    hnsw->fstdistfunc_ = graph->space_->get_dist_func();
+    hnsw->dist_func_param_ = graph->space_->get_dist_func_param();
+    hnsw->size_links_per_element_ = hnsw->maxM_ * sizeof(hnswlib::tableint) + sizeof(hnswlib::linklistsizeint);
+    hnsw->size_links_level0_ = hnsw->maxM0_ * sizeof(hnswlib::tableint) + sizeof(hnswlib::linklistsizeint);
+    hnsw->level_generator_.seed(params.random_seed);
+    hnsw->update_probability_generator_.seed(params.random_seed + 1);
+
+    std::vector<std::mutex>(count).swap(hnsw->link_list_locks_);
+    std::vector<std::mutex>(HnswIndex::MAX_LABEL_OPERATION_LOCKS).swap(hnsw->label_op_locks_);
+    hnsw->visited_list_pool_.reset(new hnswlib::VisitedListPool(1, count));
+
+    hnsw->linkLists_ = static_cast<char**>(std::malloc(sizeof(void*) * count));
+    if (hnsw->linkLists_ == nullptr) {
+        throw std::runtime_error("Not enough memory to open vector index snapshot");
+    }
+    hnsw->element_levels_ = std::vector<int>(count);
+    // 未填充的 level 为 0，中途出错时 clear() 只释放已分配的上层邻接表
+    hnsw->cur_element_count = count;
+
+    // 标签表与上层邻接表（约 1/M 的元素）需要重建，均为顺序读
+    const char* base = static_cast<const char*>(mapping.data());
+    const auto* labels = reinterpret_cast<const uint64_t*>(base + header.labels_pos);
+    const auto* levels = reinterpret_cast<const int32_t*>(base + header.levels_pos);
+    const char* links = base + header.links_pos;
+    const char* links_end = base + header.file_size;
+
+    hnsw->label_lookup_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        hnsw->label_lookup_[labels[i]] = static_cast<hnswlib::tableint>(i);
+        hnsw->element_levels_[i] = levels[i];
+        hnsw->linkLists_[i] = nullptr;
+        if (levels[i] <= 0) continue;
+
+        const size_t bytes = hnsw->size_links_per_element_ * static_cast<size_t>(levels[i]);
+        if (links + bytes > links_end) {
+            throw std::runtime_error("Vector index snapshot is corrupted: " + path);
+        }
+        hnsw->linkLists_[i] = static_cast<char*>(std::malloc(bytes));
+        if (hnsw->linkLists_[i] == nullptr) {
+            throw std::runtime_error("Not enough memory to open vector index snapshot");
+        }
+        std::memcpy(hnsw->linkLists_[i], links, bytes);
+        links += bytes;
+    }
+    hnsw->num_deleted_ = header.deleted_count;
+
+    graph->mapping_ = std::move(mapping);
+    hnsw->data_level0_memory_ = static_cast<char*>(graph->mapping_.data()) + header.level0_pos;
+    graph->hnsw_ = std::move(hnsw);
+    return graph;
+}
+
+void HnswGraph::save_snapshot(const std::string& path) const {
+    namespace fs = std::filesystem;
+    const HnswIndex& hnsw = *hnsw_;
+    const size_t count = hnsw.cur_element_count;
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.metric = static_cast<uint32_t>(params_.metric);
+    header.dim = params_.dim;
+    header.element_count = count;
+    header.deleted_count = hnsw.num_deleted_;
+    header.size_data_per_element = hnsw.size_data_per_element_;
+    header.offset_level0 = hnsw.offsetLevel0_;
+    header.offset_data = hnsw.offsetData_;
+    header.label_offset = hnsw.label_offset_;
+    header.M = hnsw.M_;
+    header.max_m = hnsw.maxM_;
+    header.max_m0 = hnsw.maxM0_;
+    header.ef_construction = hnsw.ef_construction_;
+    header.mult = hnsw.mult_;
+    header.max_level = hnsw.maxlevel_;
+    header.enterpoint = hnsw.enterpoint_node_;
+    header.level0_pos = align_up(sizeof(SnapshotHeader), kPageSize);
+    header.labels_pos = align_up(header.level0_pos + count * hnsw.size_data_per_element_, sizeof(uint64_t));
+    header.levels_pos = header.labels_pos + count * sizeof(uint64_t);
+    header.links_pos = align_up(header.levels_pos + count * sizeof(int32_t), sizeof(uint64_t));
+
+    size_t links_bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (hnsw.element_levels_[i] > 0) links_bytes += hnsw.size_links_per_element_ * hnsw.element_levels_[i];
+    }
+    header.file_size = header.links_pos + links_bytes;
+
+    const fs::path target(path);
+    if (target.has_parent_path()) fs::create_directories(target.parent_path());
+    const std::string temp_file = path + ".tmp." + std::to_string(::getpid());
+
+    {
+        std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Unable to write vector index snapshot: " + temp_file);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_padding(out, header.level0_pos);
+        out.write(hnsw.data_level0_memory_, static_cast<std::streamsize>(count * hnsw.size_data_per_element_));
+
+        write_padding(out, header.labels_pos);
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t label = hnsw.getExternalLabel(static_cast<hnswlib::tableint>(i));
+            out.write(reinterpret_cast<const char*>(&label), sizeof(label));
+        }
+        for (size_t i = 0; i < count; ++i) {
+            int32_t level = hnsw.element_levels_[i];
+            out.write(reinterpret_cast<const char*>(&level), sizeof(level));
+        }
+
+        write_padding(out, header.links_pos);
+        for (size_t i = 0; i < count; ++i) {
+            if (hnsw.element_levels_[i] <= 0) continue;
+            out.write(hnsw.linkLists_[i],
+                      static_cast<std::streamsize>(hnsw.size_links_per_element_ * hnsw.element_levels_[i]));
+        }
+        if (!out) {
+            out.close();
+            fs::remove(temp_file);
+            throw std::runtime_error("Failed to write vector index snapshot: " + temp_file);
+        }
+    }
+
+    // 先写临时文件再 rename，已打开该快照的进程继续使用旧映射
+    std::error_code ec;
+    fs::rename(temp_file, path, ec);
+    if (ec) {
+        fs::remove(temp_file, ec);
+        throw std::runtime_error("Failed to save vector index snapshot " + path + ": " + ec.message());
+    }
+    LOG_DEBUG << "[VectorIndex] Saved snapshot " << path << " (" << count << " elements, "
+              << header.file_size << " bytes)";
+}
+
+bool HnswGraph::try_add(uint64_t id, const float* vector) {
+    try {
+        hnsw_->addPoint(vector, id);
+        return true;
+    } catch (const std::runtime_error&) {
+        if (hnsw_->getCurrentElementCount() >= hnsw_->getMaxElements()) return false;
+        throw;
+    }
+}
+
+bool HnswGraph::remove(uint64_t id) {
+    try {
+        hnsw_->markDelete(id);
+        return true;
+    } catch (const std::runtime_error&) {
+        // 标签不存在或已删除
+        return false;
+    }
+}
+
+bool HnswGraph::contains(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(hnsw_->label_lookup_lock);
+    auto it = hnsw_->label_lookup_.find(id);
+    return it != hnsw_->label_lookup_.end() && !hnsw_->isMarkedDeleted(it->second);
+}
+
+bool HnswGraph::get_vector(uint64_t id, float* out) const {
+    std::lock_guard<std::mutex> lock(hnsw_->label_lookup_lock);
+    auto it = hnsw_->label_lookup_.find(id);
+    if (it == hnsw_->label_lookup_.end() || hnsw_->isMarkedDeleted(it->second)) return false;
+    std::memcpy(out, hnsw_->getDataByInternalId(it->second), params_.dim * sizeof(float));
+    return true;
+}
+
+std::vector<SearchHit> HnswGraph::search(const float* query, size_t k,
+                                         const std::function<bool(uint64_t)>& filter) const {
+    FunctionFilter functor(filter);
+    auto top = hnsw_->searchKnn(query, k, filter ? &functor : nullptr);
+
+    // 结果堆按距离从大到小弹出
+    std::vector<SearchHit> hits(top.size());
+    for (size_t i = hits.size(); i-- > 0;) {
+        const auto& [distance, label] = top.top();
+        hits[i] = {static_cast<uint64_t>(label), to_score(distance)};
+        top.pop();
+    }
+    return hits;
+}
+
+std::vector<SearchHit> HnswGraph::score(const float* query, const std::vector<uint64_t>& ids) const {
+    std::vector<SearchHit> hits;
+    hits.reserve(ids.size());
+    {
+        std::lock_guard<std::mutex> lock(hnsw_->label_lookup_lock);
+        for (uint64_t id : ids) {
+            auto it = hnsw_->label_lookup_.find(id);
+            if (it == hnsw_->label_lookup_.end() || hnsw_->isMarkedDeleted(it->second)) continue;
+            float distance = hnsw_->fstdistfunc_(query, hnsw_->getDataByInternalId(it->second), hnsw_->dist_func_param_);
+            hits.push_back({id, to_score(distance)});
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) { return a.score > b.score; });
+    return hits;
+}
+
+float HnswGraph::to_score(float distance) const {
+    return (params_.metric == IndexMetric::INNER_PRODUCT) ? 1.0f - distance : -distance;
+}
+
+void HnswGraph::collect_live(size_t limit, std::vector<uint64_t>& ids, std::vector<float>& vectors) const {
+    limit = std::min(limit, element_count());
+    ids.reserve(ids.size() + limit - std::min(limit, deleted_count()));
+    for (size_t i = 0; i < limit; ++i) {
+        auto internal_id = static_cast<hnswlib::tableint>(i);
+        if (hnsw_->isMarkedDeleted(internal_id)) continue;
+        ids.push_back(hnsw_->getExternalLabel(internal_id));
+        const auto* data = reinterpret_cast<const float*>(hnsw_->getDataByInternalId(internal_id));
+        vectors.insert(vectors.end(), data, data + params_.dim);
+    }
+}
+
+void HnswGraph::reserve(size_t capacity) {
+    if (capacity <= hnsw_->getMaxElements()) return;
+
+    // resizeIndex 会 realloc level0，映射的内存须先拷贝到堆上
+    if (mapping_.valid()) {
+        const size_t bytes = hnsw_->getMaxElements() * hnsw_->size_data_per_element_;
+        char* heap = static_cast<char*>(std::malloc(std::max<size_t>(bytes, 1)));
+        if (heap == nullptr) throw std::runtime_error("Not enough memory to detach vector index snapshot");
+        std::memcpy(heap, hnsw_->data_level0_memory_, bytes);
+        hnsw_->data_level0_memory_ = heap;
+        mapping_.close();
+        LOG_DEBUG << "[VectorIndex] Detached level0 from snapshot (" << bytes << " bytes)";
+    }
+    hnsw_->resizeIndex(capacity);
+}
+
+void HnswGraph::set_ef(size_t ef) {
+    hnsw_->setEf(ef);
+}
+
+size_t HnswGraph::element_count() const {
+    return hnsw_->cur_element_count;
+}
+
+size_t HnswGraph::deleted_count() const {
+    return hnsw_->num_deleted_;
+}
+
+size_t HnswGraph::capacity() const {
+    return hnsw_->max_elements_;
+}
+
+} // namespace infinite_rag
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <hnswlib/hnswlib.h>
+
+namespace infinite_rag {
+
+enum class IndexMetric {
+    INNER_PRODUCT,  // 1 - 内积，适用于已归一化的 embedding（等价于余弦）
+    L2              // 欧氏距离平方
+};
+
+struct GraphParams {
+    size_t dim = 0;
+    IndexMetric metric = IndexMetric::INNER_PRODUCT;
+    size_t M = 16;
+    size_t ef_construction = 200;
+    size_t random_seed = 100;
+};
+
+struct SearchHit {
+    uint64_t id = 0;
+    float score = 0.0f;  // 越大越相似：内积为 1 - distance，L2 为 -distance
+};
+
+// hnswlib 图及其距离空间。
+// 从快照打开时 level0（向量与底层邻接表，占索引绝大部分体积）以写时复制方式映射到文件，
+// 不拷贝、不重建；首次扩容时才拷贝到堆上。
+// 线程安全性同 hnswlib：try_add/remove/search 可并发，reserve/set_ef/save_snapshot 需调用方独占。
+class HnswGraph {
+public:
+    HnswGraph(const GraphParams& params, size_t capacity);
+    ~HnswGraph();
+
+    HnswGraph(const HnswGraph&) = delete;
+    HnswGraph& operator=(const HnswGraph&) = delete;
+
+    // 打开快照；维度或距离与 params 不一致、文件损坏时抛出 std::runtime_error
+    static std::unique_ptr<HnswGraph> open_snapshot(const std::string& path, const GraphParams& params);
+    void save_snapshot(const std::string& path) const;
+
+    // 插入或覆盖（已删除的 id 会被恢复）；容量已满时返回 false
+    bool try_add(uint64_t id, const float* vector);
+    // 软删除，id 不存在或已删除时返回 false
+    bool remove(uint64_t id);
+    bool contains(uint64_t id) const;
+    // 拷贝 id 对应的向量，不存在或已删除时返回 false
+    bool get_vector(uint64_t id, float* out) const;
+
+    // filter 非空时只返回 filter(id) 为 true 的元素（在图遍历中过滤）
+    std::vector<SearchHit> search(const float* query, size_t k,
+                                  const std::function<bool(uint64_t)>& filter = nullptr) const;
+    // 对给定 id 逐个精确打分，跳过不存在或已删除的 id，按分数从高到低返回
+    std::vector<SearchHit> score(const float* query, const std::vector<uint64_t>& ids) const;
+
+    // 收集内部编号 [0, limit) 中未删除的元素，用于压缩重建
+    void collect_live(size_t limit, std::vector<uint64_t>& ids, std::vector<float>& vectors) const;
+
+    void reserve(size_t capacity);
+    void set_ef(size_t ef);
+
+    const GraphParams& params() const { return params_; }
+    size_t element_count() const;  // 含已删除
+    size_t deleted_count() const;
+    size_t capacity() const;
+    bool mapped() const { return mapping_.valid(); }
+
+private:
+    explicit HnswGraph(const GraphParams& params);
+    float to_score(float distance) const;
+
+    GraphParams params_;
+    std::unique_ptr<hnswlib::SpaceInterface<float>> space_;
+    std::unique_ptr<hnswlib::HierarchicalNSW<float>> hnsw_;
+    text_embedding::MappedFile mapping_;  // level0 映射到快照时有效
+};
+
+} // namespace infinite_rag
@@ -0,0 +1,208 @@
+#include "hybrid_retriever.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 每个 BM25 线程的排队上限，队列满时 retrieve 阻塞
+constexpr size_t kLexicalQueuePerThread = 64;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<uint64_t> hit_ids(const std::vector<infinite_rag::SearchHit>& hits) {
+    std::vector<uint64_t> ids;
+    ids.reserve(hits.size());
+    for (const auto& hit : hits) ids.push_back(hit.id);
+    return ids;
+}
+
+} // namespace
+
+namespace infinite_rag {
+
+std::vector<FusedHit> fuse_rrf(const std::vector<uint64_t>& lexical,
+                               const std::vector<uint64_t>& vector,
+                               double rrf_k, size_t k) {
+    std::unordered_map<uint64_t, FusedHit> fused;
+    auto accumulate = [&](const std::vector<uint64_t>& ranked, bool is_lexical) {
+        for (size_t rank = 0; rank < ranked.size(); ++rank) {
+            auto& hit = fused[ranked[rank]];
+            hit.id = ranked[rank];
+            hit.score += 1.0 / (rrf_k + static_cast<double>(rank + 1));
+            (is_lexical ? hit.lexical_rank : hit.vector_rank) = static_cast<int>(rank);
+        }
+    };
+    accumulate(lexical, true);
+    accumulate(vector, false);
+
+    std::vector<FusedHit> result;
+    result.reserve(fused.size());
+    for (auto& entry : fused) result.push_back(entry.second);
+
+    // 同分时按 id 排序，保证结果稳定
+    auto better = [](const FusedHit& a, const FusedHit& b) {
+        return a.score != b.score ? a.score > b.score : a.id < b.id;
+    };
+    if (result.size() > k) {
+        std::partial_sort(result.begin(), result.begin() + k, result.end(), better);
+        result.resize(k);
+    } else {
+        std::sort(result.begin(), result.end(), better);
+    }
+    return result;
+}
+
+HybridRetriever::HybridRetriever(ChunkStore& store, VectorIndex& index, text_embedding::TextEmbedding& model,
+                                 HybridRetrieverOptions options)
+    : store_(store),
+      index_(index),
+      model_(model),
+      options_(std::move(options)),
+      lexical_tasks_(std::max<size_t>(options_.lexical_threads, 1) * kLexicalQueuePerThread) {
+    for (size_t i = 0; i < options_.lexical_threads; ++i) {
+        lexical_workers_.emplace_back(&HybridRetriever::lexical_loop, this);
+    }
+}
+
+HybridRetriever::~HybridRetriever() {
+    lexical_tasks_.close();
+    for (auto& worker : lexical_workers_) worker.join();
+}
+
+void HybridRetriever::lexical_loop() {
+    // 异常由 packaged_task 转交给 retrieve 中的 future
+    while (auto task = lexical_tasks_.pop()) (*task)();
+}
+
+void HybridRetriever::add_chunks(const std::vector<Chunk>& chunks) {
+    if (chunks.empty()) return;
+    store_.upsert(chunks);
+
+    std::vector<uint64_t> ids;
+    std::vector<std::string> texts;
+    ids.reserve(chunks.size());
+    texts.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+        ids.push_back(chunk.id);
+        texts.push_back(chunk.text);
+    }
+    index_.add_texts(model_, ids, texts);
+}
+
+bool HybridRetriever::remove_chunk(uint64_t id) {
+    const bool in_index = index_.remove(id);
+    const bool in_store = store_.remove(id);
+    return in_index || in_store;
+}
+
+std::vector<uint64_t> HybridRetriever::vector_candidates(const std::vector<float>& query,
+                                                         const MetadataFilter& filter) const {
+    const size_t k = options_.candidates;
+    if (filter.empty()) {
+        return hit_ids(index_.search(query.data(), query.size(), k));
+    }
+
+    // 多取一个用于判断过滤结果是否超出精确打分档
+    auto allowed = store_.filter_ids(filter, options_.exact_search_limit + 1);
+    if (allowed.size() <= options_.exact_search_limit) {
+        auto hits = index_.score(query.data(), query.size(), allowed);
+        if (hits.size() > k) hits.resize(k);
+        return hit_ids(hits);
+    }
+    // 宽泛的过滤条件只计数不取回，选中图内过滤档时才取 id 集合
+    if (store_.count_filtered(filter, options_.filter_set_limit + 1) <= options_.filter_set_limit) {
+        allowed = store_.filter_ids(filter, options_.filter_set_limit);
+        std::unordered_set<uint64_t> allowed_set(allowed.begin(), allowed.end());
+        return hit_ids(index_.search(query.data(), query.size(), k,
+                                     [&allowed_set](uint64_t id) { return allowed_set.count(id) > 0; }));
+    }
+
+    // 过滤条件选择性很低：放大候选数检索后再过滤，绝大多数候选都会保留
+    auto candidates = hit_ids(index_.search(query.data(), query.size(), k * options_.post_filter_oversample));
+    candidates = store_.filter_candidates(filter, candidates);
+    if (candidates.size() > k) candidates.resize(k);
+    return candidates;
+}
+
+RetrievalResult HybridRetriever::retrieve(const std::string& query, size_t k, const MetadataFilter& filter) const {
+    RetrievalResult result;
+    if (k == 0) return result;
+    auto& timings = result.timings;
+    const auto start = Clock::now();
+
+    // BM25 交给常驻线程执行，与向量化+ANN 重叠
+    LexicalTask lexical_task([&] {
+        const auto lexical_start = Clock::now();
+        auto hits = store_.search_bm25(query, options_.candidates, filter);
+        timings.lexical_ms = elapsed_ms(lexical_start);
+        return hits;
+    });
+    auto lexical_future = lexical_task.get_future();
+    if (lexical_workers_.empty() || !lexical_tasks_.push(lexical_task)) lexical_task();
+
+    std::vector<uint64_t> vector_ids;
+    try {
+        auto stage_start = Clock::now();
+        const auto embedding = model_.embed(query);
+        timings.embed_ms = elapsed_ms(stage_start);
+
+        stage_start = Clock::now();
+        vector_ids = vector_candidates(embedding, filter);
+        timings.vector_ms = elapsed_ms(stage_start);
+    } catch (...) {
+        // 先等 BM25 线程结束，它引用了本函数的局部变量
+        lexical_future.wait();
+        throw;
+    }
+    const auto lexical_ids = [&] {
+        std::vector<uint64_t> ids;
+        for (const auto& hit : lexical_future.get()) ids.push_back(hit.id);
+        return ids;
+    }();
+
+    auto stage_start = Clock::now();
+    const auto fused = fuse_rrf(lexical_ids, vector_ids, options_.rrf_k, k);
+    timings.fusion_ms = elapsed_ms(stage_start);
+
+    stage_start = Clock::now();
+    std::unordered_map<uint64_t, Chunk> fetched;
+    if (options_.fetch_text) {
+        std::vector<uint64_t> ids;
+        for (const auto& hit : fused) ids.push_back(hit.id);
+        for (auto& chunk : store_.get_many(ids)) fetched.emplace(chunk.id, std::move(chunk));
+    }
+    for (const auto& hit : fused) {
+        RetrievedChunk chunk;
+        chunk.id = hit.id;
+        chunk.score = hit.score;
+        chunk.lexical_rank = hit.lexical_rank;
+        chunk.vector_rank = hit.vector_rank;
+        auto it = fetched.find(hit.id);
+        if (it != fetched.end()) {
+            chunk.doc_id = std::move(it->second.doc_id);
+            chunk.text = std::move(it->second.text);
+            chunk.metadata = std::move(it->second.metadata);
+        } else if (options_.fetch_text) {
+            continue;  // 检索期间被删除
+        }
+        result.chunks.push_back(std::move(chunk));
+    }
+    timings.fetch_ms = elapsed_ms(stage_start);
+    timings.total_ms = elapsed_ms(start);
+
+    LOG_DEBUG << "[HybridRetriever] " << result.chunks.size() << " results in " << timings.total_ms
+              << " ms (embed " << timings.embed_ms << ", vector " << timings.vector_ms
+              << ", bm25 " << timings.lexical_ms << ", fusion " << timings.fusion_ms
+              << ", fetch " << timings.fetch_ms << ")";
+    return result;
+}
+
+} // namespace infinite_rag
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "bounded_queue.h"
+#include "chunk_store.h"
+#include "text_embedding.h"
+#include "vector_index.h"
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace infinite_rag {
+
+struct HybridRetrieverOptions {
+    // 每一路（BM25 / 向量）取回的候选数
+    size_t candidates = 50;
+    // RRF 平滑常数：score = Σ 1 / (rrf_k + rank)
+    double rrf_k = 60.0;
+
+    // 过滤下推的分档：满足过滤条件的块不超过 exact_search_limit 时直接精确打分；
+    // 不超过 filter_set_limit 时在 HNSW 遍历中按 id 集合过滤；否则放大候选数后再过滤
+    size_t exact_search_limit = 2048;
+    size_t filter_set_limit = 65536;
+    size_t post_filter_oversample = 4;
+
+    // 是否从 SQLite 取回命中块的正文与元数据
+    bool fetch_text = true;
+
+    // 执行 BM25 的常驻线程数，不为每次检索创建线程；为 0 时在调用线程上先于向量检索执行
+    size_t lexical_threads = 2;
+};
+
+// 各阶段耗时（毫秒）。BM25 与向量化+ANN 并行执行，total 小于各阶段之和
+struct RetrievalTimings {
+    double embed_ms = 0.0;
+    double vector_ms = 0.0;
+    double lexical_ms = 0.0;
+    double fusion_ms = 0.0;
+    double fetch_ms = 0.0;
+    double total_ms = 0.0;
+};
+
+struct RetrievedChunk {
+    uint64_t id = 0;
+    std::string doc_id;
+    std::string text;
+    std::map<std::string, std::string> metadata;
+    double score = 0.0;      // RRF 融合分
+    int lexical_rank = -1;   // 在 BM25 结果中的名次（从 0 开始），未命中为 -1
+    int vector_rank = -1;    // 在向量结果中的名次，未命中为 -1
+};
+
+struct RetrievalResult {
+    std::vector<RetrievedChunk> chunks;
+    RetrievalTimings timings;
+};
+
+struct FusedHit {
+    uint64_t id = 0;
+    double score = 0.0;
+    int lexical_rank = -1;
+    int vector_rank = -1;
+};
+
+// 倒数排名融合：只用名次、不依赖两路分数的量纲
+std::vector<FusedHit> fuse_rrf(const std::vector<uint64_t>& lexical,
+                               const std::vector<uint64_t>& vector,
+                               double rrf_k, size_t k);
+
+// 混合检索：SQLite FTS5 的 BM25 与 HNSW 向量检索并行执行，RRF 融合后返回。
+// 不持有 store / index / model，调用方保证其生命周期长于本对象。
+class HybridRetriever {
+public:
+    HybridRetriever(ChunkStore& store, VectorIndex& index, text_embedding::TextEmbedding& model,
+                    HybridRetrieverOptions options = {});
+    // 执行完已排队的 BM25 任务后返回
+    ~HybridRetriever();
+
+    // 写入 SQLite 后向量化入库，块 id 即向量 id
+    void add_chunks(const std::vector<Chunk>& chunks);
+    bool remove_chunk(uint64_t id);
+
+    RetrievalResult retrieve(const std::string& query, size_t k, const MetadataFilter& filter = {}) const;
+
+private:
+    using LexicalTask = std::packaged_task<std::vector<LexicalHit>()>;
+
+    std::vector<uint64_t> vector_candidates(const std::vector<float>& query, const MetadataFilter& filter) const;
+    void lexical_loop();
+
+    ChunkStore& store_;
+    VectorIndex& index_;
+    text_embedding::TextEmbedding& model_;
+    HybridRetrieverOptions options_;
+
+    mutable BoundedQueue<LexicalTask> lexical_tasks_;
+    std::vector<std::thread> lexical_workers_;
+};
+
+} // namespace infinite_rag
@@ -0,0 +1,289 @@
+#include "ingestion_pipeline.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kStageNames[] = {"extract", "chunk", "embed", "index"};
+
+// FNV-1a；最高位清零，保证可作为 SQLite 的有符号主键
+uint64_t default_chunk_id(const std::string& doc_id, size_t chunk_index) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    };
+    for (unsigned char c : doc_id) mix(c);
+    mix(0);
+    for (size_t i = 0; i < sizeof(chunk_index); ++i) mix(static_cast<unsigned char>(chunk_index >> (8 * i)));
+    return hash & 0x7fffffffffffffffull;
+}
+
+// 统计一次处理的耗时，析构时累加到 busy_ns
+class BusyTimer {
+public:
+    explicit BusyTimer(std::atomic<uint64_t>& busy_ns) : busy_ns_(busy_ns), start_(Clock::now()) {}
+    ~BusyTimer() {
+        busy_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count(),
+                           std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t>& busy_ns_;
+    Clock::time_point start_;
+};
+
+} // namespace
+
+namespace infinite_rag {
+
+IngestionPipeline::IngestionPipeline(ChunkStore& store, VectorIndex& index, text_embedding::TextEmbedding& model,
+                                     const document_extractor::TextChunker& chunker, IngestionOptions options)
+    : store_(store),
+      index_(index),
+      model_(model),
+      chunker_(chunker),
+      options_(std::move(options)),
+      documents_(options_.document_queue),
+      texts_(options_.text_queue),
+      chunks_(options_.chunk_queue),
+      vectors_(options_.vector_queue),
+      start_time_(Clock::now()) {
+    if (!options_.chunk_id) options_.chunk_id = default_chunk_id;
+    options_.embed_batch_size = std::max<size_t>(options_.embed_batch_size, 1);
+    options_.index_batch_size = std::max<size_t>(options_.index_batch_size, 1);
+
+    // 每个阶段最后一个工作线程退出时关闭下游队列，关闭沿流水线依次传递
+    start_stage(EXTRACT, options_.extract_workers, [this] { extract_loop(); }, [this] { texts_.close(); });
+    start_stage(CHUNK, options_.chunk_workers, [this] { chunk_loop(); }, [this] { chunks_.close(); });
+    start_stage(EMBED, options_.embed_workers, [this] { embed_loop(); }, [this] { vectors_.close(); });
+    start_stage(INDEX, options_.index_workers, [this] { index_loop(); }, [] {});
+
+    if (options_.report_interval.count() > 0) {
+        reporter_ = std::thread([this] { reporter_loop(); });
+    }
+}
+
+IngestionPipeline::~IngestionPipeline() {
+    finish();
+}
+
+void IngestionPipeline::start_stage(Stage stage, size_t workers, std::function<void()> loop,
+                                    std::function<void()> on_done) {
+    workers = std::max<size_t>(workers, 1);
+    counters_[stage].running.store(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this, stage, loop, on_done] {
+            loop();
+            if (counters_[stage].running.fetch_sub(1) == 1) on_done();
+        });
+    }
+}
+
+void IngestionPipeline::submit(IngestionDocument document) {
+    if (!documents_.push(document)) {
+        throw std::logic_error("IngestionPipeline: submit after finish");
+    }
+}
+
+void IngestionPipeline::submit_file(const std::string& path, std::map<std::string, std::string> metadata) {
+    IngestionDocument document;
+    document.doc_id = path;
+    document.path = path;
+    document.metadata = std::move(metadata);
+    submit(std::move(document));
+}
+
+void IngestionPipeline::extract_loop() {
+    auto& counters = counters_[EXTRACT];
+    while (auto document = documents_.pop()) {
+        ExtractedDocument extracted;
+        {
+            BusyTimer timer(counters.busy_ns);
+            counters.items_in.fetch_add(1, std::memory_order_relaxed);
+            try {
+                extracted.text = document->path.empty()
+                                     ? document_extractor::extract_text(document->content, document->format)
+                                     : document_extractor::extract_file(document->path);
+            } catch (const std::exception& e) {
+                counters.failures.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARNING << "[Ingestion] Failed to extract " << document->doc_id << ": " << e.what();
+                continue;
+            }
+            extracted.doc_id = std::move(document->doc_id);
+            extracted.metadata = std::move(document->metadata);
+        }
+        if (!texts_.push(extracted)) break;
+        counters.items_out.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void IngestionPipeline::chunk_loop() {
+    auto& counters = counters_[CHUNK];
+    while (auto document = texts_.pop()) {
+        std::vector<document_extractor::TextChunk> pieces;
+        {
+            BusyTimer timer(counters.busy_ns);
+            counters.items_in.fetch_add(1, std::memory_order_relaxed);
+            try {
+                pieces = chunker_.split(document->text);
+            } catch (const std::exception& e) {
+                counters.failures.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARNING << "[Ingestion] Failed to chunk " << document->doc_id << ": " << e.what();
+                continue;
+            }
+        }
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            Chunk chunk;
+            chunk.id = options_.chunk_id(document->doc_id, i);
+            chunk.doc_id = document->doc_id;
+            chunk.text = std::move(pieces[i].text);
+            chunk.metadata = document->metadata;
+            if (!chunks_.push(chunk)) return;
+            counters.items_out.fetch_add(1, std::memory_order_relaxed);
+        }
+        documents_done_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void IngestionPipeline::embed_loop() {
+    auto& counters = counters_[EMBED];
+    std::vector<Chunk> batch;
+    std::vector<std::string> texts;
+    while (chunks_.pop_batch(batch, options_.embed_batch_size) > 0) {
+        std::vector<std::vector<float>> vectors;
+        {
+            BusyTimer timer(counters.busy_ns);
+            counters.items_in.fetch_add(batch.size(), std::memory_order_relaxed);
+            texts.clear();
+            for (const auto& chunk : batch) texts.push_back(chunk.text);
+            try {
+                vectors = model_.embed_batch(texts);
+                if (vectors.size() != batch.size()) throw std::runtime_error("embed_batch size mismatch");
+            } catch (const std::exception& e) {
+                counters.failures.fetch_add(batch.size(), std::memory_order_relaxed);
+                LOG_ERROR << "[Ingestion] Failed to embed " << batch.size() << " chunks: " << e.what();
+                batch.clear();
+                continue;
+            }
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            EmbeddedChunk item{std::move(batch[i]), std::move(vectors[i])};
+            if (!vectors_.push(item)) return;
+            counters.items_out.fetch_add(1, std::memory_order_relaxed);
+        }
+        batch.clear();
+    }
+}
+
+void IngestionPipeline::index_loop() {
+    auto& counters = counters_[INDEX];
+    std::vector<EmbeddedChunk> batch;
+    std::vector<Chunk> chunks;
+    std::vector<uint64_t> ids;
+    std::vector<std::vector<float>> vectors;
+    while (vectors_.pop_batch(batch, options_.index_batch_size) > 0) {
+        BusyTimer timer(counters.busy_ns);
+        counters.items_in.fetch_add(batch.size(), std::memory_order_relaxed);
+        chunks.clear();
+        ids.clear();
+        vectors.clear();
+        for (auto& item : batch) {
+            ids.push_back(item.chunk.id);
+            vectors.push_back(std::move(item.vector));
+            chunks.push_back(std::move(item.chunk));
+        }
+        try {
+            // 先写正文再写向量：向量可检索时正文一定已可取回
+            store_.upsert(chunks);
+            index_.add_batch(ids, vectors);
+            counters.items_out.fetch_add(batch.size(), std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            counters.failures.fetch_add(batch.size(), std::memory_order_relaxed);
+            LOG_ERROR << "[Ingestion] Failed to index " << batch.size() << " chunks: " << e.what();
+        }
+        batch.clear();
+    }
+}
+
+IngestionStats IngestionPipeline::finish() {
+    std::lock_guard<std::mutex> lock(finish_mutex_);
+    if (!finished_) {
+        documents_.close();
+        for (auto& worker : workers_) worker.join();
+        workers_.clear();
+        finish_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_).count());
+        if (reporter_.joinable()) {
+            {
+                std::lock_guard<std::mutex> reporter_lock(reporter_mutex_);
+                reporter_stop_ = true;
+            }
+            reporter_cv_.notify_all();
+            reporter_.join();
+        }
+        finished_ = true;
+        LOG_INFO << "[Ingestion] Finished: " << format_ingestion_stats(stats());
+    }
+    return stats();
+}
+
+IngestionStats IngestionPipeline::stats() const {
+    IngestionStats result;
+    const int64_t finish_ns = finish_ns_.load();
+    result.elapsed_ms = finish_ns > 0
+                            ? finish_ns / 1e6
+                            : std::chrono::duration<double, std::milli>(Clock::now() - start_time_).count();
+    result.documents = documents_done_.load(std::memory_order_relaxed);
+    result.chunks = counters_[INDEX].items_out.load(std::memory_order_relaxed);
+
+    const size_t workers[] = {options_.extract_workers, options_.chunk_workers, options_.embed_workers,
+                              options_.index_workers};
+    const size_t depths[] = {documents_.size(), texts_.size(), chunks_.size(), vectors_.size()};
+    const size_t max_depths[] = {documents_.max_depth(), texts_.max_depth(), chunks_.max_depth(), vectors_.max_depth()};
+    const size_t capacities[] = {documents_.capacity(), texts_.capacity(), chunks_.capacity(), vectors_.capacity()};
+    const double seconds = std::max(result.elapsed_ms, 1e-3) / 1000.0;
+    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+        const auto& counters = counters_[s];
+        StageStats stage;
+        stage.name = kStageNames[s];
+        stage.workers = std::max<size_t>(workers[s], 1);
+        stage.items_in = counters.items_in.load(std::memory_order_relaxed);
+        stage.items_out = counters.items_out.load(std::memory_order_relaxed);
+        stage.failures = counters.failures.load(std::memory_order_relaxed);
+        stage.busy_ms = counters.busy_ns.load(std::memory_order_relaxed) / 1e6;
+        stage.queue_depth = depths[s];
+        stage.max_queue_depth = max_depths[s];
+        stage.queue_capacity = capacities[s];
+        stage.items_per_second = stage.items_in / seconds;
+        stage.utilization = stage.busy_ms / (stage.workers * seconds * 1000.0);
+        result.stages.push_back(stage);
+    }
+    return result;
+}
+
+void IngestionPipeline::reporter_loop() {
+    std::unique_lock<std::mutex> lock(reporter_mutex_);
+    while (!reporter_cv_.wait_for(lock, options_.report_interval, [this] { return reporter_stop_; })) {
+        LOG_INFO << "[Ingestion] " << format_ingestion_stats(stats());
+    }
+}
+
+std::string format_ingestion_stats(const IngestionStats& stats) {
+    std::ostringstream out;
+    out.precision(1);
+    out << std::fixed << stats.documents << " docs, " << stats.chunks << " chunks in " << stats.elapsed_ms << " ms";
+    for (const auto& stage : stats.stages) {
+        out << " | " << stage.name << " x" << stage.workers << ": " << stage.items_in << " in, "
+            << stage.items_per_second << "/s, busy " << stage.utilization * 100.0 << "%, queue "
+            << stage.queue_depth << "/" << stage.queue_capacity << " (max " << stage.max_queue_depth << ")";
+        if (stage.failures) out << ", " << stage.failures << " failed";
+    }
+    return out.str();
+}
+
+} // namespace infinite_rag
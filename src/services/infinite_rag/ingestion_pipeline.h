@@ -0,0 +1,157 @@
+#pragma once
+
+#include "bounded_queue.h"
+#include "chunk_store.h"
+#include "text_chunker.h"
+#include "text_embedding.h"
+#include "text_extractor.h"
+#include "vector_index.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace infinite_rag {
+
+struct IngestionOptions {
+    // 各阶段的工作线程数
+    size_t extract_workers = 2;
+    size_t chunk_workers = 2;
+    size_t embed_workers = 1;
+    size_t index_workers = 1;
+
+    // 各阶段输入队列的容量，决定流水线在途数据的上限
+    size_t document_queue = 256;  // 待提取的文档（仅路径或原文）
+    size_t text_queue = 16;       // 提取后的全文
+    size_t chunk_queue = 1024;    // 待向量化的块
+    size_t vector_queue = 1024;   // 待入库的块与向量
+
+    // 单次 embed_batch 的块数与单次入库的块数
+    size_t embed_batch_size = 32;
+    size_t index_batch_size = 256;
+
+    // 大于 0 时后台按该间隔输出各阶段吞吐与队列深度
+    std::chrono::milliseconds report_interval{0};
+
+    // 块 id 生成；默认对 doc_id 与块序号做 64 位哈希，重复导入同一文档即覆盖原有的块
+    std::function<uint64_t(const std::string& doc_id, size_t chunk_index)> chunk_id;
+};
+
+struct IngestionDocument {
+    std::string doc_id;
+    // 非空时由提取阶段读取文件，格式按扩展名判断
+    std::string path;
+    // path 为空时直接使用
+    std::string content;
+    document_extractor::DocumentFormat format = document_extractor::DocumentFormat::PLAIN;
+    std::map<std::string, std::string> metadata;
+};
+
+struct StageStats {
+    const char* name = "";
+    size_t workers = 0;
+    uint64_t items_in = 0;      // 已处理的输入条数
+    uint64_t items_out = 0;     // 向下一阶段产出的条数
+    uint64_t failures = 0;      // 处理失败而丢弃的输入条数
+    double busy_ms = 0.0;       // 各工作线程处理耗时之和（不含排队等待）
+    size_t queue_depth = 0;     // 输入队列当前深度
+    size_t max_queue_depth = 0;
+    size_t queue_capacity = 0;
+    double items_per_second = 0.0;
+    double utilization = 0.0;   // busy_ms / (workers * 已运行时间)
+};
+
+struct IngestionStats {
+    // 依次为 extract、chunk、embed、index
+    std::vector<StageStats> stages;
+    double elapsed_ms = 0.0;
+    uint64_t documents = 0;     // 成功切块的文档数
+    uint64_t chunks = 0;        // 成功入库的块数
+};
+
+// 流式导入流水线：提取 → 切块 → 向量化 → 入库，阶段之间以有界队列连接。
+// 各阶段并行重叠执行，队列写满时上游阻塞（背压），内存占用与语料规模无关，
+// 只取决于队列容量与单个文档大小。单个文档或批次失败只计入统计，不中断流水线
+class IngestionPipeline {
+public:
+    IngestionPipeline(ChunkStore& store, VectorIndex& index, text_embedding::TextEmbedding& model,
+                      const document_extractor::TextChunker& chunker, IngestionOptions options = {});
+    // 未调用 finish 时等待已提交的文档处理完毕
+    ~IngestionPipeline();
+
+    IngestionPipeline(const IngestionPipeline&) = delete;
+    IngestionPipeline& operator=(const IngestionPipeline&) = delete;
+
+    // 文档队列已满时阻塞；finish 之后调用抛出 std::logic_error
+    void submit(IngestionDocument document);
+    // 以路径作为 doc_id
+    void submit_file(const std::string& path, std::map<std::string, std::string> metadata = {});
+
+    // 停止接收文档，等待各阶段排空后返回最终统计；可重复调用
+    IngestionStats finish();
+    // 运行中的统计快照
+    IngestionStats stats() const;
+
+private:
+    struct ExtractedDocument {
+        std::string doc_id;
+        std::string text;
+        std::map<std::string, std::string> metadata;
+    };
+    struct EmbeddedChunk {
+        Chunk chunk;
+        std::vector<float> vector;
+    };
+    struct StageCounters {
+        std::atomic<uint64_t> items_in{0};
+        std::atomic<uint64_t> items_out{0};
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<size_t> running{0};
+    };
+    enum Stage { EXTRACT = 0, CHUNK, EMBED, INDEX, STAGE_COUNT };
+
+    ChunkStore& store_;
+    VectorIndex& index_;
+    text_embedding::TextEmbedding& model_;
+    const document_extractor::TextChunker& chunker_;
+    IngestionOptions options_;
+
+    BoundedQueue<IngestionDocument> documents_;
+    BoundedQueue<ExtractedDocument> texts_;
+    BoundedQueue<Chunk> chunks_;
+    BoundedQueue<EmbeddedChunk> vectors_;
+
+    std::array<StageCounters, STAGE_COUNT> counters_;
+    std::atomic<uint64_t> documents_done_{0};
+    const std::chrono::steady_clock::time_point start_time_;
+    std::atomic<int64_t> finish_ns_{0};
+
+    std::vector<std::thread> workers_;
+    std::mutex finish_mutex_;
+    bool finished_ = false;
+
+    std::thread reporter_;
+    std::mutex reporter_mutex_;
+    std::condition_variable reporter_cv_;
+    bool reporter_stop_ = false;
+
+    void start_stage(Stage stage, size_t workers, std::function<void()> loop, std::function<void()> on_done);
+    void extract_loop();
+    void chunk_loop();
+    void embed_loop();
+    void index_loop();
+    void reporter_loop();
+};
+
+// 单行汇总各阶段统计，用于日志
+std::string format_ingestion_stats(const IngestionStats& stats);
+
+} // namespace infinite_rag
@@ -0,0 +1,321 @@
+#include "vector_index.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+size_t resolve_threads(size_t requested) {
+    if (requested > 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// 按块把 [0, count) 分给多个线程，任一线程的异常在汇合后重新抛出
+template <typename Fn>
+void parallel_for(size_t count, size_t num_threads, Fn&& fn) {
+    num_threads = std::min(num_threads, count);
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(num_threads);
+    const size_t chunk = (count + num_threads - 1) / num_threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            try {
+                const size_t end = std::min(count, (t + 1) * chunk);
+                for (size_t i = t * chunk; i < end; ++i) fn(i);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+} // namespace
+
+namespace infinite_rag {
+
+VectorIndex::VectorIndex(VectorIndexOptions options) : options_(std::move(options)) {
+    graph_ = std::make_unique<HnswGraph>(graph_params(), options_.initial_capacity);
+    graph_->set_ef(options_.ef_search);
+
+    if (options_.background_compaction) {
+        compaction_thread_ = std::thread([this] { compaction_loop(); });
+    }
+}
+
+VectorIndex::~VectorIndex() {
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        stop_ = true;
+    }
+    worker_cv_.notify_all();
+    if (compaction_thread_.joinable()) compaction_thread_.join();
+}
+
+GraphParams VectorIndex::graph_params() const {
+    GraphParams params;
+    params.dim = options_.dim;
+    params.metric = options_.metric;
+    params.M = options_.M;
+    params.ef_construction = options_.ef_construction;
+    params.random_seed = options_.random_seed;
+    return params;
+}
+
+void VectorIndex::check_dimension(size_t dim) const {
+    if (dim != options_.dim) {
+        throw std::invalid_argument("Vector dimension " + std::to_string(dim) +
+                                    " does not match index dimension " + std::to_string(options_.dim));
+    }
+}
+
+void VectorIndex::add(uint64_t id, const float* vector, size_t dim) {
+    check_dimension(dim);
+    std::shared_lock<std::shared_mutex> writer(writer_mutex_);
+    add_locked(id, vector);
+}
+
+void VectorIndex::add(uint64_t id, const std::vector<float>& vector) {
+    add(id, vector.data(), vector.size());
+}
+
+void VectorIndex::add_batch(const std::vector<uint64_t>& ids, const std::vector<std::vector<float>>& vectors) {
+    if (ids.size() != vectors.size()) {
+        throw std::invalid_argument("ids and vectors have different sizes");
+    }
+    for (const auto& vector : vectors) check_dimension(vector.size());
+
+    std::shared_lock<std::shared_mutex> writer(writer_mutex_);
+    parallel_for(ids.size(), resolve_threads(options_.num_threads),
+                 [&](size_t i) { add_locked(ids[i], vectors[i].data()); });
+}
+
+void VectorIndex::add_texts(text_embedding::TextEmbedding& model,
+                            const std::vector<uint64_t>& ids,
+                            const std::vector<std::string>& texts) {
+    if (ids.size() != texts.size()) {
+        throw std::invalid_argument("ids and texts have different sizes");
+    }
+    if (texts.empty()) return;
+    add_batch(ids, model.embed_batch(texts));
+}
+
+void VectorIndex::add_locked(uint64_t id, const float* vector) {
+    for (;;) {
+        {
+            std::shared_lock<std::shared_mutex> lock(index_mutex_);
+            if (graph_->try_add(id, vector)) {
+                record_change(id);
+                return;
+            }
+        }
+        grow();
+    }
+}
+
+void VectorIndex::grow() {
+    std::unique_lock<std::shared_mutex> lock(index_mutex_);
+    // 其他线程可能已经扩过容
+    if (graph_->element_count() < graph_->capacity()) return;
+
+    const size_t capacity = std::max(graph_->capacity() * 2, options_.initial_capacity);
+    graph_->reserve(capacity);
+    LOG_DEBUG << "[VectorIndex] Grew capacity to " << capacity;
+}
+
+void VectorIndex::record_change(uint64_t id) {
+    std::lock_guard<std::mutex> lock(journal_mutex_);
+    if (journaling_) journal_.push_back(id);
+}
+
+bool VectorIndex::remove(uint64_t id) {
+    bool removed = false;
+    {
+        std::shared_lock<std::shared_mutex> writer(writer_mutex_);
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        removed = graph_->remove(id);
+        if (removed) record_change(id);
+    }
+    if (removed) maybe_request_compaction();
+    return removed;
+}
+
+bool VectorIndex::contains(uint64_t id) const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    return graph_->contains(id);
+}
+
+std::vector<SearchHit> VectorIndex::search(const float* query, size_t dim, size_t k,
+                                           const std::function<bool(uint64_t)>& filter) const {
+    check_dimension(dim);
+    if (k == 0) return {};
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    return graph_->search(query, k, filter);
+}
+
+std::vector<SearchHit> VectorIndex::score(const float* query, size_t dim, const std::vector<uint64_t>& ids) const {
+    check_dimension(dim);
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    return graph_->score(query, ids);
+}
+
+std::vector<SearchHit> VectorIndex::search(const std::vector<float>& query, size_t k) const {
+    return search(query.data(), query.size(), k);
+}
+
+std::vector<SearchHit> VectorIndex::search_text(text_embedding::TextEmbedding& model,
+                                                const std::string& query, size_t k) const {
+    return search(model.embed(query), k);
+}
+
+void VectorIndex::set_ef_search(size_t ef) {
+    std::unique_lock<std::shared_mutex> lock(index_mutex_);
+    options_.ef_search = ef;
+    graph_->set_ef(ef);
+}
+
+void VectorIndex::maybe_request_compaction() {
+    if (!options_.background_compaction) return;
+    {
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        const size_t total = graph_->element_count();
+        if (total == 0 || graph_->deleted_count() < options_.compaction_threshold * total) return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        compaction_requested_ = true;
+    }
+    worker_cv_.notify_one();
+}
+
+void VectorIndex::compaction_loop() {
+    std::unique_lock<std::mutex> lock(worker_mutex_);
+    for (;;) {
+        worker_cv_.wait(lock, [this] { return stop_ || compaction_requested_; });
+        if (stop_) return;
+        compaction_requested_ = false;
+
+        lock.unlock();
+        try {
+            compact();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "[VectorIndex] Background compaction failed: " << e.what();
+        }
+        lock.lock();
+    }
+}
+
+void VectorIndex::compact() {
+    std::lock_guard<std::mutex> compaction_lock(compaction_mutex_);
+    const auto start = std::chrono::steady_clock::now();
+
+    // 1. 等在途写入结束后确定快照范围并开始记录修改
+    size_t snapshot_count = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        if (graph_->deleted_count() == 0) return;
+        snapshot_count = graph_->element_count();
+        std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+        journaling_ = true;
+        journal_.clear();
+    }
+
+    // 2. 拷贝存活元素，与增删查并发
+    std::vector<uint64_t> ids;
+    std::vector<float> vectors;
+    {
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        graph_->collect_live(snapshot_count, ids, vectors);
+    }
+
+    // 3. 在锁外重建新图
+    auto fresh = std::make_unique<HnswGraph>(graph_params(), std::max(ids.size(), options_.initial_capacity));
+    parallel_for(ids.size(), resolve_threads(options_.num_threads),
+                 [&](size_t i) { fresh->try_add(ids[i], vectors.data() + i * options_.dim); });
+
+    // 4. 回放压缩期间的修改后换图，以旧图中的最终状态为准
+    size_t replayed = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+        std::vector<float> vector(options_.dim);
+        for (uint64_t id : journal_) {
+            if (graph_->get_vector(id, vector.data())) {
+                if (!fresh->try_add(id, vector.data())) {
+                    fresh->reserve(fresh->capacity() * 2);
+                    fresh->try_add(id, vector.data());
+                }
+            } else {
+                fresh->remove(id);
+            }
+        }
+        replayed = journal_.size();
+        journaling_ = false;
+        journal_.clear();
+
+        fresh->set_ef(options_.ef_search);
+        graph_.swap(fresh);
+    }
+    compactions_.fetch_add(1, std::memory_order_relaxed);
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO << "[VectorIndex] Compacted " << fresh->element_count() << " -> " << ids.size()
+             << " elements (replayed " << replayed << " changes) in " << ms << " ms";
+    // 旧图在锁外释放
+}
+
+bool VectorIndex::save(const std::string& path) {
+    try {
+        std::unique_lock<std::shared_mutex> writer(writer_mutex_);
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        graph_->save_snapshot(path);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[VectorIndex] Failed to save snapshot " << path << ": " << e.what();
+        return false;
+    }
+}
+
+bool VectorIndex::load(const std::string& path) {
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        auto graph = HnswGraph::open_snapshot(path, graph_params());
+        graph->set_ef(options_.ef_search);
+
+        std::lock_guard<std::mutex> compaction_lock(compaction_mutex_);
+        std::unique_lock<std::shared_mutex> writer(writer_mutex_);
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        graph_.swap(graph);
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO << "[VectorIndex] Opened snapshot " << path << " with " << graph_->element_count()
+                 << " elements in " << ms << " ms";
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[VectorIndex] Failed to open snapshot " << path << ": " << e.what();
+        return false;
+    }
+}
+
+VectorIndexStats VectorIndex::stats() const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    VectorIndexStats stats;
+    stats.deleted = graph_->deleted_count();
+    stats.size = graph_->element_count() - stats.deleted;
+    stats.capacity = graph_->capacity();
+    stats.mapped = graph_->mapped();
+    stats.compactions = compactions_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace infinite_rag
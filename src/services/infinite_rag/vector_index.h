@@ -0,0 +1,124 @@
+#pragma once
+
+#include "hnsw_graph.h"
+#include "text_embedding.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace infinite_rag {
+
+struct VectorIndexOptions {
+    size_t dim = 0;
+    IndexMetric metric = IndexMetric::INNER_PRODUCT;
+
+    // HNSW 图参数：M 越大召回越高、内存与建图耗时越大；ef_search 可在运行时调整
+    size_t M = 16;
+    size_t ef_construction = 200;
+    size_t ef_search = 64;
+
+    // 初始容量，写满后按倍数扩容
+    size_t initial_capacity = 10000;
+    // add_batch 的并行线程数，0 表示使用硬件线程数
+    size_t num_threads = 0;
+
+    // 已删除元素占比超过阈值时在后台重建图，回收空间并恢复召回
+    bool background_compaction = true;
+    double compaction_threshold = 0.2;
+
+    size_t random_seed = 100;
+};
+
+struct VectorIndexStats {
+    size_t size = 0;          // 未删除的元素数
+    size_t deleted = 0;       // 已软删除、等待压缩的元素数
+    size_t capacity = 0;
+    bool mapped = false;      // level0 仍映射在快照文件上
+    uint64_t compactions = 0;
+};
+
+// 增量式 HNSW 向量索引：并发插入/检索、软删除 + 后台压缩、mmap 快照。
+// id 由调用方分配（通常是文档块在 SQLite 中的主键），同一 id 再次插入即覆盖。
+class VectorIndex {
+public:
+    explicit VectorIndex(VectorIndexOptions options);
+    ~VectorIndex();
+
+    VectorIndex(const VectorIndex&) = delete;
+    VectorIndex& operator=(const VectorIndex&) = delete;
+
+    // 插入或覆盖，维度不匹配时抛出 std::invalid_argument
+    void add(uint64_t id, const float* vector, size_t dim);
+    void add(uint64_t id, const std::vector<float>& vector);
+    void add_batch(const std::vector<uint64_t>& ids, const std::vector<std::vector<float>>& vectors);
+
+    // 批量向量化后直接入库，ids 与 texts 一一对应
+    void add_texts(text_embedding::TextEmbedding& model,
+                   const std::vector<uint64_t>& ids,
+                   const std::vector<std::string>& texts);
+
+    // 软删除：立即从检索结果中消失，空间在压缩时回收
+    bool remove(uint64_t id);
+    bool contains(uint64_t id) const;
+
+    // 按相似度从高到低返回至多 k 条。
+    // filter 非空时在图遍历中过滤，适合中等选择性的过滤条件
+    std::vector<SearchHit> search(const float* query, size_t dim, size_t k,
+                                  const std::function<bool(uint64_t)>& filter = nullptr) const;
+    std::vector<SearchHit> search(const std::vector<float>& query, size_t k) const;
+    // 对候选 id 精确打分，适合选择性很高、候选很少的过滤条件
+    std::vector<SearchHit> score(const float* query, size_t dim, const std::vector<uint64_t>& ids) const;
+    std::vector<SearchHit> search_text(text_embedding::TextEmbedding& model, const std::string& query, size_t k) const;
+
+    void set_ef_search(size_t ef);
+
+    // 同步压缩：用未删除的元素重建图，期间读写照常进行
+    void compact();
+
+    // 保存快照；期间写入阻塞，检索照常
+    bool save(const std::string& path);
+    // 打开快照并替换当前内容，level0 以 mmap 方式打开，不重建图
+    bool load(const std::string& path);
+
+    VectorIndexStats stats() const;
+    size_t dimension() const { return options_.dim; }
+
+private:
+    GraphParams graph_params() const;
+    void check_dimension(size_t dim) const;
+    void add_locked(uint64_t id, const float* vector);
+    void grow();
+    void record_change(uint64_t id);
+    void maybe_request_compaction();
+    void compaction_loop();
+
+    VectorIndexOptions options_;
+
+    // 锁顺序：compaction_mutex_ -> writer_mutex_ -> index_mutex_ -> journal_mutex_
+    mutable std::shared_mutex index_mutex_;   // 共享：增删查；独占：扩容、换图、调整 ef
+    std::shared_mutex writer_mutex_;          // 共享：增删；独占：保存快照
+    std::unique_ptr<HnswGraph> graph_;
+
+    // 压缩期间记录被修改的 id，换图前从旧图回放
+    std::mutex compaction_mutex_;
+    std::mutex journal_mutex_;
+    bool journaling_ = false;
+    std::vector<uint64_t> journal_;
+    std::atomic<uint64_t> compactions_{0};
+
+    std::mutex worker_mutex_;
+    std::condition_variable worker_cv_;
+    bool compaction_requested_ = false;
+    bool stop_ = false;
+    std::thread compaction_thread_;
+};
+
+} // namespace infinite_rag
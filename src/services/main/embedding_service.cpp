@@ -0,0 +1,135 @@
+#include "embedding_service.h"
+
+#include <stdexcept>
+
+#include "json.h"
+#include "logger.h"
+
+namespace {
+
+// 单个 float 序列化后的平均长度上界，用于预留回复缓冲区
+constexpr size_t kBytesPerFloat = 14;
+
+// 覆盖写入第 index 个元素，已有元素的容量得以复用
+std::string& slot(std::vector<std::string>& inputs, size_t index) {
+    if (index == inputs.size()) inputs.emplace_back();
+    return inputs[index];
+}
+
+} // namespace
+
+namespace http_service {
+
+void parse_embedding_request(std::string_view body, size_t max_inputs, EmbeddingRequest& request) {
+    JsonReader reader(body);
+    thread_local std::string key;
+    size_t count = 0;
+    bool has_input = false;
+
+    reader.begin_object();
+    while (reader.next_key(key)) {
+        if (key != "input") {
+            reader.skip_value();
+            continue;
+        }
+        has_input = true;
+        if (reader.peek() == JsonType::STRING) {
+            request.batch = false;
+            reader.read_string(slot(request.inputs, 0));
+            count = 1;
+            continue;
+        }
+        if (reader.peek() != JsonType::ARRAY) throw std::invalid_argument("\"input\" must be a string or an array");
+        request.batch = true;
+        count = 0;
+        reader.begin_array();
+        while (reader.next_element()) {
+            if (count == max_inputs) {
+                throw std::invalid_argument("too many inputs, limit is " + std::to_string(max_inputs));
+            }
+            if (reader.peek() != JsonType::STRING) throw std::invalid_argument("\"input\" items must be strings");
+            reader.read_string(slot(request.inputs, count++));
+        }
+    }
+    reader.expect_end();
+    if (!has_input) throw std::invalid_argument("missing \"input\"");
+    request.inputs.resize(count);
+}
+
+void write_embedding_response(const std::string& model_name,
+                              const std::vector<std::vector<float>>& embeddings,
+                              std::string& out) {
+    const size_t dim = embeddings.empty() ? 0 : embeddings.front().size();
+    out.clear();
+    out.reserve(64 + model_name.size() + embeddings.size() * (32 + dim * kBytesPerFloat));
+
+    out += "{\"model\":";
+    append_json_string(out, model_name);
+    out += ",\"dim\":";
+    out += std::to_string(dim);
+    out += ",\"data\":[";
+    for (size_t i = 0; i < embeddings.size(); ++i) {
+        if (i) out += ',';
+        out += "{\"index\":";
+        out += std::to_string(i);
+        out += ",\"embedding\":[";
+        const auto& vec = embeddings[i];
+        for (size_t d = 0; d < vec.size(); ++d) {
+            if (d) out += ',';
+            append_json_number(out, vec[d]);
+        }
+        out += "]}";
+    }
+    out += "]}";
+}
+
+EmbeddingService::EmbeddingService(text_embedding::TextEmbedding& model, EmbeddingServiceOptions options)
+    : model_(model), options_(std::move(options)), pool_(options_.workers, options_.queue_capacity) {}
+
+EmbeddingService::~EmbeddingService() {
+    pool_.shutdown();
+}
+
+void EmbeddingService::register_routes(HttpServer& server) {
+    server.route("POST", "/api/embeddings", [this](HttpRequest& request, HttpResponder responder) {
+        handle(request, std::move(responder));
+    });
+}
+
+void EmbeddingService::handle(HttpRequest& request, HttpResponder responder) {
+    auto task = [this, body = std::move(request.body), responder]() {
+        responder.send(run(body));
+    };
+    if (!pool_.try_submit(std::move(task))) {
+        responder.send(HttpResponse::error(503, "embedding queue is full"));
+    }
+}
+
+HttpResponse EmbeddingService::run(const std::string& body) {
+    // 每个工作线程复用解析缓冲区
+    thread_local EmbeddingRequest request;
+    try {
+        parse_embedding_request(body, options_.max_inputs, request);
+    } catch (const std::invalid_argument& e) {
+        return HttpResponse::error(400, e.what());
+    }
+
+    std::vector<std::vector<float>> embeddings;
+    try {
+        if (request.batch) {
+            if (!request.inputs.empty()) embeddings = model_.embed_batch(request.inputs);
+        } else {
+            embeddings.push_back(model_.embed(request.inputs.front()));
+        }
+    } catch (const std::exception& e) {
+        // 异常消息可能含模型路径等内部细节，只写日志，不回给客户端
+        LOG_ERROR << "[EmbeddingService] Inference failed: " << e.what();
+        return HttpResponse::error(500, "inference failed");
+    }
+
+    std::string out;
+    write_embedding_response(options_.model_name, embeddings, out);
+    return HttpResponse::json(200, std::move(out));
+}
+
+} // namespace http_service
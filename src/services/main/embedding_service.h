@@ -0,0 +1,60 @@
+#pragma once
+
+#include "http_server.h"
+#include "text_embedding.h"
+#include "worker_pool.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http_service {
+
+struct EmbeddingServiceOptions {
+    // 执行推理的工作线程数，与连接数无关。模型为 BatchingEmbedding 时单条请求在工作线程上阻塞等待，
+    // 线程数应不小于其 max_batch_size，否则微批大小受限于线程数
+    size_t workers = 4;
+    // 排队请求上限，超出时回复 503
+    size_t queue_capacity = 1024;
+    // 单个请求的最大文本条数
+    size_t max_inputs = 256;
+    // 回复中的 model 字段
+    std::string model_name = "default";
+};
+
+// 解析后的向量化请求：{"input": "text"} 或 {"input": ["a", "b", ...]}，其他字段忽略
+struct EmbeddingRequest {
+    std::vector<std::string> inputs;
+    // 单个字符串走 embed，数组走 embed_batch
+    bool batch = false;
+};
+
+// 解析到 request 中；inputs 的元素被覆盖复用，保留各自容量。格式错误时抛出 std::invalid_argument
+void parse_embedding_request(std::string_view body, size_t max_inputs, EmbeddingRequest& request);
+
+// 输出 {"model":..,"dim":..,"data":[{"index":i,"embedding":[...]}]}，按向量总数预留容量
+void write_embedding_response(const std::string& model_name,
+                              const std::vector<std::vector<float>>& embeddings,
+                              std::string& out);
+
+// POST /api/embeddings：I/O 线程只负责转交，解析、推理与序列化都在工作线程上完成
+class EmbeddingService {
+public:
+    EmbeddingService(text_embedding::TextEmbedding& model, EmbeddingServiceOptions options = {});
+    ~EmbeddingService();
+
+    void register_routes(HttpServer& server);
+    void handle(HttpRequest& request, HttpResponder responder);
+
+    // 停止接收请求，等待已排队的请求完成
+    void shutdown() { pool_.shutdown(); }
+
+private:
+    text_embedding::TextEmbedding& model_;
+    EmbeddingServiceOptions options_;
+    WorkerPool pool_;
+
+    HttpResponse run(const std::string& body);
+};
+
+} // namespace http_service
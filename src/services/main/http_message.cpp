@@ -0,0 +1,194 @@
+#include "http_message.h"
+
+#include <charconv>
+
+#include "json.h"
+
+namespace {
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i];
+        char y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// 逗号分隔的取值列表中是否含有 token（Connection: keep-alive, Upgrade 等）
+bool header_has_token(std::string_view value, std::string_view token) {
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string_view::npos) end = value.size();
+        std::string_view item = value.substr(start, end - start);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (iequals(item, token)) return true;
+        start = end + 1;
+    }
+    return false;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+} // namespace
+
+namespace http_service {
+
+const std::string* HttpRequest::header(std::string_view name) const {
+    for (const auto& h : headers) {
+        if (iequals(h.name, name)) return &h.value;
+    }
+    return nullptr;
+}
+
+HttpResponse HttpResponse::json(int status, std::string body) {
+    HttpResponse response;
+    response.status = status;
+    response.body = std::move(body);
+    return response;
+}
+
+HttpResponse HttpResponse::error(int status, std::string_view message) {
+    std::string body = "{\"error\":";
+    append_json_string(body, message);
+    body += '}';
+    return json(status, std::move(body));
+}
+
+ParseResult parse_http_request(std::string_view buffer, const ParseLimits& limits, HttpRequest& request) {
+    ParseResult result;
+    const size_t header_end = buffer.find("\r\n\r\n");
+    if (header_end == std::string_view::npos) {
+        if (buffer.size() > limits.max_header_bytes) result.status = ParseStatus::TOO_LARGE;
+        return result;
+    }
+    if (header_end + 4 > limits.max_header_bytes) {
+        result.status = ParseStatus::TOO_LARGE;
+        return result;
+    }
+
+    // 请求行：METHOD SP target SP HTTP/1.x
+    const std::string_view head = buffer.substr(0, header_end);
+    size_t line_end = head.find("\r\n");
+    if (line_end == std::string_view::npos) line_end = head.size();
+    const std::string_view line = head.substr(0, line_end);
+    const size_t sp1 = line.find(' ');
+    const size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp1 == std::string_view::npos || sp2 == std::string_view::npos || sp1 == 0 || sp2 == sp1 + 1) {
+        result.status = ParseStatus::BAD_REQUEST;
+        return result;
+    }
+    const std::string_view version = line.substr(sp2 + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        result.status = ParseStatus::BAD_REQUEST;
+        return result;
+    }
+    const std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    const size_t question = target.find('?');
+
+    request.method.assign(line.data(), sp1);
+    request.path.assign(target.substr(0, question));
+    request.query.assign(question == std::string_view::npos ? std::string_view() : target.substr(question + 1));
+    request.headers.clear();
+    request.body.clear();
+    // HTTP/1.1 默认长连接，HTTP/1.0 需要显式声明
+    request.keep_alive = version == "HTTP/1.1";
+
+    size_t content_length = 0;
+    bool expect_continue = false;
+    size_t pos = line_end + 2;
+    while (pos < head.size() + 2) {
+        size_t end = head.find("\r\n", pos);
+        if (end == std::string_view::npos) end = head.size();
+        const std::string_view field = head.substr(pos, end - pos);
+        pos = end + 2;
+        const size_t colon = field.find(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            result.status = ParseStatus::BAD_REQUEST;
+            return result;
+        }
+        const std::string_view name = field.substr(0, colon);
+        const std::string_view value = trim(field.substr(colon + 1));
+
+        if (iequals(name, "Content-Length")) {
+            const auto parsed = std::from_chars(value.data(), value.data() + value.size(), content_length);
+            if (value.empty() || parsed.ec != std::errc() || parsed.ptr != value.data() + value.size()) {
+                result.status = ParseStatus::BAD_REQUEST;
+                return result;
+            }
+        } else if (iequals(name, "Transfer-Encoding")) {
+            result.status = ParseStatus::NOT_IMPLEMENTED;
+            return result;
+        } else if (iequals(name, "Connection")) {
+            if (header_has_token(value, "close")) request.keep_alive = false;
+            if (header_has_token(value, "keep-alive")) request.keep_alive = true;
+        } else if (iequals(name, "Expect")) {
+            expect_continue = iequals(value, "100-continue");
+        }
+        request.headers.push_back({std::string(name), std::string(value)});
+    }
+
+    if (content_length > limits.max_body_bytes) {
+        result.status = ParseStatus::TOO_LARGE;
+        return result;
+    }
+    const size_t body_start = header_end + 4;
+    if (buffer.size() - body_start < content_length) {
+        result.expect_continue = expect_continue;
+        return result;
+    }
+    request.body.assign(buffer.substr(body_start, content_length));
+    result.status = ParseStatus::COMPLETE;
+    result.consumed = body_start + content_length;
+    return result;
+}
+
+const char* status_reason(int status) {
+    switch (status) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 422: return "Unprocessable Entity";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+void serialize_response_head(const HttpResponse& response, bool keep_alive, std::string& out) {
+    out.clear();
+    out += "HTTP/1.1 ";
+    out += std::to_string(response.status);
+    out += ' ';
+    out += status_reason(response.status);
+    out += "\r\nContent-Type: ";
+    out += response.content_type;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(response.body.size());
+    out += keep_alive ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n";
+    for (const auto& h : response.headers) {
+        out += h.name;
+        out += ": ";
+        out += h.value;
+        out += "\r\n";
+    }
+    out += "\r\n";
+}
+
+} // namespace http_service
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http_service {
+
+struct HttpHeader {
+    std::string name;
+    std::string value;
+};
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string query;  // '?' 之后的部分，不解码
+    std::vector<HttpHeader> headers;
+    std::string body;
+    bool keep_alive = true;
+
+    // 按名称查找，不区分大小写；不存在时返回空指针
+    const std::string* header(std::string_view name) const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::vector<HttpHeader> headers;
+    // 序列化时不拷贝，与状态行、头部一起通过 writev 写出
+    std::string body;
+
+    static HttpResponse json(int status, std::string body);
+    // {"error": message}
+    static HttpResponse error(int status, std::string_view message);
+};
+
+struct ParseLimits {
+    // 请求行 + 头部的最大字节数
+    size_t max_header_bytes = 16 * 1024;
+    size_t max_body_bytes = 8 * 1024 * 1024;
+};
+
+enum class ParseStatus {
+    INCOMPLETE,
+    COMPLETE,
+    BAD_REQUEST,      // 400
+    TOO_LARGE,        // 413 / 431
+    NOT_IMPLEMENTED,  // 501，例如 chunked 请求体
+};
+
+struct ParseResult {
+    ParseStatus status = ParseStatus::INCOMPLETE;
+    // COMPLETE 时为该请求占用的字节数，其后可能是流水线中的下一个请求
+    size_t consumed = 0;
+    // 头部已完整、请求体未到齐且客户端带了 Expect: 100-continue
+    bool expect_continue = false;
+};
+
+// 从 buffer 开头解析一个 HTTP/1.x 请求；INCOMPLETE 时 request 的内容未定义
+ParseResult parse_http_request(std::string_view buffer, const ParseLimits& limits, HttpRequest& request);
+
+const char* status_reason(int status);
+
+// 写出状态行与头部（含 Content-Length），正文由调用方单独发送
+void serialize_response_head(const HttpResponse& response, bool keep_alive, std::string& out);
+
+} // namespace http_service
@@ -0,0 +1,529 @@
+#include "http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "logger.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t kListenerId = 0;
+constexpr uint64_t kWakeId = 1;
+constexpr uint64_t kFirstConnectionId = 2;
+constexpr size_t kReadChunk = 16 * 1024;
+constexpr int kMaxEvents = 256;
+constexpr char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+// 工作线程完成的回复，由所属 I/O 线程取出写回。
+// eventfd 归队列所有：工作线程可能在 I/O 线程退出后才 push，持有队列即保证 fd 仍有效
+struct ResponseQueue {
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, http_service::HttpResponse>> items;
+    int wake_fd = -1;
+    std::atomic<std::thread::id> loop_thread{};
+    bool closed = false;
+
+    ~ResponseQueue() {
+        if (wake_fd >= 0) ::close(wake_fd);
+    }
+
+    void push(uint64_t connection, http_service::HttpResponse response) {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) return;
+            // 队列非空说明已有唤醒在途；I/O 线程自己推入的回复在本轮循环末尾处理
+            wake = items.empty() && std::this_thread::get_id() != loop_thread.load();
+            items.emplace_back(connection, std::move(response));
+        }
+        if (wake) {
+            const uint64_t one = 1;
+            ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+};
+
+int create_listener(const std::string& host, uint16_t port, int backlog, bool reuse_port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    const std::string ip = host == "localhost" ? "127.0.0.1" : host;
+    if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+        LOG_ERROR << "[HttpServer] Invalid IPv4 address: " << host;
+        return -1;
+    }
+
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR << "[HttpServer] socket() failed: " << std::strerror(errno);
+        return -1;
+    }
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (reuse_port) setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, backlog) < 0) {
+        LOG_ERROR << "[HttpServer] Failed to listen on " << host << ":" << port << ": " << std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+uint16_t bound_port(int fd) {
+    sockaddr_in addr{};
+    socklen_t length = sizeof(addr);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+} // namespace
+
+namespace http_service {
+
+struct HttpResponder::State {
+    std::shared_ptr<ResponseQueue> queue;
+    uint64_t connection = 0;
+    std::atomic<bool> sent{false};
+
+    ~State() {
+        if (!sent.load()) queue->push(connection, HttpResponse::error(500, "request was not answered"));
+    }
+};
+
+void HttpResponder::send(HttpResponse response) const {
+    if (!state_ || state_->sent.exchange(true)) return;
+    state_->queue->push(state_->connection, std::move(response));
+}
+
+class HttpServer::EventLoop {
+public:
+    EventLoop(HttpServer& server, int listen_fd);
+    ~EventLoop();
+
+    bool start();
+    void stop();
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        // 待写出的头部与正文；out_offset 为二者拼接后的已写字节数
+        std::string out_head;
+        std::string out_body;
+        size_t out_offset = 0;
+        bool busy = false;          // 已分发、等待回复
+        bool keep_alive = true;
+        bool close_after_write = false;
+        bool want_write = false;    // 已注册 EPOLLOUT
+        bool continue_sent = false;
+        Clock::time_point last_active;
+    };
+
+    HttpServer& server_;
+    int listen_fd_;
+    int epoll_fd_ = -1;
+    std::shared_ptr<ResponseQueue> queue_;
+    std::vector<std::pair<uint64_t, HttpResponse>> draining_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    std::unordered_map<uint64_t, Connection> connections_;
+    uint64_t next_id_ = kFirstConnectionId;
+
+    void run();
+    void accept_all();
+    void on_readable(uint64_t id, Connection& conn);
+    bool process(uint64_t id, Connection& conn);
+    void dispatch(uint64_t id, HttpRequest& request);
+    bool deliver(uint64_t id, Connection& conn, HttpResponse response);
+    bool flush(uint64_t id, Connection& conn);
+    bool drain_responses();
+    void sweep_idle();
+    void set_events(uint64_t id, Connection& conn, bool want_write);
+    void close_connection(uint64_t id);
+};
+
+HttpServer::EventLoop::EventLoop(HttpServer& server, int listen_fd)
+    : server_(server), listen_fd_(listen_fd), queue_(std::make_shared<ResponseQueue>()) {}
+
+HttpServer::EventLoop::~EventLoop() {
+    stop();
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+bool HttpServer::EventLoop::start() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    queue_->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || queue_->wake_fd < 0) {
+        LOG_ERROR << "[HttpServer] epoll/eventfd setup failed: " << std::strerror(errno);
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenerId;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.u64 = kWakeId;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, queue_->wake_fd, &ev);
+
+    running_ = true;
+    thread_ = std::thread(&EventLoop::run, this);
+    return true;
+}
+
+void HttpServer::EventLoop::stop() {
+    if (!running_.exchange(false)) return;
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(queue_->wake_fd, &one, sizeof(one));
+    (void)ignored;
+    if (thread_.joinable()) thread_.join();
+}
+
+void HttpServer::EventLoop::run() {
+    queue_->loop_thread = std::this_thread::get_id();
+    epoll_event events[kMaxEvents];
+    auto next_sweep = Clock::now() + std::chrono::seconds(1);
+
+    while (running_) {
+        const int n = epoll_wait(epoll_fd_, events, kMaxEvents, 1000);
+        if (n < 0 && errno != EINTR) {
+            LOG_ERROR << "[HttpServer] epoll_wait failed: " << std::strerror(errno);
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const uint64_t id = events[i].data.u64;
+            if (id == kListenerId) {
+                accept_all();
+                continue;
+            }
+            if (id == kWakeId) {
+                uint64_t value = 0;
+                ssize_t ignored = ::read(queue_->wake_fd, &value, sizeof(value));
+                (void)ignored;
+                continue;
+            }
+            auto it = connections_.find(id);
+            if (it == connections_.end()) continue;
+            const uint32_t flags = events[i].events;
+            if (flags & EPOLLERR) {
+                close_connection(id);
+                continue;
+            }
+            if ((flags & EPOLLOUT) && !flush(id, it->second)) continue;
+            // 对端关闭时先读完已到达的数据，read 返回 0 后再关闭
+            if (flags & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) on_readable(id, it->second);
+        }
+        while (drain_responses()) {}
+
+        const auto now = Clock::now();
+        if (now >= next_sweep) {
+            sweep_idle();
+            next_sweep = now + std::chrono::seconds(1);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_->mutex);
+        queue_->closed = true;
+        queue_->items.clear();
+    }
+    std::vector<uint64_t> ids;
+    for (const auto& entry : connections_) ids.push_back(entry.first);
+    for (uint64_t id : ids) close_connection(id);
+}
+
+void HttpServer::EventLoop::accept_all() {
+    while (true) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARNING << "[HttpServer] accept failed: " << std::strerror(errno);
+            }
+            return;
+        }
+        if (server_.active_connections_.load() >= server_.options_.max_connections) {
+            ::close(fd);
+            server_.rejected_connections_.fetch_add(1);
+            continue;
+        }
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        const uint64_t id = next_id_++;
+        Connection& conn = connections_[id];
+        conn.fd = fd;
+        conn.last_active = Clock::now();
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = id;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+        server_.accepted_.fetch_add(1);
+        server_.active_connections_.fetch_add(1);
+    }
+}
+
+void HttpServer::EventLoop::on_readable(uint64_t id, Connection& conn) {
+    while (true) {
+        const size_t old_size = conn.in.size();
+        conn.in.resize(old_size + kReadChunk);
+        const ssize_t n = ::read(conn.fd, &conn.in[old_size], kReadChunk);
+        if (n > 0) {
+            conn.in.resize(old_size + static_cast<size_t>(n));
+            if (static_cast<size_t>(n) < kReadChunk) break;
+            continue;
+        }
+        conn.in.resize(old_size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        close_connection(id);
+        return;
+    }
+    conn.last_active = Clock::now();
+
+    // 等待回复期间客户端持续流水线发送，缓冲超过单个请求上限时断开
+    const auto& limits = server_.options_.limits;
+    if (conn.busy && conn.in.size() > limits.max_header_bytes + limits.max_body_bytes) {
+        close_connection(id);
+        return;
+    }
+    process(id, conn);
+}
+
+bool HttpServer::EventLoop::process(uint64_t id, Connection& conn) {
+    while (!conn.busy && conn.out_head.empty() && !conn.in.empty()) {
+        HttpRequest request;
+        const auto result = parse_http_request(conn.in, server_.options_.limits, request);
+        switch (result.status) {
+        case ParseStatus::INCOMPLETE:
+            if (result.expect_continue && !conn.continue_sent) {
+                conn.continue_sent = true;
+                ssize_t ignored = ::send(conn.fd, kContinue, sizeof(kContinue) - 1, MSG_NOSIGNAL);
+                (void)ignored;
+            }
+            return true;
+        case ParseStatus::BAD_REQUEST:
+        case ParseStatus::TOO_LARGE:
+        case ParseStatus::NOT_IMPLEMENTED: {
+            const int status = result.status == ParseStatus::BAD_REQUEST ? 400
+                             : result.status == ParseStatus::TOO_LARGE   ? 413 : 501;
+            // 无法确定请求边界，回复后关闭连接
+            conn.in.clear();
+            conn.keep_alive = false;
+            server_.requests_.fetch_add(1);
+            return deliver(id, conn, HttpResponse::error(status, status_reason(status)));
+        }
+        case ParseStatus::COMPLETE:
+            conn.in.erase(0, result.consumed);
+            conn.continue_sent = false;
+            conn.busy = true;
+            conn.keep_alive = request.keep_alive;
+            server_.requests_.fetch_add(1);
+            dispatch(id, request);
+            break;
+        }
+    }
+    return true;
+}
+
+void HttpServer::EventLoop::dispatch(uint64_t id, HttpRequest& request) {
+    auto state = std::make_shared<HttpResponder::State>();
+    state->queue = queue_;
+    state->connection = id;
+    HttpResponder responder(std::move(state));
+
+    bool path_known = false;
+    const HttpHandler* handler = server_.find_route(request.method, request.path, path_known);
+    if (!handler) {
+        responder.send(path_known ? HttpResponse::error(405, "method not allowed")
+                                  : HttpResponse::error(404, "no route for " + request.path));
+        return;
+    }
+    try {
+        (*handler)(request, responder);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[HttpServer] Handler for " << request.method << " " << request.path << " threw: " << e.what();
+        responder.send(HttpResponse::error(500, e.what()));
+    }
+}
+
+bool HttpServer::EventLoop::drain_responses() {
+    {
+        std::lock_guard<std::mutex> lock(queue_->mutex);
+        draining_.swap(queue_->items);
+    }
+    if (draining_.empty()) return false;
+    for (auto& [id, response] : draining_) {
+        auto it = connections_.find(id);
+        // 连接已关闭，丢弃回复
+        if (it == connections_.end()) continue;
+        it->second.busy = false;
+        deliver(id, it->second, std::move(response));
+    }
+    draining_.clear();
+    return true;
+}
+
+bool HttpServer::EventLoop::deliver(uint64_t id, Connection& conn, HttpResponse response) {
+    server_.responses_.fetch_add(1);
+    if (response.status >= 400) server_.error_responses_.fetch_add(1);
+
+    const bool keep_alive = conn.keep_alive && running_;
+    serialize_response_head(response, keep_alive, conn.out_head);
+    conn.out_body = std::move(response.body);
+    conn.out_offset = 0;
+    conn.close_after_write = !keep_alive;
+    return flush(id, conn);
+}
+
+bool HttpServer::EventLoop::flush(uint64_t id, Connection& conn) {
+    while (true) {
+        const size_t head_size = conn.out_head.size();
+        const size_t total = head_size + conn.out_body.size();
+        if (conn.out_offset >= total) break;
+
+        iovec iov[2];
+        int count = 0;
+        if (conn.out_offset < head_size) {
+            iov[count++] = {conn.out_head.data() + conn.out_offset, head_size - conn.out_offset};
+            if (!conn.out_body.empty()) iov[count++] = {conn.out_body.data(), conn.out_body.size()};
+        } else {
+            iov[count++] = {conn.out_body.data() + (conn.out_offset - head_size), total - conn.out_offset};
+        }
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(count);
+        const ssize_t n = ::sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.out_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 发送缓冲区已满，等 EPOLLOUT 再继续
+            if (!conn.want_write) set_events(id, conn, true);
+            return true;
+        }
+        close_connection(id);
+        return false;
+    }
+
+    if (conn.want_write) set_events(id, conn, false);
+    conn.out_head.clear();
+    conn.out_body.clear();
+    conn.out_offset = 0;
+    conn.last_active = Clock::now();
+    if (conn.close_after_write) {
+        close_connection(id);
+        return false;
+    }
+    // 继续处理流水线中已到达的下一个请求
+    return process(id, conn);
+}
+
+void HttpServer::EventLoop::set_events(uint64_t id, Connection& conn, bool want_write) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0u);
+    ev.data.u64 = id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.want_write = want_write;
+}
+
+void HttpServer::EventLoop::sweep_idle() {
+    const auto deadline = Clock::now() - server_.options_.idle_timeout;
+    std::vector<uint64_t> idle;
+    for (const auto& [id, conn] : connections_) {
+        if (!conn.busy && conn.out_head.empty() && conn.last_active < deadline) idle.push_back(id);
+    }
+    for (uint64_t id : idle) close_connection(id);
+}
+
+void HttpServer::EventLoop::close_connection(uint64_t id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) return;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+    connections_.erase(it);
+    server_.active_connections_.fetch_sub(1);
+}
+
+HttpServer::HttpServer(HttpServerOptions options) : options_(std::move(options)) {
+    options_.io_threads = std::max<size_t>(1, options_.io_threads);
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::route(const std::string& method, const std::string& path, HttpHandler handler) {
+    if (!loops_.empty()) throw std::logic_error("HttpServer::route must be called before start");
+    routes_[path][method] = std::move(handler);
+}
+
+const HttpHandler* HttpServer::find_route(const std::string& method, const std::string& path,
+                                          bool& path_known) const {
+    auto path_it = routes_.find(path);
+    path_known = path_it != routes_.end();
+    if (!path_known) return nullptr;
+    auto method_it = path_it->second.find(method);
+    return method_it == path_it->second.end() ? nullptr : &method_it->second;
+}
+
+bool HttpServer::start() {
+    if (!loops_.empty()) return true;
+
+    uint16_t port = options_.port;
+    const bool reuse_port = options_.io_threads > 1;
+    for (size_t i = 0; i < options_.io_threads; ++i) {
+        const int fd = create_listener(options_.host, port, options_.backlog, reuse_port);
+        if (fd < 0) {
+            stop();
+            return false;
+        }
+        // 端口由系统分配时，其余监听套接字绑定到同一端口
+        if (port == 0) port = bound_port(fd);
+        loops_.push_back(std::make_unique<EventLoop>(*this, fd));
+        if (!loops_.back()->start()) {
+            stop();
+            return false;
+        }
+    }
+    port_ = port;
+    LOG_INFO << "[HttpServer] Listening on " << options_.host << ":" << port_ << " with "
+             << options_.io_threads << " I/O thread(s)";
+    return true;
+}
+
+void HttpServer::stop() {
+    for (auto& loop : loops_) loop->stop();
+    loops_.clear();
+}
+
+HttpServerStats HttpServer::stats() const {
+    HttpServerStats stats;
+    stats.accepted = accepted_.load();
+    stats.active_connections = active_connections_.load();
+    stats.rejected_connections = rejected_connections_.load();
+    stats.requests = requests_.load();
+    stats.responses = responses_.load();
+    stats.error_responses = error_responses_.load();
+    return stats;
+}
+
+} // namespace http_service
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "http_message.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace http_service {
+
+struct HttpServerOptions {
+    std::string host = "127.0.0.1";
+    // 0 表示由系统分配，start 之后通过 port() 获取
+    uint16_t port = 8080;
+    // 每个 I/O 线程一个 epoll 循环，各自持有一个 SO_REUSEPORT 监听套接字，由内核分配新连接
+    size_t io_threads = 1;
+    size_t max_connections = 4096;
+    int backlog = 1024;
+    // 空闲长连接的超时时间
+    std::chrono::seconds idle_timeout{60};
+    ParseLimits limits;
+};
+
+struct HttpServerStats {
+    uint64_t accepted = 0;
+    uint64_t active_connections = 0;
+    uint64_t rejected_connections = 0;  // 超过 max_connections 被直接关闭
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t error_responses = 0;       // 状态码 >= 400
+};
+
+// 一个请求的回复句柄，可复制、可跨线程传递。
+// send 只生效一次；所有副本销毁时仍未回复，自动回复 500。
+class HttpResponder {
+public:
+    HttpResponder() = default;
+
+    void send(HttpResponse response) const;
+
+private:
+    friend class HttpServer;
+    struct State;
+    explicit HttpResponder(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<State> state_;
+};
+
+// 处理函数在 I/O 线程上调用，应尽快返回：耗时的工作交给 WorkerPool，完成后再调用 responder.send
+using HttpHandler = std::function<void(HttpRequest& request, HttpResponder responder)>;
+
+// 基于 epoll 的 HTTP/1.1 服务端（仅 Linux）。
+// 非阻塞套接字 + 水平触发，支持长连接与请求流水线（同一连接上按顺序逐个处理）；
+// 回复的头部与正文通过一次 sendmsg 写出，正文不做拷贝。
+class HttpServer {
+public:
+    explicit HttpServer(HttpServerOptions options = {});
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // 必须在 start 之前注册
+    void route(const std::string& method, const std::string& path, HttpHandler handler);
+
+    // 绑定端口并启动 I/O 线程，失败时返回 false
+    bool start();
+    // 关闭所有连接并等待 I/O 线程退出；未完成的回复被丢弃
+    void stop();
+
+    uint16_t port() const { return port_; }
+    HttpServerStats stats() const;
+
+private:
+    class EventLoop;
+
+    HttpServerOptions options_;
+    // path -> method -> handler
+    std::unordered_map<std::string, std::unordered_map<std::string, HttpHandler>> routes_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    uint16_t port_ = 0;
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> active_connections_{0};
+    std::atomic<uint64_t> rejected_connections_{0};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> responses_{0};
+    std::atomic<uint64_t> error_responses_{0};
+
+    // 未匹配时 path_known 表示路径存在但方法不支持
+    const HttpHandler* find_route(const std::string& method, const std::string& path, bool& path_known) const;
+};
+
+} // namespace http_service
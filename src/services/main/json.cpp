@@ -0,0 +1,295 @@
+#include "json.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void append_utf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+template <typename T>
+void append_number(std::string& out, T value) {
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+} // namespace
+
+namespace http_service {
+
+JsonReader::JsonReader(std::string_view text, size_t max_depth) : text_(text), max_depth_(max_depth) {}
+
+void JsonReader::fail(const char* message) const {
+    throw std::invalid_argument(std::string("JSON: ") + message + " at offset " + std::to_string(pos_));
+}
+
+void JsonReader::skip_whitespace() {
+    while (pos_ < text_.size()) {
+        const char c = text_[pos_];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        ++pos_;
+    }
+}
+
+char JsonReader::next_char() {
+    skip_whitespace();
+    if (pos_ >= text_.size()) fail("unexpected end of input");
+    return text_[pos_];
+}
+
+void JsonReader::expect(char c) {
+    if (next_char() != c) fail((std::string("expected '") + c + "'").c_str());
+    ++pos_;
+}
+
+void JsonReader::expect_literal(std::string_view literal) {
+    if (text_.substr(pos_, literal.size()) != literal) fail("invalid literal");
+    pos_ += literal.size();
+}
+
+JsonType JsonReader::peek() {
+    switch (next_char()) {
+    case '{': return JsonType::OBJECT;
+    case '[': return JsonType::ARRAY;
+    case '"': return JsonType::STRING;
+    case 't':
+    case 'f': return JsonType::BOOL;
+    case 'n': return JsonType::NUL;
+    default: return JsonType::NUMBER;
+    }
+}
+
+void JsonReader::enter_container(char open) {
+    expect(open);
+    if (first_.size() >= max_depth_) {
+        --pos_;
+        fail("nesting too deep");
+    }
+    first_.push_back(true);
+}
+
+void JsonReader::begin_object() {
+    enter_container('{');
+}
+
+void JsonReader::begin_array() {
+    enter_container('[');
+}
+
+bool JsonReader::next_member(char close) {
+    if (first_.empty()) fail("not inside a container");
+    if (next_char() == close) {
+        ++pos_;
+        first_.pop_back();
+        return false;
+    }
+    if (first_.back()) {
+        first_.back() = false;
+    } else {
+        expect(',');
+    }
+    return true;
+}
+
+bool JsonReader::next_key(std::string& key) {
+    if (!next_member('}')) return false;
+    read_string(key);
+    expect(':');
+    return true;
+}
+
+bool JsonReader::next_element() {
+    return next_member(']');
+}
+
+void JsonReader::read_string(std::string& out) {
+    expect('"');
+    out.clear();
+    while (true) {
+        // 无转义的连续片段整段追加
+        const size_t start = pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"' && text_[pos_] != '\\') {
+            if (static_cast<unsigned char>(text_[pos_]) < 0x20) fail("control character in string");
+            ++pos_;
+        }
+        out.append(text_.data() + start, pos_ - start);
+        if (pos_ >= text_.size()) fail("unterminated string");
+        if (text_[pos_++] == '"') return;
+
+        if (pos_ >= text_.size()) fail("unterminated escape");
+        const char escape = text_[pos_++];
+        switch (escape) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            auto read_hex4 = [this]() {
+                if (pos_ + 4 > text_.size()) fail("truncated \\u escape");
+                uint32_t code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int v = hex_value(text_[pos_++]);
+                    if (v < 0) fail("invalid \\u escape");
+                    code = (code << 4) | static_cast<uint32_t>(v);
+                }
+                return code;
+            };
+            uint32_t code = read_hex4();
+            // UTF-16 代理对
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                if (text_.substr(pos_, 2) != "\\u") fail("unpaired surrogate");
+                pos_ += 2;
+                const uint32_t low = read_hex4();
+                if (low < 0xDC00 || low > 0xDFFF) fail("unpaired surrogate");
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                fail("unpaired surrogate");
+            }
+            append_utf8(out, code);
+            break;
+        }
+        default:
+            fail("invalid escape");
+        }
+    }
+}
+
+double JsonReader::read_number() {
+    skip_whitespace();
+    const size_t start = pos_;
+    while (pos_ < text_.size()) {
+        const char c = text_[pos_];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            ++pos_;
+        } else {
+            break;
+        }
+    }
+    double value = 0.0;
+    const auto result = std::from_chars(text_.data() + start, text_.data() + pos_, value);
+    if (pos_ == start || result.ec != std::errc() || result.ptr != text_.data() + pos_) {
+        pos_ = start;
+        fail("invalid number");
+    }
+    return value;
+}
+
+bool JsonReader::read_bool() {
+    if (next_char() == 't') {
+        expect_literal("true");
+        return true;
+    }
+    expect_literal("false");
+    return false;
+}
+
+void JsonReader::read_null() {
+    next_char();
+    expect_literal("null");
+}
+
+void JsonReader::skip_value() {
+    // 迭代跳过：closers 记录本次进入的各层容器，键名共用一个缓冲区
+    std::string scratch;
+    std::string closers;
+    do {
+        if (!closers.empty()) {
+            const char close = closers.back();
+            if (!next_member(close)) {
+                closers.pop_back();
+                continue;
+            }
+            if (close == '}') {
+                read_string(scratch);
+                expect(':');
+            }
+        }
+        switch (peek()) {
+        case JsonType::OBJECT:
+            begin_object();
+            closers += '}';
+            break;
+        case JsonType::ARRAY:
+            begin_array();
+            closers += ']';
+            break;
+        case JsonType::STRING: read_string(scratch); break;
+        case JsonType::BOOL: read_bool(); break;
+        case JsonType::NUL: read_null(); break;
+        case JsonType::NUMBER: read_number(); break;
+        }
+    } while (!closers.empty());
+}
+
+void JsonReader::expect_end() {
+    skip_whitespace();
+    if (pos_ != text_.size()) fail("trailing characters");
+}
+
+void append_json_string(std::string& out, std::string_view value) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '"';
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(value.data() + start, i - start);
+        start = i + 1;
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += kHex[c >> 4];
+            out += kHex[c & 0xF];
+        }
+    }
+    out.append(value.data() + start, value.size() - start);
+    out += '"';
+}
+
+void append_json_number(std::string& out, float value) {
+    append_number(out, value);
+}
+
+void append_json_number(std::string& out, double value) {
+    append_number(out, value);
+}
+
+} // namespace http_service
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http_service {
+
+enum class JsonType { OBJECT, ARRAY, STRING, NUMBER, BOOL, NUL };
+
+// 拉取式 JSON 读取器：不构建 DOM，字符串直接解码到调用方复用的缓冲区。
+// 格式错误或嵌套超过 max_depth 层时抛出 std::invalid_argument，消息中带出错位置。
+class JsonReader {
+public:
+    // 请求体与语料均不需要更深的嵌套；限制深度避免恶意输入耗尽调用栈
+    static constexpr size_t kDefaultMaxDepth = 128;
+
+    explicit JsonReader(std::string_view text, size_t max_depth = kDefaultMaxDepth);
+
+    JsonType peek();
+
+    // 进入对象后循环 next_key，返回 false 表示对象结束
+    void begin_object();
+    bool next_key(std::string& key);
+
+    // 进入数组后循环 next_element，返回 false 表示数组结束
+    void begin_array();
+    bool next_element();
+
+    // 覆盖写入 out，保留其容量
+    void read_string(std::string& out);
+    double read_number();
+    bool read_bool();
+    void read_null();
+    void skip_value();
+
+    // 顶层值之后只允许空白
+    void expect_end();
+
+private:
+    std::string_view text_;
+    size_t pos_ = 0;
+    size_t max_depth_;
+    // 每层容器是否还未读到第一个成员
+    std::vector<bool> first_;
+
+    void skip_whitespace();
+    char next_char();
+    void expect(char c);
+    void expect_literal(std::string_view literal);
+    void enter_container(char open);
+    bool next_member(char close);
+    [[noreturn]] void fail(const char* message) const;
+};
+
+// 追加带引号、已转义的 JSON 字符串
+void append_json_string(std::string& out, std::string_view value);
+// 追加最短的可往返表示；非有限值输出 null
+void append_json_number(std::string& out, float value);
+void append_json_number(std::string& out, double value);
+
+} // namespace http_service
@@ -1 +1,148 @@
-TODO
+#include <pthread.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "batching_embedding.h"
+#include "embedding_service.h"
+#include "http_server.h"
+#include "logger.h"
+#include "onnx_embedding.h"
+#include "stage_metrics.h"
+
+namespace {
+
+struct ServerConfig {
+    std::string model_path = "resource/model/multilingual-e5-small/";
+    std::string model_name = "multilingual-e5-small";
+    http_service::HttpServerOptions http;
+    http_service::EmbeddingServiceOptions embedding;
+    // 合并并发的单条请求做批量推理
+    size_t max_batch_size = 32;
+    // 工作线程在 embed() 上阻塞等待所在微批完成，线程数决定了一批最多能攒到几条；0 表示与 max_batch_size 相同
+    size_t workers = 0;
+    // 请求路径上的日志交给后台线程写出
+    bool async_log = true;
+};
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --host <ip>           listen address (default 127.0.0.1)\n"
+              << "  --port <port>         listen port (default 8080)\n"
+              << "  --model <dir>         embedding model directory\n"
+              << "  --model-name <name>   model name reported in responses\n"
+              << "  --io-threads <n>      epoll I/O threads (default 1)\n"
+              << "  --workers <n>         inference worker threads (default: max batch size)\n"
+              << "  --max-batch <n>       max micro-batch size for single-text requests (default 32)\n"
+              << "  --async-log <0|1>     write logs from a background thread (default 1)\n";
+}
+
+bool parse_args(int argc, char** argv, ServerConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--host") {
+            config.http.host = value;
+        } else if (arg == "--port") {
+            config.http.port = static_cast<uint16_t>(std::stoi(value));
+        } else if (arg == "--model") {
+            config.model_path = value;
+        } else if (arg == "--model-name") {
+            config.model_name = value;
+        } else if (arg == "--io-threads") {
+            config.http.io_threads = std::stoul(value);
+        } else if (arg == "--workers") {
+            config.workers = std::stoul(value);
+        } else if (arg == "--max-batch") {
+            config.max_batch_size = std::stoul(value);
+        } else if (arg == "--async-log") {
+            config.async_log = value != "0";
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    try {
+        if (!parse_args(argc, argv, config)) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // 先屏蔽信号再创建线程，由主线程统一 sigwait
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    logger::InitLogger(argv[0]);
+    if (config.async_log) logger::EnableAsyncLogging();
+
+    // 保留具体类型的指针，用于导出分阶段指标
+    auto inner = std::make_unique<text_embedding::OnnxRuntimeEmbedding>();
+    text_embedding::OnnxRuntimeEmbedding* onnx = inner.get();
+    text_embedding::BatchingOptions batching;
+    batching.max_batch_size = config.max_batch_size;
+    text_embedding::BatchingEmbedding model(std::move(inner), batching);
+    if (!model.load_model(config.model_path)) {
+        LOG_ERROR << "Failed to load embedding model from " << config.model_path;
+        logger::ShutdownLogger();
+        return EXIT_FAILURE;
+    }
+
+    config.embedding.model_name = config.model_name;
+    config.embedding.workers = config.workers > 0 ? config.workers : std::max<size_t>(config.max_batch_size, 1);
+    if (config.embedding.workers < config.max_batch_size) {
+        LOG_WARNING << "--workers " << config.embedding.workers << " is below --max-batch " << config.max_batch_size
+                    << ", micro-batches of single-text requests cannot exceed the worker count";
+    }
+    http_service::EmbeddingService embedding(model, config.embedding);
+    http_service::HttpServer server(config.http);
+    embedding.register_routes(server);
+    server.route("GET", "/health", [](http_service::HttpRequest&, http_service::HttpResponder responder) {
+        responder.send(http_service::HttpResponse::json(200, "{\"status\":\"ok\"}"));
+    });
+    server.route("GET", "/metrics", [onnx](http_service::HttpRequest&, http_service::HttpResponder responder) {
+        http_service::HttpResponse response;
+        response.content_type = "text/plain; version=0.0.4";
+        response.body = metrics::to_prometheus(onnx->stage_metrics(), "redge_embedding");
+        responder.send(std::move(response));
+    });
+    if (!server.start()) {
+        logger::ShutdownLogger();
+        return EXIT_FAILURE;
+    }
+
+    int received = 0;
+    sigwait(&signals, &received);
+    LOG_INFO << "Received signal " << received << ", shutting down";
+
+    server.stop();
+    embedding.shutdown();
+    const auto stats = server.stats();
+    LOG_INFO << "Served " << stats.responses << " responses (" << stats.error_responses << " errors) on "
+             << stats.accepted << " connections";
+    logger::ShutdownLogger();
+    return EXIT_SUCCESS;
+}
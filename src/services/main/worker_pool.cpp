@@ -0,0 +1,63 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "logger.h"
+
+namespace http_service {
+
+WorkerPool::WorkerPool(size_t threads, size_t queue_capacity) : capacity_(std::max<size_t>(1, queue_capacity)) {
+    threads = std::max<size_t>(1, threads);
+    for (size_t i = 0; i < threads; ++i) workers_.emplace_back(&WorkerPool::worker_loop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::try_submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || tasks_.size() >= capacity_) return false;
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+size_t WorkerPool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void WorkerPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "[WorkerPool] Task failed: " << e.what();
+        }
+    }
+}
+
+} // namespace http_service
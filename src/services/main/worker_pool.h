@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace http_service {
+
+// 固定线程数的任务池，I/O 线程把耗时的推理交给它，不为每个连接创建线程。
+// 队列有上限，满时 try_submit 立即返回 false，由调用方回复 503。
+class WorkerPool {
+public:
+    WorkerPool(size_t threads, size_t queue_capacity);
+    ~WorkerPool();
+
+    bool try_submit(std::function<void()> task);
+
+    // 停止接收新任务，执行完已排队的任务后返回
+    void shutdown();
+
+    size_t pending() const;
+    size_t threads() const { return workers_.size(); }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void worker_loop();
+};
+
+} // namespace http_service
@@ -0,0 +1,73 @@
+#include "route_matrix.h"
+#include "vector_math.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace semantic_router {
+
+RouteMatrix::RouteMatrix(std::vector<Route> routes,
+                         const std::vector<std::vector<float>>& embeddings,
+                         float default_threshold)
+    : routes_(std::move(routes)) {
+    size_t total = 0;
+    for (const auto& route : routes_) {
+        if (route.utterances.empty()) {
+            throw std::invalid_argument("Route '" + route.name + "' has no utterances");
+        }
+        total += route.utterances.size();
+    }
+    if (embeddings.size() != total) {
+        throw std::invalid_argument("RouteMatrix: expected " + std::to_string(total) +
+                                    " embeddings, got " + std::to_string(embeddings.size()));
+    }
+    if (total == 0) return;
+
+    dim_ = embeddings.front().size();
+    for (const auto& embedding : embeddings) {
+        if (embedding.size() != dim_ || dim_ == 0) {
+            throw std::invalid_argument("RouteMatrix: inconsistent embedding dimension");
+        }
+    }
+
+    thresholds_.reserve(routes_.size());
+    ranges_.reserve(routes_.size());
+    matrix_.reserve(total * dim_);
+    size_t next = 0;
+    for (const auto& route : routes_) {
+        const size_t first_row = matrix_.size() / dim_;
+        const size_t count = route.utterances.size();
+        if (route.aggregation == RouteAggregation::CENTROID) {
+            // 先归一化各示例再求均值，避免长文本的向量模长主导质心方向
+            std::vector<float> centroid(dim_, 0.0f), row(dim_);
+            for (size_t i = 0; i < count; ++i) {
+                row = embeddings[next + i];
+                vector_math::l2_normalize(row.data(), dim_);
+                for (size_t j = 0; j < dim_; ++j) centroid[j] += row[j];
+            }
+            vector_math::l2_normalize(centroid.data(), dim_);
+            matrix_.insert(matrix_.end(), centroid.begin(), centroid.end());
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                const auto& embedding = embeddings[next + i];
+                matrix_.insert(matrix_.end(), embedding.begin(), embedding.end());
+                vector_math::l2_normalize(matrix_.data() + matrix_.size() - dim_, dim_);
+            }
+        }
+        next += count;
+        ranges_.push_back({first_row, matrix_.size() / dim_});
+        thresholds_.push_back(route.threshold.value_or(default_threshold));
+    }
+    row_count_ = matrix_.size() / dim_;
+    matrix_.shrink_to_fit();
+}
+
+void RouteMatrix::score(const float* query, float* row_scores, float* route_scores) const {
+    vector_math::dot_many(query, matrix_.data(), row_count_, dim_, row_scores);
+    for (size_t r = 0; r < ranges_.size(); ++r) {
+        const auto& range = ranges_[r];
+        route_scores[r] = *std::max_element(row_scores + range.begin, row_scores + range.end);
+    }
+}
+
+} // namespace semantic_router
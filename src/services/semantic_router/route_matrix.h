@@ -0,0 +1,46 @@
+#pragma once
+
+#include "route_table.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace semantic_router {
+
+// 路由表的向量化形式：所有参与比较的向量归一化后存为一个连续的行主序矩阵 [rows, dim]，
+// 一次 dot_many 即得到查询与全部行的余弦相似度，再按路由聚合。
+// MAX 路由占其全部示例行；CENTROID 路由只占一行（示例均值归一化后的向量）。
+// 构建后只读，可被多个线程同时使用。
+class RouteMatrix {
+public:
+    // embeddings 与各路由 utterances 依次展开后的顺序一一对应，无需预先归一化
+    RouteMatrix(std::vector<Route> routes,
+                const std::vector<std::vector<float>>& embeddings,
+                float default_threshold);
+
+    size_t dim() const { return dim_; }
+    size_t rows() const { return row_count_; }
+    size_t route_count() const { return routes_.size(); }
+    const Route& route(size_t index) const { return routes_[index]; }
+    const std::vector<Route>& routes() const { return routes_; }
+    float threshold(size_t index) const { return thresholds_[index]; }
+
+    // query 须为已归一化的 dim() 维向量；row_scores 至少 rows() 个元素，
+    // route_scores 至少 route_count() 个元素
+    void score(const float* query, float* row_scores, float* route_scores) const;
+
+private:
+    struct RowRange {
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<Route> routes_;
+    std::vector<float> thresholds_;
+    std::vector<RowRange> ranges_;
+    std::vector<float> matrix_;
+    size_t dim_ = 0;
+    size_t row_count_ = 0;
+};
+
+} // namespace semantic_router
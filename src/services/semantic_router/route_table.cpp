@@ -0,0 +1,113 @@
+#include "route_table.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+std::string trim(const std::string& s) {
+    const char* spaces = " \t\r\n";
+    size_t begin = s.find_first_not_of(spaces);
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(spaces);
+    return s.substr(begin, end - begin + 1);
+}
+
+[[noreturn]] void syntax_error(size_t line_no, const std::string& message) {
+    throw std::invalid_argument("Route definition line " + std::to_string(line_no) + ": " + message);
+}
+
+} // namespace
+
+namespace semantic_router {
+
+const char* aggregation_name(RouteAggregation aggregation) {
+    switch (aggregation) {
+        case RouteAggregation::MAX:      return "max";
+        case RouteAggregation::CENTROID: return "centroid";
+    }
+    return "unknown";
+}
+
+std::vector<Route> parse_routes(const std::string& text) {
+    std::vector<Route> routes;
+    std::unordered_set<std::string> names;
+    size_t route_line = 0;
+
+    auto finish_route = [&]() {
+        if (!routes.empty() && routes.back().utterances.empty()) {
+            syntax_error(route_line, "route '" + routes.back().name + "' has no utterances");
+        }
+    };
+
+    std::istringstream input(text);
+    std::string raw;
+    size_t line_no = 0;
+    while (std::getline(input, raw)) {
+        ++line_no;
+        const std::string line = trim(raw);
+        if (line.empty() || line[0] == '#') continue;
+
+        if (line.front() == '[') {
+            if (line.back() != ']') syntax_error(line_no, "unterminated route header");
+            finish_route();
+            Route route;
+            route.name = trim(line.substr(1, line.size() - 2));
+            if (route.name.empty()) syntax_error(line_no, "empty route name");
+            if (!names.insert(route.name).second) syntax_error(line_no, "duplicate route '" + route.name + "'");
+            routes.push_back(std::move(route));
+            route_line = line_no;
+            continue;
+        }
+        if (routes.empty()) syntax_error(line_no, "expected a [route] header");
+        Route& route = routes.back();
+
+        if (line[0] == '-') {
+            std::string utterance = trim(line.substr(1));
+            if (utterance.empty()) syntax_error(line_no, "empty utterance");
+            route.utterances.push_back(std::move(utterance));
+            continue;
+        }
+
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) syntax_error(line_no, "expected 'key = value' or '- utterance'");
+        const std::string key = trim(line.substr(0, eq));
+        const std::string value = trim(line.substr(eq + 1));
+        if (key == "threshold") {
+            try {
+                size_t used = 0;
+                float threshold = std::stof(value, &used);
+                if (used != value.size()) throw std::invalid_argument(value);
+                route.threshold = threshold;
+            } catch (const std::exception&) {
+                syntax_error(line_no, "invalid threshold '" + value + "'");
+            }
+        } else if (key == "aggregation") {
+            if (value == "max") {
+                route.aggregation = RouteAggregation::MAX;
+            } else if (value == "centroid") {
+                route.aggregation = RouteAggregation::CENTROID;
+            } else {
+                syntax_error(line_no, "unknown aggregation '" + value + "'");
+            }
+        } else {
+            syntax_error(line_no, "unknown key '" + key + "'");
+        }
+    }
+    finish_route();
+    return routes;
+}
+
+std::vector<Route> load_routes_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open route file: " + path);
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return parse_routes(buffer.str());
+}
+
+} // namespace semantic_router
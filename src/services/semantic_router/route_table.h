@@ -0,0 +1,38 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace semantic_router {
+
+// 路由得分的聚合方式
+enum class RouteAggregation {
+    MAX,       // 取与各示例相似度的最大值，适合表述多样的意图
+    CENTROID,  // 与示例均值向量比较，对个别离群示例更稳健
+};
+
+struct Route {
+    std::string name;
+    std::vector<std::string> utterances;
+    RouteAggregation aggregation = RouteAggregation::MAX;
+    // 余弦相似度阈值；未设置时使用 SemanticRouterOptions::default_threshold
+    std::optional<float> threshold;
+};
+
+const char* aggregation_name(RouteAggregation aggregation);
+
+// 解析路由定义文本，格式：
+//   # 注释
+//   [billing]
+//   threshold = 0.75
+//   aggregation = centroid
+//   - 我想申请退款
+//   - 发票怎么开
+// 格式错误、路由重名或没有示例时抛出 std::invalid_argument（带行号）
+std::vector<Route> parse_routes(const std::string& text);
+
+// 读取并解析路由定义文件，文件无法打开时抛出 std::runtime_error
+std::vector<Route> load_routes_file(const std::string& path);
+
+} // namespace semantic_router
@@ -0,0 +1,221 @@
+#include "semantic_router.h"
+#include "logger.h"
+#include "vector_math.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_us(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// 打分用的线程局部缓冲，稳定后路由过程不再分配内存
+struct Scratch {
+    std::vector<float> query;
+    std::vector<float> row_scores;
+    std::vector<float> route_scores;
+    std::vector<size_t> order;
+};
+
+Scratch& scratch() {
+    thread_local Scratch buffers;
+    return buffers;
+}
+
+} // namespace
+
+namespace semantic_router {
+
+SemanticRouter::SemanticRouter(text_embedding::TextEmbedding& model, SemanticRouterOptions options)
+    : model_(model), options_(options) {}
+
+SemanticRouter::TablePtr SemanticRouter::acquire_table() const {
+    return std::atomic_load(&current_);
+}
+
+bool SemanticRouter::load_routes(const std::vector<Route>& routes) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    return load_routes_locked(routes, true);
+}
+
+bool SemanticRouter::refresh_embeddings() {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    TablePtr table = acquire_table();
+    if (!table) return false;
+    return load_routes_locked(table->matrix.routes(), false);
+}
+
+bool SemanticRouter::load_routes_locked(const std::vector<Route>& routes, bool reuse_embeddings) {
+    const auto start = Clock::now();
+    try {
+        TablePtr previous = acquire_table();
+        const Table* cache = reuse_embeddings ? previous.get() : nullptr;
+        std::unordered_map<std::string, std::vector<float>> table_embeddings;
+
+        // 只为旧表中没有的示例调用模型，同一文本只向量化一次
+        std::vector<std::string> missing;
+        for (const auto& route : routes) {
+            for (const auto& utterance : route.utterances) {
+                if (table_embeddings.count(utterance)) continue;
+                if (cache) {
+                    auto it = cache->embeddings.find(utterance);
+                    if (it != cache->embeddings.end()) {
+                        table_embeddings.emplace(utterance, it->second);
+                        continue;
+                    }
+                }
+                table_embeddings.emplace(utterance, std::vector<float>());
+                missing.push_back(utterance);
+            }
+        }
+        if (!missing.empty()) {
+            auto vectors = model_.embed_batch(missing);
+            if (vectors.size() != missing.size()) {
+                throw std::runtime_error("embed_batch returned " + std::to_string(vectors.size()) +
+                                         " vectors for " + std::to_string(missing.size()) + " utterances");
+            }
+            for (size_t i = 0; i < missing.size(); ++i) table_embeddings[missing[i]] = std::move(vectors[i]);
+        }
+
+        std::vector<std::vector<float>> ordered;
+        for (const auto& route : routes) {
+            for (const auto& utterance : route.utterances) ordered.push_back(table_embeddings.at(utterance));
+        }
+
+        auto table = std::make_shared<Table>(Table{RouteMatrix(routes, ordered, options_.default_threshold),
+                                                   std::move(table_embeddings),
+                                                   previous ? previous->version + 1 : 1});
+        LOG_INFO << "[SemanticRouter] Loaded " << table->matrix.route_count() << " routes ("
+                 << table->matrix.rows() << " rows, dim " << table->matrix.dim() << ") as version "
+                 << table->version << ", embedded " << missing.size() << " new utterances in "
+                 << elapsed_us(start) / 1000.0 << " ms";
+        std::atomic_store(&current_, TablePtr(std::move(table)));
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[SemanticRouter] Failed to load routes, keeping current table: " << e.what();
+        return false;
+    }
+}
+
+bool SemanticRouter::load_routes_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    return load_file_locked(path);
+}
+
+bool SemanticRouter::load_file_locked(const std::string& path) {
+    // 先记录路径与修改时间：文件有误时不会在每次轮询时重复报错，修改后再次尝试
+    std::error_code ec;
+    routes_path_ = path;
+    routes_mtime_ = std::filesystem::last_write_time(path, ec);
+    std::vector<Route> routes;
+    try {
+        routes = semantic_router::load_routes_file(path);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[SemanticRouter] Failed to load routes, keeping current table: " << e.what();
+        return false;
+    }
+    return load_routes_locked(routes, true);
+}
+
+bool SemanticRouter::reload_if_changed() {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    if (routes_path_.empty()) return false;
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(routes_path_, ec);
+    if (ec || mtime == routes_mtime_) return false;
+    LOG_INFO << "[SemanticRouter] Route file changed, reloading: " << routes_path_;
+    return load_file_locked(routes_path_);
+}
+
+RouteMatch SemanticRouter::route(const std::string& utterance) const {
+    TablePtr table = acquire_table();
+    if (!table) {
+        throw std::runtime_error("Routes not loaded. Call load_routes first.");
+    }
+    const auto start = Clock::now();
+    const auto embedding = model_.embed(utterance);
+    const double embed_us = elapsed_us(start);
+
+    RouteMatch result = match(*table, embedding.data(), embedding.size());
+    result.timings.embed_us = embed_us;
+    return result;
+}
+
+RouteMatch SemanticRouter::route_embedding(const std::vector<float>& embedding) const {
+    TablePtr table = acquire_table();
+    if (!table) {
+        throw std::runtime_error("Routes not loaded. Call load_routes first.");
+    }
+    return match(*table, embedding.data(), embedding.size());
+}
+
+RouteMatch SemanticRouter::match(const Table& table, const float* embedding, size_t dim) const {
+    const auto start = Clock::now();
+    const RouteMatrix& matrix = table.matrix;
+    RouteMatch result;
+    if (matrix.route_count() == 0) {
+        result.timings.match_us = elapsed_us(start);
+        return result;
+    }
+    if (dim != matrix.dim()) {
+        throw std::invalid_argument("Query dimension " + std::to_string(dim) +
+                                    " does not match route dimension " + std::to_string(matrix.dim()));
+    }
+
+    Scratch& buffers = scratch();
+    buffers.query.assign(embedding, embedding + dim);
+    buffers.row_scores.resize(matrix.rows());
+    buffers.route_scores.resize(matrix.route_count());
+    vector_math::l2_normalize(buffers.query.data(), dim);
+    matrix.score(buffers.query.data(), buffers.row_scores.data(), buffers.route_scores.data());
+
+    const auto& scores = buffers.route_scores;
+    // 达到阈值的路由中取最高分；同分时取定义顺序靠前者
+    int best = -1;
+    for (size_t r = 0; r < scores.size(); ++r) {
+        if (scores[r] >= matrix.threshold(r) && (best < 0 || scores[r] > scores[best])) {
+            best = static_cast<int>(r);
+        }
+    }
+    if (best >= 0) {
+        result.route = matrix.route(best).name;
+        result.score = scores[best];
+    }
+
+    auto& order = buffers.order;
+    order.resize(scores.size());
+    for (size_t r = 0; r < order.size(); ++r) order[r] = r;
+    const size_t n = std::min(options_.top_n, order.size());
+    std::partial_sort(order.begin(), order.begin() + n, order.end(), [&scores](size_t a, size_t b) {
+        return scores[a] != scores[b] ? scores[a] > scores[b] : a < b;
+    });
+    result.candidates.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t r = order[i];
+        result.candidates.push_back({matrix.route(r).name, scores[r], scores[r] >= matrix.threshold(r)});
+    }
+    result.timings.match_us = elapsed_us(start);
+    return result;
+}
+
+size_t SemanticRouter::route_count() const {
+    TablePtr table = acquire_table();
+    return table ? table->matrix.route_count() : 0;
+}
+
+size_t SemanticRouter::dim() const {
+    TablePtr table = acquire_table();
+    return table ? table->matrix.dim() : 0;
+}
+
+uint64_t SemanticRouter::version() const {
+    TablePtr table = acquire_table();
+    return table ? table->version : 0;
+}
+
+} // namespace semantic_router
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "route_matrix.h"
+#include "route_table.h"
+#include "text_embedding.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace semantic_router {
+
+struct SemanticRouterOptions {
+    // 路由未单独设置阈值时使用
+    float default_threshold = 0.5f;
+    // RouteMatch::candidates 保留的路由数
+    size_t top_n = 3;
+};
+
+struct RouteCandidate {
+    std::string name;
+    float score = 0.0f;
+    bool passed = false;  // 是否达到该路由的阈值
+};
+
+struct RoutingTimings {
+    double embed_us = 0.0;  // 查询向量化
+    double match_us = 0.0;  // 归一化、矩阵打分与聚合
+};
+
+struct RouteMatch {
+    // 命中的路由；没有路由达到阈值时为空
+    std::string route;
+    float score = 0.0f;
+    // 相似度最高的 top_n 条路由（含未达阈值的），按相似度降序
+    std::vector<RouteCandidate> candidates;
+    RoutingTimings timings;
+
+    bool matched() const { return !route.empty(); }
+};
+
+// 语义路由：查询只向量化一次，与所有路由示例组成的矩阵一次性打分，
+// 在达到阈值的路由中取相似度最高者。
+// 路由表整体封装为不可变快照，重新加载时构建完成后原子替换，在途请求不受影响；
+// 示例向量按文本缓存，重新加载只为新增或修改的示例调用模型。
+class SemanticRouter {
+public:
+    explicit SemanticRouter(text_embedding::TextEmbedding& model, SemanticRouterOptions options = {});
+
+    // 构建并发布新的路由表；失败时保留当前路由表并返回 false
+    bool load_routes(const std::vector<Route>& routes);
+    // 从文件加载，并记录路径供 reload_if_changed 使用
+    bool load_routes_file(const std::string& path);
+    // 路由文件修改时间变化时重新加载，返回是否加载成功；可由定时任务周期调用
+    bool reload_if_changed();
+
+    // 底层模型更换后调用：丢弃缓存的示例向量，用当前模型重新构建路由表
+    bool refresh_embeddings();
+
+    // 未加载路由表时抛出 std::runtime_error
+    RouteMatch route(const std::string& utterance) const;
+    // 已有查询向量时跳过向量化（如与检索共用一次 embed），向量无需预先归一化
+    RouteMatch route_embedding(const std::vector<float>& embedding) const;
+
+    size_t route_count() const;
+    size_t dim() const;
+    // 每次成功加载递增，0 表示尚未加载
+    uint64_t version() const;
+
+private:
+    struct Table {
+        RouteMatrix matrix;
+        // 示例文本 -> 模型输出向量，供下次加载复用
+        std::unordered_map<std::string, std::vector<float>> embeddings;
+        uint64_t version = 0;
+    };
+    using TablePtr = std::shared_ptr<const Table>;
+
+    text_embedding::TextEmbedding& model_;
+    SemanticRouterOptions options_;
+
+    // 只通过 std::atomic_load / std::atomic_store 访问
+    TablePtr current_;
+
+    std::mutex load_mutex_;
+    std::string routes_path_;
+    std::filesystem::file_time_type routes_mtime_{};
+
+    TablePtr acquire_table() const;
+    bool load_routes_locked(const std::vector<Route>& routes, bool reuse_embeddings);
+    bool load_file_locked(const std::string& path);
+    RouteMatch match(const Table& table, const float* embedding, size_t dim) const;
+};
+
+} // namespace semantic_router
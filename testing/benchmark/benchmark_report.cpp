@@ -0,0 +1,221 @@
+#include "benchmark_report.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "json.h"
+#include "logger.h"
+
+namespace latency_benchmark {
+
+namespace {
+
+using http_service::append_json_number;
+using http_service::append_json_string;
+
+void append_field(std::string& out, const char* key, double value) {
+    append_json_string(out, key);
+    out += ':';
+    append_json_number(out, value);
+}
+
+void append_field(std::string& out, const char* key, const std::string& value) {
+    append_json_string(out, key);
+    out += ':';
+    append_json_string(out, value);
+}
+
+void parse_latency(http_service::JsonReader& reader, LatencySummary& latency) {
+    std::string key;
+    reader.begin_object();
+    while (reader.next_key(key)) {
+        if (key == "count") latency.count = static_cast<uint64_t>(reader.read_number());
+        else if (key == "mean") latency.mean_us = reader.read_number();
+        else if (key == "p50") latency.p50_us = reader.read_number();
+        else if (key == "p90") latency.p90_us = reader.read_number();
+        else if (key == "p99") latency.p99_us = reader.read_number();
+        else if (key == "p999") latency.p999_us = reader.read_number();
+        else if (key == "max") latency.max_us = reader.read_number();
+        else reader.skip_value();
+    }
+}
+
+BenchmarkCase parse_case(http_service::JsonReader& reader) {
+    BenchmarkCase item;
+    std::string key;
+    reader.begin_object();
+    while (reader.next_key(key)) {
+        if (key == "name") reader.read_string(item.name);
+        else if (key == "phase") reader.read_string(item.phase);
+        else if (key == "input_length") reader.read_string(item.input_length);
+        else if (key == "batch_size") item.batch_size = static_cast<size_t>(reader.read_number());
+        else if (key == "concurrency") item.concurrency = static_cast<size_t>(reader.read_number());
+        else if (key == "latency_us") parse_latency(reader, item.latency);
+        else if (key == "texts_per_second") item.texts_per_second = reader.read_number();
+        else if (key == "peak_rss_mb") item.peak_rss_mb = reader.read_number();
+        else reader.skip_value();
+    }
+    return item;
+}
+
+// 越大越差的指标：current 超出 baseline 的比例与绝对量同时越界才算回退
+void check_higher_is_worse(const std::string& name, const char* metric, double baseline_value,
+                           double current_value, double tolerance, double min_delta, std::vector<Regression>& out) {
+    if (current_value - baseline_value < min_delta) return;
+    if (current_value <= baseline_value * (1.0 + tolerance)) return;
+    out.push_back({name, metric, baseline_value, current_value});
+}
+
+} // namespace
+
+LatencySummary LatencySummary::from_histogram(const metrics::LatencyHistogram& histogram) {
+    constexpr double kNanosPerMicro = 1000.0;
+    LatencySummary summary;
+    summary.count = histogram.count();
+    summary.mean_us = histogram.mean() / kNanosPerMicro;
+    summary.p50_us = histogram.percentile(50.0) / kNanosPerMicro;
+    summary.p90_us = histogram.percentile(90.0) / kNanosPerMicro;
+    summary.p99_us = histogram.percentile(99.0) / kNanosPerMicro;
+    summary.p999_us = histogram.percentile(99.9) / kNanosPerMicro;
+    summary.max_us = histogram.max() / kNanosPerMicro;
+    return summary;
+}
+
+const BenchmarkCase* BenchmarkReport::find(const std::string& name) const {
+    for (const auto& item : cases) {
+        if (item.name == name) return &item;
+    }
+    return nullptr;
+}
+
+std::string to_json(const BenchmarkReport& report) {
+    // 每个用例一行，便于直接 diff 两份结果
+    std::string out = "{";
+    append_field(out, "suite", report.suite);
+    out += ',';
+    append_field(out, "model", report.model);
+    out += ',';
+    append_field(out, "hardware_threads", static_cast<double>(report.hardware_threads));
+    out += ",\"cases\":[";
+    for (size_t i = 0; i < report.cases.size(); ++i) {
+        const auto& item = report.cases[i];
+        out += i ? ",\n  {" : "\n  {";
+        append_field(out, "name", item.name);
+        out += ',';
+        append_field(out, "phase", item.phase);
+        out += ',';
+        append_field(out, "input_length", item.input_length);
+        out += ',';
+        append_field(out, "batch_size", static_cast<double>(item.batch_size));
+        out += ',';
+        append_field(out, "concurrency", static_cast<double>(item.concurrency));
+        out += ",\"latency_us\":{";
+        append_field(out, "count", static_cast<double>(item.latency.count));
+        out += ',';
+        append_field(out, "mean", item.latency.mean_us);
+        out += ',';
+        append_field(out, "p50", item.latency.p50_us);
+        out += ',';
+        append_field(out, "p90", item.latency.p90_us);
+        out += ',';
+        append_field(out, "p99", item.latency.p99_us);
+        out += ',';
+        append_field(out, "p999", item.latency.p999_us);
+        out += ',';
+        append_field(out, "max", item.latency.max_us);
+        out += "},";
+        append_field(out, "texts_per_second", item.texts_per_second);
+        out += ',';
+        append_field(out, "peak_rss_mb", item.peak_rss_mb);
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+BenchmarkReport parse_report(std::string_view json) {
+    http_service::JsonReader reader(json);
+    BenchmarkReport report;
+    std::string key;
+    reader.begin_object();
+    while (reader.next_key(key)) {
+        if (key == "suite") {
+            reader.read_string(report.suite);
+        } else if (key == "model") {
+            reader.read_string(report.model);
+        } else if (key == "hardware_threads") {
+            report.hardware_threads = static_cast<unsigned>(reader.read_number());
+        } else if (key == "cases") {
+            reader.begin_array();
+            while (reader.next_element()) report.cases.push_back(parse_case(reader));
+        } else {
+            reader.skip_value();
+        }
+    }
+    reader.expect_end();
+    return report;
+}
+
+bool save_report(const BenchmarkReport& report, const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR << "[Benchmark] Cannot open " << path << " for writing";
+        return false;
+    }
+    file << to_json(report);
+    return static_cast<bool>(file);
+}
+
+bool load_report(const std::string& path, BenchmarkReport& report) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR << "[Benchmark] Cannot open baseline " << path;
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    try {
+        report = parse_report(content.str());
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[Benchmark] Invalid baseline " << path << ": " << e.what();
+        return false;
+    }
+    return true;
+}
+
+std::vector<Regression> compare_reports(const BenchmarkReport& baseline, const BenchmarkReport& current,
+                                        const CompareOptions& options) {
+    if (baseline.model != current.model || baseline.hardware_threads != current.hardware_threads) {
+        LOG_WARNING << "[Benchmark] Baseline was recorded with model " << baseline.model << " on "
+                    << baseline.hardware_threads << " threads, current run uses " << current.model << " on "
+                    << current.hardware_threads << " threads";
+    }
+
+    std::vector<Regression> regressions;
+    for (const auto& base : baseline.cases) {
+        const BenchmarkCase* now = current.find(base.name);
+        if (!now) {
+            LOG_WARNING << "[Benchmark] Case " << base.name << " missing from current run";
+            continue;
+        }
+        const double tolerance = options.tolerance;
+        const double min_latency = options.min_latency_delta_us;
+        check_higher_is_worse(base.name, "p50_us", base.latency.p50_us, now->latency.p50_us, tolerance, min_latency,
+                              regressions);
+        check_higher_is_worse(base.name, "p90_us", base.latency.p90_us, now->latency.p90_us, tolerance, min_latency,
+                              regressions);
+        check_higher_is_worse(base.name, "p99_us", base.latency.p99_us, now->latency.p99_us, tolerance, min_latency,
+                              regressions);
+        check_higher_is_worse(base.name, "peak_rss_mb", base.peak_rss_mb, now->peak_rss_mb, tolerance,
+                              options.min_rss_delta_mb, regressions);
+        // 单次请求只有几十微秒时吞吐由计时与调度噪声主导，不做判定
+        if (base.latency.p50_us < min_latency || base.texts_per_second <= 0.0) continue;
+        if (now->texts_per_second < base.texts_per_second * (1.0 - tolerance)) {
+            regressions.push_back({base.name, "texts_per_second", base.texts_per_second, now->texts_per_second});
+        }
+    }
+    return regressions;
+}
+
+} // namespace latency_benchmark
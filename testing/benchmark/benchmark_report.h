@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace latency_benchmark {
+
+// 直方图的摘要，单位微秒
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double p999_us = 0.0;
+    double max_us = 0.0;
+
+    // 直方图按纳秒记录
+    static LatencySummary from_histogram(const metrics::LatencyHistogram& histogram);
+};
+
+struct BenchmarkCase {
+    // 唯一键，compare 时按名字配对，例如 "warm/len128/batch8/conc4"
+    std::string name;
+    std::string phase;  // cold / warm
+    std::string input_length;
+    size_t batch_size = 1;
+    size_t concurrency = 1;
+    LatencySummary latency;
+    double texts_per_second = 0.0;
+    double peak_rss_mb = 0.0;
+};
+
+struct BenchmarkReport {
+    std::string suite;
+    std::string model;
+    unsigned hardware_threads = 0;
+    std::vector<BenchmarkCase> cases;
+
+    const BenchmarkCase* find(const std::string& name) const;
+};
+
+std::string to_json(const BenchmarkReport& report);
+// 只识别 to_json 写出的字段，未知字段跳过；格式错误抛出 std::invalid_argument
+BenchmarkReport parse_report(std::string_view json);
+
+bool save_report(const BenchmarkReport& report, const std::string& path);
+bool load_report(const std::string& path, BenchmarkReport& report);
+
+struct CompareOptions {
+    // 相对基线变差超过该比例视为回退
+    double tolerance = 0.10;
+    // 绝对差值低于下限时忽略，避免微秒级抖动误报
+    double min_latency_delta_us = 50.0;
+    double min_rss_delta_mb = 16.0;
+};
+
+struct Regression {
+    std::string case_name;
+    std::string metric;
+    double baseline = 0.0;
+    double current = 0.0;
+};
+
+// 对比 p50/p90/p99、吞吐与峰值内存。p99.9 与 max 样本太少、抖动大，只报告不判定。
+// 基线中有而本次缺失的用例只告警，不计为回退。
+std::vector<Regression> compare_reports(const BenchmarkReport& baseline, const BenchmarkReport& current,
+                                        const CompareOptions& options = {});
+
+} // namespace latency_benchmark
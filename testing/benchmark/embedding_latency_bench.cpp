@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_report.h"
+#include "fake_embedding.h"
+#include "latency_histogram.h"
+#include "logger.h"
+#include "process_stats.h"
+#include "text_embedding_factory.h"
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr int kExitOk = 0;
+constexpr int kExitRegression = 1;
+constexpr int kExitError = 2;
+
+struct BenchConfig {
+    std::string model_path = "resource/model/multilingual-e5-small/";
+    std::string output_path = "out/benchmark/text_embedding_latency.json";
+    std::string baseline_path;
+    latency_benchmark::CompareOptions compare;
+    // 每个 warm 用例的总请求数，按并发数均分到各线程
+    size_t requests = 256;
+    size_t warmup = 16;
+    size_t cold_runs = 3;
+    // 输入长度（字符数），覆盖短查询到超过 512 token 截断的长段落
+    std::vector<size_t> input_lengths = {32, 128, 512, 2048};
+    std::vector<size_t> batch_sizes = {1, 8, 32};
+    std::vector<size_t> concurrency = {1, 4, 8};
+    // 不加载模型，用假实现验证套件本身
+    bool fake = false;
+};
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --model <dir>          embedding model directory\n"
+              << "  --output <file>        result JSON (default out/benchmark/text_embedding_latency.json)\n"
+              << "  --baseline <file>      compare against a stored result, exit 1 on regression\n"
+              << "  --tolerance <ratio>    allowed slowdown vs baseline (default 0.10)\n"
+              << "  --requests <n>         requests per warm case (default 256)\n"
+              << "  --cold-runs <n>        fresh load + first request repetitions (default 3)\n"
+              << "  --quick                reduced matrix for smoke runs\n"
+              << "  --fake                 use a fake model instead of ONNX Runtime\n";
+}
+
+bool parse_args(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") return false;
+        if (arg == "--quick") {
+            config.requests = 32;
+            config.warmup = 4;
+            config.cold_runs = 1;
+            config.input_lengths = {32, 512};
+            config.batch_sizes = {1, 8};
+            config.concurrency = {1, 4};
+            continue;
+        }
+        if (arg == "--fake") {
+            config.fake = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--model") {
+            config.model_path = value;
+        } else if (arg == "--output") {
+            config.output_path = value;
+        } else if (arg == "--baseline") {
+            config.baseline_path = value;
+        } else if (arg == "--tolerance") {
+            config.compare.tolerance = std::stod(value);
+        } else if (arg == "--requests") {
+            config.requests = std::max<size_t>(1, std::stoul(value));
+        } else if (arg == "--cold-runs") {
+            config.cold_runs = std::stoul(value);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<text_embedding::TextEmbedding> create_model(const BenchConfig& config) {
+    if (config.fake) return std::make_unique<text_embedding_test::FakeEmbedding>(384);
+    return text_embedding::EmbeddingFactory::create(text_embedding::InferenceBackend::ONNXRUNTIME);
+}
+
+// 中英混排，按字符数截断；每条带序号前缀，避免命中上层缓存
+std::string make_text(size_t length, size_t index) {
+    static const std::string kParagraph = "人工智能正在改变世界。The quick brown fox jumps over the lazy dog. ";
+    std::string text = "#" + std::to_string(index) + " ";
+    while (text.size() < length) text += kParagraph;
+    // 截断到完整的 UTF-8 字符
+    size_t cut = std::min(length, text.size());
+    while (cut < text.size() && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) ++cut;
+    text.resize(cut);
+    return text;
+}
+
+uint64_t elapsed_ns(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+double peak_rss_mb() {
+    return metrics::peak_rss_bytes() / (1024.0 * 1024.0);
+}
+
+void log_case(const latency_benchmark::BenchmarkCase& item) {
+    LOG_INFO << "[Summary] " << item.name << " | n: " << item.latency.count << ", p50: " << item.latency.p50_us
+             << " us, p90: " << item.latency.p90_us << " us, p99: " << item.latency.p99_us
+             << " us, p99.9: " << item.latency.p999_us << " us, texts/s: " << item.texts_per_second
+             << ", peak RSS: " << item.peak_rss_mb << " MB";
+}
+
+// 冷启动：每轮新建实例，分别记录 load_model 与首个请求的耗时
+bool run_cold_cases(const BenchConfig& config, latency_benchmark::BenchmarkReport& report) {
+    metrics::LatencyHistogram load;
+    metrics::LatencyHistogram first_request;
+    double peak_mb = 0.0;
+    const std::string text = make_text(128, 0);
+
+    for (size_t run = 0; run < config.cold_runs; ++run) {
+        metrics::reset_peak_rss();
+        auto model = create_model(config);
+        auto start = Clock::now();
+        if (!model->load_model(config.model_path)) {
+            LOG_ERROR << "[Benchmark] Failed to load model from " << config.model_path;
+            return false;
+        }
+        load.record(elapsed_ns(start));
+
+        start = Clock::now();
+        model->embed(text);
+        first_request.record(elapsed_ns(start));
+        peak_mb = std::max(peak_mb, peak_rss_mb());
+        model->unload_model();
+    }
+
+    for (auto* entry : {&load, &first_request}) {
+        latency_benchmark::BenchmarkCase item;
+        item.name = entry == &load ? "cold/load_model" : "cold/first_request";
+        item.phase = "cold";
+        item.input_length = entry == &load ? "" : "len128";
+        item.latency = latency_benchmark::LatencySummary::from_histogram(*entry);
+        item.peak_rss_mb = peak_mb;
+        log_case(item);
+        report.cases.push_back(std::move(item));
+    }
+    return true;
+}
+
+// 稳态：每个线程持有自己的直方图，结束后合并，计时不经过锁
+latency_benchmark::BenchmarkCase run_warm_case(text_embedding::TextEmbedding& model, const BenchConfig& config,
+                                               size_t length, size_t batch, size_t concurrency) {
+    const size_t per_thread = std::max<size_t>(1, config.requests / concurrency);
+    // 预先生成输入，避免字符串构造计入延迟
+    std::vector<std::vector<std::vector<std::string>>> inputs(concurrency);
+    size_t index = 0;
+    for (auto& thread_inputs : inputs) {
+        thread_inputs.resize(per_thread);
+        for (auto& request : thread_inputs) {
+            for (size_t b = 0; b < batch; ++b) request.push_back(make_text(length, index++));
+        }
+    }
+
+    std::vector<metrics::LatencyHistogram> histograms(concurrency);
+    std::vector<std::thread> threads;
+    metrics::reset_peak_rss();
+    const auto start = Clock::now();
+    for (size_t t = 0; t < concurrency; ++t) {
+        threads.emplace_back([&, t] {
+            for (const auto& request : inputs[t]) {
+                const auto sent = Clock::now();
+                if (batch == 1) {
+                    model.embed(request.front());
+                } else {
+                    model.embed_batch(request);
+                }
+                histograms[t].record(elapsed_ns(sent));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    metrics::LatencyHistogram merged;
+    for (const auto& histogram : histograms) merged.merge(histogram);
+
+    latency_benchmark::BenchmarkCase item;
+    item.phase = "warm";
+    item.input_length = "len" + std::to_string(length);
+    item.batch_size = batch;
+    item.concurrency = concurrency;
+    item.name = "warm/" + item.input_length + "/batch" + std::to_string(batch) + "/conc" + std::to_string(concurrency);
+    item.latency = latency_benchmark::LatencySummary::from_histogram(merged);
+    item.texts_per_second = elapsed_s > 0.0 ? merged.count() * batch / elapsed_s : 0.0;
+    item.peak_rss_mb = peak_rss_mb();
+    return item;
+}
+
+bool run_warm_cases(const BenchConfig& config, latency_benchmark::BenchmarkReport& report) {
+    auto model = create_model(config);
+    if (!model->load_model(config.model_path)) {
+        LOG_ERROR << "[Benchmark] Failed to load model from " << config.model_path;
+        return false;
+    }
+    for (size_t i = 0; i < config.warmup; ++i) model->embed(make_text(128, i));
+
+    for (size_t length : config.input_lengths) {
+        for (size_t batch : config.batch_sizes) {
+            for (size_t concurrency : config.concurrency) {
+                auto item = run_warm_case(*model, config, length, batch, concurrency);
+                log_case(item);
+                report.cases.push_back(std::move(item));
+            }
+        }
+    }
+    model->unload_model();
+    return true;
+}
+
+int compare_with_baseline(const BenchConfig& config, const latency_benchmark::BenchmarkReport& report) {
+    latency_benchmark::BenchmarkReport baseline;
+    if (!latency_benchmark::load_report(config.baseline_path, baseline)) return kExitError;
+
+    const auto regressions = latency_benchmark::compare_reports(baseline, report, config.compare);
+    for (const auto& regression : regressions) {
+        LOG_WARNING << "[Regression] " << regression.case_name << " " << regression.metric << ": "
+                    << regression.baseline << " -> " << regression.current << " ("
+                    << (regression.current / regression.baseline - 1.0) * 100.0 << "%)";
+    }
+    LOG_INFO << "[Benchmark] " << regressions.size() << " regression(s) against " << config.baseline_path
+             << " (tolerance " << config.compare.tolerance * 100.0 << "%)";
+    return regressions.empty() ? kExitOk : kExitRegression;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    try {
+        if (!parse_args(argc, argv, config)) {
+            print_usage(argv[0]);
+            return kExitError;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return kExitError;
+    }
+
+    logger::InitLogger(argv[0], 0);
+    latency_benchmark::BenchmarkReport report;
+    report.suite = "text_embedding_latency";
+    auto model_dir = std::filesystem::path(config.model_path);
+    if (model_dir.filename().empty()) model_dir = model_dir.parent_path();
+    report.model = config.fake ? "fake" : model_dir.filename().string();
+    report.hardware_threads = std::thread::hardware_concurrency();
+
+    int status = kExitOk;
+    if (!run_cold_cases(config, report) || !run_warm_cases(config, report)) {
+        status = kExitError;
+    } else {
+        const auto output_dir = std::filesystem::path(config.output_path).parent_path();
+        if (!output_dir.empty()) std::filesystem::create_directories(output_dir);
+        if (!latency_benchmark::save_report(report, config.output_path)) {
+            status = kExitError;
+        } else {
+            LOG_INFO << "[Benchmark] Wrote " << report.cases.size() << " cases to " << config.output_path;
+            if (!config.baseline_path.empty()) status = compare_with_baseline(config, report);
+        }
+    }
+
+    logger::ShutdownLogger();
+    return status;
+}
@@ -0,0 +1,109 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "benchmark_report.h"
+
+namespace {
+
+latency_benchmark::BenchmarkCase make_case(const std::string& name, double p50_us, double p99_us,
+                                           double texts_per_second, double rss_mb = 200.0) {
+    latency_benchmark::BenchmarkCase item;
+    item.name = name;
+    item.phase = "warm";
+    item.input_length = "len128";
+    item.batch_size = 8;
+    item.concurrency = 4;
+    item.latency.count = 256;
+    item.latency.mean_us = p50_us;
+    item.latency.p50_us = p50_us;
+    item.latency.p90_us = p50_us;
+    item.latency.p99_us = p99_us;
+    item.latency.p999_us = p99_us * 2;
+    item.latency.max_us = p99_us * 3;
+    item.texts_per_second = texts_per_second;
+    item.peak_rss_mb = rss_mb;
+    return item;
+}
+
+latency_benchmark::BenchmarkReport make_report(std::vector<latency_benchmark::BenchmarkCase> cases) {
+    latency_benchmark::BenchmarkReport report;
+    report.suite = "text_embedding_latency";
+    report.model = "multilingual-e5-small";
+    report.hardware_threads = 8;
+    report.cases = std::move(cases);
+    return report;
+}
+
+} // namespace
+
+TEST(BenchmarkReportTest, SummaryFromHistogramInMicroseconds) {
+    metrics::LatencyHistogram histogram;
+    for (uint64_t ms = 1; ms <= 100; ++ms) histogram.record(ms * 1000000);
+    const auto summary = latency_benchmark::LatencySummary::from_histogram(histogram);
+    EXPECT_EQ(summary.count, 100u);
+    EXPECT_NEAR(summary.p50_us, 50000.0, 50000.0 / metrics::kLatencySubBuckets);
+    EXPECT_NEAR(summary.p99_us, 99000.0, 99000.0 / metrics::kLatencySubBuckets);
+    EXPECT_DOUBLE_EQ(summary.max_us, 100000.0);
+}
+
+TEST(BenchmarkReportTest, JsonRoundTrip) {
+    auto report = make_report({make_case("warm/len128/batch8/conc4", 1234.5, 4321.25, 812.0),
+                               make_case("cold/\"quoted\"", 0.125, 7.0, 0.0)});
+    const auto parsed = latency_benchmark::parse_report(latency_benchmark::to_json(report));
+
+    EXPECT_EQ(parsed.suite, report.suite);
+    EXPECT_EQ(parsed.model, report.model);
+    EXPECT_EQ(parsed.hardware_threads, 8u);
+    ASSERT_EQ(parsed.cases.size(), 2u);
+    const auto* item = parsed.find("warm/len128/batch8/conc4");
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(item->input_length, "len128");
+    EXPECT_EQ(item->batch_size, 8u);
+    EXPECT_EQ(item->concurrency, 4u);
+    EXPECT_EQ(item->latency.count, 256u);
+    EXPECT_DOUBLE_EQ(item->latency.p50_us, 1234.5);
+    EXPECT_DOUBLE_EQ(item->latency.p99_us, 4321.25);
+    EXPECT_DOUBLE_EQ(item->latency.p999_us, 8642.5);
+    EXPECT_DOUBLE_EQ(item->texts_per_second, 812.0);
+    EXPECT_NE(parsed.find("cold/\"quoted\""), nullptr);
+}
+
+TEST(BenchmarkReportTest, UnknownFieldsAreSkippedAndGarbageRejected) {
+    const auto parsed = latency_benchmark::parse_report(
+        R"({"suite":"s","extra":{"nested":[1,2]},"cases":[{"name":"a","future":true,"latency_us":{"p50":3}}]})");
+    ASSERT_EQ(parsed.cases.size(), 1u);
+    EXPECT_DOUBLE_EQ(parsed.cases[0].latency.p50_us, 3.0);
+    EXPECT_THROW(latency_benchmark::parse_report("{\"cases\":[}"), std::invalid_argument);
+}
+
+TEST(BenchmarkReportTest, CompareFlagsSlowdownsBeyondTolerance) {
+    const auto baseline = make_report({make_case("latency", 1000.0, 3000.0, 500.0),
+                                       make_case("throughput", 1000.0, 3000.0, 500.0),
+                                       make_case("memory", 1000.0, 3000.0, 500.0, 200.0)});
+    const auto current = make_report({make_case("latency", 1050.0, 3600.0, 490.0),
+                                      make_case("throughput", 900.0, 2800.0, 400.0),
+                                      make_case("memory", 1000.0, 3000.0, 500.0, 300.0)});
+
+    const auto regressions = latency_benchmark::compare_reports(baseline, current);
+    ASSERT_EQ(regressions.size(), 3u);
+    EXPECT_EQ(regressions[0].case_name, "latency");
+    EXPECT_EQ(regressions[0].metric, "p99_us");
+    EXPECT_DOUBLE_EQ(regressions[0].baseline, 3000.0);
+    EXPECT_DOUBLE_EQ(regressions[0].current, 3600.0);
+    EXPECT_EQ(regressions[1].case_name, "throughput");
+    EXPECT_EQ(regressions[1].metric, "texts_per_second");
+    EXPECT_EQ(regressions[2].case_name, "memory");
+    EXPECT_EQ(regressions[2].metric, "peak_rss_mb");
+}
+
+TEST(BenchmarkReportTest, CompareIgnoresJitterAndMissingCases) {
+    // 相对变化大但绝对值只差几十微秒，不算回退
+    const auto baseline = make_report({make_case("tiny", 20.0, 40.0, 0.0), make_case("removed", 1.0, 1.0, 1.0)});
+    const auto current = make_report({make_case("tiny", 40.0, 80.0, 0.0), make_case("added", 1e6, 1e6, 1.0)});
+    EXPECT_TRUE(latency_benchmark::compare_reports(baseline, current).empty());
+
+    latency_benchmark::CompareOptions strict;
+    strict.min_latency_delta_us = 0.0;
+    EXPECT_EQ(latency_benchmark::compare_reports(baseline, current, strict).size(), 3u);
+}
@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bulk_embedder.h"
+#include "corpus_reader.h"
+#include "fake_embedding.h"
+#include "vector_writer.h"
+
+using bulk_embed::BulkEmbedder;
+using bulk_embed::BulkEmbedOptions;
+using bulk_embed::Checkpoint;
+using bulk_embed::CorpusFormat;
+using bulk_embed::CorpusOptions;
+using bulk_embed::CorpusReader;
+using bulk_embed::CorpusRecord;
+using bulk_embed::VectorFormat;
+using bulk_embed::VectorWriter;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kDim = 8;
+
+fs::path temp_dir() {
+    fs::path dir = fs::temp_directory_path() / "redge_bulk_embed_test";
+    fs::create_directories(dir);
+    return dir;
+}
+
+// 返回路径并删除上次运行留下的同名输出
+std::string temp_path(const std::string& name) {
+    fs::path path = temp_dir() / name;
+    for (const char* suffix : {"", ".ids", ".ckpt", ".ckpt.tmp"}) fs::remove(path.string() + suffix);
+    return path.string();
+}
+
+void write_file(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+std::string make_jsonl(size_t count, size_t fail_at = SIZE_MAX) {
+    std::string content;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string text = i == fail_at ? text_embedding_test::FakeEmbedding::kFailText
+                                              : "passage " + std::to_string(i) + " about topic " + std::to_string(i % 7);
+        content += "{\"id\":\"doc-" + std::to_string(i) + "\",\"text\":\"" + text + "\"}\n";
+    }
+    return content;
+}
+
+BulkEmbedOptions make_options(const std::string& input, const std::string& output) {
+    BulkEmbedOptions options;
+    options.input_path = input;
+    options.output_path = output;
+    options.output_format = bulk_embed::vector_format_from_path(output);
+    options.batch_size = 8;
+    options.workers = 3;
+    options.checkpoint_every = 16;
+    options.report_interval = std::chrono::milliseconds(0);
+    return options;
+}
+
+// 处理到指定批数后请求停止，模拟运行中收到 SIGINT
+class StoppingEmbedding : public text_embedding_test::FakeEmbedding {
+public:
+    explicit StoppingEmbedding(int stop_after) : FakeEmbedding(kDim), stop_after_(stop_after) {}
+
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override {
+        BulkEmbedder* target = embedder.load();
+        if (batch_calls.load() + 1 == stop_after_ && target) target->stop();
+        return FakeEmbedding::embed_batch(texts);
+    }
+
+    std::atomic<BulkEmbedder*> embedder{nullptr};
+
+private:
+    int stop_after_;
+};
+
+} // namespace
+
+TEST(CorpusReaderTest, ParsesJsonlAndSkipsMalformedLines) {
+    const std::string path = temp_path("corpus.jsonl");
+    write_file(path,
+               "{\"id\":\"a\",\"text\":\"first \\\"quoted\\\"\",\"lang\":\"en\"}\n"
+               "\n"
+               "{\"id\":42,\"text\":\"numeric id\"}\n"
+               "not json\n"
+               "{\"id\":\"b\"}\n"
+               "{\"text\":\"no id\",\"id\":\"c\"}");
+
+    CorpusReader reader(path, CorpusOptions{});
+    CorpusRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.id, "a");
+    EXPECT_EQ(record.text, "first \"quoted\"");
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.id, "42");
+    EXPECT_EQ(record.text, "numeric id");
+    const size_t third_offset = reader.offset();
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.id, "c");
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_EQ(reader.offset(), reader.size());
+    // 非 JSON 行与缺少 text 的行；空行不计
+    EXPECT_EQ(reader.skipped_lines(), 2u);
+
+    // 偏移在行首，可直接定位续读
+    CorpusReader resumed(path, CorpusOptions{});
+    resumed.seek(third_offset);
+    ASSERT_TRUE(resumed.next(record));
+    EXPECT_EQ(record.id, "c");
+    EXPECT_THROW(resumed.seek(resumed.size() + 1), std::out_of_range);
+}
+
+TEST(CorpusReaderTest, SkipsDeeplyNestedLine) {
+    // 未知字段下的深层嵌套按格式错误跳过，不能让整个批量任务栈溢出
+    const size_t depth = 1000000;
+    const std::string path = temp_path("nested.jsonl");
+    write_file(path, "{\"id\":\"a\",\"meta\":" + std::string(depth, '[') + std::string(depth, ']') +
+                         ",\"text\":\"nested\"}\n{\"id\":\"b\",\"text\":\"after\"}\n");
+
+    CorpusReader reader(path, CorpusOptions{});
+    CorpusRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.id, "b");
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_EQ(reader.skipped_lines(), 1u);
+
+    // 检查点文件损坏时同样只是读取失败
+    const std::string checkpoint_path = temp_path("nested.ckpt");
+    write_file(checkpoint_path, "{\"x\":" + std::string(depth, '[') + std::string(depth, ']') + "}");
+    Checkpoint checkpoint;
+    EXPECT_FALSE(bulk_embed::load_checkpoint(checkpoint_path, checkpoint));
+}
+
+TEST(CorpusReaderTest, ParsesTsvAndCustomFields) {
+    const std::string tsv_path = temp_path("corpus.tsv");
+    write_file(tsv_path, "q1\thow are\tyou\r\nbroken line\nq2\tsecond\n");
+    ASSERT_EQ(bulk_embed::corpus_format_from_path(tsv_path), CorpusFormat::TSV);
+
+    CorpusOptions tsv_options;
+    tsv_options.format = CorpusFormat::TSV;
+    CorpusReader tsv(tsv_path, tsv_options);
+    CorpusRecord record;
+    ASSERT_TRUE(tsv.next(record));
+    EXPECT_EQ(record.id, "q1");
+    EXPECT_EQ(record.text, "how are\tyou");
+    ASSERT_TRUE(tsv.next(record));
+    EXPECT_EQ(record.id, "q2");
+    EXPECT_FALSE(tsv.next(record));
+    EXPECT_EQ(tsv.skipped_lines(), 1u);
+
+    const std::string jsonl_path = temp_path("custom.jsonl");
+    write_file(jsonl_path, "{\"_id\":\"x\",\"body\":\"content\",\"text\":\"ignored\"}\n");
+    CorpusOptions json_options;
+    json_options.id_field = "_id";
+    json_options.text_field = "body";
+    CorpusReader jsonl(jsonl_path, json_options);
+    ASSERT_TRUE(jsonl.next(record));
+    EXPECT_EQ(record.id, "x");
+    EXPECT_EQ(record.text, "content");
+}
+
+TEST(VectorWriterTest, WritesFvecsAndTruncatesOnResume) {
+    const std::string path = temp_path("vectors.fvecs");
+    const std::string ids_path = path + ".ids";
+    {
+        VectorWriter writer(path, ids_path, VectorFormat::FVECS, 2);
+        writer.append({"a", "b"}, {{1.0f, 2.0f}, {3.0f, 4.0f}});
+        writer.sync();
+        writer.append({"c"}, {{5.0f, 6.0f}});
+        EXPECT_THROW(writer.append({"d"}, {{1.0f}}), std::invalid_argument);
+        writer.close();
+    }
+    const std::string data = read_file(path);
+    ASSERT_EQ(data.size(), 3 * (sizeof(int32_t) + 2 * sizeof(float)));
+    int32_t dim = 0;
+    float values[2];
+    std::memcpy(&dim, data.data() + 12, sizeof(dim));
+    std::memcpy(values, data.data() + 16, sizeof(values));
+    EXPECT_EQ(dim, 2);
+    EXPECT_EQ(values[0], 3.0f);
+    EXPECT_EQ(values[1], 4.0f);
+    EXPECT_EQ(read_file(ids_path), "a\nb\nc\n");
+
+    // 按检查点（2 条、4 字节 id）续写时丢弃其后的数据
+    {
+        VectorWriter writer(path, ids_path, VectorFormat::FVECS, 2, 2, 4);
+        writer.append({"z"}, {{7.0f, 8.0f}});
+    }
+    EXPECT_EQ(read_file(path).size(), 3 * 12u);
+    EXPECT_EQ(read_file(ids_path), "a\nb\nz\n");
+
+    // 文件比检查点短说明不一致，拒绝续写
+    EXPECT_THROW(VectorWriter(path, ids_path, VectorFormat::FVECS, 2, 10, 4), std::runtime_error);
+}
+
+TEST(VectorWriterTest, WritesNpyHeaderWithCurrentShape) {
+    const std::string path = temp_path("vectors.npy");
+    ASSERT_EQ(bulk_embed::vector_format_from_path(path), VectorFormat::NPY);
+    {
+        VectorWriter writer(path, path + ".ids", VectorFormat::NPY, 3);
+        writer.append({"a", "b"}, {{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}});
+    }
+    std::string data = read_file(path);
+    ASSERT_EQ(data.size(), bulk_embed::kNpyHeaderBytes + 6 * sizeof(float));
+    EXPECT_EQ(data.compare(0, 8, std::string("\x93NUMPY\x01\x00", 8)), 0);
+    EXPECT_EQ(static_cast<uint8_t>(data[8]) | (static_cast<uint8_t>(data[9]) << 8), bulk_embed::kNpyHeaderBytes - 10);
+    EXPECT_NE(data.find("'shape': (2, 3)"), std::string::npos);
+    EXPECT_EQ(data[bulk_embed::kNpyHeaderBytes - 1], '\n');
+    float last = 0.0f;
+    std::memcpy(&last, data.data() + data.size() - sizeof(float), sizeof(float));
+    EXPECT_EQ(last, 6.0f);
+
+    // 续写后头中的行数随之更新
+    {
+        VectorWriter writer(path, path + ".ids", VectorFormat::NPY, 3, 2, 4);
+        writer.append({"c"}, {{7.0f, 8.0f, 9.0f}});
+    }
+    data = read_file(path);
+    EXPECT_EQ(data.size(), bulk_embed::kNpyHeaderBytes + 9 * sizeof(float));
+    EXPECT_NE(data.find("'shape': (3, 3)"), std::string::npos);
+}
+
+TEST(BulkEmbedderTest, EmbedsWholeCorpusInInputOrder) {
+    const std::string input = temp_path("full.jsonl");
+    write_file(input, make_jsonl(100) + "garbage\n");
+    const std::string output = temp_path("full.fvecs");
+
+    text_embedding_test::FakeEmbedding model(kDim);
+    BulkEmbedder embedder(model, make_options(input, output));
+    ASSERT_TRUE(embedder.run());
+    const auto stats = embedder.stats();
+    EXPECT_TRUE(stats.completed);
+    EXPECT_EQ(stats.records, 100u);
+    EXPECT_EQ(stats.skipped_lines, 1u);
+
+    const std::string data = read_file(output);
+    const size_t record_bytes = sizeof(int32_t) + kDim * sizeof(float);
+    ASSERT_EQ(data.size(), 100 * record_bytes);
+    // 多线程推理下输出仍与输入顺序一致
+    for (size_t i : {0u, 37u, 99u}) {
+        const auto expected = model.make_vector("passage " + std::to_string(i) + " about topic " + std::to_string(i % 7));
+        std::vector<float> actual(kDim);
+        std::memcpy(actual.data(), data.data() + i * record_bytes + sizeof(int32_t), kDim * sizeof(float));
+        EXPECT_EQ(actual, expected) << "record " << i;
+    }
+    const std::string ids = read_file(output + ".ids");
+    EXPECT_EQ(ids.substr(0, 12), "doc-0\ndoc-1\n");
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), '\n'), 100);
+
+    Checkpoint checkpoint;
+    ASSERT_TRUE(bulk_embed::load_checkpoint(output + ".ckpt", checkpoint));
+    EXPECT_TRUE(checkpoint.completed);
+    EXPECT_EQ(checkpoint.records, 100u);
+    EXPECT_EQ(checkpoint.dim, kDim);
+
+    // 已完成的检查点直接返回，不再推理
+    text_embedding_test::FakeEmbedding again(kDim);
+    BulkEmbedder rerun(again, make_options(input, output));
+    ASSERT_TRUE(rerun.run());
+    EXPECT_TRUE(rerun.stats().completed);
+    EXPECT_EQ(again.batch_calls.load(), 0);
+}
+
+TEST(BulkEmbedderTest, ResumesAfterStopWithIdenticalOutput) {
+    const std::string input = temp_path("resume.jsonl");
+    write_file(input, make_jsonl(200));
+
+    const std::string reference = temp_path("reference.npy");
+    {
+        text_embedding_test::FakeEmbedding model(kDim);
+        BulkEmbedder embedder(model, make_options(input, reference));
+        ASSERT_TRUE(embedder.run());
+    }
+
+    const std::string output = temp_path("resumed.npy");
+    {
+        StoppingEmbedding model(6);
+        BulkEmbedder embedder(model, make_options(input, output));
+        model.embedder = &embedder;
+        ASSERT_TRUE(embedder.run());
+        const auto stats = embedder.stats();
+        EXPECT_FALSE(stats.completed);
+        EXPECT_GT(stats.records, 0u);
+        EXPECT_LT(stats.records, 200u);
+    }
+    Checkpoint checkpoint;
+    ASSERT_TRUE(bulk_embed::load_checkpoint(output + ".ckpt", checkpoint));
+    EXPECT_FALSE(checkpoint.completed);
+    const uint64_t first_run = checkpoint.records;
+
+    // 模拟中断时写了一半的尾部数据，续跑前应被截断
+    {
+        std::ofstream tail(output, std::ios::binary | std::ios::app);
+        tail << "partial";
+    }
+    {
+        text_embedding_test::FakeEmbedding model(kDim);
+        BulkEmbedder embedder(model, make_options(input, output));
+        ASSERT_TRUE(embedder.run());
+        const auto stats = embedder.stats();
+        EXPECT_TRUE(stats.completed);
+        EXPECT_EQ(stats.resumed_from, first_run);
+        EXPECT_EQ(stats.total_records, 200u);
+    }
+    EXPECT_EQ(read_file(output), read_file(reference));
+    EXPECT_EQ(read_file(output + ".ids"), read_file(reference + ".ids"));
+}
+
+TEST(BulkEmbedderTest, FailureKeepsResumableCheckpoint) {
+    const std::string input = temp_path("failing.jsonl");
+    write_file(input, make_jsonl(120, 70));
+    const std::string output = temp_path("failing.fvecs");
+
+    {
+        text_embedding_test::FakeEmbedding model(kDim);
+        BulkEmbedder embedder(model, make_options(input, output));
+        EXPECT_FALSE(embedder.run());
+        EXPECT_FALSE(embedder.stats().completed);
+    }
+    Checkpoint checkpoint;
+    ASSERT_TRUE(bulk_embed::load_checkpoint(output + ".ckpt", checkpoint));
+    EXPECT_FALSE(checkpoint.completed);
+    // 第 70 条所在批次（64..71）之前的数据已落盘
+    EXPECT_LE(checkpoint.records, 64u);
+    EXPECT_EQ(checkpoint.records % 8, 0u);
+
+    // 修正该条（长度不变，偏移仍有效）后续跑，结果与一次跑完一致
+    std::string fixed = make_jsonl(120, 70);
+    fixed.replace(fixed.find("__fail__"), 8, "__okay__");
+    write_file(input, fixed);
+    {
+        text_embedding_test::FakeEmbedding model(kDim);
+        BulkEmbedder embedder(model, make_options(input, output));
+        ASSERT_TRUE(embedder.run());
+        EXPECT_TRUE(embedder.stats().completed);
+        EXPECT_EQ(embedder.stats().resumed_from, checkpoint.records);
+    }
+    const std::string reference = temp_path("failing_reference.fvecs");
+    {
+        text_embedding_test::FakeEmbedding model(kDim);
+        BulkEmbedder embedder(model, make_options(input, reference));
+        ASSERT_TRUE(embedder.run());
+    }
+    EXPECT_EQ(read_file(output), read_file(reference));
+    EXPECT_EQ(read_file(output + ".ids"), read_file(reference + ".ids"));
+}
+
+TEST(BulkEmbedderTest, RejectsCheckpointOfAnotherInput) {
+    const std::string input = temp_path("other.jsonl");
+    write_file(input, make_jsonl(10));
+    const std::string output = temp_path("other.fvecs");
+
+    Checkpoint checkpoint;
+    checkpoint.input_path = "/somewhere/else.jsonl";
+    checkpoint.records = 5;
+    ASSERT_TRUE(bulk_embed::save_checkpoint(output + ".ckpt", checkpoint));
+
+    text_embedding_test::FakeEmbedding model(kDim);
+    BulkEmbedder embedder(model, make_options(input, output));
+    EXPECT_FALSE(embedder.run());
+
+    // --no-resume 忽略检查点从头开始
+    auto options = make_options(input, output);
+    options.resume = false;
+    BulkEmbedder fresh(model, options);
+    ASSERT_TRUE(fresh.run());
+    EXPECT_EQ(fresh.stats().total_records, 10u);
+}
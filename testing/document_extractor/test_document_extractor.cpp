@@ -0,0 +1,155 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "text_chunker.h"
+#include "text_extractor.h"
+
+using document_extractor::DocumentFormat;
+
+namespace {
+
+const std::string kTokenizerFile = "resource/model/multilingual-e5-small/tokenizer.json";
+
+std::string join(const std::vector<std::string>& parts) {
+    std::string out;
+    for (const auto& part : parts) out += part;
+    return out;
+}
+
+} // namespace
+
+TEST(TextExtractorTest, DetectFormat) {
+    EXPECT_EQ(document_extractor::detect_format("docs/README.md"), DocumentFormat::MARKDOWN);
+    EXPECT_EQ(document_extractor::detect_format("page.HTML"), DocumentFormat::HTML);
+    EXPECT_EQ(document_extractor::detect_format("notes.txt"), DocumentFormat::PLAIN);
+    EXPECT_EQ(document_extractor::detect_format("dir.md/file"), DocumentFormat::PLAIN);
+}
+
+TEST(TextExtractorTest, PlainNormalizesLines) {
+    auto text = document_extractor::extract_text("\xEF\xBB\xBFline one  \r\nline two\r\n\r\n\r\n\r\nnext paragraph\n\n",
+                                                 DocumentFormat::PLAIN);
+    EXPECT_EQ(text, "line one\nline two\n\nnext paragraph");
+}
+
+TEST(TextExtractorTest, MarkdownStripsMarkup) {
+    const std::string markdown =
+        "# 安装指南\n"
+        "\n"
+        "Run **pip install** with [the docs](https://example.com/docs) and `--user`.\n"
+        "![diagram](img/arch.png)\n"
+        "- first_item\n"
+        "1. 第二步\n"
+        "> quoted *text*\n"
+        "\n"
+        "| name | value |\n"
+        "|------|-------|\n"
+        "| a    | 1     |\n"
+        "---\n"
+        "```cpp\n"
+        "int x = a * b;\n"
+        "```\n";
+    auto text = document_extractor::extract_text(markdown, DocumentFormat::MARKDOWN);
+    EXPECT_NE(text.find("安装指南\n\nRun pip install with the docs and --user."), std::string::npos) << text;
+    EXPECT_NE(text.find("diagram\nfirst_item\n第二步\nquoted text"), std::string::npos) << text;
+    EXPECT_NE(text.find("name   value"), std::string::npos) << text;
+    EXPECT_NE(text.find("int x = a * b;"), std::string::npos) << text;  // 代码块原样保留
+    EXPECT_EQ(text.find("https://"), std::string::npos);
+    EXPECT_EQ(text.find("|---"), std::string::npos);
+}
+
+TEST(TextExtractorTest, HtmlExtractsVisibleText) {
+    const std::string html =
+        "<html><head><title>Pump Manual</title><style>p { color: red; }</style>"
+        "<SCRIPT>var x = '<p>hidden</p>';</SCRIPT></head>"
+        "<body><!-- comment --><h1>XK-4471 &amp; accessories</h1>"
+        "<p>Supply:   24&nbsp;V<br>Breaker:&#32;dedicated &#x4E2D;&#25991;</p>"
+        "<ul><li>one</li><li>two</li></ul><table><tr><td>a</td><td>b</td></tr></table>"
+        "<pre>  keep\n  layout</pre></body></html>";
+    auto text = document_extractor::extract_text(html, DocumentFormat::HTML);
+    EXPECT_EQ(text.find("hidden"), std::string::npos) << text;
+    EXPECT_EQ(text.find("color"), std::string::npos) << text;
+    EXPECT_EQ(text.find("comment"), std::string::npos) << text;
+    EXPECT_NE(text.find("Pump Manual\n\nXK-4471 & accessories\n\nSupply: 24 V\nBreaker: dedicated 中文"),
+              std::string::npos) << text;
+    EXPECT_NE(text.find("one\ntwo"), std::string::npos) << text;
+    EXPECT_NE(text.find("a b"), std::string::npos) << text;
+    EXPECT_NE(text.find("  keep\n  layout"), std::string::npos) << text;
+}
+
+TEST(TextExtractorTest, ExtractFile) {
+    auto path = std::filesystem::temp_directory_path() / "redge_extractor_test.md";
+    std::ofstream(path) << "## Title\n\nBody **bold**\n";
+    EXPECT_EQ(document_extractor::extract_file(path.string()), "Title\n\nBody bold");
+    std::filesystem::remove(path);
+    EXPECT_THROW(document_extractor::extract_file("/nonexistent/doc.txt"), std::runtime_error);
+}
+
+TEST(TextChunkerTest, SplitSentencesPreservesText) {
+    const std::string text = "第一句。第二句！！Third one. Fourth? Dr.Who stays\nnew line\n\nparagraph…end";
+    auto sentences = document_extractor::split_sentences(text);
+    EXPECT_EQ(join(sentences), text);
+    ASSERT_EQ(sentences.size(), 8u);
+    EXPECT_EQ(sentences[0], "第一句。");
+    EXPECT_EQ(sentences[1], "第二句！！");
+    EXPECT_EQ(sentences[2], "Third one. ");
+    EXPECT_EQ(sentences[4], "Dr.Who stays\n");
+    EXPECT_EQ(sentences[5], "new line\n\n");
+    EXPECT_EQ(sentences[7], "end");
+    EXPECT_TRUE(document_extractor::split_sentences("").empty());
+}
+
+TEST(TextChunkerTest, PlanChunksRespectsBudgetAndOverlap) {
+    // 句子 token 数
+    const std::vector<size_t> tokens = {40, 30, 50, 20, 60, 10, 10};
+    auto plans = document_extractor::plan_chunks(tokens, 100, 30);
+    ASSERT_EQ(plans.size(), 3u);
+    EXPECT_EQ(plans[0].begin, 0u);
+    EXPECT_EQ(plans[0].end, 2u);   // 40 + 30，再加 50 超限
+    EXPECT_EQ(plans[1].begin, 1u); // 回带 30
+    EXPECT_EQ(plans[1].end, 4u);   // 30 + 50 + 20
+    EXPECT_EQ(plans[1].tokens, 100u);
+    EXPECT_EQ(plans[2].begin, 3u);
+    EXPECT_EQ(plans[2].end, 7u);
+    for (const auto& plan : plans) EXPECT_LE(plan.tokens, 100u);
+
+    // 超长单句独占一块，且总能向前推进
+    plans = document_extractor::plan_chunks({150, 10, 10}, 100, 90);
+    ASSERT_EQ(plans.size(), 2u);
+    EXPECT_EQ(plans[0].end, 1u);
+    EXPECT_EQ(plans[1].begin, 1u);
+
+    EXPECT_EQ(document_extractor::plan_chunks({10, 10}, 100, 0).size(), 1u);
+    EXPECT_TRUE(document_extractor::plan_chunks({}, 100, 0).empty());
+}
+
+TEST(TextChunkerTest, ChunksFitModelTokenBudget) {
+    auto tokenizer = text_embedding::load_tokenizer_pool(kTokenizerFile);
+    document_extractor::TextChunker chunker(*tokenizer, {48, 8});
+    EXPECT_THROW(document_extractor::TextChunker(*tokenizer, {16, 16}), std::invalid_argument);
+
+    std::string text;
+    for (int i = 0; i < 40; ++i) {
+        text += "Sentence number " + std::to_string(i) + " describes the pump installation. ";
+        if (i % 7 == 6) text += "\n\n";
+    }
+    // 无标点的超长片段需要在字符边界二分
+    for (int i = 0; i < 200; ++i) text += "word" + std::to_string(i) + " ";
+    text += "\n";
+    for (int i = 0; i < 100; ++i) text += "水泵";
+
+    auto chunks = chunker.split(text);
+    ASSERT_GT(chunks.size(), 5u);
+    for (const auto& chunk : chunks) {
+        EXPECT_FALSE(chunk.text.empty());
+        EXPECT_LE(chunk.token_count, 48u);
+        EXPECT_LE(tokenizer->encode(chunk.text).size(), 56u) << chunk.text;  // 拼接处允许少量偏差
+    }
+    EXPECT_NE(chunks.front().text.find("Sentence number 0"), std::string::npos);
+    EXPECT_NE(chunks.back().text.find("水泵"), std::string::npos);
+    EXPECT_TRUE(chunker.split("  \n\n ").empty());
+}
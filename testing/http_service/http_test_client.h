@@ -0,0 +1,100 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace http_service_test {
+
+struct ClientResponse {
+    int status = 0;
+    std::string body;
+    bool keep_alive = true;
+};
+
+// 阻塞式 HTTP/1.1 长连接客户端，只支持带 Content-Length 的回复
+class HttpTestClient {
+public:
+    explicit HttpTestClient(uint16_t port) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw std::runtime_error("HttpTestClient: connect failed");
+        }
+        const int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    ~HttpTestClient() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    HttpTestClient(const HttpTestClient&) = delete;
+    HttpTestClient& operator=(const HttpTestClient&) = delete;
+
+    static std::string format(const std::string& method, const std::string& path, const std::string& body,
+                              const std::string& extra_headers = "") {
+        return method + " " + path + " HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n" +
+               "Content-Length: " + std::to_string(body.size()) + "\r\n" + extra_headers + "\r\n" + body;
+    }
+
+    void send_raw(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) throw std::runtime_error("HttpTestClient: send failed");
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    ClientResponse read_response() {
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) fill();
+
+        ClientResponse response;
+        const std::string head = buffer_.substr(0, header_end);
+        response.status = std::atoi(head.c_str() + head.find(' ') + 1);
+        response.keep_alive = head.find("Connection: close") == std::string::npos;
+        const size_t length_pos = head.find("Content-Length: ");
+        const size_t length = length_pos == std::string::npos ? 0 : std::strtoul(head.c_str() + length_pos + 16, nullptr, 10);
+
+        const size_t body_start = header_end + 4;
+        while (buffer_.size() < body_start + length) fill();
+        response.body = buffer_.substr(body_start, length);
+        buffer_.erase(0, body_start + length);
+        return response;
+    }
+
+    ClientResponse request(const std::string& method, const std::string& path, const std::string& body = "") {
+        send_raw(format(method, path, body));
+        return read_response();
+    }
+
+    // 对端是否已关闭连接
+    bool closed_by_peer() {
+        char c;
+        return ::recv(fd_, &c, 1, 0) == 0;
+    }
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+
+    void fill() {
+        char chunk[16384];
+        const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) throw std::runtime_error("HttpTestClient: connection closed");
+        buffer_.append(chunk, static_cast<size_t>(n));
+    }
+};
+
+} // namespace http_service_test
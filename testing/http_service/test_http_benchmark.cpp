@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "embedding_service.h"
+#include "fake_embedding.h"
+#include "http_server.h"
+#include "http_test_client.h"
+#include "logger.h"
+
+namespace http_benchmark {
+
+using Clock = std::chrono::high_resolution_clock;
+
+// 与 multilingual-e5-small 的维度一致，回复体积接近真实场景
+constexpr size_t kDim = 384;
+constexpr size_t kRequestsPerConnection = 200;
+// 回环接口 + 假模型，只衡量服务端本身的开销；批量请求的耗时以 JSON 序列化为主，只记录不断言
+constexpr double kP99BudgetMs = 20.0;
+
+struct LoadResult {
+    double qps = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    int failures = 0;
+};
+
+std::string make_body(size_t connection, size_t request, size_t batch) {
+    std::string body = "{\"input\": [";
+    for (size_t i = 0; i < batch; ++i) {
+        if (i) body += ',';
+        body += "\"connection " + std::to_string(connection) + " request " + std::to_string(request) +
+                " item " + std::to_string(i) + " 的文本内容\"";
+    }
+    return body + "]}";
+}
+
+// 每个连接一个客户端线程，串行发送请求并记录往返延迟
+LoadResult run_load(uint16_t port, size_t connections, size_t batch) {
+    std::vector<std::vector<double>> latencies(connections);
+    std::atomic<int> failures{0};
+    std::vector<std::thread> clients;
+
+    const auto start = Clock::now();
+    for (size_t c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c] {
+            http_service_test::HttpTestClient client(port);
+            latencies[c].reserve(kRequestsPerConnection);
+            for (size_t r = 0; r < kRequestsPerConnection; ++r) {
+                const std::string body = make_body(c, r, batch);
+                const auto sent = Clock::now();
+                const auto response = client.request("POST", "/api/embeddings", body);
+                latencies[c].push_back(std::chrono::duration<double, std::milli>(Clock::now() - sent).count());
+                if (response.status != 200) failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& client : clients) client.join();
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto& per_connection : latencies) all.insert(all.end(), per_connection.begin(), per_connection.end());
+    std::sort(all.begin(), all.end());
+
+    LoadResult result;
+    result.qps = all.size() * 1000.0 / elapsed_ms;
+    result.p50_ms = all[all.size() / 2];
+    result.p99_ms = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    result.failures = failures.load();
+    return result;
+}
+
+void run_http_benchmark() {
+    text_embedding_test::FakeEmbedding model(kDim);
+    http_service::EmbeddingServiceOptions service_options;
+    service_options.workers = 4;
+    http_service::EmbeddingService service(model, service_options);
+
+    double worst_p99 = 0.0;
+    for (size_t io_threads : {1, 2}) {
+        http_service::HttpServerOptions options;
+        options.port = 0;
+        options.io_threads = io_threads;
+        http_service::HttpServer server(options);
+        service.register_routes(server);
+        ASSERT_TRUE(server.start());
+
+        LOG_INFO << "\n========== HTTP embedding endpoint, " << io_threads << " I/O thread(s), "
+                 << service_options.workers << " workers, dim " << kDim << " ==========";
+        for (size_t connections : {1, 16, 64}) {
+            for (size_t batch : {1, 16}) {
+                const auto result = run_load(server.port(), connections, batch);
+                LOG_INFO << "[Summary] " << connections << " connections, batch " << batch << " | QPS: " << result.qps
+                         << ", texts/s: " << result.qps * batch << ", p50: " << result.p50_ms << " ms, p99: "
+                         << result.p99_ms << " ms";
+                EXPECT_EQ(result.failures, 0);
+                if (connections <= 16 && batch == 1) worst_p99 = std::max(worst_p99, result.p99_ms);
+            }
+        }
+        const auto stats = server.stats();
+        EXPECT_EQ(stats.requests, stats.responses);
+        EXPECT_EQ(stats.error_responses, 0u);
+        server.stop();
+    }
+    EXPECT_LT(worst_p99, kP99BudgetMs);
+}
+
+} // namespace http_benchmark
+
+// GTest 测试用例
+TEST(HttpServiceBenchmark, LoopbackThroughputAndLatency) {
+    http_benchmark::run_http_benchmark();
+}
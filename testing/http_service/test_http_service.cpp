@@ -0,0 +1,393 @@
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "embedding_service.h"
+#include "fake_embedding.h"
+#include "http_server.h"
+#include "http_test_client.h"
+#include "json.h"
+
+using http_service::EmbeddingRequest;
+using http_service::EmbeddingService;
+using http_service::EmbeddingServiceOptions;
+using http_service::HttpRequest;
+using http_service::HttpServer;
+using http_service::HttpServerOptions;
+using http_service::JsonReader;
+using http_service::ParseStatus;
+using http_service_test::HttpTestClient;
+
+namespace {
+
+constexpr size_t kDim = 8;
+
+HttpServerOptions loopback_options() {
+    HttpServerOptions options;
+    options.port = 0;
+    return options;
+}
+
+// 解析回复中的所有向量
+std::vector<std::vector<float>> read_embeddings(const std::string& body) {
+    std::vector<std::vector<float>> result;
+    JsonReader reader(body);
+    std::string key;
+    reader.begin_object();
+    while (reader.next_key(key)) {
+        if (key != "data") {
+            reader.skip_value();
+            continue;
+        }
+        reader.begin_array();
+        while (reader.next_element()) {
+            reader.begin_object();
+            while (reader.next_key(key)) {
+                if (key != "embedding") {
+                    reader.skip_value();
+                    continue;
+                }
+                auto& vec = result.emplace_back();
+                reader.begin_array();
+                while (reader.next_element()) vec.push_back(static_cast<float>(reader.read_number()));
+            }
+        }
+    }
+    reader.expect_end();
+    return result;
+}
+
+// 第一次调用阻塞，直到测试放行
+class BlockingEmbedding : public text_embedding_test::FakeEmbedding {
+public:
+    BlockingEmbedding() : FakeEmbedding(kDim) {}
+
+    std::vector<float> embed(const std::string& text) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++entered_;
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return released_; });
+        return make_vector(text);
+    }
+
+    void wait_entered() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return entered_ > 0; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int entered_ = 0;
+    bool released_ = false;
+};
+
+} // namespace
+
+TEST(JsonTest, ReaderHandlesEscapesAndNesting) {
+    const std::string text =
+        R"({"a": "x\"y\\z\n", "cn": "\u4e2d\u6587", "emoji": "\ud83d\ude00", "n": -1.5e2,)"
+        R"( "flags": [true, false, null], "nested": {"deep": [[1], {"k": "v"}]}, "raw": "中文"})";
+    JsonReader reader(text);
+    std::string key;
+    std::string value;
+    reader.begin_object();
+
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ(key, "a");
+    reader.read_string(value);
+    EXPECT_EQ(value, "x\"y\\z\n");
+
+    ASSERT_TRUE(reader.next_key(key));
+    reader.read_string(value);
+    EXPECT_EQ(value, "中文");
+
+    ASSERT_TRUE(reader.next_key(key));
+    reader.read_string(value);
+    EXPECT_EQ(value, "\xF0\x9F\x98\x80");
+
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ(reader.peek(), http_service::JsonType::NUMBER);
+    EXPECT_DOUBLE_EQ(reader.read_number(), -150.0);
+
+    ASSERT_TRUE(reader.next_key(key));
+    reader.begin_array();
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_TRUE(reader.read_bool());
+    ASSERT_TRUE(reader.next_element());
+    EXPECT_FALSE(reader.read_bool());
+    ASSERT_TRUE(reader.next_element());
+    reader.read_null();
+    EXPECT_FALSE(reader.next_element());
+
+    ASSERT_TRUE(reader.next_key(key));
+    EXPECT_EQ(key, "nested");
+    reader.skip_value();
+
+    ASSERT_TRUE(reader.next_key(key));
+    reader.read_string(value);
+    EXPECT_EQ(value, "中文");
+    EXPECT_FALSE(reader.next_key(key));
+    reader.expect_end();
+
+    for (const char* bad : {"{\"a\" 1}", "{\"a\": 1,}", "[1 2]", "\"abc", "{\"a\": tru}", "\"\\ud800\"", "{} x"}) {
+        JsonReader r(bad);
+        EXPECT_THROW(r.skip_value(); r.expect_end(), std::invalid_argument) << bad;
+    }
+}
+
+TEST(JsonTest, ReaderLimitsNestingDepth) {
+    const auto nested = [](size_t depth) { return std::string(depth, '[') + std::string(depth, ']'); };
+
+    const std::string at_limit = nested(JsonReader::kDefaultMaxDepth);
+    JsonReader shallow(at_limit);
+    shallow.skip_value();
+    shallow.expect_end();
+
+    // 超出深度时按格式错误处理，不能递归到栈溢出
+    const std::string too_deep = nested(1000000);
+    JsonReader deep(too_deep);
+    EXPECT_THROW(deep.skip_value(), std::invalid_argument);
+
+    JsonReader limited(R"({"a": {"b": 1}})", 1);
+    limited.begin_object();
+    std::string key;
+    ASSERT_TRUE(limited.next_key(key));
+    EXPECT_THROW(limited.begin_object(), std::invalid_argument);
+}
+
+TEST(JsonTest, WriterEscapesAndRoundTripsFloats) {
+    std::string out;
+    http_service::append_json_string(out, "a\"b\\c\n\x01中");
+    EXPECT_EQ(out, "\"a\\\"b\\\\c\\n\\u0001中\"");
+
+    for (float value : {0.0f, -1.0f, 0.1f, 3.4028235e38f, 1.17549435e-38f, 0.123456789f}) {
+        out.clear();
+        http_service::append_json_number(out, value);
+        JsonReader reader(out);
+        EXPECT_EQ(static_cast<float>(reader.read_number()), value) << out;
+    }
+    out.clear();
+    http_service::append_json_number(out, std::numeric_limits<float>::quiet_NaN());
+    EXPECT_EQ(out, "null");
+}
+
+TEST(HttpParserTest, IncrementalPipelinedAndLimits) {
+    http_service::ParseLimits limits;
+    HttpRequest request;
+    const std::string first = HttpTestClient::format("POST", "/api/embeddings?x=1", "{\"input\":\"hi\"}");
+    const std::string second = HttpTestClient::format("GET", "/health", "", "Connection: close\r\n");
+    const std::string both = first + second;
+
+    // 逐字节到达时只有完整时才返回 COMPLETE
+    for (size_t n = 0; n < first.size(); ++n) {
+        EXPECT_EQ(http_service::parse_http_request(std::string_view(both).substr(0, n), limits, request).status,
+                  ParseStatus::INCOMPLETE) << n;
+    }
+    auto result = http_service::parse_http_request(both, limits, request);
+    ASSERT_EQ(result.status, ParseStatus::COMPLETE);
+    EXPECT_EQ(result.consumed, first.size());
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.path, "/api/embeddings");
+    EXPECT_EQ(request.query, "x=1");
+    EXPECT_EQ(request.body, "{\"input\":\"hi\"}");
+    EXPECT_TRUE(request.keep_alive);
+    ASSERT_NE(request.header("content-type"), nullptr);
+    EXPECT_EQ(*request.header("CONTENT-TYPE"), "application/json");
+
+    result = http_service::parse_http_request(std::string_view(both).substr(result.consumed), limits, request);
+    ASSERT_EQ(result.status, ParseStatus::COMPLETE);
+    EXPECT_EQ(request.path, "/health");
+    EXPECT_FALSE(request.keep_alive);
+
+    // HTTP/1.0 默认短连接
+    ASSERT_EQ(http_service::parse_http_request("GET / HTTP/1.0\r\n\r\n", limits, request).status, ParseStatus::COMPLETE);
+    EXPECT_FALSE(request.keep_alive);
+    EXPECT_EQ(http_service::parse_http_request("GARBAGE\r\n\r\n", limits, request).status, ParseStatus::BAD_REQUEST);
+    EXPECT_EQ(http_service::parse_http_request("GET / HTTP/1.1\r\nContent-Length: x\r\n\r\n", limits, request).status,
+              ParseStatus::BAD_REQUEST);
+    EXPECT_EQ(http_service::parse_http_request("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", limits, request).status,
+              ParseStatus::NOT_IMPLEMENTED);
+
+    limits.max_body_bytes = 4;
+    EXPECT_EQ(http_service::parse_http_request(first, limits, request).status, ParseStatus::TOO_LARGE);
+    limits.max_header_bytes = 16;
+    EXPECT_EQ(http_service::parse_http_request("GET /a-very-long-path HTTP/1.1\r\n", limits, request).status,
+              ParseStatus::TOO_LARGE);
+
+    const auto waiting = http_service::parse_http_request(
+        "POST / HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 3\r\n\r\n", http_service::ParseLimits{}, request);
+    EXPECT_EQ(waiting.status, ParseStatus::INCOMPLETE);
+    EXPECT_TRUE(waiting.expect_continue);
+}
+
+TEST(EmbeddingServiceTest, ParsesRequestsIntoReusedBuffers) {
+    EmbeddingRequest request;
+    http_service::parse_embedding_request(R"({"model": "x", "input": ["a", "bb", "ccc"], "extra": {"k": [1]}})", 8, request);
+    EXPECT_TRUE(request.batch);
+    EXPECT_EQ(request.inputs, (std::vector<std::string>{"a", "bb", "ccc"}));
+
+    http_service::parse_embedding_request(R"({"input": "single"})", 8, request);
+    EXPECT_FALSE(request.batch);
+    EXPECT_EQ(request.inputs, (std::vector<std::string>{"single"}));
+
+    http_service::parse_embedding_request(R"({"input": []})", 8, request);
+    EXPECT_TRUE(request.inputs.empty());
+
+    for (const char* bad : {R"({"input": 1})", R"({"input": [1]})", R"({"other": "x"})", R"({"input": ["a","b","c"]})", "[]"}) {
+        EXPECT_THROW(http_service::parse_embedding_request(bad, 2, request), std::invalid_argument) << bad;
+    }
+}
+
+TEST(HttpServerTest, EmbeddingRoundTrip) {
+    text_embedding_test::FakeEmbedding model(kDim);
+    EmbeddingServiceOptions service_options;
+    service_options.model_name = "fake";
+    EmbeddingService service(model, service_options);
+    HttpServer server(loopback_options());
+    service.register_routes(server);
+    ASSERT_TRUE(server.start());
+    ASSERT_NE(server.port(), 0);
+
+    HttpTestClient client(server.port());
+    auto response = client.request("POST", "/api/embeddings", R"({"input": ["hello", "世界"]})");
+    ASSERT_EQ(response.status, 200) << response.body;
+    auto embeddings = read_embeddings(response.body);
+    ASSERT_EQ(embeddings.size(), 2u);
+    EXPECT_EQ(embeddings[0], model.make_vector("hello"));
+    EXPECT_EQ(embeddings[1], model.make_vector("世界"));
+    EXPECT_NE(response.body.find("\"model\":\"fake\""), std::string::npos);
+
+    // 同一连接上继续请求
+    response = client.request("POST", "/api/embeddings", R"({"input": "again"})");
+    ASSERT_EQ(response.status, 200);
+    EXPECT_EQ(read_embeddings(response.body)[0], model.make_vector("again"));
+
+    EXPECT_EQ(client.request("POST", "/api/embeddings", "{not json").status, 400);
+    response = client.request("POST", "/api/embeddings", R"({"input": "__fail__"})");
+    EXPECT_EQ(response.status, 500);
+    // 不把内部异常消息回给客户端
+    EXPECT_EQ(response.body.find("FakeEmbedding"), std::string::npos) << response.body;
+    EXPECT_EQ(client.request("GET", "/api/embeddings").status, 405);
+    EXPECT_EQ(client.request("GET", "/nothing").status, 404);
+
+    // 流水线：一次发出三个请求，按顺序收到三个回复
+    client.send_raw(HttpTestClient::format("POST", "/api/embeddings", R"({"input": "p1"})") +
+                    HttpTestClient::format("POST", "/api/embeddings", R"({"input": "p2"})") +
+                    HttpTestClient::format("POST", "/api/embeddings", R"({"input": "p3"})", "Connection: close\r\n"));
+    for (const char* text : {"p1", "p2", "p3"}) {
+        response = client.read_response();
+        ASSERT_EQ(response.status, 200);
+        EXPECT_EQ(read_embeddings(response.body)[0], model.make_vector(text));
+    }
+    EXPECT_FALSE(response.keep_alive);
+    EXPECT_TRUE(client.closed_by_peer());
+
+    // 坏请求回复 400 后关闭连接
+    HttpTestClient broken(server.port());
+    broken.send_raw("NOT HTTP\r\n\r\n");
+    EXPECT_EQ(broken.read_response().status, 400);
+    EXPECT_TRUE(broken.closed_by_peer());
+
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.requests, stats.responses);
+    EXPECT_EQ(stats.error_responses, 5u);
+    server.stop();
+}
+
+TEST(HttpServerTest, DeeplyNestedBodyReturns400) {
+    text_embedding_test::FakeEmbedding model(kDim);
+    EmbeddingService service(model);
+    HttpServer server(loopback_options());
+    service.register_routes(server);
+    ASSERT_TRUE(server.start());
+
+    // 2 MB 的嵌套数组远小于 max_body_bytes，未知字段被跳过时曾导致工作线程栈溢出
+    const size_t depth = 1000000;
+    const std::string body = "{\"x\":" + std::string(depth, '[') + std::string(depth, ']') + ",\"input\":\"a\"}";
+    HttpTestClient client(server.port());
+    auto response = client.request("POST", "/api/embeddings", body);
+    EXPECT_EQ(response.status, 400);
+    EXPECT_NE(response.body.find("nesting too deep"), std::string::npos) << response.body;
+
+    // 服务仍然可用
+    response = client.request("POST", "/api/embeddings", R"({"input": "ok"})");
+    ASSERT_EQ(response.status, 200);
+    EXPECT_EQ(read_embeddings(response.body)[0], model.make_vector("ok"));
+    server.stop();
+}
+
+TEST(HttpServerTest, FullQueueReturns503WithoutBlockingIo) {
+    BlockingEmbedding model;
+    EmbeddingServiceOptions service_options;
+    service_options.workers = 1;
+    service_options.queue_capacity = 1;
+    EmbeddingService service(model, service_options);
+    HttpServerOptions options = loopback_options();
+    HttpServer server(options);
+    service.register_routes(server);
+    server.route("GET", "/health", [](HttpRequest&, http_service::HttpResponder responder) {
+        responder.send(http_service::HttpResponse::json(200, "{}"));
+    });
+    ASSERT_TRUE(server.start());
+
+    // 第一个请求占住唯一的工作线程，第二个排队，第三个被拒绝
+    HttpTestClient busy(server.port());
+    busy.send_raw(HttpTestClient::format("POST", "/api/embeddings", R"({"input": "a"})"));
+    model.wait_entered();
+    HttpTestClient queued(server.port());
+    queued.send_raw(HttpTestClient::format("POST", "/api/embeddings", R"({"input": "b"})"));
+    // 等第二个请求进入队列
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    HttpTestClient rejected(server.port());
+    EXPECT_EQ(rejected.request("POST", "/api/embeddings", R"({"input": "c"})").status, 503);
+    // 推理阻塞时 I/O 线程照常处理其他连接
+    EXPECT_EQ(rejected.request("GET", "/health").status, 200);
+
+    model.release();
+    EXPECT_EQ(busy.read_response().status, 200);
+    EXPECT_EQ(queued.read_response().status, 200);
+    server.stop();
+}
+
+TEST(HttpServerTest, ConcurrentKeepAliveClients) {
+    text_embedding_test::FakeEmbedding model(kDim);
+    EmbeddingService service(model);
+    HttpServerOptions options = loopback_options();
+    options.io_threads = 2;
+    HttpServer server(options);
+    service.register_routes(server);
+    ASSERT_TRUE(server.start());
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            HttpTestClient client(server.port());
+            for (int i = 0; i < 50; ++i) {
+                const std::string text = "client " + std::to_string(t) + " request " + std::to_string(i);
+                auto response = client.request("POST", "/api/embeddings", "{\"input\": \"" + text + "\"}");
+                if (response.status != 200 || read_embeddings(response.body)[0] != model.make_vector(text)) {
+                    failures.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(server.stats().accepted, 8u);
+    server.stop();
+    EXPECT_EQ(server.stats().active_connections, 0u);
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fake_embedding.h"
+#include "hybrid_retriever.h"
+#include "logger.h"
+
+namespace hybrid_benchmark {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::high_resolution_clock;
+
+// 线上目标规模为 1M 块；CI 中用 100k 控制建库耗时，延迟随规模近似对数增长
+constexpr size_t kCorpusSize = 100000;
+constexpr size_t kDim = 64;
+constexpr size_t kQueryCount = 300;
+constexpr size_t kTopK = 10;
+// 单核 CI 机器上两路检索无法真正并行，预算按串行耗时留余量
+constexpr double kP99BudgetMs = 100.0;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string product_code(size_t id) {
+    return "PX-" + std::to_string(100000 + id);
+}
+
+// 由随机词表组成的正文，每块末尾带一个唯一型号
+std::vector<infinite_rag::Chunk> make_corpus() {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> length(4, 9);
+    std::vector<std::string> vocabulary(5000);
+    for (auto& word : vocabulary) {
+        for (int n = length(rng); n > 0; --n) word += static_cast<char>(letter(rng));
+    }
+
+    std::vector<infinite_rag::Chunk> chunks(kCorpusSize);
+    for (size_t i = 0; i < kCorpusSize; ++i) {
+        auto& chunk = chunks[i];
+        chunk.id = i;
+        chunk.doc_id = "doc" + std::to_string(i / 20);
+        for (int w = 0; w < 40; ++w) chunk.text += vocabulary[rng() % vocabulary.size()] + " ";
+        chunk.text += product_code(i);
+        chunk.metadata = {{"category", std::to_string(i % 20)}, {"tenant", std::to_string(i % 1000)}};
+    }
+    return chunks;
+}
+
+struct LatencyReport {
+    std::vector<double> total;
+    infinite_rag::RetrievalTimings sum;
+
+    void add(const infinite_rag::RetrievalTimings& t) {
+        total.push_back(t.total_ms);
+        sum.embed_ms += t.embed_ms;
+        sum.vector_ms += t.vector_ms;
+        sum.lexical_ms += t.lexical_ms;
+        sum.fusion_ms += t.fusion_ms;
+        sum.fetch_ms += t.fetch_ms;
+    }
+
+    double percentile(double p) {
+        std::sort(total.begin(), total.end());
+        return total[std::min(total.size() - 1, static_cast<size_t>(p * total.size()))];
+    }
+
+    double log(const std::string& name) {
+        const double n = static_cast<double>(total.size());
+        const double p50 = percentile(0.50);
+        const double p99 = percentile(0.99);
+        LOG_INFO << "[HybridRetriever] " << name << " | p50: " << p50 << " ms, p99: " << p99
+                 << " ms | mean embed " << sum.embed_ms / n << ", vector " << sum.vector_ms / n
+                 << ", bm25 " << sum.lexical_ms / n << ", fusion " << sum.fusion_ms / n
+                 << ", fetch " << sum.fetch_ms / n;
+        return p99;
+    }
+};
+
+void run_hybrid_benchmark() {
+    const std::string path = (fs::temp_directory_path() / "redge_hybrid_benchmark.db").string();
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path + suffix);
+
+    infinite_rag::ChunkStore store(path);
+    infinite_rag::VectorIndexOptions index_options;
+    index_options.dim = kDim;
+    index_options.metric = infinite_rag::IndexMetric::L2;
+    index_options.initial_capacity = kCorpusSize;
+    index_options.ef_construction = 100;
+    index_options.background_compaction = false;
+    infinite_rag::VectorIndex index(index_options);
+    text_embedding_test::FakeEmbedding model(kDim);
+    infinite_rag::HybridRetriever retriever(store, index, model);
+
+    const auto corpus = make_corpus();
+    auto start = Clock::now();
+    for (size_t i = 0; i < corpus.size(); i += 10000) {
+        retriever.add_chunks({corpus.begin() + i, corpus.begin() + std::min(corpus.size(), i + 10000)});
+    }
+    LOG_INFO << "\n========== HybridRetriever: " << kCorpusSize << " chunks, " << kQueryCount
+             << " queries, top " << kTopK << " ==========";
+    LOG_INFO << "[HybridRetriever] ingest: " << elapsed_ms(start) << " ms";
+
+    std::mt19937 rng(11);
+    const std::vector<std::pair<std::string, infinite_rag::MetadataFilter>> scenarios = {
+        {"unfiltered", {}},
+        {"filter 1/20", {{"category", "3"}}},
+        {"filter 1/1000", {{"tenant", "42"}}},
+    };
+
+    double worst_p99 = 0.0;
+    size_t identifier_hits = 0;
+    for (const auto& [name, filter] : scenarios) {
+        LatencyReport report;
+        for (size_t q = 0; q < kQueryCount; ++q) {
+            const size_t target = rng() % kCorpusSize;
+            // 一半查询是型号，一半是正文片段
+            const std::string query = q % 2 ? product_code(target)
+                                            : corpus[target].text.substr(0, corpus[target].text.find(' ', 40));
+            auto result = retriever.retrieve(query, kTopK, filter);
+            report.add(result.timings);
+            if (filter.empty() && q % 2) {
+                for (const auto& chunk : result.chunks) identifier_hits += chunk.id == target;
+            }
+        }
+        worst_p99 = std::max(worst_p99, report.log(name));
+    }
+
+    LOG_INFO << "[HybridRetriever] exact identifier in top " << kTopK << ": " << identifier_hits << "/" << kQueryCount / 2;
+    EXPECT_EQ(identifier_hits, kQueryCount / 2);
+    EXPECT_LT(worst_p99, kP99BudgetMs);
+
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path + suffix);
+}
+
+} // namespace hybrid_benchmark
+
+// GTest 测试用例
+TEST(HybridRetrieverBenchmark, FusedLatencyPercentiles) {
+    hybrid_benchmark::run_hybrid_benchmark();
+}
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "chunk_store.h"
+#include "fake_embedding.h"
+#include "hybrid_retriever.h"
+#include "logger.h"
+
+using infinite_rag::Chunk;
+using infinite_rag::ChunkStore;
+using infinite_rag::HybridRetriever;
+using infinite_rag::HybridRetrieverOptions;
+using infinite_rag::VectorIndex;
+using infinite_rag::VectorIndexOptions;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kDim = 8;
+
+std::string temp_db_path(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / "redge_hybrid_retriever_test";
+    fs::create_directories(dir);
+    fs::path path = dir / (name + ".db");
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path.string() + suffix);
+    return path.string();
+}
+
+std::vector<Chunk> sample_chunks() {
+    return {
+        {1, "manual", "The XK-4471-B pump requires a 24V supply and a dedicated breaker.", {{"lang", "en"}, {"product", "pump"}}},
+        {2, "manual", "Replace the filter cartridge every six months to keep the pump efficient.", {{"lang", "en"}, {"product", "pump"}}},
+        {3, "manual", "Valve VX-200 supports pressures up to 16 bar in continuous operation.", {{"lang", "en"}, {"product", "valve"}}},
+        {4, "faq", "水泵型号 XK-4471-B 的额定电压为 24 伏，需要独立断路器。", {{"lang", "zh"}, {"product", "pump"}}},
+        {5, "faq", "阀门在连续运行时最高支持 16 bar 的压力。", {{"lang", "zh"}, {"product", "valve"}}},
+        {6, "notes", "General safety instructions apply to every installation.", {{"lang", "en"}}},
+    };
+}
+
+VectorIndexOptions index_options() {
+    VectorIndexOptions options;
+    options.dim = kDim;
+    options.metric = infinite_rag::IndexMetric::L2;
+    options.initial_capacity = 64;
+    options.background_compaction = false;
+    return options;
+}
+
+std::vector<uint64_t> result_ids(const infinite_rag::RetrievalResult& result) {
+    std::vector<uint64_t> ids;
+    for (const auto& chunk : result.chunks) ids.push_back(chunk.id);
+    return ids;
+}
+
+} // namespace
+
+TEST(ChunkStoreTest, UpsertGetAndRemove) {
+    ChunkStore store(temp_db_path("crud"));
+    store.upsert(sample_chunks());
+    EXPECT_EQ(store.size(), 6u);
+
+    auto chunk = store.get(3);
+    ASSERT_TRUE(chunk.has_value());
+    EXPECT_EQ(chunk->doc_id, "manual");
+    EXPECT_EQ(chunk->metadata.at("product"), "valve");
+
+    // 覆盖时正文、元数据与全文索引一起更新
+    store.upsert({{3, "manual", "Valve VX-300 replaces the older model.", {{"lang", "en"}}}});
+    chunk = store.get(3);
+    ASSERT_TRUE(chunk.has_value());
+    EXPECT_EQ(chunk->metadata.count("product"), 0u);
+    EXPECT_TRUE(store.search_bm25("VX-200", 10).empty());
+    ASSERT_EQ(store.search_bm25("VX-300", 10).size(), 1u);
+
+    EXPECT_TRUE(store.remove(3));
+    EXPECT_FALSE(store.remove(3));
+    EXPECT_FALSE(store.get(3).has_value());
+    EXPECT_TRUE(store.search_bm25("VX-300", 10).empty());
+    EXPECT_TRUE(store.filter_ids({{"lang", "en"}}, 100).size() == 3u);
+
+    auto many = store.get_many({6, 42, 1});
+    ASSERT_EQ(many.size(), 2u);
+    EXPECT_EQ(many[0].id, 6u);
+    EXPECT_EQ(many[1].id, 1u);
+}
+
+TEST(ChunkStoreTest, Bm25MatchesIdentifiersAndChinese) {
+    ChunkStore store(temp_db_path("bm25"));
+    store.upsert(sample_chunks());
+
+    auto hits = store.search_bm25("XK-4471-B", 10);
+    ASSERT_EQ(hits.size(), 2u);
+    std::vector<uint64_t> ids = {hits[0].id, hits[1].id};
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids, (std::vector<uint64_t>{1, 4}));
+    EXPECT_GE(hits[0].score, hits[1].score);
+
+    // 中文无空格，按三字滑窗匹配
+    hits = store.search_bm25("额定电压是多少", 10);
+    ASSERT_FALSE(hits.empty());
+    EXPECT_EQ(hits[0].id, 4u);
+
+    // 过滤条件下推
+    hits = store.search_bm25("XK-4471-B", 10, {{"lang", "zh"}});
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].id, 4u);
+
+    // FTS5 语法字符按字面处理，不报错
+    EXPECT_NO_THROW(store.search_bm25("pump\" OR (NEAR AND *", 10));
+    EXPECT_TRUE(store.search_bm25("", 10).empty());
+    EXPECT_TRUE(store.search_bm25("ab", 10).empty());
+}
+
+TEST(ChunkStoreTest, FilterCandidatesKeepsOrder) {
+    ChunkStore store(temp_db_path("filter"));
+    store.upsert(sample_chunks());
+
+    auto kept = store.filter_candidates({{"product", "pump"}, {"lang", "en"}}, {6, 4, 2, 3, 1});
+    EXPECT_EQ(kept, (std::vector<uint64_t>{2, 1}));
+    EXPECT_EQ(store.filter_ids({{"product", "pump"}, {"lang", "zh"}}, 10), (std::vector<uint64_t>{4}));
+    EXPECT_THROW(store.filter_ids({}, 10), std::invalid_argument);
+
+    EXPECT_EQ(store.count_filtered({{"lang", "en"}}, 100), 4u);
+    EXPECT_EQ(store.count_filtered({{"lang", "en"}}, 2), 2u);
+    EXPECT_EQ(store.count_filtered({{"product", "pump"}, {"lang", "zh"}}, 10), 1u);
+    EXPECT_EQ(store.count_filtered({{"lang", "fr"}}, 10), 0u);
+    EXPECT_THROW(store.count_filtered({}, 10), std::invalid_argument);
+}
+
+TEST(HybridRetrieverTest, FuseRrf) {
+    auto fused = infinite_rag::fuse_rrf({1, 2, 3}, {3, 4, 1}, 60.0, 10);
+    ASSERT_EQ(fused.size(), 4u);
+    // 1 与 3 都被两路命中；1 的名次之和更靠前
+    EXPECT_EQ(fused[0].id, 1u);
+    EXPECT_EQ(fused[1].id, 3u);
+    EXPECT_EQ(fused[0].lexical_rank, 0);
+    EXPECT_EQ(fused[0].vector_rank, 2);
+    EXPECT_EQ(fused[3].id, 4u);
+    EXPECT_EQ(fused[3].lexical_rank, -1);
+
+    EXPECT_EQ(infinite_rag::fuse_rrf({1, 2, 3}, {4, 5}, 60.0, 2).size(), 2u);
+    EXPECT_TRUE(infinite_rag::fuse_rrf({}, {}, 60.0, 5).empty());
+}
+
+TEST(HybridRetrieverTest, ExactIdentifierRanksFirst) {
+    ChunkStore store(temp_db_path("identifier"));
+    VectorIndex index(index_options());
+    text_embedding_test::FakeEmbedding model(kDim);
+    HybridRetriever retriever(store, index, model);
+    retriever.add_chunks(sample_chunks());
+
+    auto result = retriever.retrieve("XK-4471-B", 3);
+    ASSERT_FALSE(result.chunks.empty());
+    const auto& top = result.chunks.front();
+    EXPECT_TRUE(top.id == 1u || top.id == 4u);
+    EXPECT_GE(top.lexical_rank, 0);
+    EXPECT_FALSE(top.text.empty());
+    EXPECT_FALSE(top.metadata.empty());
+
+    const auto& t = result.timings;
+    EXPECT_GT(t.total_ms, 0.0);
+    EXPECT_GE(t.embed_ms, 0.0);
+    EXPECT_GE(t.lexical_ms, 0.0);
+    EXPECT_LE(t.fusion_ms, t.total_ms);
+    LOG_INFO << "Hybrid timings: total " << t.total_ms << " ms, embed " << t.embed_ms << ", vector "
+             << t.vector_ms << ", bm25 " << t.lexical_ms << ", fusion " << t.fusion_ms << ", fetch " << t.fetch_ms;
+
+    // 向量路总能返回结果，即便查询词在全文索引里不存在
+    result = retriever.retrieve("zzzzqqq", 3);
+    EXPECT_EQ(result.chunks.size(), 3u);
+    for (const auto& chunk : result.chunks) EXPECT_EQ(chunk.lexical_rank, -1);
+
+    EXPECT_TRUE(retriever.remove_chunk(1));
+    EXPECT_FALSE(retriever.remove_chunk(1));
+    auto ids = result_ids(retriever.retrieve("XK-4471-B", 6));
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), 1u), 0);
+}
+
+TEST(HybridRetrieverTest, FilterTiersReturnOnlyMatchingChunks) {
+    std::vector<Chunk> chunks;
+    for (uint64_t id = 0; id < 300; ++id) {
+        chunks.push_back({id, "doc" + std::to_string(id / 10),
+                          "chunk number " + std::to_string(id) + " about topic " + std::to_string(id % 7),
+                          {{"shard", std::to_string(id % 3)}, {"rare", id % 50 == 0 ? "yes" : "no"}}});
+    }
+
+    // 依次覆盖三档：精确打分、图内过滤、放大后过滤
+    const std::vector<std::pair<size_t, size_t>> tiers = {{1000, 2000}, {10, 2000}, {10, 20}};
+    for (const auto& [exact_limit, set_limit] : tiers) {
+        ChunkStore store(temp_db_path("tiers"));
+        VectorIndex index(index_options());
+        text_embedding_test::FakeEmbedding model(kDim);
+        HybridRetrieverOptions options;
+        options.candidates = 20;
+        options.exact_search_limit = exact_limit;
+        options.filter_set_limit = set_limit;
+        // 顺带覆盖不启用 BM25 线程、在调用线程上执行的路径
+        options.lexical_threads = set_limit == 20 ? 0 : 1;
+        HybridRetriever retriever(store, index, model, options);
+        retriever.add_chunks(chunks);
+
+        auto result = retriever.retrieve("chunk number 42 about topic", 10, {{"shard", "1"}});
+        ASSERT_FALSE(result.chunks.empty()) << exact_limit << "/" << set_limit;
+        for (const auto& chunk : result.chunks) EXPECT_EQ(chunk.metadata.at("shard"), "1");
+
+        result = retriever.retrieve("chunk number", 10, {{"rare", "yes"}, {"shard", "0"}});
+        for (const auto& chunk : result.chunks) {
+            EXPECT_EQ(chunk.id % 150, 0u);
+        }
+    }
+}
+
+TEST(HybridRetrieverTest, ConcurrentRetrieve) {
+    ChunkStore store(temp_db_path("concurrent"), {"trigram", 2});
+    VectorIndex index(index_options());
+    text_embedding_test::FakeEmbedding model(kDim);
+    HybridRetriever retriever(store, index, model);
+    retriever.add_chunks(sample_chunks());
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 50; ++i) {
+                auto result = retriever.retrieve(t % 2 ? "XK-4471-B pump" : "阀门压力", 3);
+                if (result.chunks.empty()) failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(failures.load(), 0);
+}
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fake_embedding.h"
+#include "ingestion_pipeline.h"
+#include "logger.h"
+
+namespace ingestion_benchmark {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr size_t kDocuments = 300;
+constexpr size_t kDim = 64;
+const std::string kTokenizerFile = "resource/model/multilingual-e5-small/tokenizer.json";
+
+// 模拟推理耗时：每次调用固定开销加每条文本的边际开销，批量越大摊薄越多
+class TimedEmbedding : public text_embedding_test::FakeEmbedding {
+public:
+    TimedEmbedding() : FakeEmbedding(kDim) {}
+
+    std::vector<float> embed(const std::string& text) override {
+        std::this_thread::sleep_for(kCallOverhead + kPerText);
+        return make_vector(text);
+    }
+
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override {
+        std::this_thread::sleep_for(kCallOverhead + kPerText * static_cast<int>(texts.size()));
+        return FakeEmbedding::embed_batch(texts);
+    }
+
+private:
+    static constexpr std::chrono::microseconds kCallOverhead{500};
+    static constexpr std::chrono::microseconds kPerText{50};
+};
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<std::string> write_corpus(const fs::path& dir) {
+    fs::create_directories(dir);
+    std::mt19937 rng(5);
+    std::vector<std::string> paths;
+    for (size_t d = 0; d < kDocuments; ++d) {
+        const bool html = d % 3 == 0;
+        std::string body;
+        for (int p = 0; p < 6; ++p) {
+            std::string paragraph;
+            for (int s = 0; s < 5; ++s) {
+                paragraph += "Section " + std::to_string(p) + " sentence " + std::to_string(s) + " mentions part PX-" +
+                             std::to_string(rng() % 100000) + " and its maintenance schedule. ";
+            }
+            body += html ? "<p>" + paragraph + "</p>\n" : "## Part " + std::to_string(p) + "\n\n" + paragraph + "\n\n";
+        }
+        const fs::path path = dir / ("doc" + std::to_string(d) + (html ? ".html" : ".md"));
+        std::ofstream(path) << (html ? "<html><body>" + body + "</body></html>" : body);
+        paths.push_back(path.string());
+    }
+    return paths;
+}
+
+infinite_rag::VectorIndexOptions index_options() {
+    infinite_rag::VectorIndexOptions options;
+    options.dim = kDim;
+    options.metric = infinite_rag::IndexMetric::L2;
+    options.initial_capacity = kDocuments * 16;
+    options.background_compaction = false;
+    return options;
+}
+
+std::string reset_db(const fs::path& dir, const std::string& name) {
+    const std::string path = (dir / (name + ".db")).string();
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path + suffix);
+    return path;
+}
+
+void run_ingestion_benchmark() {
+    const fs::path dir = fs::temp_directory_path() / "redge_ingestion_benchmark";
+    const auto paths = write_corpus(dir / "corpus");
+    auto tokenizer = text_embedding::load_tokenizer_pool(kTokenizerFile);
+    document_extractor::TextChunker chunker(*tokenizer, {128, 16});
+    TimedEmbedding model;
+
+    LOG_INFO << "\n========== Ingestion: " << kDocuments << " documents ==========";
+
+    // 基线：逐文档串行提取、切块，逐块调用 embed 后入库
+    double serial_ms = 0.0;
+    size_t serial_chunks = 0;
+    {
+        infinite_rag::ChunkStore store(reset_db(dir, "serial"));
+        infinite_rag::VectorIndex index(index_options());
+        const auto start = Clock::now();
+        for (const auto& path : paths) {
+            const auto pieces = chunker.split(document_extractor::extract_file(path));
+            for (size_t i = 0; i < pieces.size(); ++i) {
+                infinite_rag::Chunk chunk{serial_chunks + 1, path, pieces[i].text, {}};
+                store.upsert({chunk});
+                index.add(chunk.id, model.embed(chunk.text));
+                ++serial_chunks;
+            }
+        }
+        serial_ms = elapsed_ms(start);
+        LOG_INFO << "[Ingestion] serial loop: " << serial_chunks << " chunks in " << serial_ms << " ms";
+    }
+
+    infinite_rag::ChunkStore store(reset_db(dir, "pipeline"));
+    infinite_rag::VectorIndex index(index_options());
+    infinite_rag::IngestionOptions options;
+    options.embed_workers = 2;
+    options.embed_batch_size = 32;
+    const auto start = Clock::now();
+    infinite_rag::IngestionPipeline pipeline(store, index, model, chunker, options);
+    for (const auto& path : paths) pipeline.submit_file(path);
+    const auto stats = pipeline.finish();
+    const double pipeline_ms = elapsed_ms(start);
+    LOG_INFO << "[Ingestion] pipeline: " << infinite_rag::format_ingestion_stats(stats);
+    LOG_INFO << "[Ingestion] speedup: " << serial_ms / pipeline_ms << "x";
+
+    EXPECT_EQ(stats.documents, kDocuments);
+    EXPECT_EQ(stats.chunks, serial_chunks);
+    EXPECT_LT(pipeline_ms, serial_ms);
+
+    fs::remove_all(dir);
+}
+
+} // namespace ingestion_benchmark
+
+// GTest 测试用例
+TEST(IngestionBenchmark, SerialLoopVersusPipeline) {
+    ingestion_benchmark::run_ingestion_benchmark();
+}
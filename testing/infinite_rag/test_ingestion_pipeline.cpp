@@ -0,0 +1,191 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fake_embedding.h"
+#include "ingestion_pipeline.h"
+#include "logger.h"
+
+using infinite_rag::ChunkStore;
+using infinite_rag::IngestionDocument;
+using infinite_rag::IngestionOptions;
+using infinite_rag::IngestionPipeline;
+using infinite_rag::VectorIndex;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kDim = 8;
+const std::string kTokenizerFile = "resource/model/multilingual-e5-small/tokenizer.json";
+
+fs::path temp_dir() {
+    fs::path dir = fs::temp_directory_path() / "redge_ingestion_test";
+    fs::create_directories(dir);
+    return dir;
+}
+
+std::string temp_db_path(const std::string& name) {
+    fs::path path = temp_dir() / (name + ".db");
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path.string() + suffix);
+    return path.string();
+}
+
+infinite_rag::VectorIndexOptions index_options() {
+    infinite_rag::VectorIndexOptions options;
+    options.dim = kDim;
+    options.metric = infinite_rag::IndexMetric::L2;
+    options.initial_capacity = 1024;
+    options.background_compaction = false;
+    return options;
+}
+
+std::string make_document(size_t id) {
+    std::string text = "# Document " + std::to_string(id) + "\n\n";
+    for (int s = 0; s < 12; ++s) {
+        text += "Paragraph sentence " + std::to_string(s) + " of document " + std::to_string(id) + " about item DX-" +
+                std::to_string(id) + ". ";
+    }
+    return text;
+}
+
+// 每批推理固定耗时的向量化，用于制造慢阶段以观察背压
+class SlowEmbedding : public text_embedding_test::FakeEmbedding {
+public:
+    SlowEmbedding(size_t dim, std::chrono::milliseconds delay) : FakeEmbedding(dim), delay_(delay) {}
+
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override {
+        std::this_thread::sleep_for(delay_);
+        return FakeEmbedding::embed_batch(texts);
+    }
+
+private:
+    std::chrono::milliseconds delay_;
+};
+
+} // namespace
+
+TEST(IngestionPipelineTest, IngestsDocumentsEndToEnd) {
+    auto tokenizer = text_embedding::load_tokenizer_pool(kTokenizerFile);
+    document_extractor::TextChunker chunker(*tokenizer, {32, 4});
+    ChunkStore store(temp_db_path("end_to_end"));
+    VectorIndex index(index_options());
+    text_embedding_test::FakeEmbedding model(kDim);
+
+    const fs::path html_path = temp_dir() / "manual.html";
+    std::ofstream(html_path) << "<html><body><h1>Manual</h1><p>The XK-4471-B pump needs 24V.</p>"
+                                "<script>ignored()</script></body></html>";
+
+    IngestionOptions options;
+    options.embed_batch_size = 8;
+    options.index_batch_size = 16;
+    IngestionPipeline pipeline(store, index, model, chunker, options);
+
+    const size_t kDocuments = 40;
+    for (size_t i = 0; i < kDocuments; ++i) {
+        IngestionDocument document;
+        document.doc_id = "doc" + std::to_string(i);
+        document.content = make_document(i);
+        document.format = document_extractor::DocumentFormat::MARKDOWN;
+        document.metadata = {{"source", "generated"}};
+        pipeline.submit(std::move(document));
+    }
+    pipeline.submit_file(html_path.string(), {{"source", "file"}});
+    pipeline.submit_file((temp_dir() / "missing.txt").string());
+
+    auto stats = pipeline.finish();
+    LOG_INFO << infinite_rag::format_ingestion_stats(stats);
+    EXPECT_THROW(pipeline.submit_file(html_path.string()), std::logic_error);
+
+    ASSERT_EQ(stats.stages.size(), 4u);
+    EXPECT_STREQ(stats.stages[0].name, "extract");
+    EXPECT_EQ(stats.stages[0].items_in, kDocuments + 2);
+    EXPECT_EQ(stats.stages[0].failures, 1u);  // 缺失的文件
+    EXPECT_EQ(stats.documents, kDocuments + 1);
+    EXPECT_GT(stats.chunks, kDocuments);       // 每个文档切为多块
+    EXPECT_EQ(stats.chunks, stats.stages[1].items_out);
+    EXPECT_EQ(stats.stages[3].failures, 0u);
+    for (const auto& stage : stats.stages) EXPECT_EQ(stage.queue_depth, 0u);
+
+    EXPECT_EQ(store.size(), stats.chunks);
+    EXPECT_EQ(index.stats().size, stats.chunks);
+    auto hits = store.search_bm25("XK-4471-B", 5);
+    ASSERT_EQ(hits.size(), 1u);
+    auto chunk = store.get(hits[0].id);
+    ASSERT_TRUE(chunk.has_value());
+    EXPECT_EQ(chunk->doc_id, html_path.string());
+    EXPECT_EQ(chunk->metadata.at("source"), "file");
+    EXPECT_EQ(chunk->text.find("ignored"), std::string::npos);
+    EXPECT_TRUE(index.contains(hits[0].id));
+
+    // 重复导入同一文档覆盖原有的块
+    IngestionPipeline again(store, index, model, chunker, options);
+    again.submit_file(html_path.string(), {{"source", "file"}});
+    EXPECT_EQ(again.finish().chunks, 1u);
+    EXPECT_EQ(store.size(), stats.chunks);
+}
+
+TEST(IngestionPipelineTest, BackpressureBoundsQueues) {
+    auto tokenizer = text_embedding::load_tokenizer_pool(kTokenizerFile);
+    document_extractor::TextChunker chunker(*tokenizer, {32, 4});
+    ChunkStore store(temp_db_path("backpressure"));
+    VectorIndex index(index_options());
+    SlowEmbedding model(kDim, std::chrono::milliseconds(5));
+
+    IngestionOptions options;
+    options.document_queue = 4;
+    options.text_queue = 2;
+    options.chunk_queue = 8;
+    options.vector_queue = 8;
+    options.embed_batch_size = 4;
+    options.report_interval = std::chrono::milliseconds(50);
+    IngestionPipeline pipeline(store, index, model, chunker, options);
+
+    // 向量化是瓶颈：提交方被阻塞，上游队列停在容量上限
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < 30; ++i) {
+        pipeline.submit({"doc" + std::to_string(i), "", make_document(i), document_extractor::DocumentFormat::PLAIN, {}});
+    }
+    const double submit_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto running = pipeline.stats();
+    EXPECT_LE(running.stages[2].max_queue_depth, options.chunk_queue);
+    auto stats = pipeline.finish();
+    LOG_INFO << "submit blocked for " << submit_ms << " ms; " << infinite_rag::format_ingestion_stats(stats);
+
+    EXPECT_EQ(stats.documents, 30u);
+    EXPECT_EQ(stats.stages[0].max_queue_depth, options.document_queue);
+    EXPECT_EQ(stats.stages[2].max_queue_depth, options.chunk_queue);
+    EXPECT_LE(stats.stages[3].max_queue_depth, options.vector_queue);
+    EXPECT_GT(stats.stages[2].utilization, stats.stages[0].utilization);
+    // 向量化批次不超过上限
+    for (size_t size : model.recorded_batch_sizes()) EXPECT_LE(size, options.embed_batch_size);
+    EXPECT_EQ(index.stats().size, stats.chunks);
+}
+
+TEST(IngestionPipelineTest, EmbeddingFailureDropsOnlyThatBatch) {
+    auto tokenizer = text_embedding::load_tokenizer_pool(kTokenizerFile);
+    document_extractor::TextChunker chunker(*tokenizer, {32, 4});
+    ChunkStore store(temp_db_path("failure"));
+    VectorIndex index(index_options());
+    text_embedding_test::FakeEmbedding model(kDim);
+
+    IngestionOptions options;
+    options.embed_batch_size = 1;
+    IngestionPipeline pipeline(store, index, model, chunker, options);
+    pipeline.submit({"ok", "", "A normal document.", document_extractor::DocumentFormat::PLAIN, {}});
+    pipeline.submit({"bad", "", text_embedding_test::FakeEmbedding::kFailText,
+                     document_extractor::DocumentFormat::PLAIN, {}});
+    auto stats = pipeline.finish();
+
+    EXPECT_EQ(stats.documents, 2u);
+    EXPECT_EQ(stats.stages[2].failures, 1u);
+    EXPECT_EQ(stats.chunks, 1u);
+    EXPECT_EQ(store.size(), 1u);
+}
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fake_embedding.h"
+#include "logger.h"
+#include "vector_index.h"
+#include "vector_math.h"
+
+using infinite_rag::VectorIndex;
+using infinite_rag::VectorIndexOptions;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kDim = 32;
+
+// 围绕若干中心的归一化向量，近似真实 embedding 的聚簇分布
+std::vector<std::vector<float>> clustered_vectors(size_t count, size_t dim, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> centers(16, std::vector<float>(dim));
+    for (auto& center : centers) {
+        for (auto& x : center) x = dist(rng);
+    }
+
+    std::vector<std::vector<float>> vectors(count, std::vector<float>(dim));
+    for (size_t i = 0; i < count; ++i) {
+        const auto& center = centers[i % centers.size()];
+        for (size_t d = 0; d < dim; ++d) vectors[i][d] = center[d] + 0.3f * dist(rng);
+        vector_math::l2_normalize(vectors[i].data(), dim);
+    }
+    return vectors;
+}
+
+VectorIndexOptions test_options() {
+    VectorIndexOptions options;
+    options.dim = kDim;
+    options.initial_capacity = 128;
+    options.background_compaction = false;
+    return options;
+}
+
+std::vector<uint64_t> sequential_ids(size_t count, uint64_t first = 0) {
+    std::vector<uint64_t> ids(count);
+    for (size_t i = 0; i < count; ++i) ids[i] = first + i;
+    return ids;
+}
+
+std::string temp_snapshot_path(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / "redge_vector_index_test";
+    fs::create_directories(dir);
+    return (dir / name).string();
+}
+
+} // namespace
+
+TEST(VectorIndexTest, SearchFindsInsertedVectorsAndGrows) {
+    VectorIndex index(test_options());
+    auto vectors = clustered_vectors(1000, kDim, 1);
+    index.add_batch(sequential_ids(vectors.size()), vectors);
+
+    auto stats = index.stats();
+    EXPECT_EQ(stats.size, vectors.size());
+    EXPECT_GE(stats.capacity, vectors.size());
+
+    for (size_t i = 0; i < vectors.size(); i += 97) {
+        auto hits = index.search(vectors[i], 5);
+        ASSERT_FALSE(hits.empty());
+        EXPECT_EQ(hits[0].id, i);
+        EXPECT_NEAR(hits[0].score, 1.0f, 1e-4f);
+        for (size_t h = 1; h < hits.size(); ++h) EXPECT_GE(hits[h - 1].score, hits[h].score);
+    }
+}
+
+TEST(VectorIndexTest, SameIdOverwrites) {
+    VectorIndex index(test_options());
+    auto vectors = clustered_vectors(2, kDim, 2);
+    index.add(7, vectors[0]);
+    index.add(7, vectors[1]);
+
+    EXPECT_EQ(index.stats().size, 1u);
+    auto hits = index.search(vectors[1], 1);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].id, 7u);
+    EXPECT_NEAR(hits[0].score, 1.0f, 1e-4f);
+}
+
+TEST(VectorIndexTest, RejectsDimensionMismatch) {
+    VectorIndex index(test_options());
+    EXPECT_THROW(index.add(1, std::vector<float>(kDim + 1)), std::invalid_argument);
+    EXPECT_THROW(index.search(std::vector<float>(kDim - 1), 1), std::invalid_argument);
+    EXPECT_THROW(index.add_batch({1, 2}, {std::vector<float>(kDim)}), std::invalid_argument);
+}
+
+TEST(VectorIndexTest, SoftDeleteHidesAndReAddRestores) {
+    VectorIndex index(test_options());
+    auto vectors = clustered_vectors(200, kDim, 3);
+    index.add_batch(sequential_ids(vectors.size()), vectors);
+
+    EXPECT_TRUE(index.remove(10));
+    EXPECT_FALSE(index.remove(10));
+    EXPECT_FALSE(index.remove(12345));
+    EXPECT_FALSE(index.contains(10));
+    EXPECT_EQ(index.stats().deleted, 1u);
+
+    for (const auto& hit : index.search(vectors[10], 20)) EXPECT_NE(hit.id, 10u);
+
+    index.add(10, vectors[10]);
+    EXPECT_TRUE(index.contains(10));
+    EXPECT_EQ(index.stats().deleted, 0u);
+    EXPECT_EQ(index.search(vectors[10], 1)[0].id, 10u);
+}
+
+TEST(VectorIndexTest, CompactionDropsDeletedElements) {
+    VectorIndex index(test_options());
+    auto vectors = clustered_vectors(1000, kDim, 4);
+    index.add_batch(sequential_ids(vectors.size()), vectors);
+    for (uint64_t id = 0; id < vectors.size(); id += 2) ASSERT_TRUE(index.remove(id));
+
+    index.compact();
+    auto stats = index.stats();
+    EXPECT_EQ(stats.size, 500u);
+    EXPECT_EQ(stats.deleted, 0u);
+    EXPECT_EQ(stats.compactions, 1u);
+
+    for (uint64_t id = 1; id < vectors.size(); id += 50) {
+        EXPECT_TRUE(index.contains(id));
+        EXPECT_FALSE(index.contains(id - 1));
+        auto hits = index.search(vectors[id], 10);
+        ASSERT_FALSE(hits.empty());
+        EXPECT_EQ(hits[0].id, id);
+        for (const auto& hit : hits) EXPECT_EQ(hit.id % 2, 1u) << "Deleted id " << hit.id << " returned";
+    }
+}
+
+TEST(VectorIndexTest, BackgroundCompactionTriggersOnDeleteRatio) {
+    auto options = test_options();
+    options.background_compaction = true;
+    options.compaction_threshold = 0.25;
+    VectorIndex index(options);
+
+    auto vectors = clustered_vectors(400, kDim, 5);
+    index.add_batch(sequential_ids(vectors.size()), vectors);
+    for (uint64_t id = 0; id < 120; ++id) index.remove(id);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (index.stats().compactions == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto stats = index.stats();
+    EXPECT_GE(stats.compactions, 1u);
+    EXPECT_EQ(stats.size, 280u);
+    EXPECT_LT(stats.deleted, 120u);
+}
+
+// 并发插入、删除、检索的同时反复压缩，最终内容与串行语义一致
+TEST(VectorIndexTest, ConcurrentWritesDuringCompaction) {
+    VectorIndex index(test_options());
+    constexpr size_t kWriters = 4;
+    constexpr size_t kPerWriter = 500;
+    auto vectors = clustered_vectors(kWriters * kPerWriter, kDim, 6);
+
+    std::atomic<bool> writers_done{false};
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&, w] {
+            for (size_t i = 0; i < kPerWriter; ++i) {
+                const uint64_t id = w * kPerWriter + i;
+                index.add(id, vectors[id]);
+                // 每个写线程删除自己写入的 id % 3 == 0
+                if (id % 3 == 0) index.remove(id);
+            }
+        });
+    }
+    std::thread searcher([&] {
+        size_t round = 0;
+        while (!writers_done.load()) index.search(vectors[round++ % vectors.size()], 10);
+    });
+    std::thread compactor([&] {
+        while (!writers_done.load()) {
+            index.compact();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    for (auto& thread : threads) thread.join();
+    writers_done = true;
+    searcher.join();
+    compactor.join();
+    index.compact();
+
+    for (uint64_t id = 0; id < vectors.size(); ++id) {
+        EXPECT_EQ(index.contains(id), id % 3 != 0) << "id " << id;
+    }
+    auto stats = index.stats();
+    EXPECT_EQ(stats.size, vectors.size() - (vectors.size() + 2) / 3);
+    LOG_INFO << "[VectorIndex] compactions during concurrent writes: " << stats.compactions;
+}
+
+TEST(VectorIndexTest, SnapshotReopensWithoutRebuild) {
+    const std::string path = temp_snapshot_path("roundtrip.hnsw");
+    auto vectors = clustered_vectors(3000, kDim, 7);
+    std::vector<std::vector<infinite_rag::SearchHit>> expected;
+
+    {
+        VectorIndex index(test_options());
+        index.add_batch(sequential_ids(vectors.size()), vectors);
+        for (uint64_t id = 0; id < 30; ++id) index.remove(id);
+        for (size_t i = 0; i < vectors.size(); i += 100) expected.push_back(index.search(vectors[i], 10));
+        ASSERT_TRUE(index.save(path));
+    }
+
+    VectorIndex reopened(test_options());
+    ASSERT_TRUE(reopened.load(path));
+    auto stats = reopened.stats();
+    EXPECT_TRUE(stats.mapped);
+    EXPECT_EQ(stats.size, vectors.size() - 30);
+    EXPECT_EQ(stats.deleted, 30u);
+
+    for (size_t q = 0; q < expected.size(); ++q) {
+        auto hits = reopened.search(vectors[q * 100], 10);
+        ASSERT_EQ(hits.size(), expected[q].size());
+        for (size_t h = 0; h < hits.size(); ++h) {
+            EXPECT_EQ(hits[h].id, expected[q][h].id);
+            EXPECT_FLOAT_EQ(hits[h].score, expected[q][h].score);
+        }
+    }
+
+    // 删除在映射上写时复制，不影响快照文件；扩容时才脱离映射
+    EXPECT_TRUE(reopened.remove(100));
+    EXPECT_TRUE(reopened.stats().mapped);
+    reopened.add(100000, vectors[5]);
+    EXPECT_FALSE(reopened.stats().mapped);
+    EXPECT_EQ(reopened.search(vectors[5], 1)[0].id, 100000u);
+
+    VectorIndex again(test_options());
+    ASSERT_TRUE(again.load(path));
+    EXPECT_TRUE(again.contains(100));
+    EXPECT_FALSE(again.contains(100000));
+}
+
+TEST(VectorIndexTest, LoadRejectsMismatchedSnapshot) {
+    const std::string path = temp_snapshot_path("mismatch.hnsw");
+    {
+        VectorIndex index(test_options());
+        index.add(1, clustered_vectors(1, kDim, 8)[0]);
+        ASSERT_TRUE(index.save(path));
+    }
+
+    auto options = test_options();
+    options.dim = kDim * 2;
+    VectorIndex other(options);
+    EXPECT_FALSE(other.load(path));
+    EXPECT_FALSE(other.load(temp_snapshot_path("missing.hnsw")));
+    EXPECT_EQ(other.stats().size, 0u);
+}
+
+TEST(VectorIndexTest, StoresTextEmbeddingOutput) {
+    text_embedding_test::FakeEmbedding model(kDim);
+    auto options = test_options();
+    options.metric = infinite_rag::IndexMetric::L2;  // FakeEmbedding 的向量未归一化
+    VectorIndex index(options);
+
+    const std::vector<std::string> texts = {"向量检索", "hello world", "incremental index", "知识库"};
+    index.add_texts(model, sequential_ids(texts.size(), 100), texts);
+    EXPECT_EQ(index.stats().size, texts.size());
+
+    for (size_t i = 0; i < texts.size(); ++i) {
+        auto hits = index.search_text(model, texts[i], 1);
+        ASSERT_EQ(hits.size(), 1u);
+        EXPECT_EQ(hits[0].id, 100 + i);
+        EXPECT_NEAR(hits[0].score, 0.0f, 1e-4f);
+    }
+}
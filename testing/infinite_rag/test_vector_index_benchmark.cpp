@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "vector_index.h"
+#include "vector_math.h"
+
+namespace vector_index_benchmark {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr size_t kDim = 384;          // e5-small / bge-small 的输出维度
+constexpr size_t kCorpusSize = 20000;
+constexpr size_t kQueryCount = 200;
+constexpr size_t kTopK = 10;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 聚簇分布的归一化向量；查询是语料向量加噪声，近似真实检索
+struct Dataset {
+    std::vector<std::vector<float>> corpus;
+    std::vector<float> corpus_matrix;  // [kCorpusSize, kDim]，供暴力检索
+    std::vector<std::vector<float>> queries;
+};
+
+Dataset make_dataset() {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> centers(256, std::vector<float>(kDim));
+    for (auto& center : centers) {
+        for (auto& x : center) x = dist(rng);
+    }
+
+    Dataset data;
+    data.corpus.assign(kCorpusSize, std::vector<float>(kDim));
+    for (size_t i = 0; i < kCorpusSize; ++i) {
+        const auto& center = centers[rng() % centers.size()];
+        for (size_t d = 0; d < kDim; ++d) data.corpus[i][d] = center[d] + 0.5f * dist(rng);
+        vector_math::l2_normalize(data.corpus[i].data(), kDim);
+        data.corpus_matrix.insert(data.corpus_matrix.end(), data.corpus[i].begin(), data.corpus[i].end());
+    }
+
+    for (size_t q = 0; q < kQueryCount; ++q) {
+        std::vector<float> query = data.corpus[rng() % kCorpusSize];
+        for (auto& x : query) x += 0.05f * dist(rng);
+        vector_math::l2_normalize(query.data(), kDim);
+        data.queries.push_back(std::move(query));
+    }
+    return data;
+}
+
+std::vector<uint64_t> brute_force_top_k(const Dataset& data, const std::vector<float>& query, std::vector<float>& scores) {
+    vector_math::dot_many(query.data(), data.corpus_matrix.data(), kCorpusSize, kDim, scores.data());
+    std::vector<uint64_t> ids(kCorpusSize);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::partial_sort(ids.begin(), ids.begin() + kTopK, ids.end(),
+                      [&](uint64_t a, uint64_t b) { return scores[a] > scores[b]; });
+    ids.resize(kTopK);
+    return ids;
+}
+
+double recall_at_k(const std::vector<infinite_rag::SearchHit>& hits, const std::vector<uint64_t>& truth) {
+    size_t found = 0;
+    for (const auto& hit : hits) {
+        if (std::find(truth.begin(), truth.end(), hit.id) != truth.end()) ++found;
+    }
+    return static_cast<double>(found) / truth.size();
+}
+
+void run_vector_index_benchmark() {
+    const Dataset data = make_dataset();
+    std::vector<uint64_t> ids(kCorpusSize);
+    std::iota(ids.begin(), ids.end(), 0);
+
+    LOG_INFO << "\n========== VectorIndex: " << kCorpusSize << " x " << kDim << ", " << kQueryCount
+             << " queries, recall@" << kTopK << " ==========";
+
+    // 暴力检索：基准真值与 QPS 下限
+    std::vector<std::vector<uint64_t>> truth;
+    std::vector<float> scores(kCorpusSize);
+    auto start = Clock::now();
+    for (const auto& query : data.queries) truth.push_back(brute_force_top_k(data, query, scores));
+    const double brute_ms = elapsed_ms(start);
+    const double brute_qps = kQueryCount * 1000.0 / brute_ms;
+    LOG_INFO << "[VectorIndex] brute force QPS: " << brute_qps;
+
+    double best_recall = 0.0;
+    for (size_t M : {8, 16, 32}) {
+        infinite_rag::VectorIndexOptions options;
+        options.dim = kDim;
+        options.M = M;
+        options.initial_capacity = kCorpusSize;
+        options.background_compaction = false;
+        infinite_rag::VectorIndex index(options);
+
+        start = Clock::now();
+        index.add_batch(ids, data.corpus);
+        LOG_INFO << "[VectorIndex] M = " << M << ", build: " << elapsed_ms(start) << " ms";
+
+        for (size_t ef : {16, 32, 64, 128, 256}) {
+            index.set_ef_search(ef);
+            double recall = 0.0;
+            start = Clock::now();
+            for (size_t q = 0; q < kQueryCount; ++q) {
+                recall += recall_at_k(index.search(data.queries[q], kTopK), truth[q]);
+            }
+            const double qps = kQueryCount * 1000.0 / elapsed_ms(start);
+            recall /= kQueryCount;
+            best_recall = std::max(best_recall, recall);
+            LOG_INFO << "[VectorIndex] M = " << M << ", ef = " << ef << " | recall@" << kTopK << ": " << recall
+                     << ", QPS: " << qps << " (" << qps / brute_qps << "x brute force)";
+        }
+    }
+    EXPECT_GT(best_recall, 0.95);
+}
+
+// 快照重新打开与重建的耗时对比
+void run_snapshot_benchmark() {
+    const Dataset data = make_dataset();
+    std::vector<uint64_t> ids(kCorpusSize);
+    std::iota(ids.begin(), ids.end(), 0);
+    const std::string path = (fs::temp_directory_path() / "redge_vector_index_benchmark.hnsw").string();
+
+    infinite_rag::VectorIndexOptions options;
+    options.dim = kDim;
+    options.initial_capacity = kCorpusSize;
+    options.background_compaction = false;
+
+    double build_ms = 0.0;
+    {
+        infinite_rag::VectorIndex index(options);
+        auto start = Clock::now();
+        index.add_batch(ids, data.corpus);
+        build_ms = elapsed_ms(start);
+
+        start = Clock::now();
+        ASSERT_TRUE(index.save(path));
+        LOG_INFO << "[VectorIndex] snapshot save: " << elapsed_ms(start) << " ms, "
+                 << fs::file_size(path) / (1024.0 * 1024.0) << " MB";
+    }
+
+    infinite_rag::VectorIndex reopened(options);
+    auto start = Clock::now();
+    ASSERT_TRUE(reopened.load(path));
+    const double open_ms = elapsed_ms(start);
+    LOG_INFO << "[VectorIndex] rebuild: " << build_ms << " ms, snapshot open (mmap): " << open_ms << " ms";
+
+    EXPECT_EQ(reopened.stats().size, kCorpusSize);
+    EXPECT_LT(open_ms, build_ms);
+    fs::remove(path);
+}
+
+} // namespace vector_index_benchmark
+
+// GTest 测试用例
+TEST(VectorIndexBenchmark, RecallAndQpsAgainstBruteForce) {
+    vector_index_benchmark::run_vector_index_benchmark();
+}
+
+TEST(VectorIndexBenchmark, SnapshotOpenVersusRebuild) {
+    vector_index_benchmark::run_snapshot_benchmark();
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "llama_inference.h"
+#include "logger.h"
+
+namespace llama_benchmark {
+
+using Clock = std::chrono::high_resolution_clock;
+
+const std::string kModelPath = "resource/model/qwen2.5-0.5b-instruct/qwen2.5-0.5b-instruct-q4_k_m.gguf";
+constexpr size_t kRequests = 8;
+constexpr size_t kMaxTokens = 32;
+
+// RAG 场景：较长的固定系统提示 + 相同的检索上下文，只有问题不同
+std::string shared_prefix() {
+    std::string prefix =
+        "<|im_start|>system\nYou are a support assistant for industrial pumps. Answer strictly from the "
+        "context below, cite the section number, and say you do not know when the context is silent.\n";
+    for (int i = 1; i <= 12; ++i) {
+        prefix += "Section " + std::to_string(i) + ": The XK-" + std::to_string(4400 + i) +
+                  " pump requires a 24V supply, a dedicated breaker, and a filter cartridge that is replaced "
+                  "every six months. Maximum continuous pressure is " + std::to_string(10 + i) + " bar.\n";
+    }
+    return prefix + "<|im_end|>\n";
+}
+
+std::string make_prompt(size_t i) {
+    return shared_prefix() + "<|im_start|>user\nWhat pressure does the XK-" + std::to_string(4400 + i % 12 + 1) +
+           " support?<|im_end|>\n<|im_start|>assistant\n";
+}
+
+struct Summary {
+    double mean_ttft_ms = 0.0;
+    double mean_tokens_per_second = 0.0;
+    double cached_ratio = 0.0;
+};
+
+Summary summarize(const std::string& name, const std::vector<llm_inference::GenerationResult>& results,
+                  double wall_ms) {
+    Summary summary;
+    size_t prompt = 0;
+    size_t cached = 0;
+    size_t generated = 0;
+    for (const auto& r : results) {
+        summary.mean_ttft_ms += r.ttft_ms;
+        summary.mean_tokens_per_second += r.tokens_per_second;
+        prompt += r.prompt_tokens;
+        cached += r.cached_tokens;
+        generated += r.generated_tokens;
+    }
+    const double n = static_cast<double>(results.size());
+    summary.mean_ttft_ms /= n;
+    summary.mean_tokens_per_second /= n;
+    summary.cached_ratio = prompt ? static_cast<double>(cached) / prompt : 0.0;
+    LOG_INFO << "[Summary] " << name << " | mean TTFT: " << summary.mean_ttft_ms << " ms, decode: "
+             << summary.mean_tokens_per_second << " tok/s/seq, aggregate: " << generated * 1000.0 / wall_ms
+             << " tok/s, cached prompt tokens: " << summary.cached_ratio * 100.0 << "%";
+    return summary;
+}
+
+// 逐个请求串行生成，TTFT 不含排队
+Summary run_sequential(const std::string& name, llm_inference::LlamaInference& llm) {
+    llm_inference::GenerationParams params;
+    params.max_tokens = kMaxTokens;
+    params.temperature = 0.0f;
+
+    std::vector<llm_inference::GenerationResult> results;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < kRequests; ++i) results.push_back(llm.generate(make_prompt(i), params));
+    const double wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return summarize(name, results, wall_ms);
+}
+
+// 同时提交全部请求，在一个 context 内连续批处理
+Summary run_concurrent(const std::string& name, llm_inference::LlamaInference& llm) {
+    llm_inference::GenerationParams params;
+    params.max_tokens = kMaxTokens;
+    params.temperature = 0.0f;
+
+    std::vector<std::future<llm_inference::GenerationResult>> futures;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < kRequests; ++i) futures.push_back(llm.submit(make_prompt(i), params));
+    std::vector<llm_inference::GenerationResult> results;
+    for (auto& future : futures) results.push_back(future.get());
+    const double wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return summarize(name, results, wall_ms);
+}
+
+void run_llama_benchmark() {
+    llm_inference::LlamaOptions options;
+    options.context_per_sequence = 2048;
+    options.prefix_cache = false;
+    llm_inference::LlamaInference baseline(options);
+    ASSERT_TRUE(baseline.load_model(kModelPath)) << "Failed to load GGUF model.";
+
+    LOG_INFO << "\n========== " << kRequests << " requests, shared prefix "
+             << baseline.count_tokens(shared_prefix()) << " tokens, " << kMaxTokens << " new tokens ==========\n";
+    const auto cold = run_sequential("sequential, no reuse", baseline);
+    run_concurrent("concurrent, 4 sequences, no reuse", baseline);
+    baseline.unload_model();
+
+    options.prefix_cache = true;
+    llm_inference::LlamaInference cached(options);
+    ASSERT_TRUE(cached.load_model(kModelPath)) << "Failed to load GGUF model.";
+    // 预热：第一个请求写入共享前缀的快照
+    run_sequential("sequential, warming cache", cached);
+    const auto warm = run_sequential("sequential, prefix reuse", cached);
+    run_concurrent("concurrent, 4 sequences, prefix reuse", cached);
+
+    const auto stats = cached.cache_stats();
+    LOG_INFO << "[Summary] prefix cache | entries: " << stats.entries << ", bytes: " << stats.bytes
+             << ", hits: " << stats.hits << "/" << stats.lookups << ", reused tokens: " << stats.reused_tokens;
+
+    EXPECT_GT(warm.cached_ratio, 0.8);
+    EXPECT_LT(warm.mean_ttft_ms, cold.mean_ttft_ms);
+}
+
+// 相同 prompt 在复用前后贪心解码结果一致
+void run_consistency_check() {
+    llm_inference::LlamaOptions options;
+    options.context_per_sequence = 2048;
+    llm_inference::LlamaInference llm(options);
+    ASSERT_TRUE(llm.load_model(kModelPath)) << "Failed to load GGUF model.";
+
+    llm_inference::GenerationParams params;
+    params.max_tokens = 16;
+    params.temperature = 0.0f;
+    const auto first = llm.generate(make_prompt(0), params);
+    const auto second = llm.generate(make_prompt(0), params);
+    EXPECT_EQ(first.cached_tokens, 0u);
+    EXPECT_GT(second.cached_tokens, 0u);
+    EXPECT_EQ(first.text, second.text);
+
+    std::string streamed;
+    const auto third = llm.generate(make_prompt(1), params, [&streamed](const std::string& piece) {
+        streamed += piece;
+        return streamed.size() < 8;
+    });
+    EXPECT_EQ(third.finish_reason, llm_inference::FinishReason::CANCELLED);
+    EXPECT_EQ(streamed, third.text);
+}
+
+// 一个序列持续出字时接入新 prompt：前缀快照在调度线程上执行，其耗时应远小于一个解码步，
+// 且共享前缀、只有问题不同的后续请求不再重复快照
+void run_snapshot_stall_check() {
+    llm_inference::LlamaOptions options;
+    options.context_per_sequence = 2048;
+    llm_inference::LlamaInference llm(options);
+    ASSERT_TRUE(llm.load_model(kModelPath)) << "Failed to load GGUF model.";
+
+    llm_inference::GenerationParams long_params;
+    long_params.max_tokens = 128;
+    long_params.temperature = 0.0f;
+    std::vector<Clock::time_point> arrivals;
+    auto streaming = llm.submit("<|im_start|>user\nWrite a long story about a pump.<|im_end|>\n<|im_start|>assistant\n",
+                                long_params, [&arrivals](const std::string&) {
+                                    arrivals.push_back(Clock::now());
+                                    return true;
+                                });
+
+    llm_inference::GenerationParams params;
+    params.max_tokens = 8;
+    params.temperature = 0.0f;
+    std::vector<llm_inference::GenerationResult> results;
+    for (size_t i = 0; i < 4; ++i) results.push_back(llm.generate(make_prompt(i), params));
+    streaming.get();
+
+    std::vector<double> gaps;
+    for (size_t i = 1; i < arrivals.size(); ++i) {
+        gaps.push_back(std::chrono::duration<double, std::milli>(arrivals[i] - arrivals[i - 1]).count());
+    }
+    ASSERT_FALSE(gaps.empty());
+    std::sort(gaps.begin(), gaps.end());
+    const double median_gap = gaps[gaps.size() / 2];
+    LOG_INFO << "[Snapshot] first prompt: " << results[0].snapshot_ms << " ms, median token gap: " << median_gap
+             << " ms, max gap: " << gaps.back() << " ms";
+
+    EXPECT_GT(results[0].snapshot_ms, 0.0);
+    EXPECT_LT(results[0].snapshot_ms, median_gap);
+    for (size_t i = 1; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].snapshot_ms, 0.0) << "request " << i << " re-snapshotted a cached prefix";
+        EXPECT_GT(results[i].cached_tokens, 0u);
+    }
+}
+
+} // namespace llama_benchmark
+
+// GTest 测试用例
+TEST(LlamaInferenceBenchmark, PrefixReuseConsistency) {
+    llama_benchmark::run_consistency_check();
+}
+
+TEST(LlamaInferenceBenchmark, TtftAndThroughput) {
+    llama_benchmark::run_llama_benchmark();
+}
+
+TEST(LlamaInferenceBenchmark, PrefixSnapshotDoesNotStallDecode) {
+    llama_benchmark::run_snapshot_stall_check();
+}
@@ -0,0 +1,126 @@
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "prefix_cache.h"
+
+using llm_inference::PrefixCache;
+using llm_inference::PrefixCacheOptions;
+
+namespace {
+
+std::vector<int32_t> tokens(int32_t begin, size_t n) {
+    std::vector<int32_t> result(n);
+    std::iota(result.begin(), result.end(), begin);
+    return result;
+}
+
+std::vector<int32_t> concat(std::vector<int32_t> a, const std::vector<int32_t>& b) {
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+PrefixCacheOptions small_options(size_t max_bytes = 1 << 20) {
+    PrefixCacheOptions options;
+    options.max_bytes = max_bytes;
+    options.min_tokens = 4;
+    return options;
+}
+
+} // namespace
+
+TEST(PrefixCacheTest, CommonPrefixLength) {
+    EXPECT_EQ(llm_inference::common_prefix_length({1, 2, 3}, {1, 2, 4}), 2u);
+    EXPECT_EQ(llm_inference::common_prefix_length({1, 2}, {1, 2, 3}), 2u);
+    EXPECT_EQ(llm_inference::common_prefix_length({}, {1}), 0u);
+}
+
+TEST(PrefixCacheTest, LongestPrefixWins) {
+    PrefixCache cache(small_options());
+    const auto system = tokens(0, 10);
+    cache.insert(system, std::vector<uint8_t>(10, 1));
+    cache.insert(concat(system, tokens(100, 10)), std::vector<uint8_t>(20, 2));
+
+    // 第二条以第一条为前缀，第一条被替代
+    EXPECT_EQ(cache.stats().entries, 1u);
+
+    auto match = cache.lookup(concat(system, tokens(100, 5)));
+    ASSERT_TRUE(match.entry);
+    EXPECT_EQ(match.length, 15u);
+    EXPECT_EQ(match.entry->state.front(), 2);
+
+    // 只共享 system 部分时返回同一条目，由调用方截断到公共前缀
+    match = cache.lookup(concat(system, tokens(500, 8)));
+    ASSERT_TRUE(match.entry);
+    EXPECT_EQ(match.length, 10u);
+
+    cache.insert(concat(system, tokens(500, 8)), std::vector<uint8_t>(18, 3));
+    match = cache.lookup(concat(system, tokens(500, 9)));
+    ASSERT_TRUE(match.entry);
+    EXPECT_EQ(match.length, 18u);
+    EXPECT_EQ(match.entry->state.front(), 3);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.bytes, 38u);
+    EXPECT_EQ(stats.lookups, 3u);
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.reused_tokens, 43u);
+}
+
+TEST(PrefixCacheTest, ShortPrefixIsMiss) {
+    PrefixCache cache(small_options());
+    cache.insert(tokens(0, 3), {1});
+    EXPECT_EQ(cache.stats().entries, 0u);
+
+    cache.insert(tokens(0, 8), {1});
+    EXPECT_FALSE(cache.lookup(concat(tokens(0, 3), tokens(50, 5))).entry);
+    EXPECT_FALSE(cache.lookup(tokens(1, 8)).entry);
+    EXPECT_TRUE(cache.lookup(tokens(0, 4)).entry);
+    EXPECT_EQ(cache.stats().hits, 1u);
+}
+
+TEST(PrefixCacheTest, WorthSavingNeedsEnoughNewTokens) {
+    PrefixCache cache(small_options());
+    EXPECT_FALSE(cache.worth_saving(tokens(0, 3)));
+    EXPECT_TRUE(cache.worth_saving(tokens(0, 4)));
+
+    cache.insert(tokens(0, 20), std::vector<uint8_t>(20));
+    // 已被覆盖，或公共前缀之后新 token 少于 min_tokens
+    EXPECT_FALSE(cache.worth_saving(tokens(0, 12)));
+    EXPECT_FALSE(cache.worth_saving(tokens(0, 20)));
+    EXPECT_FALSE(cache.worth_saving(tokens(0, 23)));
+    EXPECT_FALSE(cache.worth_saving(concat(tokens(0, 18), tokens(100, 3))));
+    EXPECT_TRUE(cache.worth_saving(tokens(0, 24)));
+    EXPECT_TRUE(cache.worth_saving(concat(tokens(0, 16), tokens(100, 4))));
+
+    cache.insert(tokens(0, 12), std::vector<uint8_t>(12));
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, 20u);
+    EXPECT_EQ(stats.insertions, 1u);
+}
+
+TEST(PrefixCacheTest, EvictsLeastRecentlyUsed) {
+    PrefixCache cache(small_options(100));
+    cache.insert(tokens(0, 8), std::vector<uint8_t>(40, 'a'));
+    cache.insert(tokens(100, 8), std::vector<uint8_t>(40, 'b'));
+    // 访问 a，使 b 成为最久未用
+    ASSERT_TRUE(cache.lookup(tokens(0, 8)).entry);
+    cache.insert(tokens(200, 8), std::vector<uint8_t>(40, 'c'));
+
+    EXPECT_TRUE(cache.lookup(tokens(0, 8)).entry);
+    EXPECT_FALSE(cache.lookup(tokens(100, 8)).entry);
+    EXPECT_TRUE(cache.lookup(tokens(200, 8)).entry);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    EXPECT_EQ(cache.stats().bytes, 80u);
+
+    // 单条超过容量时不缓存
+    cache.insert(tokens(300, 8), std::vector<uint8_t>(101));
+    EXPECT_FALSE(cache.lookup(tokens(300, 8)).entry);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().entries, 0u);
+    EXPECT_EQ(cache.stats().bytes, 0u);
+}
@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "stop_sequence.h"
+
+using llm_inference::StopSequenceFilter;
+
+namespace {
+
+// 依次追加片段，返回流式输出拼接的结果
+std::string stream(StopSequenceFilter& filter, const std::vector<std::string>& pieces) {
+    std::string out;
+    for (const auto& piece : pieces) {
+        out += filter.append(piece);
+        if (filter.stopped()) break;
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(StopSequenceTest, StopSpreadOverTokensDoesNotLeakPrefix) {
+    StopSequenceFilter filter({"</answer>"});
+    std::vector<std::string> streamed;
+    for (const std::string piece : {"42", " </", "ans", "wer>", " ignored"}) {
+        std::string ready = filter.append(piece);
+        if (!ready.empty()) streamed.push_back(ready);
+        if (filter.stopped()) break;
+    }
+    EXPECT_TRUE(filter.stopped());
+    EXPECT_EQ(filter.text(), "42 ");
+    // 停止串的前缀 "</"、"</ans" 从未交给回调
+    ASSERT_EQ(streamed.size(), 2u);
+    EXPECT_EQ(streamed[0], "42");
+    EXPECT_EQ(streamed[1], " ");
+}
+
+TEST(StopSequenceTest, HeldBackBytesAreReleasedWhenMatchFails) {
+    StopSequenceFilter filter({"\n\nUser:"});
+    EXPECT_EQ(filter.append("Hi"), "Hi");
+    EXPECT_EQ(filter.append("\n"), "");
+    EXPECT_EQ(filter.append("\n"), "");
+    EXPECT_EQ(filter.append("Us"), "");
+    // 不再可能组成停止串，暂扣的字节随新片段一起输出
+    EXPECT_EQ(filter.append("age"), "\n\nUsage");
+    EXPECT_FALSE(filter.stopped());
+    EXPECT_EQ(filter.text(), "Hi\n\nUsage");
+}
+
+TEST(StopSequenceTest, FlushReleasesTailAtEndOfGeneration) {
+    StopSequenceFilter filter({"###"});
+    std::string out = stream(filter, {"done", " #"});
+    EXPECT_EQ(out, "done ");
+    out += filter.flush();
+    EXPECT_EQ(out, filter.text());
+    EXPECT_EQ(out, "done #");
+    EXPECT_EQ(filter.flush(), "");
+}
+
+TEST(StopSequenceTest, StreamedTextAlwaysEqualsFinalText) {
+    const std::vector<std::vector<std::string>> cases = {
+        {"a", "b", "S", "T", "O", "P", "c"},
+        {"xSTO", "Px"},
+        {"STOP"},
+        {"ST", "ST", "OP"},
+        {"no stop here"},
+    };
+    for (const auto& pieces : cases) {
+        StopSequenceFilter filter({"STOP", "END"});
+        std::string out = stream(filter, pieces);
+        if (!filter.stopped()) out += filter.flush();
+        EXPECT_EQ(out, filter.text());
+    }
+}
+
+TEST(StopSequenceTest, EarliestStopWinsAndEmptyStopsAreIgnored) {
+    StopSequenceFilter filter({"", "cd", "bcde"});
+    EXPECT_EQ(stream(filter, {"ab", "cdef"}), "a");
+    EXPECT_EQ(filter.text(), "a");
+
+    StopSequenceFilter no_stops;
+    EXPECT_EQ(no_stops.append("text"), "text");
+}
@@ -0,0 +1,193 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+
+namespace {
+
+struct CapturedLog {
+    logger::LogLevel level;
+    std::string message;
+};
+
+std::mutex g_capture_mutex;
+std::vector<CapturedLog> g_captured;
+std::atomic<int> g_writer_delay_us{0};
+
+void capture_writer(logger::LogLevel level, const char*, int, const char* message, size_t size) {
+    if (int delay = g_writer_delay_us.load()) std::this_thread::sleep_for(std::chrono::microseconds(delay));
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
+    g_captured.push_back({level, std::string(message, size)});
+}
+
+std::vector<CapturedLog> take_captured() {
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
+    return std::move(g_captured);
+}
+
+// 每个用例从同步模式、INFO 等级、捕获写出开始，结束时恢复默认
+class AsyncLoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        logger::DisableAsyncLogging();
+        logger::SetLogLevel(logger::LogLevel::INFO);
+        logger::SetLogWriter(capture_writer);
+        g_writer_delay_us = 0;
+        take_captured();
+    }
+
+    void TearDown() override {
+        logger::DisableAsyncLogging();
+        logger::SetLogWriter(nullptr);
+        logger::SetLogLevel(logger::LogLevel::INFO);
+        g_writer_delay_us = 0;
+    }
+};
+
+int count_calls(int& calls) {
+    return ++calls;
+}
+
+} // namespace
+
+TEST_F(AsyncLoggerTest, FormatMatchesOstream) {
+    const std::string text = "str";
+    const char* null_text = nullptr;
+    LOG_INFO << "a=" << 42 << " b=" << -7L << " c=" << 3.14159265 << " d=" << 0.1f << " e=" << 'x'
+             << " f=" << true << " g=" << text << " h=" << std::string_view("view") << " i=" << null_text
+             << " j=" << 1e20 << " k=" << static_cast<const void*>(nullptr);
+
+    std::ostringstream expected;
+    expected << "a=" << 42 << " b=" << -7L << " c=" << 3.14159265 << " d=" << 0.1f << " e=" << 'x'
+             << " f=" << true << " g=" << text << " h=" << "view" << " i=" << "(null)"
+             << " j=" << 1e20 << " k=" << static_cast<const void*>(nullptr);
+
+    auto logs = take_captured();
+    ASSERT_EQ(logs.size(), 1u);
+    EXPECT_EQ(logs[0].level, logger::LogLevel::INFO);
+    EXPECT_EQ(logs[0].message, expected.str());
+}
+
+TEST_F(AsyncLoggerTest, AsyncPreservesOrderPerThread) {
+    logger::EnableAsyncLogging();
+    ASSERT_TRUE(logger::IsAsyncLoggingEnabled());
+    constexpr int kMessages = 1000;
+    for (int i = 0; i < kMessages; ++i) LOG_INFO << "msg " << i;
+    logger::FlushLogger();
+
+    auto logs = take_captured();
+    ASSERT_EQ(logs.size(), static_cast<size_t>(kMessages));
+    for (int i = 0; i < kMessages; ++i) EXPECT_EQ(logs[i].message, "msg " + std::to_string(i));
+}
+
+TEST_F(AsyncLoggerTest, RuntimeLevelSkipsFormatting) {
+    int calls = 0;
+    logger::SetLogLevel(logger::LogLevel::WARNING);
+    LOG_INFO << "skipped " << count_calls(calls);
+    LOG_WARNING << "kept " << count_calls(calls);
+    EXPECT_EQ(calls, 1);
+
+    auto logs = take_captured();
+    ASSERT_EQ(logs.size(), 1u);
+    EXPECT_EQ(logs[0].level, logger::LogLevel::WARNING);
+    EXPECT_EQ(logs[0].message, "kept 1");
+}
+
+TEST_F(AsyncLoggerTest, NestedLogInsideArgument) {
+    auto nested = [] {
+        LOG_INFO << "inner";
+        return 5;
+    };
+    LOG_INFO << "outer " << nested();
+
+    auto logs = take_captured();
+    ASSERT_EQ(logs.size(), 2u);
+    EXPECT_EQ(logs[0].message, "inner");
+    EXPECT_EQ(logs[1].message, "outer 5");
+}
+
+TEST_F(AsyncLoggerTest, DropPolicyCountsDroppedMessages) {
+    // 写出很慢、队列很小，必然溢出
+    g_writer_delay_us = 200;
+    logger::AsyncLoggerOptions options;
+    options.queue_capacity = 8;
+    options.overflow = logger::OverflowPolicy::DROP;
+    logger::EnableAsyncLogging(options);
+
+    const uint64_t dropped_before = logger::DroppedLogCount();
+    constexpr int kMessages = 500;
+    for (int i = 0; i < kMessages; ++i) LOG_INFO << "msg " << i;
+    logger::DisableAsyncLogging();
+
+    const uint64_t dropped = logger::DroppedLogCount() - dropped_before;
+    EXPECT_GT(dropped, 0u);
+
+    auto logs = take_captured();
+    size_t delivered = 0;
+    bool reported = false;
+    for (const auto& log : logs) {
+        if (log.message.rfind("msg ", 0) == 0) ++delivered;
+        if (log.message.find("dropped") != std::string::npos) reported = true;
+    }
+    EXPECT_EQ(delivered + dropped, static_cast<size_t>(kMessages));
+    EXPECT_TRUE(reported);
+}
+
+TEST_F(AsyncLoggerTest, BlockPolicyLosesNothing) {
+    g_writer_delay_us = 20;
+    logger::AsyncLoggerOptions options;
+    options.queue_capacity = 8;
+    options.overflow = logger::OverflowPolicy::BLOCK;
+    logger::EnableAsyncLogging(options);
+
+    const uint64_t dropped_before = logger::DroppedLogCount();
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 200;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([t] {
+            for (int i = 0; i < kPerThread; ++i) LOG_INFO << "t" << t << " " << i;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    logger::FlushLogger();
+
+    EXPECT_EQ(logger::DroppedLogCount(), dropped_before);
+    auto logs = take_captured();
+    ASSERT_EQ(logs.size(), static_cast<size_t>(kThreads * kPerThread));
+
+    // 单个线程内的顺序保持不变
+    std::vector<int> next(kThreads, 0);
+    for (const auto& log : logs) {
+        const int t = log.message[1] - '0';
+        EXPECT_EQ(log.message, "t" + std::to_string(t) + " " + std::to_string(next[t]));
+        ++next[t];
+    }
+}
+
+TEST_F(AsyncLoggerTest, DisableDrainsPendingMessages) {
+    g_writer_delay_us = 50;
+    logger::AsyncLoggerOptions options;
+    options.overflow = logger::OverflowPolicy::BLOCK;
+    logger::EnableAsyncLogging(options);
+    for (int i = 0; i < 100; ++i) LOG_ERROR << "pending " << i;
+    logger::DisableAsyncLogging();
+    EXPECT_FALSE(logger::IsAsyncLoggingEnabled());
+
+    auto logs = take_captured();
+    ASSERT_EQ(logs.size(), 100u);
+    EXPECT_EQ(logs.back().level, logger::LogLevel::ERROR);
+
+    // 关闭后回到同步写出
+    LOG_INFO << "sync";
+    logs = take_captured();
+    ASSERT_EQ(logs.size(), 1u);
+    EXPECT_EQ(logs[0].message, "sync");
+}
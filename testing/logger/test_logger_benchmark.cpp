@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+
+// 编译期过滤掉 INFO 的对照组：与 LOGGER_MIN_LEVEL=1 时 LOG_INFO 的展开一致
+#define BENCH_LOG_COMPILED_OUT                                                              \
+    !(static_cast<int>(logger::LogLevel::INFO) >= 1 && logger::IsLevelEnabled(logger::LogLevel::INFO)) \
+        ? (void)0                                                                           \
+        : logger::LogVoidify() & logger::LoggerStream(logger::LogLevel::INFO, __FILE__, __LINE__)
+
+namespace logger_benchmark {
+
+using Clock = std::chrono::high_resolution_clock;
+
+// 不做任何 I/O 的写出函数，只衡量日志框架本身
+void null_writer(logger::LogLevel, const char*, int, const char*, size_t) {}
+
+// 每条日志写一次文件并 flush，近似 glog 同步写日志文件的系统调用开销
+FILE* g_sink = nullptr;
+void file_writer(logger::LogLevel, const char*, int, const char* message, size_t size) {
+    std::fwrite(message, 1, size, g_sink);
+    std::fputc('\n', g_sink);
+    std::fflush(g_sink);
+}
+
+constexpr size_t kIterations = 200000;
+// 异步模式按批计时，批量小于队列容量，批间的排空不计入：衡量的是调用线程上的开销
+constexpr size_t kBurst = 1024;
+
+template <typename Fn>
+double ns_per_call(Fn&& log_once) {
+    double elapsed_ns = 0.0;
+    for (size_t done = 0; done < kIterations; done += kBurst) {
+        const auto start = Clock::now();
+        for (size_t i = done; i < done + kBurst; ++i) log_once(i);
+        elapsed_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        logger::FlushLogger();
+    }
+    return elapsed_ns / kIterations;
+}
+
+void run_logger_benchmark() {
+    g_sink = std::fopen("/dev/null", "w");
+    ASSERT_NE(g_sink, nullptr);
+    const std::string path = "/v1/embeddings";
+
+    // 一条典型的请求路径日志：字符串 + 整数 + 浮点
+    auto log_info = [&](size_t i) { LOG_INFO << "[HTTP] " << path << " request=" << i << " latency_ms=" << 1.25; };
+
+    logger::DisableAsyncLogging();
+    logger::SetLogWriter(null_writer);
+    const double sync_null_ns = ns_per_call(log_info);
+    logger::SetLogWriter(file_writer);
+    const double sync_file_ns = ns_per_call(log_info);
+
+    logger::AsyncLoggerOptions options;
+    options.queue_capacity = 2 * kBurst;
+    logger::EnableAsyncLogging(options);
+    const double async_file_ns = ns_per_call(log_info);
+    const uint64_t dropped = logger::DroppedLogCount();
+    logger::DisableAsyncLogging();
+
+    logger::SetLogLevel(logger::LogLevel::WARNING);
+    const double runtime_filtered_ns = ns_per_call(log_info);
+    logger::SetLogLevel(logger::LogLevel::INFO);
+
+    const double compiled_out_ns = ns_per_call(
+        [&](size_t i) { BENCH_LOG_COMPILED_OUT << "[HTTP] " << path << " request=" << i; });
+
+    logger::SetLogWriter(nullptr);
+    std::fclose(g_sink);
+
+    LOG_INFO << "[Summary] Sync, format only:      " << sync_null_ns << " ns/call";
+    LOG_INFO << "[Summary] Sync, file write:       " << sync_file_ns << " ns/call";
+    LOG_INFO << "[Summary] Async, file write:      " << async_file_ns << " ns/call (dropped " << dropped << ")";
+    LOG_INFO << "[Summary] Runtime filtered:       " << runtime_filtered_ns << " ns/call";
+    LOG_INFO << "[Summary] Compile-time filtered:  " << compiled_out_ns << " ns/call";
+
+    EXPECT_EQ(dropped, 0u);
+    // 调用线程不再承担 I/O
+    EXPECT_LT(async_file_ns, sync_file_ns);
+    // 过滤掉的日志只剩一次原子读
+    EXPECT_LT(runtime_filtered_ns, 20.0);
+    EXPECT_LT(compiled_out_ns, 20.0);
+}
+
+} // namespace logger_benchmark
+
+// GTest 测试用例
+TEST(LoggerBenchmark, NsPerCall) {
+    logger_benchmark::run_logger_benchmark();
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "latency_histogram.h"
+#include "process_stats.h"
+
+namespace {
+
+// 与排序后精确分位数对比，误差不超过一个子桶宽度
+void expect_close_to_exact(const metrics::LatencyHistogram& histogram, std::vector<uint64_t> values, double p) {
+    std::sort(values.begin(), values.end());
+    const size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(p / 100.0 * values.size())));
+    const double exact = static_cast<double>(values[rank - 1]);
+    const double reported = static_cast<double>(histogram.percentile(p));
+    EXPECT_GE(reported, exact) << "p" << p;
+    EXPECT_LE(reported, exact * (1.0 + 1.0 / metrics::kLatencySubBuckets) + 1.0) << "p" << p;
+}
+
+} // namespace
+
+TEST(LatencyHistogramTest, BucketsAreContiguousAndMonotonic) {
+    uint64_t previous_upper = 0;
+    for (size_t i = 1; i < metrics::kLatencyBucketCount; ++i) {
+        const uint64_t upper = metrics::latency_bucket_upper_bound(i);
+        ASSERT_GT(upper, previous_upper) << "bucket " << i;
+        // 上一个桶的上界 + 1 恰好落在当前桶
+        EXPECT_EQ(metrics::latency_bucket_index(previous_upper + 1), i);
+        EXPECT_EQ(metrics::latency_bucket_index(upper), i);
+        previous_upper = upper;
+    }
+    EXPECT_EQ(previous_upper, metrics::kLatencyMaxValue);
+    EXPECT_EQ(metrics::latency_bucket_index(UINT64_MAX), metrics::kLatencyBucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    metrics::LatencyHistogram histogram;
+    for (uint64_t v = 1; v <= 50; ++v) histogram.record(v);
+    EXPECT_EQ(histogram.count(), 50u);
+    EXPECT_EQ(histogram.min(), 1u);
+    EXPECT_EQ(histogram.max(), 50u);
+    EXPECT_EQ(histogram.percentile(50.0), 25u);
+    EXPECT_EQ(histogram.percentile(100.0), 50u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 25.5);
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinRelativeError) {
+    // 对数正态分布近似真实延迟的长尾
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> distribution(13.0, 0.8);
+    std::vector<uint64_t> values;
+    metrics::LatencyHistogram histogram;
+    for (int i = 0; i < 100000; ++i) {
+        const auto v = static_cast<uint64_t>(distribution(rng));
+        values.push_back(v);
+        histogram.record(v);
+    }
+    for (double p : {50.0, 90.0, 99.0, 99.9}) expect_close_to_exact(histogram, values, p);
+    EXPECT_EQ(histogram.percentile(100.0), *std::max_element(values.begin(), values.end()));
+}
+
+TEST(LatencyHistogramTest, MergeEqualsRecordingIntoOne) {
+    metrics::LatencyHistogram a, b, all;
+    for (uint64_t v = 0; v < 5000; ++v) {
+        const uint64_t value = v * v + 17;
+        (v % 3 ? a : b).record(value);
+        all.record(value);
+    }
+    a.merge(b);
+    EXPECT_EQ(a.count(), all.count());
+    EXPECT_EQ(a.min(), all.min());
+    EXPECT_EQ(a.max(), all.max());
+    EXPECT_EQ(a.buckets(), all.buckets());
+    EXPECT_EQ(a.percentile(99.0), all.percentile(99.0));
+
+    a.reset();
+    EXPECT_EQ(a.count(), 0u);
+    EXPECT_EQ(a.percentile(50.0), 0u);
+    EXPECT_EQ(a.min(), 0u);
+}
+
+TEST(ProcessStatsTest, PeakRssCoversCurrentRss) {
+    const size_t current = metrics::current_rss_bytes();
+    ASSERT_GT(current, 0u);
+    // 触碰 64MB 新页面后峰值至少随之上涨
+    std::vector<char> block(64 << 20, 1);
+    EXPECT_GE(metrics::peak_rss_bytes(), current + block.size() / 2);
+    EXPECT_GE(metrics::peak_rss_bytes(), metrics::current_rss_bytes());
+}
@@ -0,0 +1,91 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "stage_metrics.h"
+
+TEST(ConcurrentHistogramTest, MatchesSingleThreadedHistogram) {
+    constexpr int kThreads = 8;
+    constexpr uint64_t kPerThread = 20000;
+    metrics::ConcurrentHistogram concurrent;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (uint64_t i = 0; i < kPerThread; ++i) concurrent.record(i * kThreads + t);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    metrics::LatencyHistogram expected;
+    for (uint64_t v = 0; v < kPerThread * kThreads; ++v) expected.record(v);
+
+    const auto snapshot = concurrent.snapshot();
+    EXPECT_EQ(snapshot.count(), expected.count());
+    EXPECT_EQ(snapshot.min(), expected.min());
+    EXPECT_EQ(snapshot.max(), expected.max());
+    EXPECT_DOUBLE_EQ(snapshot.mean(), expected.mean());
+    EXPECT_EQ(snapshot.buckets(), expected.buckets());
+
+    concurrent.reset();
+    EXPECT_EQ(concurrent.snapshot().count(), 0u);
+    EXPECT_EQ(concurrent.snapshot().percentile(99.0), 0u);
+}
+
+TEST(ConcurrentCounterTest, SumsAcrossThreads) {
+    metrics::ConcurrentCounter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 40; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) counter.add(2);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(counter.value(), 80000u);
+    counter.reset();
+    EXPECT_EQ(counter.value(), 0u);
+}
+
+TEST(StageMetricsTest, SnapshotByName) {
+    metrics::StageMetrics stage_metrics({"tokenize", "run_model"}, {"texts"});
+    stage_metrics.record(0, 1000);
+    stage_metrics.record(1, 5000000);
+    stage_metrics.record(1, 7000000);
+    stage_metrics.add(0, 3);
+    {
+        metrics::ScopedStageTimer timer(&stage_metrics, 0);
+    }
+    // 空指针表示不采集
+    {
+        metrics::ScopedStageTimer timer(nullptr, 0);
+    }
+    STAGE_COUNT(&stage_metrics, 0, 2);
+
+    const auto snapshot = stage_metrics.snapshot();
+    ASSERT_NE(snapshot.stage("tokenize"), nullptr);
+    EXPECT_EQ(snapshot.stage("tokenize")->histogram.count(), 2u);
+    EXPECT_EQ(snapshot.stage("run_model")->histogram.count(), 2u);
+    EXPECT_EQ(snapshot.stage("run_model")->histogram.max(), 7000000u);
+    EXPECT_EQ(snapshot.stage("pooling"), nullptr);
+    EXPECT_EQ(snapshot.counter("texts"), 5u);
+    EXPECT_EQ(snapshot.counter("missing"), 0u);
+
+    stage_metrics.reset();
+    EXPECT_EQ(stage_metrics.snapshot().stage("run_model")->histogram.count(), 0u);
+}
+
+TEST(StageMetricsTest, PrometheusTextFormat) {
+    metrics::StageMetrics stage_metrics({"run_model"}, {"texts"});
+    for (int i = 0; i < 100; ++i) stage_metrics.record(0, 2000000);  // 2 ms
+    stage_metrics.add(0, 42);
+
+    const std::string text = metrics::to_prometheus(stage_metrics.snapshot(), "redge_embedding");
+    EXPECT_NE(text.find("# TYPE redge_embedding_stage_seconds summary\n"), std::string::npos);
+    EXPECT_NE(text.find("redge_embedding_stage_seconds{stage=\"run_model\",quantile=\"0.99\"} 0.002"),
+              std::string::npos);
+    EXPECT_NE(text.find("redge_embedding_stage_seconds_sum{stage=\"run_model\"} 0.2\n"), std::string::npos);
+    EXPECT_NE(text.find("redge_embedding_stage_seconds_count{stage=\"run_model\"} 100\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE redge_embedding_texts_total counter\nredge_embedding_texts_total 42\n"),
+              std::string::npos);
+}
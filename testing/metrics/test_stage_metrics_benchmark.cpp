@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "stage_metrics.h"
+
+namespace stage_metrics_benchmark {
+
+using Clock = std::chrono::high_resolution_clock;
+
+// OnnxRuntimeEmbedding 每次请求的埋点：4 个阶段计时 + 3 次计数
+constexpr int kStagesPerRequest = 4;
+constexpr int kCountersPerRequest = 3;
+// CPU 上 multilingual-e5-small 最短输入的单条延迟约 1 ms 以上，按 1 ms 估算开销占比偏保守
+constexpr double kReferenceRequestNs = 1000000.0;
+
+// 多线程同时计时的单次开销：总耗时折算到实际可并行的核数上，线程数超过核数时不把排队时间算进去
+double timer_cost_ns(metrics::StageMetrics& stage_metrics, size_t threads, size_t iterations) {
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (size_t i = 0; i < iterations; ++i) {
+                STAGE_TIMER(&stage_metrics, i % kStagesPerRequest);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    const size_t cores = std::min<size_t>(threads, std::max(1u, std::thread::hardware_concurrency()));
+    return elapsed_ns * cores / (threads * iterations);
+}
+
+double counter_cost_ns(metrics::StageMetrics& stage_metrics, size_t iterations) {
+    const auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        STAGE_COUNT(&stage_metrics, i % kCountersPerRequest, 1);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+// 约 200 us 的纯计算负载，模拟一个很短的推理请求
+double simulated_request(size_t rounds) {
+    double acc = 0.0;
+    for (size_t i = 1; i <= rounds; ++i) acc += std::sqrt(static_cast<double>(i));
+    return acc;
+}
+
+// 同一负载分别在有无埋点时运行，取多轮最小值减少调度噪声
+void run_end_to_end_overhead(metrics::StageMetrics& stage_metrics) {
+    constexpr size_t kRounds = 100000;
+    constexpr int kRequests = 200;
+    constexpr int kRepeats = 5;
+    volatile double sink = 0.0;
+
+    double plain_ms = 1e18;
+    double instrumented_ms = 1e18;
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+        auto start = Clock::now();
+        for (int r = 0; r < kRequests; ++r) {
+            for (int s = 0; s < kStagesPerRequest; ++s) sink = sink + simulated_request(kRounds / kStagesPerRequest);
+        }
+        plain_ms = std::min(plain_ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+        start = Clock::now();
+        for (int r = 0; r < kRequests; ++r) {
+            for (int s = 0; s < kStagesPerRequest; ++s) {
+                STAGE_TIMER(&stage_metrics, s);
+                sink = sink + simulated_request(kRounds / kStagesPerRequest);
+            }
+            for (int c = 0; c < kCountersPerRequest; ++c) STAGE_COUNT(&stage_metrics, c, 1);
+        }
+        instrumented_ms = std::min(instrumented_ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    LOG_INFO << "[Summary] Simulated requests (" << plain_ms * 1000.0 / kRequests << " us each): plain "
+             << plain_ms << " ms, instrumented " << instrumented_ms << " ms, overhead "
+             << (instrumented_ms / plain_ms - 1.0) * 100.0 << "% (noise included)";
+}
+
+void run_overhead_benchmark() {
+    metrics::StageMetrics stage_metrics({"tokenize", "prepare_inputs", "run_model", "pooling"},
+                                        {"texts", "model_runs", "tokens"});
+    constexpr size_t kIterations = 2000000;
+
+    const double counter_ns = counter_cost_ns(stage_metrics, kIterations);
+    double worst_timer_ns = 0.0;
+    for (size_t threads : {1, 4, 16}) {
+        const double timer_ns = timer_cost_ns(stage_metrics, threads, kIterations / threads);
+        worst_timer_ns = std::max(worst_timer_ns, timer_ns);
+        LOG_INFO << "[Summary] " << threads << " thread(s): " << timer_ns << " ns per stage timer";
+    }
+    LOG_INFO << "[Summary] " << counter_ns << " ns per counter add";
+
+    const double per_request_ns = worst_timer_ns * kStagesPerRequest + counter_ns * kCountersPerRequest;
+    const double overhead = per_request_ns / kReferenceRequestNs;
+    LOG_INFO << "[Summary] Instrumentation per request: " << per_request_ns << " ns, "
+             << overhead * 100.0 << "% of a " << kReferenceRequestNs / 1e6 << " ms request";
+    EXPECT_LT(overhead, 0.01);
+
+    run_end_to_end_overhead(stage_metrics);
+}
+
+} // namespace stage_metrics_benchmark
+
+// GTest 测试用例
+TEST(StageMetricsBenchmark, InstrumentationOverhead) {
+    stage_metrics_benchmark::run_overhead_benchmark();
+}
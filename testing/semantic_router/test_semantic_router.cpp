@@ -0,0 +1,223 @@
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "semantic_router.h"
+
+using semantic_router::Route;
+using semantic_router::RouteAggregation;
+using semantic_router::SemanticRouter;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kDim = 256;
+
+// 词袋向量：共享的词越多相似度越高，用于在不依赖模型文件的情况下构造可预期的路由结果
+class BagOfWordsEmbedding : public text_embedding::TextEmbedding {
+public:
+    bool load_model(const std::string&) override { return true; }
+    void unload_model() override {}
+
+    std::vector<float> embed(const std::string& text) override {
+        return make_vector(text);
+    }
+
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override {
+        embedded_texts.fetch_add(texts.size());
+        std::vector<std::vector<float>> result;
+        for (const auto& text : texts) result.push_back(make_vector(text));
+        return result;
+    }
+
+    std::vector<float> make_vector(const std::string& text) const {
+        std::vector<float> vec(kDim, 0.0f);
+        std::istringstream words(text);
+        std::string word;
+        while (words >> word) vec[(std::hash<std::string>{}(word) + salt) % kDim] += 1.0f;
+        return vec;
+    }
+
+    std::atomic<size_t> embedded_texts{0};
+    size_t salt = 0;
+};
+
+std::vector<Route> sample_routes() {
+    Route billing{"billing", {"refund my order", "invoice for my order", "payment failed"}};
+    Route weather{"weather", {"weather today", "will it rain tomorrow", "weather forecast"}};
+    weather.aggregation = RouteAggregation::CENTROID;
+    Route greeting{"greeting", {"hello there", "good morning"}};
+    greeting.threshold = 0.9f;
+    return {billing, weather, greeting};
+}
+
+std::string temp_route_file(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / "redge_semantic_router_test";
+    fs::create_directories(dir);
+    return (dir / name).string();
+}
+
+void write_file(const std::string& path, const std::string& content) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+} // namespace
+
+TEST(RouteTableTest, ParseRoutes) {
+    auto routes = semantic_router::parse_routes(
+        "# 路由定义\n"
+        "[billing]\n"
+        "threshold = 0.72\n"
+        "- 我想申请退款\n"
+        "-   invoice please  \n"
+        "\n"
+        "[weather]\n"
+        "aggregation = centroid\n"
+        "- 今天天气怎么样\n");
+    ASSERT_EQ(routes.size(), 2u);
+    EXPECT_EQ(routes[0].name, "billing");
+    ASSERT_TRUE(routes[0].threshold.has_value());
+    EXPECT_FLOAT_EQ(*routes[0].threshold, 0.72f);
+    EXPECT_EQ(routes[0].utterances, (std::vector<std::string>{"我想申请退款", "invoice please"}));
+    EXPECT_EQ(routes[0].aggregation, RouteAggregation::MAX);
+    EXPECT_EQ(routes[1].aggregation, RouteAggregation::CENTROID);
+    EXPECT_FALSE(routes[1].threshold.has_value());
+
+    EXPECT_THROW(semantic_router::parse_routes("- orphan\n"), std::invalid_argument);
+    EXPECT_THROW(semantic_router::parse_routes("[a]\n- x\n[a]\n- y\n"), std::invalid_argument);
+    EXPECT_THROW(semantic_router::parse_routes("[a]\n[b]\n- y\n"), std::invalid_argument);
+    EXPECT_THROW(semantic_router::parse_routes("[a]\nthreshold = high\n- x\n"), std::invalid_argument);
+    EXPECT_THROW(semantic_router::parse_routes("[a]\naggregation = mean\n- x\n"), std::invalid_argument);
+    EXPECT_THROW(semantic_router::load_routes_file("/nonexistent/routes.txt"), std::runtime_error);
+}
+
+TEST(RouteMatrixTest, MaxAndCentroidAggregation) {
+    Route max_route{"max", {"a", "b"}};
+    Route centroid_route{"centroid", {"a", "b"}, RouteAggregation::CENTROID, 0.3f};
+    semantic_router::RouteMatrix matrix({max_route, centroid_route},
+                                        {{2, 0}, {0, 1}, {1, 0}, {0, 3}}, 0.5f);
+    EXPECT_EQ(matrix.dim(), 2u);
+    EXPECT_EQ(matrix.rows(), 3u);  // 2 行示例 + 1 行质心
+    EXPECT_FLOAT_EQ(matrix.threshold(0), 0.5f);
+    EXPECT_FLOAT_EQ(matrix.threshold(1), 0.3f);
+
+    const float query[2] = {1.0f, 0.0f};
+    std::vector<float> rows(matrix.rows()), routes(matrix.route_count());
+    matrix.score(query, rows.data(), routes.data());
+    EXPECT_NEAR(routes[0], 1.0f, 1e-5f);
+    EXPECT_NEAR(routes[1], 1.0f / std::sqrt(2.0f), 1e-5f);
+
+    EXPECT_THROW(semantic_router::RouteMatrix({max_route}, {{1, 0}}, 0.5f), std::invalid_argument);
+    EXPECT_THROW(semantic_router::RouteMatrix({max_route}, {{1, 0}, {1, 0, 0}}, 0.5f), std::invalid_argument);
+}
+
+TEST(SemanticRouterTest, RoutesToBestRouteAboveThreshold) {
+    BagOfWordsEmbedding model;
+    SemanticRouter router(model, {0.5f, 2});
+    EXPECT_THROW(router.route("hello"), std::runtime_error);
+    ASSERT_TRUE(router.load_routes(sample_routes()));
+    EXPECT_EQ(router.route_count(), 3u);
+    EXPECT_EQ(router.dim(), kDim);
+    EXPECT_EQ(router.version(), 1u);
+
+    auto match = router.route("refund my order");
+    EXPECT_EQ(match.route, "billing");
+    EXPECT_NEAR(match.score, 1.0f, 1e-5f);
+    ASSERT_EQ(match.candidates.size(), 2u);
+    EXPECT_EQ(match.candidates[0].name, "billing");
+    EXPECT_TRUE(match.candidates[0].passed);
+    EXPECT_GE(match.candidates[0].score, match.candidates[1].score);
+    EXPECT_GE(match.timings.match_us, 0.0);
+
+    EXPECT_EQ(router.route("what is the weather forecast today").route, "weather");
+
+    // 与 greeting 只部分相似，达不到其 0.9 的阈值
+    match = router.route("hello friend");
+    EXPECT_FALSE(match.matched());
+    ASSERT_FALSE(match.candidates.empty());
+    EXPECT_EQ(match.candidates[0].name, "greeting");
+    EXPECT_FALSE(match.candidates[0].passed);
+
+    EXPECT_FALSE(router.route("completely unrelated words").matched());
+
+    // 复用已有查询向量
+    EXPECT_EQ(router.route_embedding(model.make_vector("payment failed")).route, "billing");
+    EXPECT_THROW(router.route_embedding(std::vector<float>(kDim + 1, 1.0f)), std::invalid_argument);
+}
+
+TEST(SemanticRouterTest, ReloadReusesCachedEmbeddings) {
+    BagOfWordsEmbedding model;
+    SemanticRouter router(model);
+    ASSERT_TRUE(router.load_routes(sample_routes()));
+    EXPECT_EQ(model.embedded_texts.load(), 8u);
+
+    auto routes = sample_routes();
+    routes[1].utterances.push_back("sunny or cloudy");
+    ASSERT_TRUE(router.load_routes(routes));
+    EXPECT_EQ(model.embedded_texts.load(), 9u);  // 只向量化新增的一条
+    EXPECT_EQ(router.version(), 2u);
+
+    // 加载失败时保留当前路由表
+    routes.push_back({"empty", {}});
+    EXPECT_FALSE(router.load_routes(routes));
+    EXPECT_EQ(router.version(), 2u);
+    EXPECT_EQ(router.route("refund my order").route, "billing");
+
+    // 模型更换后全部重新向量化
+    model.salt = 7;
+    ASSERT_TRUE(router.refresh_embeddings());
+    EXPECT_EQ(model.embedded_texts.load(), 18u);
+    EXPECT_EQ(router.route("refund my order").route, "billing");
+}
+
+TEST(SemanticRouterTest, HotReloadFromFileDuringTraffic) {
+    const std::string path = temp_route_file("routes.txt");
+    write_file(path, "[billing]\n- refund my order\n[weather]\n- weather today\n");
+
+    BagOfWordsEmbedding model;
+    SemanticRouter router(model);
+    ASSERT_TRUE(router.load_routes_file(path));
+    EXPECT_FALSE(router.reload_if_changed());
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            while (!stop.load()) {
+                auto match = router.route("refund my order");
+                if (match.route != "billing") failures.fetch_add(1);
+            }
+        });
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        write_file(path, "[billing]\n- refund my order\n[weather]\n- weather today\n[support]\n- talk to agent " +
+                             std::to_string(i) + "\n");
+        fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(i + 1));
+        EXPECT_TRUE(router.reload_if_changed());
+    }
+
+    // 文件有误时保留旧表，且不会在每次轮询时重试
+    write_file(path, "[broken\n");
+    fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(10));
+    EXPECT_FALSE(router.reload_if_changed());
+    EXPECT_FALSE(router.reload_if_changed());
+
+    stop.store(true);
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(router.version(), 6u);
+    EXPECT_EQ(router.route_count(), 3u);
+    EXPECT_EQ(router.route("talk to agent 4").route, "support");
+}
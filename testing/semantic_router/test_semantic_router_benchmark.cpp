@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "semantic_router.h"
+#include "vector_math.h"
+
+namespace semantic_router_benchmark {
+
+using Clock = std::chrono::high_resolution_clock;
+
+// 典型规模：数十条路由、每条数十个示例，向量维度与 bge-base 一致
+constexpr size_t kDim = 768;
+constexpr size_t kQueryCount = 20000;
+// 常规规模（不超过约 1000 行）路由开销（不含向量化）的 p99 预算；
+// 矩阵超出缓存后耗时随行数线性增长，最大一组只输出不断言
+constexpr double kP99BudgetUs = 200.0;
+
+// 由文本哈希确定的随机向量，基准中不含模型推理
+class HashEmbedding : public text_embedding::TextEmbedding {
+public:
+    bool load_model(const std::string&) override { return true; }
+    void unload_model() override {}
+
+    std::vector<float> embed(const std::string& text) override { return vector_for(text); }
+
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override {
+        std::vector<std::vector<float>> result;
+        for (const auto& text : texts) result.push_back(vector_for(text));
+        return result;
+    }
+
+private:
+    std::vector<float> vector_for(const std::string& text) {
+        std::mt19937 rng(static_cast<unsigned>(std::hash<std::string>{}(text)));
+        std::normal_distribution<float> dist;
+        std::vector<float> vec(kDim);
+        for (auto& x : vec) x = dist(rng);
+        return vec;
+    }
+};
+
+double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+double run_router_benchmark(size_t route_count, size_t examples_per_route) {
+    HashEmbedding model;
+    std::vector<semantic_router::Route> routes;
+    for (size_t r = 0; r < route_count; ++r) {
+        semantic_router::Route route;
+        route.name = "route_" + std::to_string(r);
+        route.aggregation = r % 4 == 0 ? semantic_router::RouteAggregation::CENTROID
+                                       : semantic_router::RouteAggregation::MAX;
+        for (size_t e = 0; e < examples_per_route; ++e) {
+            route.utterances.push_back(route.name + " example " + std::to_string(e));
+        }
+        routes.push_back(std::move(route));
+    }
+
+    semantic_router::SemanticRouter router(model, {0.3f, 3});
+    EXPECT_TRUE(router.load_routes(routes));
+
+    std::vector<std::vector<float>> queries;
+    for (size_t q = 0; q < 256; ++q) queries.push_back(model.embed("query " + std::to_string(q)));
+
+    std::vector<double> latencies;
+    latencies.reserve(kQueryCount);
+    size_t matched = 0;
+    for (size_t q = 0; q < kQueryCount; ++q) {
+        const auto start = Clock::now();
+        auto match = router.route_embedding(queries[q % queries.size()]);
+        latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        matched += match.matched();
+    }
+
+    const double p50 = percentile(latencies, 0.50);
+    const double p99 = percentile(latencies, 0.99);
+    LOG_INFO << "[SemanticRouter] " << route_count << " routes x " << examples_per_route << " examples, dim "
+             << kDim << " (" << vector_math::isa_name(vector_math::active_isa()) << ") | p50: " << p50
+             << " us, p99: " << p99 << " us | matched " << matched << "/" << kQueryCount;
+    return p99;
+}
+
+} // namespace semantic_router_benchmark
+
+// GTest 测试用例
+TEST(SemanticRouterBenchmark, RoutingOverheadPercentiles) {
+    LOG_INFO << "\n========== SemanticRouter: routing overhead excluding embedding ==========";
+    EXPECT_LT(semantic_router_benchmark::run_router_benchmark(10, 10), semantic_router_benchmark::kP99BudgetUs);
+    EXPECT_LT(semantic_router_benchmark::run_router_benchmark(50, 20), semantic_router_benchmark::kP99BudgetUs);
+    semantic_router_benchmark::run_router_benchmark(100, 30);
+}
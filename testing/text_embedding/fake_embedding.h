@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "text_embedding.h"
+
+namespace text_embedding_test {
+
+// 不依赖模型文件的确定性向量化实现，用于调度、缓存等组件的单元测试
+class FakeEmbedding : public text_embedding::TextEmbedding {
+public:
+    explicit FakeEmbedding(size_t dim = 8) : dim_(dim) {}
+
+    bool load_model(const std::string&) override { return true; }
+    void unload_model() override {}
+
+    std::vector<float> embed(const std::string& text) override {
+        embed_calls.fetch_add(1);
+        return make_vector(text);
+    }
+
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::string>& texts) override {
+        batch_calls.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch_sizes.push_back(texts.size());
+        }
+        std::vector<std::vector<float>> result;
+        for (const auto& text : texts) result.push_back(make_vector(text));
+        return result;
+    }
+
+    // 第 0 维编码文本长度，其余维度由文本哈希确定
+    std::vector<float> make_vector(const std::string& text) const {
+        if (text == kFailText) {
+            throw std::runtime_error("FakeEmbedding: forced failure");
+        }
+        std::vector<float> vec(dim_);
+        size_t h = std::hash<std::string>{}(text);
+        vec[0] = static_cast<float>(text.size());
+        for (size_t i = 1; i < dim_; ++i) {
+            vec[i] = static_cast<float>((h >> (i % 16)) & 0xff) / 255.0f;
+        }
+        return vec;
+    }
+
+    std::vector<size_t> recorded_batch_sizes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batch_sizes;
+    }
+
+    static constexpr const char* kFailText = "__fail__";
+
+    std::atomic<int> embed_calls{0};
+    std::atomic<int> batch_calls{0};
+
+private:
+    size_t dim_;
+    std::mutex mutex_;
+    std::vector<size_t> batch_sizes;
+};
+
+} // namespace text_embedding_test
@@ -15,6 +15,8 @@ def debug_print(*args, **kwargs):
 model_dir = sys.argv[1]
 text = sys.argv[2]
 output_path = sys.argv[3]
+# 可选：模型文件名（如 model_int8.onnx），默认 fp32 的 model.onnx
+model_file = sys.argv[4] if len(sys.argv) > 4 else "model.onnx"
 
 # ========== 加载分词器 ==========
 tokenizer = PreTrainedTokenizerFast(tokenizer_file=os.path.join(model_dir, "tokenizer.json"))
@@ -28,7 +30,7 @@ if tokenizer.pad_token is None:
         tokenizer.add_special_tokens({'pad_token': '[PAD]'})
 
 # ========== 加载 ONNX 模型 ==========
-session = ort.InferenceSession(os.path.join(model_dir, "model.onnx"))
+session = ort.InferenceSession(os.path.join(model_dir, model_file))
 
 # ========== 编码文本 ==========
 inputs = tokenizer(text, return_tensors="np", padding=True, truncation=True)
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "batching_embedding.h"
+#include "fake_embedding.h"
+#include "logger.h"
+
+using text_embedding::BatchingEmbedding;
+using text_embedding::BatchingOptions;
+using text_embedding_test::FakeEmbedding;
+
+namespace {
+
+struct BatchingFixture {
+    FakeEmbedding* fake = nullptr;
+    std::unique_ptr<BatchingEmbedding> batching;
+
+    explicit BatchingFixture(BatchingOptions options) {
+        auto inner = std::make_unique<FakeEmbedding>();
+        fake = inner.get();
+        batching = std::make_unique<BatchingEmbedding>(std::move(inner), options);
+    }
+};
+
+} // namespace
+
+TEST(BatchingEmbeddingTest, MergesConcurrentRequests) {
+    BatchingOptions options;
+    options.max_batch_size = 8;
+    options.max_wait = std::chrono::milliseconds(20);
+    BatchingFixture fixture(options);
+
+    const int thread_count = 16;
+    const int repeat_per_thread = 20;
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < repeat_per_thread; ++i) {
+                std::string text = "thread-" + std::to_string(t) + "-request-" + std::to_string(i);
+                if (fixture.batching->embed(text) != fixture.fake->make_vector(text)) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(mismatches.load(), 0) << "Results were routed to the wrong caller";
+
+    auto sizes = fixture.fake->recorded_batch_sizes();
+    size_t total = 0;
+    for (size_t size : sizes) {
+        EXPECT_LE(size, options.max_batch_size);
+        total += size;
+    }
+    EXPECT_EQ(total, static_cast<size_t>(thread_count * repeat_per_thread));
+    EXPECT_LT(sizes.size(), total) << "Concurrent requests were never merged";
+
+    LOG_INFO << "[Batching] " << total << " requests served by " << sizes.size() << " batched calls";
+}
+
+TEST(BatchingEmbeddingTest, SingleRequestLatencyIsBounded) {
+    BatchingOptions options;
+    options.max_batch_size = 64;
+    options.max_wait = std::chrono::milliseconds(2);
+    BatchingFixture fixture(options);
+
+    auto start = std::chrono::steady_clock::now();
+    auto vec = fixture.batching->embed("lonely request");
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(vec, fixture.fake->make_vector("lonely request"));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(50));
+}
+
+TEST(BatchingEmbeddingTest, FailureIsIsolatedToOffendingRequest) {
+    BatchingOptions options;
+    options.max_batch_size = 4;
+    options.max_wait = std::chrono::milliseconds(50);
+    BatchingFixture fixture(options);
+
+    std::thread bad([&] {
+        EXPECT_THROW(fixture.batching->embed(FakeEmbedding::kFailText), std::runtime_error);
+    });
+    std::thread good([&] {
+        EXPECT_EQ(fixture.batching->embed("healthy"), fixture.fake->make_vector("healthy"));
+    });
+    bad.join();
+    good.join();
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "compact_embedding.h"
+#include "fake_embedding.h"
+#include "logger.h"
+#include "vector_math.h"
+
+using text_embedding::CompactVectorStore;
+using text_embedding_test::FakeEmbedding;
+
+namespace {
+
+std::vector<float> random_unit_vector(size_t dim, std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> v(dim);
+    for (auto& x : v) x = dist(rng);
+    vector_math::l2_normalize(v.data(), dim);
+    return v;
+}
+
+} // namespace
+
+TEST(CompactEmbeddingTest, Fp16RoundTripKeepsDirection) {
+    std::mt19937 rng(1);
+    auto v = random_unit_vector(384, rng);
+    auto restored = text_embedding::from_fp16(text_embedding::to_fp16(v.data(), v.size()));
+    ASSERT_EQ(restored.size(), v.size());
+    EXPECT_GT(vector_math::cosine(v.data(), restored.data(), v.size()), 0.99999f);
+}
+
+TEST(CompactEmbeddingTest, Int8QuantizationUsesPerVectorScale) {
+    std::vector<float> v = {0.5f, -1.0f, 0.25f, 0.0f};
+    auto q = text_embedding::quantize_int8(v.data(), v.size());
+    EXPECT_FLOAT_EQ(q.scale, 1.0f / 127.0f);
+    EXPECT_EQ(q.values[1], -127);
+    EXPECT_EQ(q.values[3], 0);
+
+    auto restored = text_embedding::dequantize_int8(q);
+    for (size_t i = 0; i < v.size(); ++i) EXPECT_NEAR(restored[i], v[i], q.scale);
+
+    std::vector<float> zeros(4, 0.0f);
+    auto zero_q = text_embedding::quantize_int8(zeros.data(), zeros.size());
+    EXPECT_EQ(zero_q.scale, 0.0f);
+}
+
+TEST(CompactEmbeddingTest, Int8DotApproximatesFloatDot) {
+    std::mt19937 rng(2);
+    const size_t dim = 512;
+    auto a = random_unit_vector(dim, rng);
+    auto b = random_unit_vector(dim, rng);
+    float expected = vector_math::dot(a.data(), b.data(), dim);
+
+    auto qa = text_embedding::quantize_int8(a.data(), dim);
+    auto qb = text_embedding::quantize_int8(b.data(), dim);
+    EXPECT_NEAR(text_embedding::int8_dot(qa, qb), expected, 0.01f);
+    EXPECT_NEAR(text_embedding::int8_dot(a.data(), qb.values.data(), qb.scale, dim), expected, 0.005f);
+}
+
+TEST(CompactEmbeddingTest, BinarizePacksSignBits) {
+    std::vector<float> v(70, -1.0f);
+    v[0] = 1.0f;
+    v[63] = 1.0f;
+    v[64] = 1.0f;
+    auto bits = text_embedding::binarize(v.data(), v.size());
+    ASSERT_EQ(bits.bits.size(), 2u);
+    EXPECT_EQ(bits.bits[0], (uint64_t{1} << 63) | 1u);
+    EXPECT_EQ(bits.bits[1], 1u);
+
+    std::vector<float> flipped(v.size());
+    std::transform(v.begin(), v.end(), flipped.begin(), [](float x) { return -x; });
+    EXPECT_EQ(text_embedding::hamming_distance(bits, text_embedding::binarize(flipped.data(), flipped.size())), v.size());
+}
+
+TEST(CompactEmbeddingTest, DistanceRejectsDimensionMismatch) {
+    std::vector<float> a(8, 1.0f), b(16, 1.0f);
+    EXPECT_THROW(text_embedding::hamming_distance(text_embedding::binarize(a.data(), a.size()),
+                                                  text_embedding::binarize(b.data(), b.size())),
+                 std::invalid_argument);
+    EXPECT_THROW(text_embedding::int8_dot(text_embedding::quantize_int8(a.data(), a.size()),
+                                          text_embedding::quantize_int8(b.data(), b.size())),
+                 std::invalid_argument);
+}
+
+TEST(CompactEmbeddingTest, EmbedVariantsConvertModelOutput) {
+    FakeEmbedding fake(16);
+    auto expected = fake.make_vector("hello");
+
+    auto half = text_embedding::embed_fp16(fake, "hello");
+    EXPECT_EQ(half, text_embedding::to_fp16(expected.data(), expected.size()));
+    auto q = text_embedding::embed_int8(fake, "hello");
+    EXPECT_EQ(q.values.size(), 16u);
+    auto bits = text_embedding::embed_binary(fake, "hello");
+    EXPECT_EQ(bits.dim, 16u);
+
+    auto batch = text_embedding::embed_batch_int8(fake, {"a", "bb", "ccc"});
+    ASSERT_EQ(batch.size(), 3u);
+    EXPECT_EQ(fake.batch_calls.load(), 1);
+}
+
+// 二值粗筛 + int8 重排的召回应接近 fp32 暴力检索
+TEST(CompactEmbeddingTest, StoreSearchRecallsExactTopK) {
+    const size_t dim = 384, count = 2000, queries = 50, k = 10;
+    std::mt19937 rng(3);
+
+    // 按簇生成语料，贴近真实句向量的分布
+    std::vector<std::vector<float>> centroids;
+    for (size_t c = 0; c < 100; ++c) centroids.push_back(random_unit_vector(dim, rng));
+
+    CompactVectorStore store(dim);
+    std::vector<std::vector<float>> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        auto v = random_unit_vector(dim, rng);
+        const auto& centroid = centroids[i % centroids.size()];
+        for (size_t d = 0; d < dim; ++d) v[d] = centroid[d] + 0.6f * v[d];
+        vector_math::l2_normalize(v.data(), dim);
+        corpus.push_back(std::move(v));
+        EXPECT_EQ(store.add(corpus.back().data()), i);
+    }
+    EXPECT_EQ(store.size(), count);
+    EXPECT_LT(store.memory_bytes(), count * dim * sizeof(float) / 3);
+
+    size_t hits = 0;
+    for (size_t q = 0; q < queries; ++q) {
+        // 在语料附近取查询，使 top-k 有明确的区分度
+        auto query = corpus[q * 7];
+        auto noise = random_unit_vector(dim, rng);
+        for (size_t i = 0; i < dim; ++i) query[i] += 0.3f * noise[i];
+        vector_math::l2_normalize(query.data(), dim);
+
+        std::vector<float> scores(count);
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            scores[i] = vector_math::dot(query.data(), corpus[i].data(), dim);
+            order[i] = i;
+        }
+        std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                          [&](size_t a, size_t b) { return scores[a] > scores[b]; });
+        std::set<size_t> expected(order.begin(), order.begin() + k);
+
+        auto results = store.search(query.data(), k, 20 * k);
+        ASSERT_EQ(results.size(), k);
+        for (size_t i = 1; i < results.size(); ++i) EXPECT_GE(results[i - 1].score, results[i].score);
+        for (const auto& hit : results) hits += expected.count(hit.id);
+    }
+
+    float recall = static_cast<float>(hits) / (queries * k);
+    LOG_INFO << "[Compact] binary+int8 recall@" << k << " : " << recall;
+    EXPECT_GE(recall, 0.8f);
+}
+
+TEST(CompactEmbeddingTest, StoreSearchHandlesSmallAndEmptyStores) {
+    CompactVectorStore store(8);
+    std::vector<float> v(8, 0.5f);
+    EXPECT_TRUE(store.search(v.data(), 3, 10).empty());
+
+    store.add(v.data());
+    auto results = store.search(v.data(), 3, 1);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].id, 0u);
+    EXPECT_THROW(CompactVectorStore(0), std::invalid_argument);
+}
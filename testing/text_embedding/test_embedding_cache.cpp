@@ -0,0 +1,281 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "embedding_cache.h"
+#include "fake_embedding.h"
+#include "logger.h"
+
+namespace fs = std::filesystem;
+
+using text_embedding::CachedEmbedding;
+using text_embedding::EmbeddingCacheOptions;
+using text_embedding_test::FakeEmbedding;
+
+namespace {
+
+struct CacheFixture {
+    FakeEmbedding* fake = nullptr;
+    std::unique_ptr<CachedEmbedding> cache;
+
+    explicit CacheFixture(EmbeddingCacheOptions options, size_t dim = 8) {
+        auto inner = std::make_unique<FakeEmbedding>(dim);
+        fake = inner.get();
+        cache = std::make_unique<CachedEmbedding>(std::move(inner), options);
+    }
+};
+
+// 可控制加载结果的向量化实现，用于检查加载失败时的缓存标识
+class FlakyLoadEmbedding : public FakeEmbedding {
+public:
+    bool load_model(const std::string&) override { return load_succeeds; }
+    bool load_succeeds = true;
+};
+
+void write_model_file(const fs::path& dir, const std::string& content) {
+    fs::create_directories(dir);
+    std::ofstream out(dir / "model.onnx", std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+std::string temp_cache_path(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / "redge_embedding_cache_test";
+    fs::create_directories(dir);
+    fs::path path = dir / name;
+    fs::remove(path);
+    return path.string();
+}
+
+} // namespace
+
+TEST(EmbeddingCacheTest, RepeatedTextHitsMemoryTier) {
+    EmbeddingCacheOptions options;
+    options.model_id = "fake-model";
+    CacheFixture fixture(options);
+
+    auto first = fixture.cache->embed("重复的查询");
+    auto second = fixture.cache->embed("重复的查询");
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(fixture.fake->embed_calls.load(), 1);
+
+    auto stats = fixture.cache->stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST(EmbeddingCacheTest, ByteBudgetEvictsLeastRecentlyUsed) {
+    EmbeddingCacheOptions options;
+    options.model_id = "fake-model";
+    options.num_shards = 1;
+    options.max_bytes = 3 * (8 * sizeof(float) + 96);  // 恰好容纳 3 条 8 维向量
+    CacheFixture fixture(options);
+
+    fixture.cache->embed("a");
+    fixture.cache->embed("b");
+    fixture.cache->embed("c");
+    fixture.cache->embed("a");  // a 变为最近使用
+    fixture.cache->embed("d");  // 淘汰 b
+
+    auto stats = fixture.cache->stats();
+    EXPECT_EQ(stats.entries, 3u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_LE(stats.bytes, options.max_bytes);
+
+    int calls_before = fixture.fake->embed_calls.load();
+    fixture.cache->embed("a");
+    EXPECT_EQ(fixture.fake->embed_calls.load(), calls_before);
+    fixture.cache->embed("b");
+    EXPECT_EQ(fixture.fake->embed_calls.load(), calls_before + 1);
+}
+
+TEST(EmbeddingCacheTest, BatchOnlyComputesUniqueMisses) {
+    EmbeddingCacheOptions options;
+    options.model_id = "fake-model";
+    CacheFixture fixture(options);
+
+    fixture.cache->embed("cached");
+    auto results = fixture.cache->embed_batch({"cached", "new-1", "new-2", "new-1"});
+
+    ASSERT_EQ(results.size(), 4u);
+    EXPECT_EQ(results[0], fixture.fake->make_vector("cached"));
+    EXPECT_EQ(results[1], fixture.fake->make_vector("new-1"));
+    EXPECT_EQ(results[3], results[1]);
+
+    auto sizes = fixture.fake->recorded_batch_sizes();
+    ASSERT_EQ(sizes.size(), 1u);
+    EXPECT_EQ(sizes[0], 2u);
+}
+
+TEST(EmbeddingCacheTest, ModelIdentityIsPartOfTheKey) {
+    EmbeddingCacheOptions options;
+    CacheFixture fixture(options);
+
+    fixture.cache->load_model("models/a/");
+    fixture.cache->embed("same text");
+    fixture.cache->load_model("models/b/");
+    fixture.cache->embed("same text");
+
+    EXPECT_EQ(fixture.fake->embed_calls.load(), 2);
+}
+
+TEST(EmbeddingCacheTest, ReloadingChangedModelAtSamePathMisses) {
+    const fs::path model_dir = fs::temp_directory_path() / "redge_embedding_cache_test" / "model";
+    fs::remove_all(model_dir);
+    write_model_file(model_dir, "weights v1");
+
+    EmbeddingCacheOptions options;
+    options.persistent_path = temp_cache_path("reload.cache");
+    options.persistent_capacity = 1024;
+    CacheFixture fixture(options);
+
+    ASSERT_TRUE(fixture.cache->load_model(model_dir.string()));
+    fixture.cache->embed("same text");
+    // 文件未变时重新加载仍可命中
+    ASSERT_TRUE(fixture.cache->load_model(model_dir.string()));
+    fixture.cache->embed("same text");
+    EXPECT_EQ(fixture.fake->embed_calls.load(), 1);
+
+    // 同一路径替换为新模型后，内存层与持久层的旧向量都不能再命中
+    write_model_file(model_dir, "weights v2, different size");
+    ASSERT_TRUE(fixture.cache->load_model(model_dir.string()));
+    fixture.cache->embed("same text");
+    EXPECT_EQ(fixture.fake->embed_calls.load(), 2);
+    EXPECT_EQ(fixture.cache->stats().persistent_hits, 0u);
+
+    fs::remove_all(model_dir);
+    fs::remove(options.persistent_path);
+}
+
+TEST(EmbeddingCacheTest, FailedLoadKeepsPreviousIdentity) {
+    auto inner = std::make_unique<FlakyLoadEmbedding>();
+    FlakyLoadEmbedding* fake = inner.get();
+    CachedEmbedding cache(std::move(inner));
+
+    ASSERT_TRUE(cache.load_model("models/a/"));
+    cache.embed("same text");
+
+    // 加载失败时旧模型继续服务，其向量不能记到新模型名下
+    fake->load_succeeds = false;
+    EXPECT_FALSE(cache.load_model("models/b/"));
+    cache.embed("same text");
+    EXPECT_EQ(fake->embed_calls.load(), 1);
+
+    fake->load_succeeds = true;
+    ASSERT_TRUE(cache.load_model("models/b/"));
+    cache.embed("same text");
+    EXPECT_EQ(fake->embed_calls.load(), 2);
+}
+
+TEST(EmbeddingCacheTest, PersistentTierSurvivesRestart) {
+    const std::string path = temp_cache_path("persistent.cache");
+    EmbeddingCacheOptions options;
+    options.model_id = "fake-model";
+    options.persistent_path = path;
+    options.persistent_capacity = 1024;
+
+    std::vector<std::string> texts;
+    for (int i = 0; i < 100; ++i) texts.push_back("chunk-" + std::to_string(i));
+
+    {
+        CacheFixture fixture(options);
+        fixture.cache->embed_batch(texts);
+        fixture.cache->flush();
+    }
+
+    // 模拟进程重启：新实例、空内存层
+    CacheFixture restarted(options);
+    auto results = restarted.cache->embed_batch(texts);
+    for (size_t i = 0; i < texts.size(); ++i) {
+        EXPECT_EQ(results[i], restarted.fake->make_vector(texts[i]));
+    }
+    EXPECT_EQ(restarted.fake->batch_calls.load(), 0);
+    EXPECT_EQ(restarted.cache->stats().persistent_hits, texts.size());
+
+    // 不同模型不能复用持久层中的向量
+    options.model_id = "another-model";
+    CacheFixture other_model(options);
+    other_model.cache->embed(texts[0]);
+    EXPECT_EQ(other_model.fake->embed_calls.load(), 1);
+
+    fs::remove(path);
+}
+
+// 换模型时持久层实例被替换，请求线程仍可能在读旧实例；旧映射须保持有效，
+// 最后一个模型写入的数据在重启后仍可命中
+TEST(EmbeddingCacheTest, SwitchingModelsWhileServingKeepsPersistentTierValid) {
+    const std::string path = temp_cache_path("switch.cache");
+    EmbeddingCacheOptions options;
+    options.persistent_path = path;
+    options.persistent_capacity = 1024;
+    options.max_bytes = 0;  // 关闭内存层，每次都读写持久层
+    CacheFixture fixture(options);
+    ASSERT_TRUE(fixture.cache->load_model("models/a/"));
+
+    std::vector<std::string> texts;
+    for (int i = 0; i < 32; ++i) texts.push_back("chunk-" + std::to_string(i));
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; !stop.load(); ++i) {
+                const auto& text = texts[i % texts.size()];
+                if (fixture.cache->embed(text) != fixture.fake->make_vector(text)) mismatches.fetch_add(1);
+            }
+        });
+    }
+    for (int round = 0; round < 20; ++round) {
+        ASSERT_TRUE(fixture.cache->load_model(round % 2 ? "models/a/" : "models/b/"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stop = true;
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+
+    // 最后加载的是 models/a/
+    fixture.cache->embed_batch(texts);
+    fixture.cache->flush();
+    CacheFixture restarted(options);
+    ASSERT_TRUE(restarted.cache->load_model("models/a/"));
+    restarted.cache->embed_batch(texts);
+    EXPECT_EQ(restarted.cache->stats().persistent_hits, texts.size());
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+
+    fs::remove(path);
+}
+
+TEST(EmbeddingCacheTest, ConcurrentAccessIsConsistent) {
+    EmbeddingCacheOptions options;
+    options.model_id = "fake-model";
+    options.max_bytes = 64 * (8 * sizeof(float) + 96);
+    CacheFixture fixture(options);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                std::string text = "q" + std::to_string((i * 7 + t) % 200);
+                if (fixture.cache->embed(text) != fixture.fake->make_vector(text)) ++mismatches;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    auto stats = fixture.cache->stats();
+    LOG_INFO << "[EmbeddingCache] hits=" << stats.hits << " misses=" << stats.misses
+             << " evictions=" << stats.evictions << " entries=" << stats.entries;
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_LE(stats.bytes, options.max_bytes);
+    EXPECT_EQ(stats.hits + stats.misses, 8u * 2000u);
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "length_bucketing.h"
+#include "logger.h"
+
+using text_embedding::BucketingOptions;
+using text_embedding::compute_padding_stats;
+using text_embedding::plan_length_buckets;
+
+TEST(LengthBucketingTest, CoversEveryInputExactlyOnce) {
+    std::vector<size_t> lengths = {5, 500, 12, 64, 7, 300, 33, 8, 130, 510};
+    auto batches = plan_length_buckets(lengths, BucketingOptions{});
+
+    std::vector<size_t> seen;
+    for (const auto& batch : batches) seen.insert(seen.end(), batch.begin(), batch.end());
+    std::sort(seen.begin(), seen.end());
+
+    std::vector<size_t> expected(lengths.size());
+    for (size_t i = 0; i < expected.size(); ++i) expected[i] = i;
+    EXPECT_EQ(seen, expected);
+}
+
+TEST(LengthBucketingTest, BatchesStayWithinOneBucket) {
+    BucketingOptions options;
+    options.bucket_bounds = {16, 64, 256};
+    options.max_batch_size = 3;
+
+    std::vector<size_t> lengths = {5, 500, 12, 64, 7, 300, 33, 8, 130, 10, 11};
+    auto batches = plan_length_buckets(lengths, options);
+
+    auto bucket_of = [&](size_t len) {
+        return std::lower_bound(options.bucket_bounds.begin(), options.bucket_bounds.end(), len) -
+               options.bucket_bounds.begin();
+    };
+    for (const auto& batch : batches) {
+        ASSERT_FALSE(batch.empty());
+        EXPECT_LE(batch.size(), options.max_batch_size);
+        for (size_t index : batch) {
+            EXPECT_EQ(bucket_of(lengths[index]), bucket_of(lengths[batch.front()]));
+        }
+    }
+}
+
+TEST(LengthBucketingTest, ImprovesPaddingEfficiencyOnSkewedLengths) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> short_len(4, 24);
+    std::uniform_int_distribution<size_t> long_len(200, 512);
+
+    // 模拟文档切片：大部分为短文本，少量长段落
+    std::vector<size_t> lengths;
+    for (int i = 0; i < 256; ++i) {
+        lengths.push_back(i % 8 == 0 ? long_len(rng) : short_len(rng));
+    }
+
+    BucketingOptions options;
+    options.max_batch_size = 32;
+
+    // 不分桶：按原始顺序每 32 条一批
+    std::vector<std::vector<size_t>> naive;
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        if (i % options.max_batch_size == 0) naive.emplace_back();
+        naive.back().push_back(i);
+    }
+
+    auto naive_stats = compute_padding_stats(lengths, naive);
+    auto bucketed_stats = compute_padding_stats(lengths, plan_length_buckets(lengths, options));
+
+    LOG_INFO << "[Bucketing] naive efficiency: " << naive_stats.efficiency()
+             << ", bucketed efficiency: " << bucketed_stats.efficiency();
+
+    EXPECT_EQ(naive_stats.useful_tokens, bucketed_stats.useful_tokens);
+    EXPECT_LT(bucketed_stats.computed_tokens * 2, naive_stats.computed_tokens);
+    EXPECT_GT(bucketed_stats.efficiency(), 0.8);
+}
@@ -0,0 +1,102 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "long_text.h"
+
+namespace fs = std::filesystem;
+
+using text_embedding::combine_window_embeddings;
+using text_embedding::plan_token_windows;
+using text_embedding::read_model_max_length;
+
+using Span = std::pair<size_t, size_t>;
+
+namespace {
+
+// 在临时目录中写入配置文件，析构时删除
+struct ModelDir {
+    fs::path path;
+
+    ModelDir() {
+        path = fs::temp_directory_path() / ("long_text_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+                                            "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        fs::create_directories(path);
+    }
+    ~ModelDir() { fs::remove_all(path); }
+
+    void write(const std::string& name, const std::string& content) const {
+        std::ofstream(path / name) << content;
+    }
+    std::string dir() const { return path.string() + "/"; }
+};
+
+} // namespace
+
+TEST(LongTextTest, WindowsCoverAllTokensWithOverlap) {
+    auto windows = plan_token_windows(1000, 510, 64);
+    ASSERT_EQ(windows.size(), 3u);
+    EXPECT_EQ(windows[0], Span(0, 510));
+    EXPECT_EQ(windows[1], Span(446, 956));
+    EXPECT_EQ(windows[2], Span(892, 1000));
+}
+
+TEST(LongTextTest, ShortInputFitsInOneWindow) {
+    auto windows = plan_token_windows(100, 510, 64);
+    ASSERT_EQ(windows.size(), 1u);
+    EXPECT_EQ(windows[0], Span(0, 100));
+    EXPECT_TRUE(plan_token_windows(0, 510, 64).empty());
+}
+
+TEST(LongTextTest, WindowCountGrowsLinearly) {
+    size_t previous = 0;
+    for (size_t tokens = 1000; tokens <= 16000; tokens *= 2) {
+        size_t count = plan_token_windows(tokens, 256, 32).size();
+        if (previous) EXPECT_LE(count, 2 * previous + 1);
+        previous = count;
+    }
+}
+
+TEST(LongTextTest, RejectsInvalidWindowParameters) {
+    EXPECT_THROW(plan_token_windows(100, 0, 0), std::invalid_argument);
+    EXPECT_THROW(plan_token_windows(100, 64, 64), std::invalid_argument);
+}
+
+TEST(LongTextTest, CombineWeightsByWindowLength) {
+    std::vector<std::vector<float>> windows = {{1.0f, 0.0f}, {0.0f, 1.0f}};
+    std::vector<float> out(2);
+    combine_window_embeddings(windows, {3, 1}, out.data(), out.size());
+    EXPECT_FLOAT_EQ(out[0], 0.75f);
+    EXPECT_FLOAT_EQ(out[1], 0.25f);
+
+    EXPECT_THROW(combine_window_embeddings(windows, {1}, out.data(), out.size()), std::invalid_argument);
+}
+
+TEST(LongTextTest, ReadsMaxLengthFromTokenizerConfig) {
+    ModelDir model;
+    model.write("tokenizer_config.json", R"({"do_lower_case": true, "model_max_length": 256})");
+    model.write("config.json", R"({"max_position_embeddings": 512})");
+    EXPECT_EQ(read_model_max_length(model.dir()), 256u);
+}
+
+TEST(LongTextTest, IgnoresUnsetTokenizerLimit) {
+    ModelDir model;
+    model.write("tokenizer_config.json", R"({"model_max_length": 1000000000000000019884624838656})");
+    model.write("config.json", R"({"model_type": "bert", "max_position_embeddings": 512})");
+    EXPECT_EQ(read_model_max_length(model.dir()), 512u);
+}
+
+TEST(LongTextTest, RobertaPositionsReserveTwoSlots) {
+    ModelDir model;
+    model.write("config.json", R"({"max_position_embeddings" : 514, "model_type": "xlm-roberta"})");
+    EXPECT_EQ(read_model_max_length(model.dir()), 512u);
+}
+
+TEST(LongTextTest, FallsBackToDefault) {
+    ModelDir model;
+    EXPECT_EQ(read_model_max_length(model.dir()), text_embedding::kDefaultMaxLength);
+}
@@ -0,0 +1,191 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fake_embedding.h"
+#include "logger.h"
+#include "model_registry.h"
+
+using text_embedding::ModelRegistry;
+using text_embedding::ModelRegistryOptions;
+using text_embedding::ModelSpec;
+using text_embedding::TextEmbedding;
+using text_embedding_test::FakeEmbedding;
+
+namespace {
+
+constexpr size_t kModelBytes = 100;
+
+// 用 FakeEmbedding 代替 ORT 模型，记录加载次数；model_path 为 "fail" 时加载失败
+struct CountingLoader {
+    std::shared_ptr<std::atomic<int>> loads = std::make_shared<std::atomic<int>>(0);
+    std::shared_ptr<std::atomic<int>> fail_remaining = std::make_shared<std::atomic<int>>(0);
+    std::chrono::milliseconds delay{0};
+
+    ModelRegistry::ModelLoader make() const {
+        return [loads = loads, fail_remaining = fail_remaining, delay = delay](const ModelSpec&)
+                   -> std::shared_ptr<TextEmbedding> {
+            std::this_thread::sleep_for(delay);
+            loads->fetch_add(1);
+            if (fail_remaining->load() > 0) {
+                fail_remaining->fetch_sub(1);
+                return nullptr;
+            }
+            return std::make_shared<FakeEmbedding>();
+        };
+    }
+};
+
+ModelSpec fake_spec(const std::string& path) {
+    ModelSpec spec;
+    spec.model_path = path;
+    spec.memory_bytes = kModelBytes;
+    return spec;
+}
+
+std::unique_ptr<ModelRegistry> make_registry(const CountingLoader& loader, size_t budget,
+                                             const std::vector<std::string>& names) {
+    ModelRegistryOptions options;
+    options.memory_budget_bytes = budget;
+    auto registry = std::make_unique<ModelRegistry>(options, loader.make());
+    for (const auto& name : names) registry->register_model(name, fake_spec("resource/model/" + name + "/"));
+    return registry;
+}
+
+bool is_loaded(const ModelRegistry& registry, const std::string& name) {
+    for (const auto& info : registry.models()) {
+        if (info.name == name) return info.loaded;
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(ModelRegistryTest, LoadsOnDemandAndReuses) {
+    CountingLoader loader;
+    auto registry = make_registry(loader, 0, {"e5", "bge"});
+    EXPECT_EQ(loader.loads->load(), 0);
+
+    auto first = registry->acquire("e5");
+    auto second = registry->acquire("e5");
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(loader.loads->load(), 1);
+    EXPECT_EQ(first->embed("hello").size(), 8u);
+
+    EXPECT_EQ(registry->acquire("missing"), nullptr);
+    EXPECT_FALSE(registry->register_model("e5", fake_spec("other/")));
+
+    const auto stats = registry->stats();
+    EXPECT_EQ(stats.loaded_models, 1u);
+    EXPECT_EQ(stats.resident_bytes, kModelBytes);
+    EXPECT_FALSE(is_loaded(*registry, "bge"));
+}
+
+TEST(ModelRegistryTest, ConcurrentFirstRequestsLoadOnce) {
+    CountingLoader loader;
+    loader.delay = std::chrono::milliseconds(50);
+    auto registry = make_registry(loader, 0, {"e5"});
+
+    constexpr int kThreads = 8;
+    std::vector<std::shared_ptr<TextEmbedding>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&, i] { results[i] = registry->acquire("e5"); });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(loader.loads->load(), 1);
+    for (const auto& result : results) {
+        ASSERT_NE(result, nullptr);
+        EXPECT_EQ(result, results.front());
+    }
+}
+
+TEST(ModelRegistryTest, EvictsLeastRecentlyUsedWithinBudget) {
+    CountingLoader loader;
+    auto registry = make_registry(loader, 2 * kModelBytes, {"a", "b", "c"});
+
+    registry->acquire("a");
+    registry->acquire("b");
+    registry->acquire("a");  // b 成为最久未使用
+    registry->acquire("c");
+
+    EXPECT_TRUE(is_loaded(*registry, "a"));
+    EXPECT_FALSE(is_loaded(*registry, "b"));
+    EXPECT_TRUE(is_loaded(*registry, "c"));
+    auto stats = registry->stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.resident_bytes, 2 * kModelBytes);
+
+    // 被淘汰的模型再次请求时重新加载
+    registry->acquire("b");
+    EXPECT_EQ(loader.loads->load(), 4);
+    EXPECT_FALSE(is_loaded(*registry, "a"));
+}
+
+TEST(ModelRegistryTest, ModelsInUseAreNotEvicted) {
+    CountingLoader loader;
+    auto registry = make_registry(loader, kModelBytes + kModelBytes / 2, {"a", "b", "c"});
+
+    auto held = registry->acquire("a");
+    registry->acquire("b");
+    // a 仍被持有，只能暂时超出预算
+    EXPECT_TRUE(is_loaded(*registry, "a"));
+    EXPECT_TRUE(is_loaded(*registry, "b"));
+    EXPECT_EQ(registry->stats().resident_bytes, 2 * kModelBytes);
+
+    held.reset();
+    registry->acquire("c");
+    EXPECT_FALSE(is_loaded(*registry, "a"));
+    EXPECT_FALSE(is_loaded(*registry, "b"));
+    EXPECT_TRUE(is_loaded(*registry, "c"));
+    EXPECT_EQ(registry->stats().resident_bytes, kModelBytes);
+}
+
+TEST(ModelRegistryTest, FailedLoadCanBeRetried) {
+    CountingLoader loader;
+    loader.fail_remaining->store(1);
+    auto registry = make_registry(loader, 0, {"e5"});
+
+    EXPECT_EQ(registry->acquire("e5"), nullptr);
+    EXPECT_EQ(registry->stats().load_failures, 1u);
+    EXPECT_NE(registry->acquire("e5"), nullptr);
+    EXPECT_EQ(loader.loads->load(), 2);
+}
+
+TEST(ModelRegistryTest, LoaderThrowingNonStdExceptionCanBeRetried) {
+    std::atomic<int> calls{0};
+    ModelRegistry registry(ModelRegistryOptions{}, [&](const ModelSpec&) -> std::shared_ptr<TextEmbedding> {
+        if (calls.fetch_add(1) == 0) throw 42;
+        return std::make_shared<FakeEmbedding>();
+    });
+    registry.register_model("e5", fake_spec("resource/model/e5/"));
+
+    // 加载状态必须被清除，否则之后的请求会永远等待
+    EXPECT_EQ(registry.acquire("e5"), nullptr);
+    EXPECT_EQ(registry.stats().load_failures, 1u);
+    EXPECT_NE(registry.acquire("e5"), nullptr);
+    EXPECT_EQ(calls.load(), 2);
+}
+
+TEST(ModelRegistryTest, UnloadReleasesMemory) {
+    CountingLoader loader;
+    auto registry = make_registry(loader, 0, {"a", "b"});
+    std::weak_ptr<TextEmbedding> weak = registry->acquire("a");
+    registry->acquire("b");
+    EXPECT_EQ(registry->stats().resident_bytes, 2 * kModelBytes);
+
+    registry->unload("a");
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(registry->stats().resident_bytes, kModelBytes);
+
+    registry->unload_all();
+    EXPECT_EQ(registry->stats().loaded_models, 0u);
+    EXPECT_EQ(registry->stats().resident_bytes, 0u);
+}
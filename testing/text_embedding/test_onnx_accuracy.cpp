@@ -1,17 +1,24 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono> 
 #include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <vector>
 #include <numeric>
+#include <set>
+#include <thread>
 #include <filesystem>
 #include <limits.h>
 #include <unistd.h>
 
 #include <gtest/gtest.h>
 
+#include "compact_embedding.h"
 #include "logger.h"
+#include "onnx_embedding.h"
 #include "text_embedding_factory.h"
+#include "vector_math.h"
 
 namespace fs = std::filesystem;
 
@@ -93,19 +100,412 @@ TEST_P(EmbeddingBatchTest, CompareE5AndBGE) {
     run_embedding_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/", text);
 }
 
+const std::vector<std::string> kSampleTexts = {
+    "你好，世界！",
+    "今天天气不错。",
+    "OpenAI is building amazing models.",
+    "如何前往火车站？",
+    "The quick brown fox jumps over the lazy dog.",
+    "我爱北京天安门。",
+    "This is a test sentence.",
+    "人工智能正在改变世界。",
+    "Bonjour le monde!",
+    "未来属于我们"
+};
+
 INSTANTIATE_TEST_SUITE_P(
     EmbeddingSamples,
     EmbeddingBatchTest,
-    ::testing::Values(
-        "你好，世界！",
-        "今天天气不错。",
-        "OpenAI is building amazing models.",
-        "如何前往火车站？",
-        "The quick brown fox jumps over the lazy dog.",
-        "我爱北京天安门。",
-        "This is a test sentence.",
-        "人工智能正在改变世界。",
-        "Bonjour le monde!",
-        "未来属于我们"
-    )
+    ::testing::ValuesIn(kSampleTexts)
 );
+
+// 批量推理（动态补齐）的每一行应与单条推理结果一致
+void run_batch_consistency_test(const std::string& model_name, const std::string& model_path) {
+    LOG_INFO << "\n=== [" << model_name << "] Batch consistency on " << kSampleTexts.size() << " texts ===";
+
+    auto embedding = std::make_unique<text_embedding::OnnxRuntimeEmbedding>();
+    ASSERT_TRUE(embedding->load_model(model_path));
+
+    auto batch_start_time = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<float>> batch_vecs = embedding->embed_batch(kSampleTexts);
+    auto batch_end_time = std::chrono::high_resolution_clock::now();
+    ASSERT_EQ(batch_vecs.size(), kSampleTexts.size());
+
+    std::chrono::duration<double, std::milli> batch_elapsed = batch_end_time - batch_start_time;
+    LOG_INFO << "[Profiling] embed_batch elapsed : " << batch_elapsed.count() << " ms";
+    LOG_INFO << "[Padding] efficiency : " << embedding->padding_stats().efficiency();
+
+    for (size_t i = 0; i < kSampleTexts.size(); ++i) {
+        std::vector<float> single_vec = embedding->embed(kSampleTexts[i]);
+        ASSERT_EQ(single_vec.size(), batch_vecs[i].size()) << "Vector size mismatch at row " << i;
+
+        float sim = cosine_similarity(single_vec, batch_vecs[i]);
+        EXPECT_NEAR(sim, 1.0, 0.001) << "Batch row " << i << " differs from single embedding!";
+    }
+
+    embedding->unload_model();
+}
+
+TEST(EmbeddingBatchConsistencyTest, CompareE5AndBGE) {
+    run_batch_consistency_test("multilingual-e5-small",  "resource/model/multilingual-e5-small/");
+    run_batch_consistency_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/");
+}
+
+// fp32 精确 top-k 的 id 集合
+std::set<size_t> exact_top_k(const std::vector<std::vector<float>>& corpus, const std::vector<float>& query, size_t k) {
+    std::vector<std::pair<float, size_t>> scored;
+    for (size_t id = 0; id < corpus.size(); ++id) {
+        scored.emplace_back(vector_math::dot(query.data(), corpus[id].data(), query.size()), id);
+    }
+    std::sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::set<size_t> ids;
+    for (size_t i = 0; i < std::min(k, scored.size()); ++i) ids.insert(scored[i].second);
+    return ids;
+}
+
+// 紧凑格式（fp16 / int8 / binary）相对 fp32 的余弦与 recall 损失
+void run_compact_format_test(const std::string& model_name, const std::string& model_path) {
+    LOG_INFO << "\n=== [" << model_name << "] Compact formats on " << kSampleTexts.size() << " texts ===";
+
+    auto embedding = std::make_unique<text_embedding::OnnxRuntimeEmbedding>();
+    ASSERT_TRUE(embedding->load_model(model_path));
+    std::vector<std::vector<float>> fp32_vecs = embedding->embed_batch(kSampleTexts);
+    embedding->unload_model();
+    ASSERT_EQ(fp32_vecs.size(), kSampleTexts.size());
+
+    const size_t dim = fp32_vecs[0].size();
+    float fp16_min = 1.0f, int8_min = 1.0f, fp16_sum = 0.0f, int8_sum = 0.0f;
+    text_embedding::CompactVectorStore store(dim);
+    std::vector<text_embedding::BinaryEmbedding> binary_vecs;
+
+    for (const auto& v : fp32_vecs) {
+        float fp16_sim = cosine_similarity(v, text_embedding::from_fp16(text_embedding::to_fp16(v.data(), dim)));
+        float int8_sim = cosine_similarity(v, text_embedding::dequantize_int8(text_embedding::quantize_int8(v.data(), dim)));
+        fp16_min = std::min(fp16_min, fp16_sim);
+        int8_min = std::min(int8_min, int8_sim);
+        fp16_sum += fp16_sim;
+        int8_sum += int8_sim;
+
+        store.add(v.data());
+        binary_vecs.push_back(text_embedding::binarize(v.data(), dim));
+    }
+
+    const size_t k = 3;
+    size_t int8_hits = 0, binary_hits = 0, rescore_hits = 0;
+    for (const auto& query : fp32_vecs) {
+        auto expected = exact_top_k(fp32_vecs, query, k);
+
+        // int8 全量重排（粗筛候选数 = 全部）
+        for (const auto& hit : store.search(query.data(), k, store.size())) int8_hits += expected.count(hit.id);
+        // 仅二值 Hamming
+        auto query_code = text_embedding::binarize(query.data(), dim);
+        std::vector<std::pair<size_t, size_t>> by_hamming;
+        for (size_t id = 0; id < binary_vecs.size(); ++id) {
+            by_hamming.emplace_back(text_embedding::hamming_distance(query_code, binary_vecs[id]), id);
+        }
+        std::sort(by_hamming.begin(), by_hamming.end());
+        for (size_t i = 0; i < k; ++i) binary_hits += expected.count(by_hamming[i].second);
+        // 二值粗筛 2k 条 + int8 重排
+        for (const auto& hit : store.search(query.data(), k, 2 * k)) rescore_hits += expected.count(hit.id);
+    }
+
+    const float total = static_cast<float>(fp32_vecs.size() * k);
+    LOG_INFO << "[Compact] fp16 cosine mean/min : " << fp16_sum / fp32_vecs.size() << " / " << fp16_min;
+    LOG_INFO << "[Compact] int8 cosine mean/min : " << int8_sum / fp32_vecs.size() << " / " << int8_min;
+    LOG_INFO << "[Compact] recall@" << k << " int8 : " << int8_hits / total
+             << ", binary : " << binary_hits / total
+             << ", binary+rescore : " << rescore_hits / total;
+    LOG_INFO << "[Compact] bytes per vector fp32 : " << dim * sizeof(float)
+             << ", fp16 : " << dim * sizeof(uint16_t)
+             << ", int8 : " << dim + sizeof(float)
+             << ", binary : " << text_embedding::binary_words(dim) * sizeof(uint64_t);
+
+    EXPECT_GT(fp16_min, 0.9999f) << "fp16 conversion lost too much precision!";
+    EXPECT_GT(int8_min, 0.99f) << "int8 quantization lost too much precision!";
+    EXPECT_GE(int8_hits / total, 0.9f) << "int8 recall too low!";
+}
+
+TEST(EmbeddingCompactFormatTest, CompareE5AndBGE) {
+    run_compact_format_test("multilingual-e5-small",  "resource/model/multilingual-e5-small/");
+    run_compact_format_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/");
+}
+
+// 量化模型（tools/quantize_onnx.py 导出）与 Python fp32 参考输出的精度门限
+void run_quantized_accuracy_test(const std::string& model_name, const std::string& model_path,
+                                 text_embedding::ModelPrecision precision, float min_similarity) {
+    const std::string precision_str = text_embedding::precision_name(precision);
+    LOG_INFO << "\n=== [" << model_name << "] " << precision_str << " vs fp32 reference ===";
+
+    text_embedding::OnnxEmbeddingOptions options;
+    options.precision = precision;
+    auto embedding = std::make_unique<text_embedding::OnnxRuntimeEmbedding>(options);
+    ASSERT_TRUE(embedding->load_model(model_path));
+    if (embedding->loaded_precision() != precision) {
+        GTEST_SKIP() << precision_str << " variant of " << model_name << " not exported, run tools/quantize_onnx.py first.";
+    }
+
+    std::string script_path = get_binary_dir() + "/scripts/test_onnx_embedding.py";
+    float min_sim = 1.0f;
+    for (const auto& text : kSampleTexts) {
+        std::string safe_text = std::to_string(std::hash<std::string>{}(text));
+        std::string py_out = "out/temp/embedding_py_" + model_name + "_" + safe_text + ".txt";
+
+        // fp32 参考向量由 Python 端 model.onnx 生成
+        std::string cmd = "python3 \"" + script_path + "\" \"" + model_path + "\" \"" + text + "\" \"" + py_out + "\" model.onnx";
+        ASSERT_EQ(std::system(cmd.c_str()), 0) << "Python script failed!";
+        std::vector<float> vec_py = read_vector_from_file(py_out);
+
+        std::vector<float> vec = embedding->embed(text);
+        ASSERT_EQ(vec.size(), vec_py.size()) << "Vector size mismatch!";
+        min_sim = std::min(min_sim, cosine_similarity(vec, vec_py));
+    }
+    embedding->unload_model();
+
+    LOG_INFO << "[Cosine Similarity] " << precision_str << " min : " << min_sim;
+    EXPECT_GE(min_sim, min_similarity) << precision_str << " model drifted too far from fp32!";
+}
+
+// 每个模型单独一个用例：GTEST_SKIP 只会从辅助函数返回，同一用例中后续模型仍会运行
+TEST(EmbeddingQuantizedTest, Int8E5) {
+    run_quantized_accuracy_test("multilingual-e5-small", "resource/model/multilingual-e5-small/",
+                                text_embedding::ModelPrecision::INT8, 0.98f);
+}
+
+TEST(EmbeddingQuantizedTest, Int8BGE) {
+    run_quantized_accuracy_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/",
+                                text_embedding::ModelPrecision::INT8, 0.98f);
+}
+
+TEST(EmbeddingQuantizedTest, Fp16E5) {
+    run_quantized_accuracy_test("multilingual-e5-small", "resource/model/multilingual-e5-small/",
+                                text_embedding::ModelPrecision::FP16, 0.999f);
+}
+
+TEST(EmbeddingQuantizedTest, Fp16BGE) {
+    run_quantized_accuracy_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/",
+                                text_embedding::ModelPrecision::FP16, 0.999f);
+}
+
+std::string make_long_document(size_t repeats) {
+    std::string doc;
+    for (size_t r = 0; r < repeats; ++r) {
+        for (const auto& text : kSampleTexts) doc += text + " ";
+    }
+    return doc;
+}
+
+// 超长文本：截断与滑动窗口两种策略均应可用，且单条与批量路径结果一致
+void run_long_text_test(const std::string& model_name, const std::string& model_path) {
+    LOG_INFO << "\n=== [" << model_name << "] Long text policies ===";
+    const std::string doc = make_long_document(40);
+    const std::string short_text = kSampleTexts[0];
+
+    text_embedding::OnnxEmbeddingOptions truncate_options;
+    truncate_options.long_text.policy = text_embedding::LongTextPolicy::TRUNCATE;
+    text_embedding::OnnxRuntimeEmbedding truncating(truncate_options);
+    ASSERT_TRUE(truncating.load_model(model_path));
+    LOG_INFO << "[LongText] max length : " << truncating.max_length();
+    EXPECT_GT(truncating.max_length(), 0u);
+
+    text_embedding::OnnxEmbeddingOptions window_options;
+    window_options.long_text.policy = text_embedding::LongTextPolicy::SLIDING_WINDOW;
+    text_embedding::OnnxRuntimeEmbedding windowed(window_options);
+    ASSERT_TRUE(windowed.load_model(model_path));
+
+    std::vector<float> truncated_vec = truncating.embed(doc);
+    std::vector<float> window_vec = windowed.embed(doc);
+    ASSERT_EQ(truncated_vec.size(), window_vec.size());
+    LOG_INFO << "[LongText] truncate vs sliding window cosine : " << cosine_similarity(truncated_vec, window_vec);
+
+    auto batch_vecs = windowed.embed_batch({doc, short_text});
+    ASSERT_EQ(batch_vecs.size(), 2u);
+    EXPECT_NEAR(cosine_similarity(window_vec, batch_vecs[0]), 1.0, 0.001) << "Sliding window batch row differs!";
+
+    // 未超长的文本不受策略影响
+    EXPECT_NEAR(cosine_similarity(truncating.embed(short_text), batch_vecs[1]), 1.0, 0.001);
+
+    truncating.unload_model();
+    windowed.unload_model();
+}
+
+TEST(EmbeddingLongTextTest, CompareE5AndBGE) {
+    run_long_text_test("multilingual-e5-small",  "resource/model/multilingual-e5-small/");
+    run_long_text_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/");
+}
+
+// 从优化图缓存加载的模型输出应与直接加载 model.onnx 一致
+void run_optimized_cache_test(const std::string& model_name, const std::string& model_path) {
+    LOG_INFO << "\n=== [" << model_name << "] Optimized graph cache ===";
+    const std::string cache_dir = "out/temp/ort_cache_accuracy";
+    fs::remove_all(cache_dir);
+
+    text_embedding::OnnxRuntimeEmbedding reference;
+    ASSERT_TRUE(reference.load_model(model_path));
+    auto expected = reference.embed_batch(kSampleTexts);
+    reference.unload_model();
+
+    text_embedding::OnnxEmbeddingOptions options;
+    options.session.optimized_model_cache_dir = cache_dir;
+    options.warmup.runs = 1;
+    for (bool expect_hit : {false, true}) {
+        text_embedding::OnnxRuntimeEmbedding cached(options);
+        ASSERT_TRUE(cached.load_model(model_path));
+        EXPECT_EQ(cached.load_timings().optimized_cache_hit, expect_hit);
+
+        for (size_t i = 0; i < kSampleTexts.size(); ++i) {
+            EXPECT_NEAR(cosine_similarity(cached.embed(kSampleTexts[i]), expected[i]), 1.0, 0.001)
+                << "Cached graph differs at row " << i;
+        }
+        cached.unload_model();
+    }
+}
+
+TEST(EmbeddingOptimizedCacheTest, CompareE5AndBGE) {
+    run_optimized_cache_test("multilingual-e5-small",  "resource/model/multilingual-e5-small/");
+    run_optimized_cache_test("bge-small-zh-v1.5", "resource/model/bge-small-zh-v1.5/");
+}
+
+// 模型在原地被替换且保留了旧的修改时间（cp -p、rsync -t）时，不能命中上一个模型的优化图
+TEST(EmbeddingOptimizedCacheTest, InPlaceSwapWithPreservedMtimeMisses) {
+    const std::string first = "resource/model/multilingual-e5-small/";
+    const std::string second = "resource/model/bge-small-zh-v1.5/";
+    const std::string model_dir = "out/temp/ort_cache_swap/model/";
+    const std::string cache_dir = "out/temp/ort_cache_swap/cache";
+    fs::remove_all("out/temp/ort_cache_swap");
+    fs::create_directories(model_dir);
+    fs::copy(first, model_dir, fs::copy_options::recursive);
+
+    text_embedding::OnnxEmbeddingOptions options;
+    options.session.optimized_model_cache_dir = cache_dir;
+    {
+        text_embedding::OnnxRuntimeEmbedding cached(options);
+        ASSERT_TRUE(cached.load_model(model_dir));
+        EXPECT_FALSE(cached.load_timings().optimized_cache_hit);
+    }
+
+    const auto old_mtime = fs::last_write_time(model_dir + "model.onnx");
+    fs::copy(second, model_dir, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+    fs::last_write_time(model_dir + "model.onnx", old_mtime);
+
+    text_embedding::OnnxRuntimeEmbedding reference;
+    ASSERT_TRUE(reference.load_model(second));
+    text_embedding::OnnxRuntimeEmbedding swapped(options);
+    ASSERT_TRUE(swapped.load_model(model_dir));
+    EXPECT_FALSE(swapped.load_timings().optimized_cache_hit);
+    EXPECT_NEAR(cosine_similarity(swapped.embed(kSampleTexts[0]), reference.embed(kSampleTexts[0])), 1.0, 0.001);
+}
+
+// 推理线程持续请求的同时在 e5 与 bge 之间反复热加载：请求不报错，版本号单调递增，
+// 且每条结果都与其版本号对应模型的参考向量一致
+TEST(EmbeddingHotReloadTest, SwapE5AndBGE) {
+    const std::vector<std::string> model_paths = {"resource/model/multilingual-e5-small/",
+                                                  "resource/model/bge-small-zh-v1.5/"};
+    const std::string text = kSampleTexts.front();
+
+    std::vector<std::vector<float>> expected;
+    for (const auto& path : model_paths) {
+        text_embedding::OnnxRuntimeEmbedding reference;
+        ASSERT_TRUE(reference.load_model(path));
+        expected.push_back(reference.embed(text));
+    }
+
+    text_embedding::OnnxEmbeddingOptions options;
+    options.warmup.runs = 1;
+    text_embedding::OnnxRuntimeEmbedding model(options);
+    ASSERT_TRUE(model.load_model(model_paths[0]));
+    ASSERT_EQ(model.model_version(), 1u);
+
+    constexpr size_t kThreads = 4;
+    constexpr size_t kReloads = 6;
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> errors{0};
+    std::vector<std::vector<text_embedding::EmbeddingResult>> results(kThreads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&, t] {
+            uint64_t last_version = 0;
+            while (!stop.load()) {
+                try {
+                    auto result = model.embed_with_version(text);
+                    if (result.model_version < last_version) ++errors;
+                    last_version = result.model_version;
+                    results[t].push_back(std::move(result));
+                } catch (const std::exception& e) {
+                    LOG_ERROR << "[HotReload] embed failed: " << e.what();
+                    ++errors;
+                }
+            }
+        });
+    }
+
+    std::vector<double> reload_ms;
+    for (size_t i = 1; i <= kReloads; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        ASSERT_TRUE(model.reload_model_async(model_paths[i % 2]).get());
+        reload_ms.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count());
+        EXPECT_EQ(model.model_version(), i + 1);
+    }
+    stop = true;
+    for (auto& worker : workers) worker.join();
+
+    EXPECT_EQ(errors.load(), 0u);
+    // 版本 v 由 model_paths[(v - 1) % 2] 加载
+    size_t total = 0;
+    for (const auto& thread_results : results) {
+        for (const auto& result : thread_results) {
+            ASSERT_GE(result.model_version, 1u);
+            const auto& reference = expected[(result.model_version - 1) % 2];
+            EXPECT_NEAR(cosine_similarity(result.vector, reference), 1.0, 0.001)
+                << "Result of version " << result.model_version << " does not match its model";
+        }
+        total += thread_results.size();
+    }
+    LOG_INFO << "[HotReload] requests served: " << total << ", average reload: "
+             << std::accumulate(reload_ms.begin(), reload_ms.end(), 0.0) / reload_ms.size() << " ms";
+
+    model.unload_model();
+    EXPECT_EQ(model.model_version(), 0u);
+    EXPECT_THROW(model.embed(text), std::runtime_error);
+}
+
+// 热加载的预热与线上请求并发：补齐统计只排除预热本身，期间服务的请求一条不少
+TEST(EmbeddingHotReloadTest, PaddingStatsKeepRequestsServedDuringReload) {
+    const std::string model_path = "resource/model/multilingual-e5-small/";
+    const std::vector<std::string> texts = {kSampleTexts[0], kSampleTexts[1]};
+
+    text_embedding::OnnxEmbeddingOptions options;
+    options.warmup.runs = 2;
+    text_embedding::OnnxRuntimeEmbedding model(options);
+    ASSERT_TRUE(model.load_model(model_path));
+    EXPECT_EQ(model.padding_stats().useful_tokens, 0u) << "warm-up must not be counted";
+
+    model.embed_batch(texts);
+    const auto per_request = model.padding_stats();
+    ASSERT_GT(per_request.useful_tokens, 0u);
+    model.reset_padding_stats();
+
+    constexpr size_t kThreads = 4;
+    constexpr size_t kReloads = 4;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> served{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&] {
+            while (!stop.load()) {
+                model.embed_batch(texts);
+                ++served;
+            }
+        });
+    }
+    for (size_t i = 0; i < kReloads; ++i) {
+        ASSERT_TRUE(model.reload_model_async(model_path).get());
+    }
+    stop = true;
+    for (auto& worker : workers) worker.join();
+
+    // 同一模型重复加载，每个请求的 token 数不变
+    const auto stats = model.padding_stats();
+    EXPECT_EQ(stats.useful_tokens, served.load() * per_request.useful_tokens);
+    EXPECT_EQ(stats.computed_tokens, served.load() * per_request.computed_tokens);
+}
@@ -1,4 +1,5 @@
 #include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <mutex>
 #include <numeric>
@@ -8,6 +9,7 @@
 #include <gtest/gtest.h>
 
 #include "logger.h"
+#include "onnx_embedding.h"
 #include "text_embedding_factory.h"
 
 namespace text_embedding_benchmark {
@@ -42,7 +44,7 @@ void embedding_thread_worker(
               << "Avg latency = " << (duration.count() / repeat_times) << " ms\n";
 }
 
-void run_qps_test(
+double run_qps_test(
     const std::string& model_name,
     text_embedding::TextEmbedding* embedding,
     const std::string& text,
@@ -72,6 +74,7 @@ void run_qps_test(
     LOG_INFO << "[Summary] Total Requests: " << total_requests
               << ", Max Elapsed Time: " << total_time_ms << " ms"
               << ", QPS: " << qps << "\n";
+    return qps;
 }
 
 void run_text_embedding_benchmark() {
@@ -94,6 +97,170 @@ void run_text_embedding_benchmark() {
         run_qps_test("bge-small-zh-v1.5", bge_embedding.get(), test_text, thread_count, repeat_per_thread);
         bge_embedding->unload_model();
     }
+
+    {
+        // 多 Session 绑核：每个 Session 独占一组 CPU 核，请求路由到负载最低的 Session
+        const int cores = std::max(1u, std::thread::hardware_concurrency());
+        const int cores_per_session = std::max(1, cores / thread_count);
+
+        text_embedding::OnnxEmbeddingOptions options;
+        options.session.num_sessions = std::max(1, cores / cores_per_session);
+        for (size_t i = 0; i < options.session.num_sessions; ++i) {
+            std::vector<int> core_set;
+            for (int c = 0; c < cores_per_session; ++c) core_set.push_back(static_cast<int>(i) * cores_per_session + c);
+            options.session.core_sets.push_back(core_set);
+        }
+
+        const std::string e5_model_path = "resource/model/multilingual-e5-small/";
+        text_embedding::OnnxRuntimeEmbedding pooled_embedding(options);
+        ASSERT_TRUE(pooled_embedding.load_model(e5_model_path)) << "Failed to load E5 model.";
+        run_qps_test("multilingual-e5-small (" + std::to_string(options.session.num_sessions) + " pinned sessions)",
+                     &pooled_embedding, test_text, thread_count, repeat_per_thread);
+        pooled_embedding.unload_model();
+    }
+
+    {
+        // 量化模型相对 fp32 的吞吐提升，变体文件由 tools/quantize_onnx.py 导出
+        const std::string e5_model_path = "resource/model/multilingual-e5-small/";
+        double fp32_qps = 0.0;
+        for (auto precision : {text_embedding::ModelPrecision::FP32,
+                               text_embedding::ModelPrecision::INT8,
+                               text_embedding::ModelPrecision::FP16}) {
+            text_embedding::OnnxEmbeddingOptions options;
+            options.precision = precision;
+            text_embedding::OnnxRuntimeEmbedding embedding(options);
+            ASSERT_TRUE(embedding.load_model(e5_model_path)) << "Failed to load E5 model.";
+            if (embedding.loaded_precision() != precision) {
+                LOG_INFO << "[Precision] " << text_embedding::precision_name(precision)
+                         << " variant not exported, skipped.";
+                continue;
+            }
+
+            double qps = run_qps_test(std::string("multilingual-e5-small (") + text_embedding::precision_name(precision) + ")",
+                                      &embedding, test_text, thread_count, repeat_per_thread);
+            if (precision == text_embedding::ModelPrecision::FP32) {
+                fp32_qps = qps;
+            } else if (fp32_qps > 0.0) {
+                LOG_INFO << "[Precision] " << text_embedding::precision_name(precision)
+                         << " QPS gain vs fp32: " << qps / fp32_qps << "x";
+            }
+            embedding.unload_model();
+        }
+    }
+}
+
+// 滑动窗口下单篇文档耗时应随长度线性增长
+void run_long_text_latency_test() {
+    const std::string paragraph = "人工智能正在改变世界。The quick brown fox jumps over the lazy dog. ";
+    const std::string e5_model_path = "resource/model/multilingual-e5-small/";
+
+    text_embedding::OnnxEmbeddingOptions options;
+    options.long_text.policy = text_embedding::LongTextPolicy::SLIDING_WINDOW;
+    text_embedding::OnnxRuntimeEmbedding embedding(options);
+    ASSERT_TRUE(embedding.load_model(e5_model_path)) << "Failed to load E5 model.";
+
+    LOG_INFO << "\n========== Long text latency (sliding window, max length "
+             << embedding.max_length() << ") ==========\n";
+    std::string doc;
+    for (int repeats = 16; repeats <= 256; repeats *= 2) {
+        doc.clear();
+        for (int r = 0; r < repeats; ++r) doc += paragraph;
+
+        const int rounds = 5;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < rounds; ++i) embedding.embed(doc);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        LOG_INFO << "[LongText] " << doc.size() << " bytes : " << elapsed.count() / rounds << " ms per document";
+    }
+    embedding.unload_model();
+}
+
+// 冷启动：load_model 耗时与首个请求延迟
+void run_cold_start_test() {
+    const std::string e5_model_path = "resource/model/multilingual-e5-small/";
+    const std::string cache_dir = "out/temp/ort_cache";
+    const std::string test_text = "人工智能正在改变世界。";
+    std::filesystem::remove_all(cache_dir);
+
+    struct Scenario {
+        std::string name;
+        bool mmap_model;
+        bool use_cache;
+        size_t warmup_runs;
+    };
+    const std::vector<Scenario> scenarios = {
+        {"baseline", false, false, 0},
+        {"mmap", true, false, 0},
+        {"mmap + cache (write)", true, true, 0},
+        {"mmap + cache (hit)", true, true, 0},
+        {"mmap + cache (hit) + warmup", true, true, 1},
+    };
+
+    LOG_INFO << "\n========== Cold start [multilingual-e5-small] ==========\n";
+    for (const auto& scenario : scenarios) {
+        text_embedding::OnnxEmbeddingOptions options;
+        options.session.mmap_model = scenario.mmap_model;
+        options.session.optimized_model_cache_dir = scenario.use_cache ? cache_dir : "";
+        options.warmup.runs = scenario.warmup_runs;
+
+        text_embedding::OnnxRuntimeEmbedding embedding(options);
+        ASSERT_TRUE(embedding.load_model(e5_model_path)) << "Failed to load E5 model.";
+        auto timings = embedding.load_timings();
+
+        auto first_start = std::chrono::high_resolution_clock::now();
+        embedding.embed(test_text);
+        auto first_end = std::chrono::high_resolution_clock::now();
+        auto second_start = first_end;
+        embedding.embed(test_text);
+        auto second_end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double, std::milli> first_ms = first_end - first_start;
+        std::chrono::duration<double, std::milli> second_ms = second_end - second_start;
+        LOG_INFO << "[ColdStart] " << scenario.name
+                 << " | load: " << timings.total_ms << " ms (tokenizer " << timings.tokenizer_ms
+                 << ", sessions " << timings.session_ms << ", warmup " << timings.warmup_ms << ")"
+                 << (timings.optimized_cache_hit ? " [cache hit]" : "")
+                 << " | first request: " << first_ms.count() << " ms, second: " << second_ms.count() << " ms";
+        embedding.unload_model();
+    }
+}
+
+// 单条与批量路径的分阶段耗时，定位慢在 tokenizer、张量准备、Session::Run 还是池化
+void run_stage_breakdown_test() {
+    const std::string e5_model_path = "resource/model/multilingual-e5-small/";
+    const std::string test_text = "人工智能正在改变世界。The quick brown fox jumps over the lazy dog.";
+
+    text_embedding::OnnxRuntimeEmbedding embedding;
+    ASSERT_TRUE(embedding.load_model(e5_model_path)) << "Failed to load E5 model.";
+
+    for (size_t batch : {1, 16}) {
+        embedding.reset_stage_metrics();
+        const std::vector<std::string> texts(batch, test_text);
+        for (int i = 0; i < 100; ++i) {
+            if (batch == 1) {
+                embedding.embed(test_text);
+            } else {
+                embedding.embed_batch(texts);
+            }
+        }
+
+        const auto snapshot = embedding.stage_metrics();
+        double total_ms = 0.0;
+        for (const auto& stage : snapshot.stages) total_ms += stage.histogram.mean() * stage.histogram.count() / 1e6;
+        LOG_INFO << "\n========== Stage breakdown, batch " << batch << " ==========";
+        for (const auto& stage : snapshot.stages) {
+            const double stage_ms = stage.histogram.mean() * stage.histogram.count() / 1e6;
+            LOG_INFO << "[Stage] " << stage.name << " | n: " << stage.histogram.count()
+                     << ", p50: " << stage.histogram.percentile(50.0) / 1000.0 << " us, p99: "
+                     << stage.histogram.percentile(99.0) / 1000.0 << " us, share: "
+                     << (total_ms > 0.0 ? stage_ms / total_ms * 100.0 : 0.0) << "%";
+        }
+        EXPECT_EQ(snapshot.counter("texts"), 100 * batch);
+    }
+    LOG_DEBUG << metrics::to_prometheus(embedding.stage_metrics(), "redge_embedding");
+    embedding.unload_model();
 }
 
 } // namespace text_embedding_benchmark
@@ -102,3 +269,15 @@ void run_text_embedding_benchmark() {
 TEST(TextEmbeddingBenchmark, RunBenchmark) {
     text_embedding_benchmark::run_text_embedding_benchmark();
 }
+
+TEST(TextEmbeddingBenchmark, LongTextLatency) {
+    text_embedding_benchmark::run_long_text_latency_test();
+}
+
+TEST(TextEmbeddingBenchmark, ColdStart) {
+    text_embedding_benchmark::run_cold_start_test();
+}
+
+TEST(TextEmbeddingBenchmark, StageBreakdown) {
+    text_embedding_benchmark::run_stage_breakdown_test();
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "tokenizer_pool.h"
+
+using text_embedding::TokenizerPool;
+using text_embedding::TokenizerPoolOptions;
+
+namespace {
+
+const std::string kTokenizerFile = "resource/model/multilingual-e5-small/tokenizer.json";
+
+std::string read_blob(const std::string& path) {
+    std::ifstream file(path);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+std::vector<std::string> make_texts(size_t count) {
+    const std::vector<std::string> seeds = {
+        "你好，世界！", "OpenAI is building amazing models.", "如何前往火车站？",
+        "The quick brown fox jumps over the lazy dog.", "人工智能正在改变世界。", "Bonjour le monde!"};
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < count; ++i) {
+        texts.push_back(seeds[i % seeds.size()] + " #" + std::to_string(i));
+    }
+    return texts;
+}
+
+class TokenizerPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        blob_ = read_blob(kTokenizerFile);
+        ASSERT_FALSE(blob_.empty()) << "Missing tokenizer: " << kTokenizerFile;
+
+        TokenizerPoolOptions single;
+        single.num_instances = 1;
+        reference_ = std::make_unique<TokenizerPool>(blob_, single);
+    }
+
+    std::vector<std::vector<int32_t>> reference_encode(const std::vector<std::string>& texts) {
+        std::vector<std::vector<int32_t>> results;
+        for (const auto& text : texts) results.push_back(reference_->encode(text));
+        return results;
+    }
+
+    std::string blob_;
+    std::unique_ptr<TokenizerPool> reference_;
+};
+
+} // namespace
+
+TEST_F(TokenizerPoolTest, BatchMatchesSequentialEncode) {
+    TokenizerPoolOptions options;
+    options.num_instances = 4;
+    TokenizerPool pool(blob_, options);
+    EXPECT_EQ(pool.size(), 4u);
+
+    auto texts = make_texts(200);
+    EXPECT_EQ(pool.encode_batch(texts), reference_encode(texts));
+
+    // 低于并行阈值的小批量走串行路径
+    auto small = make_texts(3);
+    EXPECT_EQ(pool.encode_batch(small), reference_encode(small));
+    EXPECT_TRUE(pool.encode_batch({}).empty());
+    EXPECT_EQ(pool.token_to_id("</s>"), reference_->token_to_id("</s>"));
+}
+
+TEST_F(TokenizerPoolTest, ConcurrentCallersGetTheirOwnResults) {
+    TokenizerPoolOptions options;
+    options.num_instances = 3;
+    TokenizerPool pool(blob_, options);
+
+    auto texts = make_texts(64);
+    auto expected = reference_encode(texts);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 20; ++round) {
+                if ((t + round) % 2 == 0) {
+                    if (pool.encode_batch(texts) != expected) mismatches.fetch_add(1);
+                } else {
+                    size_t index = (t * 7 + round) % texts.size();
+                    if (pool.encode(texts[index]) != expected[index]) mismatches.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST_F(TokenizerPoolTest, ParallelBatchThroughput) {
+    TokenizerPool pool(blob_);
+    auto texts = make_texts(2000);
+
+    auto sequential_start = std::chrono::high_resolution_clock::now();
+    auto sequential = reference_encode(texts);
+    auto sequential_end = std::chrono::high_resolution_clock::now();
+
+    auto parallel_start = std::chrono::high_resolution_clock::now();
+    auto parallel = pool.encode_batch(texts);
+    auto parallel_end = std::chrono::high_resolution_clock::now();
+
+    EXPECT_EQ(parallel, sequential);
+    std::chrono::duration<double, std::milli> sequential_ms = sequential_end - sequential_start;
+    std::chrono::duration<double, std::milli> parallel_ms = parallel_end - parallel_start;
+    LOG_INFO << "[Tokenizer] " << texts.size() << " texts, sequential: " << sequential_ms.count()
+             << " ms, parallel (" << pool.size() << " instances): " << parallel_ms.count() << " ms";
+}
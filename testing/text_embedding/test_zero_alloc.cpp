@@ -0,0 +1,105 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "embedding_workspace.h"
+#include "logger.h"
+#include "onnx_embedding.h"
+#include "vector_math.h"
+
+// === 统计当前线程的堆分配次数 ===
+namespace {
+
+thread_local bool g_counting = false;
+thread_local size_t g_allocations = 0;
+
+struct AllocationCounter {
+    AllocationCounter() {
+        g_allocations = 0;
+        g_counting = true;
+    }
+    ~AllocationCounter() { g_counting = false; }
+
+    size_t count() const { return g_allocations; }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (g_counting) ++g_allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+TEST(ZeroAllocationTest, WorkspaceSteadyStateDoesNotAllocate) {
+    const size_t hidden_size = 384;
+    std::vector<int32_t> long_tokens(510, 7);
+    std::vector<int32_t> short_tokens(12, 9);
+    std::vector<float> pooled(hidden_size);
+
+    auto& workspace = text_embedding::thread_workspace();
+
+    // 预热：用最长输入撑开工作区容量
+    size_t seq_len = text_embedding::fill_single_input(long_tokens, 101, 102, workspace);
+    workspace.hidden_states.resize(seq_len * hidden_size, 0.5f);
+
+    size_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < 1000; ++i) {
+            const auto& tokens = (i % 2 == 0) ? short_tokens : long_tokens;
+            seq_len = text_embedding::fill_single_input(tokens, 101, 102, workspace);
+            workspace.hidden_states.resize(seq_len * hidden_size);
+            vector_math::masked_mean_pooling(workspace.hidden_states.data(), workspace.attention_mask.data(),
+                                             seq_len, hidden_size, pooled.data());
+            vector_math::l2_normalize(pooled.data(), hidden_size);
+        }
+        allocations = counter.count();
+    }
+
+    EXPECT_EQ(allocations, 0u) << "Steady-state buffer preparation must not touch the heap";
+}
+
+TEST(ZeroAllocationTest, EmbedIntoAllocatesLessThanEmbed) {
+    const std::string model_path = "resource/model/multilingual-e5-small/";
+    const std::string text = "人工智能正在改变世界。";
+    const int rounds = 100;
+
+    text_embedding::OnnxRuntimeEmbedding embedding;
+    ASSERT_TRUE(embedding.load_model(model_path));
+    ASSERT_GT(embedding.dimension(), 0u);
+
+    std::vector<float> row(embedding.dimension());
+    for (int i = 0; i < 10; ++i) {
+        embedding.embed_into(text, row.data(), row.size());
+        embedding.embed(text);
+    }
+
+    size_t embed_into_allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < rounds; ++i) embedding.embed_into(text, row.data(), row.size());
+        embed_into_allocations = counter.count();
+    }
+
+    size_t embed_allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < rounds; ++i) embedding.embed(text);
+        embed_allocations = counter.count();
+    }
+
+    // 剩余的分配来自 tokenizer 与 ORT 内部（OrtValue、IoBinding、执行帧），不在本库可控范围内
+    LOG_INFO << "[Allocations] embed_into: " << (double)embed_into_allocations / rounds
+             << " per request, embed: " << (double)embed_allocations / rounds << " per request";
+    EXPECT_LT(embed_into_allocations, embed_allocations);
+
+    embedding.unload_model();
+}
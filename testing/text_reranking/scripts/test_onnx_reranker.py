@@ -0,0 +1,58 @@
+import sys
+import numpy as np
+from transformers import PreTrainedTokenizerFast
+import onnxruntime as ort
+import os
+
+# ========== DEBUG 控制 ==========
+DEBUG = os.getenv("DEBUG", "0") == "1"
+
+def debug_print(*args, **kwargs):
+    if DEBUG:
+        print("[Debug]", *args, **kwargs)
+
+# ========== 参数读取 ==========
+model_dir = sys.argv[1]
+query = sys.argv[2]
+# 候选文件：每行一个 passage
+passages_path = sys.argv[3]
+output_path = sys.argv[4]
+max_length = int(sys.argv[5]) if len(sys.argv) > 5 else 512
+model_file = sys.argv[6] if len(sys.argv) > 6 else "model.onnx"
+
+with open(passages_path, encoding="utf-8") as f:
+    passages = [line.rstrip("\n") for line in f if line.strip()]
+
+# ========== 加载分词器 ==========
+tokenizer = PreTrainedTokenizerFast(tokenizer_file=os.path.join(model_dir, "tokenizer.json"))
+if tokenizer.pad_token is None:
+    for token in ("[PAD]", "<pad>"):
+        if token in tokenizer.get_vocab():
+            tokenizer.pad_token = token
+            break
+
+# ========== 加载 ONNX 模型 ==========
+session = ort.InferenceSession(os.path.join(model_dir, model_file))
+input_names = [i.name for i in session.get_inputs()]
+output_names = [o.name for o in session.get_outputs()]
+output_name = "logits" if "logits" in output_names else output_names[0]
+debug_print("Inputs:", input_names, "Output:", output_name)
+
+# ========== 编码句对 ==========
+# 与 C++ 实现一致：只截断 passage
+inputs = tokenizer([query] * len(passages), passages, return_tensors="np", padding=True,
+                   truncation="only_second", max_length=max_length)
+feed = {name: inputs[name].astype(np.int64) for name in input_names if name in inputs}
+if "token_type_ids" in input_names and "token_type_ids" not in feed:
+    feed["token_type_ids"] = np.zeros_like(feed["input_ids"])
+debug_print("PY input_ids:", feed["input_ids"])
+
+# ========== 模型推理 ==========
+logits = session.run([output_name], feed)[0]
+logits = logits.reshape(len(passages), -1)
+scores = logits[:, -1]
+debug_print("Scores:", scores)
+
+# ========== 保存分数 ==========
+os.makedirs(os.path.dirname(output_path), exist_ok=True)
+np.savetxt(output_path, scores)
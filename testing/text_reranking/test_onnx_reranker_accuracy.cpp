@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <limits.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "onnx_reranker.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<float> read_scores_from_file(const std::string& filename) {
+    std::vector<float> scores;
+    std::ifstream in(filename);
+    float value;
+    while (in >> value) scores.push_back(value);
+    return scores;
+}
+
+std::string get_binary_dir() {
+    char result[PATH_MAX];
+    ssize_t count = readlink("/proc/self/exe", result, PATH_MAX);
+    if (count != -1) {
+        return fs::path(std::string(result, count)).parent_path().string();
+    }
+    return "./";
+}
+
+const std::string kQuery = "如何前往火车站？";
+
+const std::vector<std::string> kPassages = {
+    "从这里步行十分钟即可到达火车站，沿主街一直向北走。",
+    "乘坐地铁二号线在火车站站下车，出站即是售票大厅。",
+    "今天天气不错，适合去公园散步。",
+    "The train station is ten minutes away on foot, head north along the main street.",
+    "Bus 12 stops right in front of the central railway station.",
+    "人工智能正在改变世界。",
+    "The quick brown fox jumps over the lazy dog.",
+    "火车站附近有很多餐馆和酒店，价格适中。",
+};
+
+const std::vector<std::pair<std::string, std::string>> kModels = {
+    {"bge-reranker-base", "resource/model/bge-reranker-base/"},            // XLM-R：<s> q </s></s> p </s>
+    {"ms-marco-MiniLM-L-6-v2", "resource/model/ms-marco-MiniLM-L-6-v2/"},  // BERT：带 token_type_ids
+};
+
+} // namespace
+
+// 逐条分数与 Python（transformers + onnxruntime）一致
+void run_reranker_accuracy_test(const std::string& model_name, const std::string& model_path) {
+    LOG_INFO << "\n=== [" << model_name << "] Reranker accuracy on " << kPassages.size() << " passages ===";
+
+    text_reranking::OnnxRuntimeReranker reranker;
+    ASSERT_TRUE(reranker.load_model(model_path));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<float> scores = reranker.score(kQuery, kPassages);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    LOG_INFO << "[Profiling] score elapsed : " << elapsed.count() << " ms, session runs: " << reranker.session_runs();
+
+    const std::string passages_file = "out/temp/rerank_passages_" + model_name + ".txt";
+    const std::string py_out = "out/temp/rerank_py_" + model_name + ".txt";
+    fs::create_directories("out/temp");
+    {
+        std::ofstream out(passages_file);
+        for (const auto& passage : kPassages) out << passage << "\n";
+    }
+
+    std::string script_path = get_binary_dir() + "/scripts/test_onnx_reranker.py";
+    std::string cmd = "python3 \"" + script_path + "\" \"" + model_path + "\" \"" + kQuery + "\" \"" +
+                      passages_file + "\" \"" + py_out + "\" " + std::to_string(reranker.max_length());
+    int ret = std::system(cmd.c_str());
+    ASSERT_EQ(ret, 0) << "Python script failed!";
+
+    std::vector<float> py_scores = read_scores_from_file(py_out);
+    ASSERT_EQ(scores.size(), py_scores.size()) << "Score count mismatch!";
+    for (size_t i = 0; i < scores.size(); ++i) {
+        LOG_INFO << "[Score] " << i << ": cpp " << scores[i] << ", py " << py_scores[i];
+        EXPECT_NEAR(scores[i], py_scores[i], 1e-2f * std::max(1.0f, std::fabs(py_scores[i]))) << "Passage " << i;
+    }
+
+    // 与 Python 的排序一致
+    auto cpp_top = text_reranking::select_top_k(scores, scores.size(), 3);
+    auto py_top = text_reranking::select_top_k(py_scores, py_scores.size(), 3);
+    for (size_t i = 0; i < cpp_top.size(); ++i) EXPECT_EQ(cpp_top[i].index, py_top[i].index);
+
+    reranker.unload_model();
+}
+
+TEST(RerankerAccuracyTest, CompareWithPython) {
+    for (const auto& [name, path] : kModels) run_reranker_accuracy_test(name, path);
+}
+
+// 批量打分（补齐、分桶）的每一项应与单条打分一致；early cut 的 top-k 与全量一致
+TEST(RerankerAccuracyTest, BatchAndEarlyCutConsistency) {
+    for (const auto& [name, path] : kModels) {
+        LOG_INFO << "\n=== [" << name << "] Batch / early cut consistency ===";
+        text_reranking::OnnxRerankerOptions options;
+        options.bucketing.max_batch_size = 3;
+        text_reranking::OnnxRuntimeReranker reranker(options);
+        ASSERT_TRUE(reranker.load_model(path));
+
+        auto batch_scores = reranker.score(kQuery, kPassages);
+        for (size_t i = 0; i < kPassages.size(); ++i) {
+            auto single = reranker.score(kQuery, {kPassages[i]});
+            EXPECT_NEAR(single[0], batch_scores[i], 1e-3f * std::max(1.0f, std::fabs(single[0]))) << "Passage " << i;
+        }
+        LOG_INFO << "[Padding] efficiency : " << reranker.padding_stats().efficiency();
+
+        text_reranking::OnnxRerankerOptions cut_options;
+        cut_options.early_cut.enabled = true;
+        cut_options.early_cut.first_stage = 4;
+        cut_options.early_cut.stage_size = 2;
+        text_reranking::OnnxRuntimeReranker cut_reranker(cut_options);
+        ASSERT_TRUE(cut_reranker.load_model(path));
+
+        text_reranking::RerankStats stats;
+        auto cut = cut_reranker.rerank(kQuery, kPassages, 2, &stats);
+        auto full = reranker.rerank(kQuery, kPassages, 2);
+        LOG_INFO << "[EarlyCut] scored " << stats.scored << "/" << stats.candidates << " in " << stats.stages << " stages";
+        ASSERT_EQ(cut.size(), full.size());
+        for (size_t i = 0; i < cut.size(); ++i) EXPECT_EQ(cut[i].index, full[i].index);
+    }
+}
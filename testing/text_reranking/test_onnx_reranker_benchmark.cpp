@@ -0,0 +1,102 @@
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "onnx_reranker.h"
+
+namespace text_reranking_benchmark {
+
+using Clock = std::chrono::high_resolution_clock;
+
+const std::string kModelPath = "resource/model/bge-reranker-base/";
+const std::string kQuery = "如何前往火车站？";
+
+// 构造 n 个长度不一的候选，模拟召回阶段的 top-N
+std::vector<std::string> make_candidates(size_t n) {
+    const std::vector<std::string> sentences = {
+        "从这里步行十分钟即可到达火车站，沿主街一直向北走。",
+        "The quick brown fox jumps over the lazy dog.",
+        "人工智能正在改变世界。",
+        "Bus 12 stops right in front of the central railway station.",
+    };
+    std::vector<std::string> candidates;
+    for (size_t i = 0; i < n; ++i) {
+        std::string text;
+        for (size_t r = 0; r <= i % 6; ++r) text += sentences[(i + r) % sentences.size()];
+        candidates.push_back(text);
+    }
+    return candidates;
+}
+
+// 每个请求为 top-N 候选重排，QPS 以请求计
+double run_qps_test(const std::string& name, text_reranking::OnnxRuntimeReranker& reranker,
+                    const std::vector<std::string>& candidates, size_t top_k, int thread_num, int repeat_per_thread) {
+    const uint64_t runs_before = reranker.session_runs();
+    std::vector<std::thread> threads;
+    std::vector<size_t> scored(thread_num, 0);
+
+    auto start = Clock::now();
+    for (int t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < repeat_per_thread; ++i) {
+                text_reranking::RerankStats stats;
+                reranker.rerank(kQuery, candidates, top_k, &stats);
+                scored[t] += stats.scored;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+    const int requests = thread_num * repeat_per_thread;
+    size_t total_scored = 0;
+    for (size_t s : scored) total_scored += s;
+    const double qps = requests * 1000.0 / elapsed.count();
+    LOG_INFO << "[Summary] " << name << " | top-" << candidates.size() << " -> " << top_k << ", " << thread_num
+             << " threads: QPS " << qps << ", avg latency " << elapsed.count() * thread_num / requests
+             << " ms, session runs per request " << static_cast<double>(reranker.session_runs() - runs_before) / requests
+             << ", pairs scored per request " << static_cast<double>(total_scored) / requests;
+    return qps;
+}
+
+void run_reranker_benchmark() {
+    const int thread_count = 4;
+    const int repeat_per_thread = 10;
+
+    for (size_t n : {20, 50, 100}) {
+        const auto candidates = make_candidates(n);
+
+        text_reranking::OnnxRerankerOptions options;
+        options.warmup_runs = 1;
+        text_reranking::OnnxRuntimeReranker reranker(options);
+        ASSERT_TRUE(reranker.load_model(kModelPath)) << "Failed to load reranker model.";
+        LOG_INFO << "\n========== Reranking top-" << n << " candidates ==========\n";
+        double full_qps = run_qps_test("full", reranker, candidates, 10, thread_count, repeat_per_thread);
+
+        // 逐条打分：每个候选一次 Session::Run
+        text_reranking::OnnxRerankerOptions single_options = options;
+        single_options.bucketing.max_batch_size = 1;
+        text_reranking::OnnxRuntimeReranker single(single_options);
+        ASSERT_TRUE(single.load_model(kModelPath));
+        double single_qps = run_qps_test("unbatched", single, candidates, 10, thread_count, repeat_per_thread);
+        LOG_INFO << "[Batching] QPS gain vs unbatched: " << full_qps / single_qps << "x";
+
+        text_reranking::OnnxRerankerOptions cut_options = options;
+        cut_options.early_cut.enabled = true;
+        text_reranking::OnnxRuntimeReranker cut(cut_options);
+        ASSERT_TRUE(cut.load_model(kModelPath));
+        double cut_qps = run_qps_test("early cut", cut, candidates, 10, thread_count, repeat_per_thread);
+        LOG_INFO << "[EarlyCut] QPS gain vs full: " << cut_qps / full_qps << "x";
+    }
+}
+
+} // namespace text_reranking_benchmark
+
+// GTest 测试用例
+TEST(TextRerankingBenchmark, QpsWithBatchingAndEarlyCut) {
+    text_reranking_benchmark::run_reranker_benchmark();
+}
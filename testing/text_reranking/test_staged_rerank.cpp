@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pair_encoding.h"
+#include "staged_rerank.h"
+
+using text_reranking::EarlyCutOptions;
+using text_reranking::PairTemplate;
+using text_reranking::RerankStats;
+
+namespace {
+
+PairTemplate bert_template() {
+    PairTemplate tpl;
+    tpl.bos = 101;  // [CLS]
+    tpl.eos = 102;  // [SEP]
+    return tpl;
+}
+
+PairTemplate roberta_template() {
+    PairTemplate tpl;
+    tpl.bos = 0;  // <s>
+    tpl.eos = 2;  // </s>
+    tpl.double_separator = true;
+    return tpl;
+}
+
+// 候选分数按召回名次递减，加上少量扰动
+std::vector<float> retrieval_ordered_scores(size_t count) {
+    std::vector<float> scores(count);
+    for (size_t i = 0; i < count; ++i) scores[i] = 100.0f - static_cast<float>(i) + ((i % 3 == 1) ? 1.5f : 0.0f);
+    return scores;
+}
+
+} // namespace
+
+TEST(PairEncodingTest, BertTemplateWithTokenTypes) {
+    auto row = text_reranking::build_pair_row({7, 8}, {20, 21, 22}, bert_template(), 512, 64);
+    EXPECT_EQ(row.input_ids, (std::vector<int64_t>{101, 7, 8, 102, 20, 21, 22, 102}));
+    EXPECT_EQ(row.token_type_ids, (std::vector<int64_t>{0, 0, 0, 0, 1, 1, 1, 1}));
+}
+
+TEST(PairEncodingTest, RobertaTemplateUsesDoubleSeparator) {
+    auto row = text_reranking::build_pair_row({7}, {20, 21}, roberta_template(), 512, 64);
+    EXPECT_EQ(row.input_ids, (std::vector<int64_t>{0, 7, 2, 2, 20, 21, 2}));
+    EXPECT_EQ(row.token_type_ids, std::vector<int64_t>(7, 0));
+}
+
+TEST(PairEncodingTest, TruncatesPassageThenQuery) {
+    std::vector<int32_t> query(10, 7);
+    std::vector<int32_t> passage(100, 20);
+
+    // only_second：总长不超过 max_length，query 保持完整
+    auto row = text_reranking::build_pair_row(query, passage, bert_template(), 32, 0);
+    EXPECT_EQ(row.input_ids.size(), 32u);
+    EXPECT_EQ(std::count(row.input_ids.begin(), row.input_ids.end(), 7), 10);
+    EXPECT_EQ(row.input_ids.back(), 102);
+
+    // 超长 query 先截断到 max_query_tokens
+    row = text_reranking::build_pair_row(std::vector<int32_t>(50, 7), passage, bert_template(), 32, 8);
+    EXPECT_EQ(std::count(row.input_ids.begin(), row.input_ids.end(), 7), 8);
+    EXPECT_EQ(row.input_ids.size(), 32u);
+
+    // 不限制 query 时也至少为 passage 留一个 token
+    row = text_reranking::build_pair_row(std::vector<int32_t>(50, 7), passage, roberta_template(), 16, 0);
+    EXPECT_EQ(row.input_ids.size(), 16u);
+    EXPECT_EQ(std::count(row.input_ids.begin(), row.input_ids.end(), 20), 1);
+
+    EXPECT_THROW(text_reranking::build_pair_row(query, passage, bert_template(), 4, 0), std::invalid_argument);
+}
+
+TEST(PairEncodingTest, PairScoreUsesPositiveMinusNegativeLogit) {
+    // 单列 logits 直接作为分数
+    const float single[] = {1.5f};
+    EXPECT_FLOAT_EQ(text_reranking::pair_score(single, 1, false), 1.5f);
+
+    // 二分类 [batch, 2]：a 的正类 logit 更大，但 softmax 正类概率 b 更高
+    const float logits[] = {5.0f, 3.0f,    // a: p = sigmoid(-2)
+                            -4.0f, 1.0f};  // b: p = sigmoid(5)
+    const float a = text_reranking::pair_score(logits, 2, false);
+    const float b = text_reranking::pair_score(logits + 2, 2, false);
+    EXPECT_FLOAT_EQ(a, -2.0f);
+    EXPECT_FLOAT_EQ(b, 5.0f);
+    EXPECT_GT(b, a);
+
+    // sigmoid(l1 - l0) 等于 softmax 的正类概率
+    const float p = text_reranking::pair_score(logits + 2, 2, true);
+    EXPECT_NEAR(p, std::exp(1.0f) / (std::exp(-4.0f) + std::exp(1.0f)), 1e-6);
+}
+
+TEST(StagedRerankTest, SelectTopKIsStable) {
+    auto top = text_reranking::select_top_k({1.0f, 3.0f, 3.0f, 2.0f}, 4, 3);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0].index, 1u);
+    EXPECT_EQ(top[1].index, 2u);
+    EXPECT_EQ(top[2].index, 3u);
+    EXPECT_EQ(text_reranking::select_top_k({1.0f}, 1, 5).size(), 1u);
+}
+
+TEST(StagedRerankTest, DisabledScoresEverythingInOneStage) {
+    const auto truth = retrieval_ordered_scores(100);
+    size_t calls = 0;
+    RerankStats stats;
+    auto results = text_reranking::staged_rerank(
+        truth.size(), 5, EarlyCutOptions{},
+        [&](size_t begin, size_t end, std::vector<float>& scores) {
+            ++calls;
+            std::copy(truth.begin() + begin, truth.begin() + end, scores.begin() + begin);
+        },
+        &stats);
+
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(stats.scored, 100u);
+    EXPECT_EQ(stats.stages, 1u);
+    ASSERT_EQ(results.size(), 5u);
+    EXPECT_EQ(results[0].index, 1u);
+}
+
+TEST(StagedRerankTest, EarlyCutStopsOnceTopKIsStable) {
+    const auto truth = retrieval_ordered_scores(200);
+    EarlyCutOptions options;
+    options.enabled = true;
+    options.stage_size = 10;
+    options.patience = 2;
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    RerankStats stats;
+    auto results = text_reranking::staged_rerank(
+        truth.size(), 5, options,
+        [&](size_t begin, size_t end, std::vector<float>& scores) {
+            ranges.emplace_back(begin, end);
+            std::copy(truth.begin() + begin, truth.begin() + end, scores.begin() + begin);
+        },
+        &stats);
+
+    // 首阶段 max(2 * 5, 10) = 10 个，之后两个阶段 top-5 不变即停止
+    ASSERT_EQ(ranges.size(), 3u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].second, 10u);
+    EXPECT_EQ(ranges[2].second, 30u);
+    EXPECT_EQ(stats.scored, 30u);
+    EXPECT_EQ(stats.stages, 3u);
+    EXPECT_EQ(stats.candidates, 200u);
+
+    // 与全量打分的 top-k 一致
+    auto full = text_reranking::select_top_k(truth, truth.size(), 5);
+    ASSERT_EQ(results.size(), full.size());
+    for (size_t i = 0; i < full.size(); ++i) EXPECT_EQ(results[i].index, full[i].index);
+}
+
+TEST(StagedRerankTest, EarlyCutKeepsScoringWhileTopKChanges) {
+    // 越靠后的候选分数越高：top-k 每个阶段都在变，必须打完全部候选
+    std::vector<float> truth(64);
+    for (size_t i = 0; i < truth.size(); ++i) truth[i] = static_cast<float>(i);
+    EarlyCutOptions options;
+    options.enabled = true;
+    options.stage_size = 8;
+
+    RerankStats stats;
+    auto results = text_reranking::staged_rerank(
+        truth.size(), 3, options,
+        [&](size_t begin, size_t end, std::vector<float>& scores) {
+            std::copy(truth.begin() + begin, truth.begin() + end, scores.begin() + begin);
+        },
+        &stats);
+
+    EXPECT_EQ(stats.scored, 64u);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].index, 63u);
+}
+
+TEST(StagedRerankTest, EmptyInputs) {
+    auto fail = [](size_t, size_t, std::vector<float>&) { FAIL() << "should not score"; };
+    EXPECT_TRUE(text_reranking::staged_rerank(0, 5, EarlyCutOptions{}, fail).empty());
+    EXPECT_TRUE(text_reranking::staged_rerank(10, 0, EarlyCutOptions{}, fail).empty());
+}
@@ -0,0 +1,159 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "vector_math.h"
+
+namespace {
+
+std::vector<float> random_vector(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto& x : v) x = dist(rng);
+    return v;
+}
+
+} // namespace
+
+// 覆盖整块、尾部与极短长度
+class VectorMathTest : public ::testing::TestWithParam<size_t> {};
+
+TEST_P(VectorMathTest, DotAndCosineMatchScalar) {
+    size_t dim = GetParam();
+    std::mt19937 rng(static_cast<unsigned>(dim));
+    auto a = random_vector(dim, rng);
+    auto b = random_vector(dim, rng);
+
+    float tolerance = 1e-4f * std::max<size_t>(dim, 1);
+    EXPECT_NEAR(vector_math::dot(a.data(), b.data(), dim), vector_math::scalar::dot(a.data(), b.data(), dim), tolerance);
+    EXPECT_NEAR(vector_math::cosine(a.data(), b.data(), dim),
+                vector_math::scalar::cosine(a.data(), b.data(), dim), 1e-4f);
+}
+
+TEST_P(VectorMathTest, NormalizeProducesUnitVector) {
+    size_t dim = GetParam();
+    std::mt19937 rng(static_cast<unsigned>(dim) + 1);
+    auto v = random_vector(dim, rng);
+    auto expected = v;
+
+    vector_math::l2_normalize(v.data(), dim);
+    vector_math::scalar::l2_normalize(expected.data(), dim);
+
+    EXPECT_NEAR(vector_math::l2_norm(v.data(), dim), 1.0f, 1e-4f);
+    for (size_t i = 0; i < dim; ++i) EXPECT_NEAR(v[i], expected[i], 1e-5f);
+}
+
+TEST_P(VectorMathTest, MaskedMeanPoolingMatchesScalar) {
+    size_t dim = GetParam();
+    const size_t seq_len = 13;
+    std::mt19937 rng(static_cast<unsigned>(dim) + 2);
+    auto hidden = random_vector(seq_len * dim, rng);
+    std::vector<int64_t> mask(seq_len, 1);
+    for (size_t i = 9; i < seq_len; ++i) mask[i] = 0;  // 模拟补齐位置
+
+    std::vector<float> out(dim), expected(dim);
+    vector_math::masked_mean_pooling(hidden.data(), mask.data(), seq_len, dim, out.data());
+    vector_math::scalar::masked_mean_pooling(hidden.data(), mask.data(), seq_len, dim, expected.data());
+    for (size_t i = 0; i < dim; ++i) EXPECT_NEAR(out[i], expected[i], 1e-5f);
+}
+
+TEST_P(VectorMathTest, DotManyMatchesScalar) {
+    size_t dim = GetParam();
+    const size_t rows = 37;
+    std::mt19937 rng(static_cast<unsigned>(dim) + 3);
+    auto query = random_vector(dim, rng);
+    auto matrix = random_vector(rows * dim, rng);
+
+    std::vector<float> scores(rows), expected(rows);
+    vector_math::dot_many(query.data(), matrix.data(), rows, dim, scores.data());
+    vector_math::scalar::dot_many(query.data(), matrix.data(), rows, dim, expected.data());
+    for (size_t r = 0; r < rows; ++r) EXPECT_NEAR(scores[r], expected[r], 1e-4f * std::max<size_t>(dim, 1));
+}
+
+TEST_P(VectorMathTest, Int8DotMatchesScalar) {
+    size_t dim = GetParam();
+    std::mt19937 rng(static_cast<unsigned>(dim) + 4);
+    std::uniform_int_distribution<int> dist(-127, 127);
+    std::vector<int8_t> a(dim), b(dim);
+    for (size_t i = 0; i < dim; ++i) {
+        a[i] = static_cast<int8_t>(dist(rng));
+        b[i] = static_cast<int8_t>(dist(rng));
+    }
+    EXPECT_EQ(vector_math::dot_int8(a.data(), b.data(), dim), vector_math::scalar::dot_int8(a.data(), b.data(), dim));
+}
+
+TEST_P(VectorMathTest, HammingMatchesScalar) {
+    size_t words = GetParam();
+    std::mt19937_64 rng(words);
+    std::vector<uint64_t> a(words), b(words);
+    for (size_t i = 0; i < words; ++i) {
+        a[i] = rng();
+        b[i] = rng();
+    }
+    EXPECT_EQ(vector_math::hamming(a.data(), b.data(), words), vector_math::scalar::hamming(a.data(), b.data(), words));
+    EXPECT_EQ(vector_math::hamming(a.data(), a.data(), words), 0u);
+}
+
+TEST_P(VectorMathTest, Fp16ConversionMatchesScalar) {
+    size_t dim = GetParam();
+    std::mt19937 rng(static_cast<unsigned>(dim) + 5);
+    auto v = random_vector(dim, rng);
+
+    std::vector<uint16_t> half(dim), expected_half(dim);
+    vector_math::fp32_to_fp16(v.data(), half.data(), dim);
+    vector_math::scalar::fp32_to_fp16(v.data(), expected_half.data(), dim);
+    EXPECT_EQ(half, expected_half);
+
+    std::vector<float> restored(dim), expected_restored(dim);
+    vector_math::fp16_to_fp32(half.data(), restored.data(), dim);
+    vector_math::scalar::fp16_to_fp32(half.data(), expected_restored.data(), dim);
+    for (size_t i = 0; i < dim; ++i) {
+        EXPECT_EQ(restored[i], expected_restored[i]);
+        EXPECT_NEAR(restored[i], v[i], 1e-3f);  // 半精度 10 位尾数，[-1, 1] 内误差不超过 2^-11
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Dimensions,
+    VectorMathTest,
+    ::testing::Values(1, 3, 8, 15, 16, 31, 33, 100, 384, 512, 1024)
+);
+
+TEST(VectorMathTest, Fp16HandlesSpecialValues) {
+    const std::vector<float> values = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 1e6f, -1e6f,
+                                       6.0e-8f, 1.0e-5f, 1.0e-10f, INFINITY, -INFINITY};
+    std::vector<uint16_t> half(values.size());
+    vector_math::scalar::fp32_to_fp16(values.data(), half.data(), values.size());
+    EXPECT_EQ(half[0], 0x0000);
+    EXPECT_EQ(half[1], 0x8000);
+    EXPECT_EQ(half[2], 0x3c00);
+    EXPECT_EQ(half[3], 0xc100);
+    EXPECT_EQ(half[4], 0x7bff);  // 半精度最大有限值
+    EXPECT_EQ(half[5], 0x7c00);  // 上溢为 +Inf
+    EXPECT_EQ(half[6], 0xfc00);
+    EXPECT_EQ(half[7], 0x0001);  // 最小非规格化数
+    EXPECT_EQ(half[9], 0x0000);  // 下溢为 0
+    EXPECT_EQ(half[10], 0x7c00);
+    EXPECT_EQ(half[11], 0xfc00);
+
+    std::vector<float> restored(values.size());
+    vector_math::scalar::fp16_to_fp32(half.data(), restored.data(), half.size());
+    EXPECT_NEAR(restored[8], 1.0e-5f, 1e-7f);
+
+    uint16_t nan_half = 0;
+    float nan_value = NAN;
+    vector_math::scalar::fp32_to_fp16(&nan_value, &nan_half, 1);
+    float nan_restored = 0.0f;
+    vector_math::scalar::fp16_to_fp32(&nan_half, &nan_restored, 1);
+    EXPECT_TRUE(std::isnan(nan_restored));
+}
+
+TEST(VectorMathTest, ReportsActiveIsa) {
+    LOG_INFO << "[VectorMath] Active ISA: " << vector_math::isa_name(vector_math::active_isa());
+    std::vector<float> zero(16, 0.0f);
+    vector_math::l2_normalize(zero.data(), zero.size());
+    for (float v : zero) EXPECT_EQ(v, 0.0f);
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logger.h"
+#include "vector_math.h"
+
+namespace vector_math_benchmark {
+
+// 防止编译器把被测调用优化掉
+volatile float g_sink = 0.0f;
+
+double time_ns_per_call(const std::function<void()>& fn, int iterations) {
+    for (int i = 0; i < iterations / 10 + 1; ++i) fn();  // 预热
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void report(const std::string& name, double scalar_ns, double simd_ns) {
+    LOG_INFO << "[VectorMath][" << name << "] scalar: " << scalar_ns << " ns, "
+             << vector_math::isa_name(vector_math::active_isa()) << ": " << simd_ns
+             << " ns, speedup: " << (scalar_ns / simd_ns) << "x";
+}
+
+void run_vector_math_benchmark(size_t dim) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    auto random_vector = [&](size_t n) {
+        std::vector<float> v(n);
+        for (auto& x : v) x = dist(rng);
+        return v;
+    };
+
+    const size_t seq_len = 128;
+    const size_t rows = 4096;
+    auto a = random_vector(dim);
+    auto b = random_vector(dim);
+    auto hidden = random_vector(seq_len * dim);
+    auto matrix = random_vector(rows * dim);
+    std::vector<int64_t> mask(seq_len, 1);
+    std::vector<float> out(dim), scores(rows);
+
+    LOG_INFO << "\n========== vector_math kernels, dim = " << dim << " ==========";
+
+    report("dot",
+           time_ns_per_call([&] { g_sink = vector_math::scalar::dot(a.data(), b.data(), dim); }, 200000),
+           time_ns_per_call([&] { g_sink = vector_math::dot(a.data(), b.data(), dim); }, 200000));
+
+    report("l2_normalize",
+           time_ns_per_call([&] { vector_math::scalar::l2_normalize(a.data(), dim); }, 200000),
+           time_ns_per_call([&] { vector_math::l2_normalize(a.data(), dim); }, 200000));
+
+    report("masked_mean_pooling(seq=128)",
+           time_ns_per_call([&] {
+               vector_math::scalar::masked_mean_pooling(hidden.data(), mask.data(), seq_len, dim, out.data());
+           }, 2000),
+           time_ns_per_call([&] {
+               vector_math::masked_mean_pooling(hidden.data(), mask.data(), seq_len, dim, out.data());
+           }, 2000));
+
+    report("dot_many(rows=4096)",
+           time_ns_per_call([&] {
+               vector_math::scalar::dot_many(a.data(), matrix.data(), rows, dim, scores.data());
+           }, 200),
+           time_ns_per_call([&] {
+               vector_math::dot_many(a.data(), matrix.data(), rows, dim, scores.data());
+           }, 200));
+}
+
+} // namespace vector_math_benchmark
+
+// GTest 测试用例
+TEST(VectorMathBenchmark, RunBenchmark) {
+    vector_math_benchmark::run_vector_math_benchmark(384);
+    vector_math_benchmark::run_vector_math_benchmark(512);
+}
@@ -96,13 +96,26 @@ if [ ! -d "$SQLITE_INSTALL_SUBDIR" ]; then
     mkdir -p build && cd build
     ../configure --prefix="$SQLITE_INSTALL_SUBDIR" \
         --disable-tcl \
-        CFLAGS="-DSQLITE_ENABLE_VECTOR"
+        --enable-fts5 \
+        CFLAGS="-DSQLITE_ENABLE_VECTOR -DSQLITE_ENABLE_FTS5"
     make -j$(nproc)
     make install
     popd
     echo "[INFO] SQLite installed to $SQLITE_INSTALL_SUBDIR"
 fi
 
+# =====================================
+# Install hnswlib (header-only)
+# =====================================
+HNSWLIB_INSTALL_SUBDIR="$INSTALL_DIR/hnswlib"
+if [ ! -d "$HNSWLIB_INSTALL_SUBDIR" ]; then
+    echo "[INFO] Installing hnswlib headers..."
+    HNSWLIB_SRC_DIR="$(dirname "$0")/hnswlib"
+    mkdir -p "$HNSWLIB_INSTALL_SUBDIR/include/hnswlib"
+    cp "$HNSWLIB_SRC_DIR/hnswlib/"*.h "$HNSWLIB_INSTALL_SUBDIR/include/hnswlib/"
+    echo "[INFO] hnswlib installed to $HNSWLIB_INSTALL_SUBDIR"
+fi
+
 # =====================================
 # Build cppjieba
 # =====================================
@@ -188,7 +201,7 @@ echo "[INFO] Merging all headers and libraries to ${INSTALL_DIR}/include and lib
 mkdir -p "$INSTALL_DIR/include"
 mkdir -p "$INSTALL_DIR/lib"
 
-for SUB in glog llama.cpp googletest onnxruntime sqlite cppjieba tokenizers-cpp; do
+for SUB in glog llama.cpp googletest onnxruntime sqlite hnswlib cppjieba tokenizers-cpp; do
     SUB_DIR="$INSTALL_DIR/$SUB"
     echo "[INFO] === Merging for $SUB ==="
 
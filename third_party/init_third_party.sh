@@ -12,6 +12,7 @@ declare -A repos=(
     ["sqlite"]="https://github.com/sqlite/sqlite.git"
     ["tokenizers-cpp"]="https://github.com/mlc-ai/tokenizers-cpp.git"
     ["glog"]="git@github.com:google/glog.git"
+    ["hnswlib"]="https://github.com/nmslib/hnswlib.git -b v0.8.0"
     ["googletest"]="https://github.com/google/googletest.git -b v1.16.0"
 )
 
@@ -23,7 +24,8 @@ for name in "${!repos[@]}"; do
         echo "==> $name 已存在，跳过..."
     else
         echo "==> 克隆 $name ..."
-        git clone "$url" "$path"
+        # url 中可带 -b <tag>，需按空格拆分
+        git clone $url "$path"
     fi
 done
 
@@ -0,0 +1,136 @@
+import argparse
+import os
+import sys
+
+import numpy as np
+import onnx
+import onnxruntime as ort
+from onnxruntime.quantization import QuantType, quantize_dynamic
+from onnxconverter_common import float16
+from transformers import PreTrainedTokenizerFast
+
+# 与 C++ 端 ModelPrecision 对应的文件名
+OUTPUT_FILES = {
+    "int8": "model_int8.onnx",
+    "fp16": "model_fp16.onnx",
+}
+
+# 量化模型与 fp32 模型输出向量的最低余弦相似度，低于该值视为不可用
+DEFAULT_THRESHOLDS = {
+    "int8": 0.98,
+    "fp16": 0.999,
+}
+
+SAMPLE_TEXTS = [
+    "你好，世界！",
+    "今天天气不错。",
+    "OpenAI is building amazing models.",
+    "如何前往火车站？",
+    "The quick brown fox jumps over the lazy dog.",
+    "人工智能正在改变世界。",
+    "Bonjour le monde!",
+]
+
+
+def quantize_int8(src, dst):
+    # 仅量化权重（MatMul/Gemm 等），激活值在运行时动态量化，无需校准数据
+    quantize_dynamic(
+        model_input=src,
+        model_output=dst,
+        weight_type=QuantType.QInt8,
+        per_channel=True,
+    )
+
+
+def convert_fp16(src, dst):
+    model = onnx.load(src)
+    # 保持 fp32 输入输出，C++ 端无需区分精度即可读取输出
+    model_fp16 = float16.convert_float_to_float16(model, keep_io_types=True)
+    onnx.save(model_fp16, dst)
+
+
+def select_output_name(output_names):
+    # 与 C++ 端 OnnxRuntimeEmbedding::select_output_name 一致，校验的是运行时实际使用的输出
+    for name in output_names:
+        if "sentence" in name or "embedding" in name:
+            return name
+    return next((name for name in output_names if name != "last_hidden_state"), None)
+
+
+def embed(session, tokenizer, text):
+    inputs = tokenizer(text, return_tensors="np", truncation=True)
+    feeds = {
+        "input_ids": inputs["input_ids"].astype(np.int64),
+        "attention_mask": inputs["attention_mask"].astype(np.int64),
+    }
+    output_names = [o.name for o in session.get_outputs()]
+    sentence_output = select_output_name(output_names)
+
+    if sentence_output:
+        vec = session.run([sentence_output], feeds)[0].squeeze()
+    else:
+        hidden = session.run(["last_hidden_state"], feeds)[0]
+        mask = np.expand_dims(feeds["attention_mask"], axis=-1)
+        vec = (np.sum(hidden * mask, axis=1) / np.clip(mask.sum(axis=1), 1e-9, None)).squeeze()
+    return vec / (np.linalg.norm(vec) + 1e-12)
+
+
+def check_accuracy(model_dir, variant_file, threshold):
+    tokenizer = PreTrainedTokenizerFast(tokenizer_file=os.path.join(model_dir, "tokenizer.json"))
+    reference = ort.InferenceSession(os.path.join(model_dir, "model.onnx"), providers=["CPUExecutionProvider"])
+    candidate = ort.InferenceSession(variant_file, providers=["CPUExecutionProvider"])
+
+    sims = [float(np.dot(embed(reference, tokenizer, t), embed(candidate, tokenizer, t))) for t in SAMPLE_TEXTS]
+    min_sim = min(sims)
+    print(f"   余弦相似度 mean={np.mean(sims):.5f} min={min_sim:.5f} (阈值 {threshold})")
+    return min_sim >= threshold
+
+
+def main():
+    parser = argparse.ArgumentParser(description="导出 INT8 / FP16 量化模型并校验精度")
+    parser.add_argument("model_dir", help="包含 model.onnx 和 tokenizer.json 的目录路径")
+    parser.add_argument("--precision", choices=["int8", "fp16", "all"], default="all", help="导出的精度")
+    parser.add_argument("--threshold", type=float, default=None, help="覆盖默认的最低余弦相似度")
+    parser.add_argument("--skip-check", action="store_true", help="跳过与 fp32 的精度对比")
+    args = parser.parse_args()
+
+    src = os.path.join(args.model_dir, "model.onnx")
+    if not os.path.exists(src):
+        raise FileNotFoundError(f"未找到模型文件: {src}")
+
+    precisions = ["int8", "fp16"] if args.precision == "all" else [args.precision]
+    passed = True
+    for precision in precisions:
+        dst = os.path.join(args.model_dir, OUTPUT_FILES[precision])
+        # 先导出到临时文件，校验通过后再替换，避免 C++ 端 resolve_model_file 加载未通过校验的模型
+        tmp = dst + ".tmp"
+        try:
+            if precision == "int8":
+                quantize_int8(src, tmp)
+            else:
+                convert_fp16(src, tmp)
+            print(f"✅ {precision} 模型导出成功：{tmp} ({os.path.getsize(tmp) / 1e6:.1f} MB)")
+
+            if args.skip_check:
+                os.replace(tmp, dst)
+                print(f"⚠️ 已跳过精度校验，{dst} 未经验证")
+                continue
+            threshold = args.threshold if args.threshold is not None else DEFAULT_THRESHOLDS[precision]
+            if check_accuracy(args.model_dir, tmp, threshold):
+                os.replace(tmp, dst)
+                print(f"✅ {precision} 精度校验通过，已写入 {dst}")
+            else:
+                # 旧的同名文件可能来自其他版本的 model.onnx，一并删除，让运行时回退到 fp32
+                if os.path.exists(dst):
+                    os.remove(dst)
+                print(f"❌ {precision} 精度校验未通过，未写入 {dst}")
+                passed = False
+        finally:
+            if os.path.exists(tmp):
+                os.remove(tmp)
+
+    sys.exit(0 if passed else 1)
+
+
+if __name__ == "__main__":
+    main()